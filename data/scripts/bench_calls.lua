@@ -0,0 +1,53 @@
+-- measures the cost of calling reflected math functions from lua, 10M calls per case
+-- run through a LuaInterpreter that declared the types of the two.math module, with LuaInterpreter::call
+
+local count = 10000000
+
+local function bench(name, case)
+    local start = os.clock()
+    local result = case()
+    local elapsed = os.clock() - start
+    print(string.format("%-28s %8.3f s %8.1f ns/call   (%g)", name, elapsed, elapsed * 1e9 / count, result))
+end
+
+bench("ncosf(float) -> float", function()
+    local sum = 0.0
+    for i = 1, count do
+        sum = sum + ncosf(i * 0.001)
+    end
+    return sum
+end)
+
+bench("vec3(float, float, float)", function()
+    local v
+    for i = 1, count do
+        v = vec3(i, 0.5, 0.25)
+    end
+    return v.x
+end)
+
+bench("vec3.x get", function()
+    local v = vec3(1.0, 2.0, 3.0)
+    local sum = 0.0
+    for i = 1, count do
+        sum = sum + v.x
+    end
+    return sum
+end)
+
+bench("vec3.x set", function()
+    local v = vec3(1.0, 2.0, 3.0)
+    for i = 1, count do
+        v.x = i
+    end
+    return v.x
+end)
+
+bench("look_dir(vec3) -> quat", function()
+    local direction = vec3(0.0, 0.0, 1.0)
+    local q
+    for i = 1, count do
+        q = look_dir(direction)
+    end
+    return q ~= nil and 1 or 0
+end)
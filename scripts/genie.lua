@@ -28,6 +28,10 @@ if _OPTIONS["tools"] then
     two_binary("webcl", { two.webcl })
 end
 
+if _OPTIONS["ui-bench"] then
+    two_binary("ui_bench", { two.ui.null, two.ui.bench })
+end
+
 if _OPTIONS["webcompile"] then
 	two_webcl("webproject")
 end
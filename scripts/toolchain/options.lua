@@ -111,6 +111,16 @@ newoption {
     description = "Use vg-renderer",
 }
 
+newoption {
+    trigger = "vg-batch",
+    description = "Use the batched vg backend (with vg-vg)",
+}
+
+newoption {
+    trigger = "ui-bench",
+    description = "Build the headless ui benchmark",
+}
+
 newoption {
     trigger = "vg-nanovg",
     description = "Use NanoVG",
@@ -139,6 +139,7 @@ end
 function two_ui()
     two_module()
     includedirs {
+        path.join(TWO_3RDPARTY_DIR, "stb"),
         path.join(TWO_3RDPARTY_DIR, "json11"),
     }
 end
@@ -320,10 +321,10 @@ else
   two.math  = module("two", "math",     TWO_SRC_DIR,    "math",     two_math,   uses_two_math,  true,       { stb.image, stb.rect_pack, two.infra, two.type })
 end     
 -- geom
-two.geom    = module("two", "geom",     TWO_SRC_DIR,    "geom",     two_geom,   nil,            true,       { mikktspace, two.type, two.math })
+two.geom    = module("two", "geom",     TWO_SRC_DIR,    "geom",     two_geom,   nil,            true,       { mikktspace, two.infra, two.jobs, two.type, two.math })
 -- procgen
-two.noise   = module("two", "noise",    TWO_SRC_DIR,    "noise",    two_noise,  uses_two_noise, true,       { fastnoise, two.infra, two.type, two.math, two.geom })
-two.wfc     = module("two", "wfc",      TWO_SRC_DIR,    "wfc",      two_wfc,    nil,            true,       { json11, two.infra, two.type, two.srlz, two.math, two.geom })
+two.noise   = module("two", "noise",    TWO_SRC_DIR,    "noise",    two_noise,  uses_two_noise, true,       { fastnoise, two.infra, two.jobs, two.type, two.math, two.geom })
+two.wfc     = module("two", "wfc",      TWO_SRC_DIR,    "wfc",      two_wfc,    nil,            true,       { json11, two.infra, two.jobs, two.type, two.srlz, two.math, two.geom })
 two.fract   = module("two", "fract",    TWO_SRC_DIR,    "fract",    two_module, nil,            true,       { json11, two.infra, two.type, two.math, two.geom })
 -- lang
 two.lang    = module("two", "lang",     TWO_SRC_DIR,    "lang",     two_lang,   nil,            true,       { lua, wren, two.infra, two.type, two.pool, two.refl })
@@ -332,7 +333,7 @@ two.ctx     = module("two", "ctx",      TWO_SRC_DIR,    "ctx",      two_module,
 two.ui      = module("two", "ui",       TWO_SRC_DIR,    "ui",       two_ui,     uses_two_ui,    true,       { two.infra, two.type, two.math, two.ctx })
 two.uio     = module("two", "uio",      TWO_SRC_DIR,    "uio",      two_module, nil,            true,       { two.infra, two.tree, two.type, two.ecs, two.pool, two.refl, two.math, two.lang, two.ctx, two.ui })
 -- snd
-two.snd     = module("two", "snd",      TWO_SRC_DIR,    "snd",      two_snd,    uses_two_snd,   true,       { ogg, vorbis, vorbisfile, two.type, two.math })
+two.snd     = module("two", "snd",      TWO_SRC_DIR,    "snd",      two_snd,    uses_two_snd,   true,       { ogg, vorbis, vorbisfile, two.type, two.math, two.jobs })
 
 if _OPTIONS["context-glfw"] then
     dofile(path.join(TWO_DIR, "scripts/two_ctx_glfw.lua"))
@@ -376,6 +377,11 @@ if _OPTIONS["tools"] then
   two.webcl  = module("two", "webcl",   TWO_SRC_DIR,    "webcl",    two_webcl,  nil,            false,      { json11, zeromq, two.infra })
 end
 
+if _OPTIONS["ui-bench"] then
+  two.ui.null  = module("two", "ui-null",  TWO_SRC_DIR, "ui-null",  two_module,  nil,         false,      { two.infra, two.type, two.math, two.ctx, two.ui })
+  two.ui.bench = module("two", "ui-bench", TWO_SRC_DIR, "ui-bench", two_module,  nil,         false,      { two.infra, two.type, two.math, two.ctx, two.ui, two.ui.null })
+end
+
 --two_sys(true)
 --two_vec(true)
 --two.db = module("two", "db", TWO_SRC_DIR, "db", { two.type, two.util })
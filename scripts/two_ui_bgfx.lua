@@ -16,6 +16,12 @@ function uses_two_ui_vg()
     defines {
         "TWO_VG_VG",
     }
+    
+    if _OPTIONS["vg-batch"] then
+        defines {
+            "TWO_VG_BATCH",
+        }
+    end
 end
 
 function two_ui_nvg()
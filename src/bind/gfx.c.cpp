@@ -818,6 +818,24 @@ extern "C" {
 	void DECL two_RenderFrame__set_nutriangles(two::RenderFrame* self, uint32_t value) {
 		self->m_num_triangles = value;
 	}
+	uint32_t DECL two_RenderFrame__get_nushadow_casters(two::RenderFrame* self) {
+		return self->m_num_shadow_casters;
+	}
+	void DECL two_RenderFrame__set_nushadow_casters(two::RenderFrame* self, uint32_t value) {
+		self->m_num_shadow_casters = value;
+	}
+	uint32_t DECL two_RenderFrame__get_nushadow_maps(two::RenderFrame* self) {
+		return self->m_num_shadow_maps;
+	}
+	void DECL two_RenderFrame__set_nushadow_maps(two::RenderFrame* self, uint32_t value) {
+		self->m_num_shadow_maps = value;
+	}
+	uint32_t DECL two_RenderFrame__get_nushadow_cached(two::RenderFrame* self) {
+		return self->m_num_shadow_cached;
+	}
+	void DECL two_RenderFrame__set_nushadow_cached(two::RenderFrame* self, uint32_t value) {
+		self->m_num_shadow_cached = value;
+	}
 	void DECL two_RenderFrame__destroy(two::RenderFrame* self) {
 		delete self;
 	}
@@ -3087,6 +3105,12 @@ extern "C" {
 	void DECL two_Light__set_shadow_bias(two::Light* self, float value) {
 		self->m_shadow_bias = value;
 	}
+	uint32_t DECL two_Light__get_shadow_casters(two::Light* self) {
+		return self->m_shadow_casters;
+	}
+	void DECL two_Light__set_shadow_casters(two::Light* self, uint32_t value) {
+		self->m_shadow_casters = value;
+	}
 	void DECL two_Light__destroy(two::Light* self) {
 		delete self;
 	}
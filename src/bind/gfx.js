@@ -1091,6 +1091,33 @@ Object.defineProperty(RenderFrame.prototype, "nutriangles", {
         _two_RenderFrame__set_nutriangles(this.__ptr, value);
     }
 });
+Object.defineProperty(RenderFrame.prototype, "nushadow_casters", {
+    get: function() {
+        return _two_RenderFrame__get_nushadow_casters(this.__ptr);
+    },
+    set: function(value) {
+        if (typeof value !== 'number') throw Error('RenderFrame.nushadow_casters: expected integer');
+        _two_RenderFrame__set_nushadow_casters(this.__ptr, value);
+    }
+});
+Object.defineProperty(RenderFrame.prototype, "nushadow_maps", {
+    get: function() {
+        return _two_RenderFrame__get_nushadow_maps(this.__ptr);
+    },
+    set: function(value) {
+        if (typeof value !== 'number') throw Error('RenderFrame.nushadow_maps: expected integer');
+        _two_RenderFrame__set_nushadow_maps(this.__ptr, value);
+    }
+});
+Object.defineProperty(RenderFrame.prototype, "nushadow_cached", {
+    get: function() {
+        return _two_RenderFrame__get_nushadow_cached(this.__ptr);
+    },
+    set: function(value) {
+        if (typeof value !== 'number') throw Error('RenderFrame.nushadow_cached: expected integer');
+        _two_RenderFrame__set_nushadow_cached(this.__ptr, value);
+    }
+});
 RenderFrame.prototype["__destroy"] = RenderFrame.prototype.__destroy = function() {
     _two_RenderFrame__destroy(this.__ptr);
 };
@@ -4313,6 +4340,15 @@ Object.defineProperty(Light.prototype, "shadow_bias", {
         _two_Light__set_shadow_bias(this.__ptr, value);
     }
 });
+Object.defineProperty(Light.prototype, "shadow_casters", {
+    get: function() {
+        return _two_Light__get_shadow_casters(this.__ptr);
+    },
+    set: function(value) {
+        if (typeof value !== 'number') throw Error('Light.shadow_casters: expected integer');
+        _two_Light__set_shadow_casters(this.__ptr, value);
+    }
+});
 Light.prototype["__destroy"] = Light.prototype.__destroy = function() {
     _two_Light__destroy(this.__ptr);
 };
@@ -4,6 +4,7 @@
 #include <ctx/InputDevice.h>
 #include <ctx/InputDispatcher.h>
 #include <ctx/InputEvent.h>
+#include <ctx/InputRecord.h>
 #include <ctx/KeyCode.h>
 #include <ctx/Types.h>
 
@@ -31,6 +31,8 @@ namespace two
     class ControlNode;
     struct EventBatch;
     class EventDispatcher;
+    struct RecordedInput;
+    class InputRecord;
     class InputDevice;
     class Keyboard;
     class MouseButton;
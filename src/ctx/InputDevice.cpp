@@ -15,6 +15,7 @@ module two.ctx;
 #include <ctx/InputDevice.h>
 #include <ctx/InputEvent.h>
 #include <ctx/ControlNode.h>
+#include <ctx/InputRecord.h>
 #endif
 
 
@@ -50,8 +51,20 @@ namespace two
 		m_dispatcher.dispatch_event(m_events.back());
 	}
 
+	void Keyboard::record(uint8_t type, Key key, Key translated, InputMod mods)
+	{
+		if(!m_dispatcher.m_record) return;
+		RecordedInput input; input.m_type = RecordedInput::Type(type); input.m_key = key; input.m_translated = translated; input.m_modifiers = mods;
+		m_dispatcher.m_record->push(input);
+	}
+
 	void Keyboard::key_char(char c)
 	{
+		if(m_dispatcher.m_record)
+		{
+			RecordedInput input; input.m_type = RecordedInput::KeyChar; input.m_char = c;
+			m_dispatcher.m_record->push(input);
+		}
 		dispatch_event(KeyEvent(DeviceType::Keyboard, EventType::Stroked, Key::Unassigned, c, InputMod::None));
 	}
 
@@ -66,6 +79,7 @@ namespace two
 
 	void Keyboard::key_pressed(Key key, Key translated, InputMod mods)
 	{
+		this->record(RecordedInput::KeyPressed, key, translated, mods);
 		dispatch_event(KeyEvent(DeviceType::Keyboard, EventType::Pressed, key, char(0), mods));
 		dispatch_event(KeyEvent(DeviceType::Keyboard, EventType::Pressed, translated, char(0), mods));
 	}
@@ -81,6 +95,7 @@ namespace two
 
 	void Keyboard::key_released(Key key, Key translated, InputMod mods)
 	{
+		this->record(RecordedInput::KeyReleased, key, translated, mods);
 		dispatch_event(KeyEvent(DeviceType::Keyboard, EventType::Released, key, char(0), mods));
 		dispatch_event(KeyEvent(DeviceType::Keyboard, EventType::Released, translated, char(0), mods));
 	}
@@ -92,6 +107,7 @@ namespace two
 
 	void Keyboard::key_stroke(Key key, Key translated, InputMod mods)
 	{
+		this->record(RecordedInput::KeyStroked, key, translated, mods);
 		dispatch_event(KeyEvent(DeviceType::Keyboard, EventType::Stroked, key, char(0), mods));
 		dispatch_event(KeyEvent(DeviceType::Keyboard, EventType::Stroked, translated, char(0), mods));
 	}
@@ -126,6 +142,8 @@ namespace two
 
 	MouseEvent& Mouse::heartbeat()
 	{
+		this->flush();
+
 		MouseEvent& event = dispatch_event(MouseEvent(DeviceType::Mouse, EventType::Heartbeat, m_pos));
 		m_last_pos = m_pos;
 		m_pos = event.m_pos;
@@ -137,10 +155,28 @@ namespace two
 
 	void Mouse::moved(vec2 pos, vec2* offset)
 	{
+		if(m_dispatcher.m_record)
+		{
+			RecordedInput input; input.m_type = RecordedInput::Moved; input.m_pos = pos; input.m_offset = offset != nullptr; input.m_delta = offset ? *offset : vec2(0.f);
+			m_dispatcher.m_record->push(input);
+		}
+
 		m_pos = offset ? m_pos + *offset : pos;
 
+		if(m_coalesce)
+		{
+			m_moved = true;
+			m_moved_pos = pos;
+		}
+		else
+			this->dispatch_moved(pos);
+	}
+
+	void Mouse::dispatch_moved(vec2 pos)
+	{
 		MouseEvent& event = dispatch_event(MouseEvent(DeviceType::Mouse, EventType::Moved, pos));
-		
+
+
 		const float drag_threshold = 3.f;
 
 		for(MouseButton& button : m_buttons)
@@ -154,10 +190,46 @@ namespace two
 
 	void Mouse::wheeled(vec2 pos, float amount)
 	{
-		MouseEvent& event = dispatch_event(MouseEvent(DeviceType::MouseMiddle, EventType::Moved, pos, m_keyboard.modifiers()));
+		const InputMod modifiers = m_keyboard.modifiers();
+		if(m_dispatcher.m_record)
+		{
+			RecordedInput input; input.m_type = RecordedInput::Wheeled; input.m_pos = pos; input.m_amount = amount; input.m_modifiers = modifiers;
+			m_dispatcher.m_record->push(input);
+		}
+
+		if(!m_coalesce)
+			return this->dispatch_wheeled(pos, amount, modifiers);
+
+		// a modifier change splits the wheel motion, since it changes its meaning
+		if(m_wheeled && modifiers != m_wheel_modifiers)
+			this->flush();
+
+		m_wheel = m_wheeled ? m_wheel + amount : amount;
+		m_wheel_pos = pos;
+		m_wheel_modifiers = modifiers;
+		m_wheeled = true;
+	}
+
+	void Mouse::dispatch_wheeled(vec2 pos, float amount, InputMod modifiers)
+	{
+		MouseEvent& event = dispatch_event(MouseEvent(DeviceType::MouseMiddle, EventType::Moved, pos, modifiers));
 		event.m_deltaZ = amount;
 	}
 
+	void Mouse::flush()
+	{
+		if(m_moved)
+		{
+			m_moved = false;
+			this->dispatch_moved(m_moved_pos);
+		}
+		if(m_wheeled)
+		{
+			m_wheeled = false;
+			this->dispatch_wheeled(m_wheel_pos, m_wheel, m_wheel_modifiers);
+		}
+	}
+
 	void Mouse::fix_press(ControlNode& node)
 	{
 		for(MouseButton& button : m_buttons)
@@ -172,6 +244,13 @@ namespace two
 
 	void MouseButton::pressed(vec2 pos, InputMod modifiers)
 	{
+		if(m_dispatcher.m_record)
+		{
+			RecordedInput input; input.m_type = RecordedInput::ButtonPressed; input.m_button = uint8_t(this - m_mouse.m_buttons); input.m_pos = pos; input.m_modifiers = modifiers;
+			m_dispatcher.m_record->push(input);
+		}
+
+		m_mouse.flush();
 		MouseEvent& event = m_mouse.dispatch_event(MouseEvent(m_deviceType, EventType::Pressed, pos, modifiers));
 
 		m_pressed = m_dispatcher.dispatch_event(event);
@@ -185,6 +264,13 @@ namespace two
 
 	void MouseButton::released(vec2 pos)
 	{
+		if(m_dispatcher.m_record)
+		{
+			RecordedInput input; input.m_type = RecordedInput::ButtonReleased; input.m_button = uint8_t(this - m_mouse.m_buttons); input.m_pos = pos;
+			m_dispatcher.m_record->push(input);
+		}
+
+		m_mouse.flush();
 		MouseEvent& event = m_mouse.dispatch_event(MouseEvent(m_deviceType, EventType::Released, pos, m_pressed_event.m_modifiers));
 
 		if(m_dragging)
@@ -237,7 +323,9 @@ namespace two
 	}
 
 	void InputContext::begin_frame()
-	{}
+	{
+		m_mouse.flush();
+	}
 
 	void InputContext::end_frame()
 	{
@@ -41,6 +41,10 @@ namespace two
 		void key_stroke(Key key, Key translated, InputMod mods);
 		void key_char(char c);
 
+	private:
+		void record(uint8_t type, Key key, Key translated, InputMod mods);
+
+	public:
 		bool m_shift = false;
 		bool m_ctrl = false;
 		bool m_alt = false;
@@ -83,6 +87,9 @@ namespace two
 		void moved(vec2 pos, vec2* offset = nullptr);
 		void wheeled(vec2 pos, float amount);
 
+		// dispatch the pending coalesced motion
+		void flush();
+
 		void fix_press(ControlNode& node);
 
 	public:
@@ -92,6 +99,20 @@ namespace two
 		MouseButton m_buttons[3];
 
 		vector<MouseEvent> m_events;
+
+		// consecutive moves and wheel deltas are merged into one event, dispatched before the next button event or heartbeat
+		bool m_coalesce = true;
+
+	private:
+		void dispatch_moved(vec2 pos);
+		void dispatch_wheeled(vec2 pos, float amount, InputMod modifiers);
+
+		bool m_moved = false;
+		vec2 m_moved_pos;
+		bool m_wheeled = false;
+		vec2 m_wheel_pos;
+		float m_wheel = 0.f;
+		InputMod m_wheel_modifiers = InputMod::None;
 	};
 
 	export_ class TWO_CTX_EXPORT InputContext : public ControlNode, public EventDispatcher
@@ -13,6 +13,7 @@ module two.ctx;
 #include <ctx/InputDispatcher.h>
 #include <ctx/InputDevice.h>
 #include <ctx/ControlNode.h>
+#include <ctx/InputRecord.h>
 #endif
 
 namespace two
@@ -37,6 +38,9 @@ namespace two
 		}
 
 		m_top = 0;
+
+		if(m_record)
+			m_record->next_frame();
 	}
 
 	void EventDispatcher::receive_event(InputEvent& event, ControlNode& receiver)
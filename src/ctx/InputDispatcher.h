@@ -43,5 +43,8 @@ namespace two
 		ControlNode& m_control_node;
 		vector<EventBatch> m_event_batches;
 		size_t m_top = 0;
+
+		// when set, the raw input received by the devices is recorded, one frame per update
+		InputRecord* m_record = nullptr;
 	};
 }
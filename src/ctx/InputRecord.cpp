@@ -0,0 +1,118 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#include <infra/Cpp20.h>
+#ifndef TWO_CPP_20
+#include <cstring>
+#endif
+
+#ifdef TWO_MODULES
+module two.ctx;
+#else
+#include <stl/vector.hpp>
+#include <infra/File.h>
+#include <ctx/InputRecord.h>
+#include <ctx/InputDevice.h>
+#endif
+
+namespace two
+{
+	static const uint32_t c_record_magic = 0x54504e49; // 'INPT'
+
+	void InputRecord::clear()
+	{
+		m_frame = 0;
+		m_inputs.clear();
+	}
+
+	void InputRecord::push(RecordedInput input)
+	{
+		input.m_frame = m_frame;
+		m_inputs.push_back(input);
+	}
+
+	void InputRecord::replay(uint32_t frame, Mouse& mouse, Keyboard& keyboard) const
+	{
+		// first input of the frame
+		size_t lo = 0;
+		size_t hi = m_inputs.size();
+		while(lo < hi)
+		{
+			const size_t mid = (lo + hi) / 2;
+			if(m_inputs[mid].m_frame < frame)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		auto mod = [](InputMod modifiers, InputMod mod) { return (uint8_t(modifiers) & uint8_t(mod)) != 0; };
+
+		for(size_t i = lo; i < m_inputs.size() && m_inputs[i].m_frame == frame; ++i)
+		{
+			const RecordedInput& input = m_inputs[i];
+			switch(input.m_type)
+			{
+			case RecordedInput::Moved:
+			{
+				vec2 delta = input.m_delta;
+				mouse.moved(input.m_pos, input.m_offset ? &delta : nullptr);
+				break;
+			}
+			case RecordedInput::Wheeled:
+				keyboard.update_modifiers(mod(input.m_modifiers, InputMod::Shift), mod(input.m_modifiers, InputMod::Ctrl), mod(input.m_modifiers, InputMod::Alt));
+				mouse.wheeled(input.m_pos, input.m_amount);
+				break;
+			case RecordedInput::ButtonPressed:
+				mouse.m_buttons[input.m_button].pressed(input.m_pos, input.m_modifiers);
+				break;
+			case RecordedInput::ButtonReleased:
+				mouse.m_buttons[input.m_button].released(input.m_pos);
+				break;
+			case RecordedInput::KeyPressed:
+				keyboard.update_modifiers(mod(input.m_modifiers, InputMod::Shift), mod(input.m_modifiers, InputMod::Ctrl), mod(input.m_modifiers, InputMod::Alt));
+				keyboard.key_pressed(input.m_key, input.m_translated, input.m_modifiers);
+				break;
+			case RecordedInput::KeyReleased:
+				keyboard.update_modifiers(mod(input.m_modifiers, InputMod::Shift), mod(input.m_modifiers, InputMod::Ctrl), mod(input.m_modifiers, InputMod::Alt));
+				keyboard.key_released(input.m_key, input.m_translated, input.m_modifiers);
+				break;
+			case RecordedInput::KeyStroked:
+				keyboard.key_stroke(input.m_key, input.m_translated, input.m_modifiers);
+				break;
+			case RecordedInput::KeyChar:
+				keyboard.key_char(input.m_char);
+				break;
+			}
+		}
+	}
+
+	void InputRecord::save(const string& path) const
+	{
+		const size_t size = m_inputs.size() * sizeof(RecordedInput);
+		vector<uint8_t> data(2 * sizeof(uint32_t) + size);
+		memcpy(data.data(), &c_record_magic, sizeof(uint32_t));
+		memcpy(data.data() + sizeof(uint32_t), &m_frame, sizeof(uint32_t));
+		if(size > 0)
+			memcpy(data.data() + 2 * sizeof(uint32_t), m_inputs.data(), size);
+		write_binary_file(path, data);
+	}
+
+	bool InputRecord::load(const string& path)
+	{
+		const vector<uint8_t> data = read_binary_file(path);
+		if(data.size() < 2 * sizeof(uint32_t))
+			return false;
+
+		uint32_t magic = 0;
+		memcpy(&magic, data.data(), sizeof(uint32_t));
+		if(magic != c_record_magic || (data.size() - 2 * sizeof(uint32_t)) % sizeof(RecordedInput) != 0)
+			return false;
+
+		memcpy(&m_frame, data.data() + sizeof(uint32_t), sizeof(uint32_t));
+		m_inputs.resize((data.size() - 2 * sizeof(uint32_t)) / sizeof(RecordedInput));
+		if(!m_inputs.empty())
+			memcpy(m_inputs.data(), data.data() + 2 * sizeof(uint32_t), m_inputs.size() * sizeof(RecordedInput));
+		return true;
+	}
+}
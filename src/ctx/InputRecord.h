@@ -0,0 +1,57 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#pragma once
+
+#ifndef TWO_MODULES
+#include <stl/string.h>
+#include <stl/vector.h>
+#include <math/Vec.h>
+#endif
+#include <ctx/Forward.h>
+#include <ctx/KeyCode.h>
+#include <ctx/InputEvent.h>
+
+namespace two
+{
+	// raw device input, as received from the context, tagged with the frame it was received in
+	export_ struct RecordedInput
+	{
+		enum Type : uint8_t { Moved, Wheeled, ButtonPressed, ButtonReleased, KeyPressed, KeyReleased, KeyStroked, KeyChar };
+
+		uint32_t m_frame = 0;
+		Type m_type = Moved;
+		uint8_t m_button = 0;
+		InputMod m_modifiers = InputMod::None;
+		char m_char = 0;
+		Key m_key = Key(0);
+		Key m_translated = Key(0);
+		bool m_offset = false;
+		vec2 m_pos = vec2(0.f);
+		vec2 m_delta = vec2(0.f);
+		float m_amount = 0.f;
+	};
+
+	// records the input fed to a dispatcher devices, and feeds it back frame by frame
+	// recorded input goes through the same coalescing and dispatch as live input, so replaying a session is a headless benchmark of the input handling
+	export_ class TWO_CTX_EXPORT InputRecord
+	{
+	public:
+		void clear();
+		void next_frame() { m_frame++; }
+
+		void push(RecordedInput input);
+
+		uint32_t frame_count() const { return m_frame; }
+
+		// feed the input recorded at frame to the devices
+		void replay(uint32_t frame, Mouse& mouse, Keyboard& keyboard) const;
+
+		void save(const string& path) const;
+		bool load(const string& path);
+
+		uint32_t m_frame = 0;
+		vector<RecordedInput> m_inputs;
+	};
+}
@@ -14,6 +14,7 @@ namespace stl
 	template class TWO_CTX_EXPORT vector<EventBatch>;
 	template class TWO_CTX_EXPORT vector<KeyEvent>;
 	template class TWO_CTX_EXPORT vector<MouseEvent>;
+	template class TWO_CTX_EXPORT vector<RecordedInput>;
 	template class TWO_CTX_EXPORT unordered_map<int, InputEvent*>;
 }
 #endif
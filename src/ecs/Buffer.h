@@ -25,6 +25,8 @@ namespace two
 		virtual void remove(uint32_t index) = 0;
 #ifdef TWO_ECS_TYPED
 		virtual Ref get(uint32_t index) = 0;
+		// the components are contiguous, meta(*m_type).m_size bytes apart
+		virtual void* data() = 0;
 #endif
 	};
 
@@ -55,6 +57,7 @@ namespace two
 
 #ifdef TWO_ECS_TYPED
 		virtual Ref get(uint32_t index) override { return Ref(&m_data[index], *m_type); }
+		virtual void* data() override { return m_data.data(); }
 #endif
 
 		vector<T> m_data;
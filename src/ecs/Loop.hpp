@@ -4,6 +4,7 @@
 #include <ecs/Forward.h>
 #include <ecs/ECS.hpp>
 #include <jobs/JobLoop.hpp>
+#include <jobs/Commands.h>
 
 namespace two
 {
@@ -40,4 +41,29 @@ namespace two
 	{
 		return for_components_impl<Types...>(job_system, parent, ecs, action, index_tuple<sizeof...(Types)>());
 	}
+
+	// same as for_components, but the action also receives the index of the thread it runs on,
+	// to select state owned by that thread, e.g. a script vm, or the command buffer to record mutations to
+	template <class... Types, class T_Function>
+	Job* for_components_threaded(JobSystem& job_system, Job* parent, ECS& ecs, T_Function action)
+	{
+		auto threaded = [&job_system, action](Types&... components)
+		{
+			action(job_system.thread(), components...);
+		};
+		return for_components<Types...>(job_system, parent, ecs, threaded);
+	}
+
+	// runs a script callback per entity in parallel : each thread calls into its own vm from the pool,
+	// and mutations of the ecs or of the world must be recorded to the commands of that thread, to be applied on the main thread
+	// the pool is any type providing interpreter(thread), e.g. ScriptPool
+	template <class... Types, class T_Pool, class T_Function>
+	Job* for_scripts(JobSystem& job_system, Job* parent, ECS& ecs, T_Pool& pool, ThreadCommands& commands, T_Function action)
+	{
+		auto script = [&pool, &commands, action](uint32_t thread, Types&... components)
+		{
+			action(pool.interpreter(thread), commands[thread], components...);
+		};
+		return for_components_threaded<Types...>(job_system, parent, ecs, script);
+	}
 }
@@ -2,6 +2,7 @@
 //#include <frame/Types.h>
 
 #include <ui-vg/VgVg.h>
+#include <ui-vg/VgBatch.h>
 
 #ifdef TWO_PLATFORM_EMSCRIPTEN
 #include <emscripten/emscripten.h>
@@ -27,7 +28,10 @@ namespace two
 
 	unique<Vg> create_vg(GfxSystem& gfx, const string& resource_path)
 	{
-#if defined TWO_VG_VG
+#if defined TWO_VG_BATCH
+		Program& program = gfx.programs().fetch("ui_batch");
+		return construct<VgBatch>(resource_path, [&program]() { return program.default_version(); });
+#elif defined TWO_VG_VG
 		return construct<VgVg>(resource_path, &gfx.allocator());
 #elif defined TWO_VG_NANOVG
 		return construct<VgNanoBgfx>(m_resource_path);
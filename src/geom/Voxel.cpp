@@ -12,6 +12,16 @@ module two.geom;
 #include <geom/Voxel.h>
 #include <geom/Primitive.hpp>
 #include <geom/Geometry.h>
+#include <jobs/Job.h>
+#endif
+
+#include <cstring>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define TWO_VOXEL_SSE 1
+#include <emmintrin.h>
+#else
+#define TWO_VOXEL_SSE 0
 #endif
 
 #define FLAT false
@@ -69,14 +79,47 @@ namespace two
 		return cubeindex;
 	}
 
+	void MarchingCubes::classify4(size_t q, float isol, uint8_t* cubeindices) const
+	{
+#if TWO_VOXEL_SSE
+		const float* field = m_field.data() + q;
+		const __m128 visol = _mm_set1_ps(isol);
+		__m128i index = _mm_setzero_si128();
+
+		auto corner = [&](size_t offset, int bit)
+		{
+			const __m128 below = _mm_cmplt_ps(_mm_loadu_ps(field + offset), visol);
+			index = _mm_or_si128(index, _mm_and_si128(_mm_castps_si128(below), _mm_set1_epi32(bit)));
+		};
+
+		corner(0, 1);
+		corner(1, 2);
+		corner(m_yd, 8);
+		corner(1 + m_yd, 4);
+		corner(m_zd, 16);
+		corner(1 + m_zd, 32);
+		corner(m_yd + m_zd, 128);
+		corner(1 + m_yd + m_zd, 64);
+
+		alignas(16) int32_t lanes[4];
+		_mm_store_si128((__m128i*)lanes, index);
+		for(size_t i = 0; i < 4; ++i)
+			cubeindices[i] = uint8_t(lanes[i]);
+#else
+		for(size_t i = 0; i < 4; ++i)
+			cubeindices[i] = this->classify(q + i, isol);
+#endif
+	}
+
 	inline void calc_normal(MarchingCubes::Cache& cache, const MarchingCubes& cubes, size_t q)
 	{
-		if(!cache.m_normal[q].set)
+		MarchingCubes::Cache::Normal& normal = cache.m_normal[q - cache.m_offset];
+		if(!normal.set)
 		{
-			cache.m_normal[q].n.x = cubes.m_field[q - 1] - cubes.m_field[q + 1];
-			cache.m_normal[q].n.y = cubes.m_field[q - cubes.m_yd] - cubes.m_field[q + cubes.m_yd];
-			cache.m_normal[q].n.z = cubes.m_field[q - cubes.m_zd] - cubes.m_field[q + cubes.m_zd];
-			cache.m_normal[q].set = true;
+			normal.n.x = cubes.m_field[q - 1] - cubes.m_field[q + 1];
+			normal.n.y = cubes.m_field[q - cubes.m_yd] - cubes.m_field[q + cubes.m_yd];
+			normal.n.z = cubes.m_field[q - cubes.m_zd] - cubes.m_field[q + cubes.m_zd];
+			normal.set = true;
 		}
 	};
 
@@ -107,13 +150,13 @@ namespace two
 #if !FLAT_BLEND
 			if constexpr(!flat)
 #endif
-				cache.norm[i] = lerp(cache.m_normal[a.q].n, cache.m_normal[b.q].n, mu);
+				cache.norm[i] = lerp(cache.m_normal[a.q - cache.m_offset].n, cache.m_normal[b.q - cache.m_offset].n, mu);
 
 			cache.color[i] = lerp(cubes.m_colour[a.q], cubes.m_colour[b.q], mu);
 		}
 	};
 
-	uint8_t MarchingCubes::polygonize(Cache& cache, const vec3& p, size_t q, float isol) const
+	void MarchingCubes::polygonize(Cache& cache, const vec3& p, size_t q, float isol, uint8_t cubeindex) const
 	{
 		auto cell = [&](size_t q) -> Cell { return { q, m_field[q] }; };
 		// cache indices
@@ -126,21 +169,7 @@ namespace two
 		const Cell cyz = cell(q + m_yd + m_zd);
 		const Cell cxyz = cell(q + 1 + m_yd + m_zd);
 
-		uint8_t cubeindex = 0;
-
-		if(c.f    < isol) cubeindex |= 1;
-		if(cx.f   < isol) cubeindex |= 2;
-		if(cy.f   < isol) cubeindex |= 8;
-		if(cxy.f  < isol) cubeindex |= 4;
-		if(cz.f   < isol) cubeindex |= 16;
-		if(cxz.f  < isol) cubeindex |= 32;
-		if(cyz.f  < isol) cubeindex |= 128;
-		if(cxyz.f < isol) cubeindex |= 64;
-
-		// if cube is entirely in/out of the surface - bail, nothing to draw
-
 		const int bits = c_edge_table[cubeindex];
-		if(bits == 0) return 0;
 
 		const float d = m_delta;
 		const vec3 pp = p + d;
@@ -160,65 +189,9 @@ namespace two
 		calc_side<Axis::Z, FLAT>(cache, *this, bits, 512,  9,  isol, vec3(pp.x, p.y,  p.z ), cx,  cxz);
 		calc_side<Axis::Z, FLAT>(cache, *this, bits, 1024, 10, isol, vec3(pp.x, pp.y, p.z ), cxy, cxyz);
 		calc_side<Axis::Z, FLAT>(cache, *this, bits, 2048, 11, isol, vec3(p.x,  pp.y, p.z ), cy,  cyz);
-
-		return cubeindex;
 	}
 
-	uint32_t MarchingCubes::triangulate(MeshAdapter& output, Cache& cache, uint8_t cubeindex) const
-	{
-		const CubeSide& side = c_tri_table[cubeindex];
-
-		auto triangle = [&](size_t o1, size_t o2, size_t o3, bool flat = false)
-		{
-			output.dposition(cache.vert[o1]);
-			output.dposition(cache.vert[o2]);
-			output.dposition(cache.vert[o3]);
-
-			if(flat)
-			{
-#if FLAT_BLEND
-				vec3 n = normalize(cache.norm[o1] + cache.norm[o2] + cache.norm[o3]);
-#else
-				vec3 n = normalize(cross(cache.vert[o2] - cache.vert[o1], cache.vert[o3] - cache.vert[o1]));
-#endif
-				output.normal(n);
-				output.normal(n);
-				output.normal(n);
-			}
-			else
-			{
-				output.normal(cache.norm[o1]);
-				output.normal(cache.norm[o2]);
-				output.normal(cache.norm[o3]);
-			}
-
-			if((output.m_vertex_format & VertexAttribute::TexCoord0) != 0)
-			{
-				output.duv0(vec2(cache.vert[o1]));
-				output.duv0(vec2(cache.vert[o2]));
-				output.duv0(vec2(cache.vert[o3]));
-			}
-
-			if((output.m_vertex_format & VertexAttribute::Colour) != 0)
-			{
-				output.colour(cache.color[o1]);
-				output.colour(cache.color[o2]);
-				output.colour(cache.color[o3]);
-			}
-		};
-
-		size_t i = 0;
-		while(side.tris[i] != -1)
-		{
-			triangle(side.tris[i+0], side.tris[i+1], side.tris[i+2], FLAT);
-			i += 3;
-		}
-
-		//assert(i / 3 == side.num);
-		return uint32_t(side.num);
-	}
-
-	uint32_t MarchingCubes::triangulate(MeshPacker& output, Cache& cache, uint8_t cubeindex) const
+	uint32_t MarchingCubes::triangulate(Block& output, Cache& cache, uint8_t cubeindex) const
 	{
 		const CubeSide& side = c_tri_table[cubeindex];
 
@@ -246,19 +219,9 @@ namespace two
 				output.m_normals.push_back(cache.norm[o3]);
 			}
 
-			if(false) //output.m_has_uvs)
-			{
-				output.m_uv0s.push_back(vec2(cache.vert[o1]));
-				output.m_uv0s.push_back(vec2(cache.vert[o2]));
-				output.m_uv0s.push_back(vec2(cache.vert[o3]));
-			}
-			
-			if(false) //output.m_has_colors)
-			{
-				output.m_colours.push_back(to_colour(cache.color[o1]));
-				output.m_colours.push_back(to_colour(cache.color[o2]));
-				output.m_colours.push_back(to_colour(cache.color[o3]));
-			}
+			output.m_colours.push_back(cache.color[o1]);
+			output.m_colours.push_back(cache.color[o2]);
+			output.m_colours.push_back(cache.color[o3]);
 		};
 
 		size_t i = 0;
@@ -268,7 +231,6 @@ namespace two
 			i += 3;
 		}
 
-		//assert(i / 3 == side.num);
 		return uint32_t(side.num);
 	}
 
@@ -281,65 +243,176 @@ namespace two
 		}
 	}
 
-	void MarchingCubes::begin(Cache& cache) const
+	void MarchingCubes::begin(Cache& cache, uint32_t z0, uint32_t z1) const
 	{
-		if(cache.m_normal.size() != m_size)
-			cache.m_normal.resize(m_size);
-
-		//for(size_t i = 0; i < m_size; i++)
-		//	cache.m_normal[i].set = false;
+		// cubes in [z0, z1) read normals from layers z0 to z1 included
+		const size_t size = m_zd * (z1 - z0 + 1);
+		cache.m_offset = m_zd * z0;
+		if(cache.m_normal.size() != size)
+			cache.m_normal.resize(size);
 
 		memset(cache.m_normal.data(), 0, cache.m_normal.size() * sizeof(Cache::Normal));
 	}
 
-	uint32_t MarchingCubes::count() const
+	bool MarchingCubes::changed(const uvec3& lo, const uvec3& hi) const
 	{
-		uint32_t num_tris = 0;
+		// cubes read one cell past the block, and normals one more cell on each side
+		const uint32_t x0 = lo.x - 1, y0 = lo.y - 1, z0 = lo.z - 1;
+		const uint32_t x1 = min(hi.x + 2, m_subdiv), y1 = min(hi.y + 2, m_subdiv), z1 = min(hi.z + 2, m_subdiv);
 
-		const uint32_t subdiv = m_subdiv - 2;
-		for(uint32_t z = 1; z < subdiv; z++)
-			for(uint32_t y = 1; y < subdiv; y++)
-				for(uint32_t x = 1; x < subdiv; x++)
-				{
-					const size_t q = m_zd * z + m_yd * y + x;
-					const uint8_t cubeindex = classify(q, m_isolation);
-					num_tris += c_tri_table[cubeindex].num;
-				}
+		for(uint32_t z = z0; z < z1; z++)
+			for(uint32_t y = y0; y < y1; y++)
+			{
+				const size_t row = m_zd * z + m_yd * y + x0;
+				const size_t count = x1 - x0;
+				if(memcmp(&m_field[row], &m_last_field[row], count * sizeof(float)) != 0
+				|| memcmp(&m_colour[row], &m_last_colour[row], count * sizeof(vec3)) != 0)
+					return true;
+			}
 
-		return num_tris;
+		return false;
 	}
 
-	void MarchingCubes::direct(MeshAdapter& output) const
+	void MarchingCubes::mesh_block(Cache& cache, Block& block, const uvec3& lo, const uvec3& hi) const
 	{
-		this->begin(m_cache);
+		block.m_positions.clear();
+		block.m_normals.clear();
+		block.m_colours.clear();
 
-		const uint32_t subdiv = m_subdiv - 2;
-		for(uint32_t z = 1; z < subdiv; z++)
-			for(uint32_t y = 1; y < subdiv; y++)
-				for(uint32_t x = 1; x < subdiv; x++)
+		for(uint32_t z = lo.z; z < hi.z; z++)
+			for(uint32_t y = lo.y; y < hi.y; y++)
+				for(uint32_t x = lo.x; x < hi.x; x += 4)
 				{
 					const size_t q = m_zd * z + m_yd * y + x;
-					const vec3 f = (vec3(float(x), float(y), float(z)) - m_extent) / m_extent; //+ 1
-					const uint8_t cubeindex = polygonize(m_cache, f, q, m_isolation);
-					triangulate(output, m_cache, cubeindex);
+
+					uint8_t cubeindices[4];
+					this->classify4(q, m_isolation, cubeindices);
+
+					const uint32_t count = min(4U, hi.x - x);
+					for(uint32_t i = 0; i < count; ++i)
+					{
+						if(c_edge_table[cubeindices[i]] == 0)
+							continue;
+
+						const vec3 f = (vec3(uvec3(x + i, y, z)) - m_extent) / m_extent; //+ 1
+						this->polygonize(cache, f, q + i, m_isolation, cubeindices[i]);
+						this->triangulate(block, cache, cubeindices[i]);
+					}
 				}
 	}
 
-	void MarchingCubes::render(MeshPacker& output) const
+	void MarchingCubes::remesh_slab(uint32_t slab, bool force) const
 	{
-		this->begin(m_cache);
+		const uint32_t end = m_subdiv - 2;
+		auto range = [&](uint32_t b) { return uvec2(1 + b * c_block, min(1 + (b + 1) * c_block, end)); };
+
+		const uvec2 zr = range(slab);
 
-		const uint32_t subdiv = m_subdiv - 2;
+		Cache& cache = m_slab_caches[slab];
+		bool begun = false;
+
+		for(uint32_t by = 0; by < m_blocks; by++)
+			for(uint32_t bx = 0; bx < m_blocks; bx++)
+			{
+				const uvec2 xr = range(bx);
+				const uvec2 yr = range(by);
+				const uvec3 lo = { xr.x, yr.x, zr.x };
+				const uvec3 hi = { xr.y, yr.y, zr.y };
 
-		for(uint32_t z = 1; z < subdiv; z++)
-			for(uint32_t y = 1; y < subdiv; y++)
-				for(uint32_t x = 1; x < subdiv; x++)
+				if(!force && !this->changed(lo, hi))
+					continue;
+
+				if(!begun)
 				{
-					const size_t q = m_zd * z + m_yd * y + x;
-					const vec3 f = (vec3(uvec3(x, y, z)) - m_extent) / m_extent; //+ 1
-					const uint8_t cubeindex = polygonize(m_cache, f, q, m_isolation);
-					triangulate(output, m_cache, cubeindex);
+					this->begin(cache, zr.x, zr.y);
+					begun = true;
 				}
+
+				Block& block = m_block_meshes[m_blocks * m_blocks * slab + m_blocks * by + bx];
+				this->mesh_block(cache, block, lo, hi);
+			}
+	}
+
+	uint32_t MarchingCubes::remesh() const
+	{
+		if(m_subdiv < 4)
+			return 0;
+
+		const uint32_t cells = m_subdiv - 3;
+		const uint32_t blocks = (cells + c_block - 1) / c_block;
+
+		const bool force = blocks != m_blocks
+						|| m_last_field.size() != m_size
+						|| m_last_isolation != m_isolation;
+
+		if(blocks != m_blocks)
+		{
+			m_blocks = blocks;
+			m_block_meshes.clear();
+			m_block_meshes.resize(blocks * blocks * blocks);
+			m_slab_caches.resize(blocks);
+		}
+
+		JobSystem* js = JobSystem::instance();
+		if(js && blocks > 1)
+		{
+			Job* parent = js->job();
+			for(uint32_t slab = 0; slab < blocks; slab++)
+			{
+				auto task = [this, slab, force](JobSystem&, Job*) { this->remesh_slab(slab, force); };
+				js->run(js->job(parent, task));
+			}
+			js->complete(parent);
+		}
+		else
+		{
+			for(uint32_t slab = 0; slab < blocks; slab++)
+				this->remesh_slab(slab, force);
+		}
+
+		m_last_field = m_field;
+		m_last_colour = m_colour;
+		m_last_isolation = m_isolation;
+
+		uint32_t num_tris = 0;
+		for(const Block& block : m_block_meshes)
+			num_tris += uint32_t(block.m_positions.size() / 3);
+		return num_tris;
+	}
+
+	uint32_t MarchingCubes::count() const
+	{
+		return this->remesh();
+	}
+
+	void MarchingCubes::direct(MeshAdapter& output) const
+	{
+		this->remesh();
+
+		const bool uvs = (output.m_vertex_format & VertexAttribute::TexCoord0) != 0;
+		const bool colours = (output.m_vertex_format & VertexAttribute::Colour) != 0;
+
+		for(const Block& block : m_block_meshes)
+			for(size_t i = 0; i < block.m_positions.size(); ++i)
+			{
+				output.dposition(block.m_positions[i]);
+				output.normal(block.m_normals[i]);
+				if(uvs)
+					output.duv0(vec2(block.m_positions[i]));
+				if(colours)
+					output.colour(block.m_colours[i]);
+			}
+	}
+
+	void MarchingCubes::render(MeshPacker& output) const
+	{
+		this->remesh();
+
+		for(const Block& block : m_block_meshes)
+		{
+			extend(output.m_positions, block.m_positions);
+			extend(output.m_normals, block.m_normals);
+		}
 	}
 
 	void add_ball(MarchingCubes& cubes, const vec3& ball, float strength, float subtract, const Colour& colour)
@@ -359,26 +432,68 @@ namespace two
 		const uvec3 lo = uvec3(max(ivec3(floor(s - radius)), ivec3(1)));
 		const uvec3 hi = uvec3(min(ivec3(floor(s + radius)), ivec3(int(cubes.m_subdiv - 1))));
 
+		const vec3 c = to_vec3(colour);
+		const float scale = size / radius;
+
+		// optimization - http://www.geisswerks.com/ryan/BLOBS/blobs.html
+		auto blend = [](float r) { return 1.f - r * r * r * (r * (r * 6.f - 15.f) + 10.f); };
+
 		for(uint32_t z = lo.z; z < hi.z; z++)
 			for(uint32_t y = lo.y; y < hi.y; y++)
-				for(uint32_t x = lo.x; x < hi.x; x++)
+			{
+				const size_t row = cubes.m_zd * z + cubes.m_yd * y;
+				const float yz = sq(float(y) / size - ball.y) + sq(float(z) / size - ball.z);
+
+				uint32_t x = lo.x;
+#if TWO_VOXEL_SSE
+				// four cells of a row at a time : the field is accumulated in vector registers, the colours of the cells in the ball only
+				const __m128 vsize = _mm_set1_ps(1.f / size);
+				const __m128 vball = _mm_set1_ps(ball.x);
+				const __m128 vyz = _mm_set1_ps(yz);
+				const __m128 veps = _mm_set1_ps(0.000001f);
+				const __m128 vstrength = _mm_set1_ps(strength);
+				const __m128 vsubtract = _mm_set1_ps(subtract);
+				const __m128 vsign = _mm_set1_ps(sign);
+				const __m128 vscale = _mm_set1_ps(scale);
+				const __m128 one = _mm_set1_ps(1.f);
+
+				for(; x + 4 <= hi.x; x += 4)
 				{
-					const size_t offset = cubes.m_zd * z + cubes.m_yd * y + x;
-
-					const vec3 p = vec3(uvec3(x, y, z));
-					const vec3 f = p / size - ball;
-
-					const float val = strength / (0.000001f + sq(f.x) + sq(f.y) + sq(f.z)) - subtract;
+					const __m128 px = _mm_add_ps(_mm_set1_ps(float(x)), _mm_setr_ps(0.f, 1.f, 2.f, 3.f));
+					const __m128 fx = _mm_sub_ps(_mm_mul_ps(px, vsize), vball);
+					const __m128 d2 = _mm_add_ps(_mm_mul_ps(fx, fx), vyz);
+					const __m128 val = _mm_sub_ps(_mm_div_ps(vstrength, _mm_add_ps(veps, d2)), vsubtract);
+					const __m128 inside = _mm_cmpgt_ps(val, _mm_setzero_ps());
+
+					const int bits = _mm_movemask_ps(inside);
+					if(bits == 0)
+						continue;
+
+					float* field = &cubes.m_field[row + x];
+					_mm_storeu_ps(field, _mm_add_ps(_mm_loadu_ps(field), _mm_and_ps(inside, _mm_mul_ps(val, vsign))));
+
+					const __m128 r = _mm_mul_ps(_mm_sqrt_ps(d2), vscale);
+					const __m128 poly = _mm_add_ps(_mm_mul_ps(r, _mm_sub_ps(_mm_mul_ps(r, _mm_set1_ps(6.f)), _mm_set1_ps(15.f))), _mm_set1_ps(10.f));
+					const __m128 contrib = _mm_sub_ps(one, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(r, r), r), poly));
+
+					float contribs[4];
+					_mm_storeu_ps(contribs, contrib);
+					for(uint32_t i = 0; i < 4; ++i)
+						if(bits & (1 << i))
+							cubes.m_colour[row + x + i] += c * contribs[i];
+				}
+#endif
+				for(; x < hi.x; x++)
+				{
+					const float d2 = sq(float(x) / size - ball.x) + yz;
+					const float val = strength / (0.000001f + d2) - subtract;
 					if(val > 0.f)
 					{
-						cubes.m_field[offset] += val * sign;
-						
-						// optimization - http://www.geisswerks.com/ryan/BLOBS/blobs.html
-						const float r = sqrt(sq(p.x - s.x) + sq(p.y - s.y) + sq(p.z - s.z)) / radius;
-						const float contrib = 1.f - r * r * r * (r * (r * 6.f - 15.f ) + 10.f );
-						cubes.m_colour[offset] += to_vec3(colour) * contrib;
+						cubes.m_field[row + x] += val * sign;
+						cubes.m_colour[row + x] += c * blend(sqrt(d2) * scale);
 					}
 				}
+			}
 	}
 
 	void add_ball(MarchingCubes& cubes, const vec3& ball, float strength, float subtract)
@@ -39,26 +39,49 @@ namespace two
 		{
 			struct Normal { vec3 n; bool set = false; };
 			vector<Normal> m_normal;
+			size_t m_offset = 0;
 
 			vec3 vert[12];
 			vec3 norm[12];
 			vec3 color[12];
 		};
-		
-		mutable Cache m_cache;
+
+		// triangles of a block of c_block^3 cells, kept until the field values the block reads change
+		struct Block
+		{
+			vector<vec3> m_positions;
+			vector<vec3> m_normals;
+			vector<vec3> m_colours;
+		};
+
+		static constexpr uint32_t c_block = 8;
+
+		mutable uint32_t m_blocks = 0;
+		mutable vector<Block> m_block_meshes;
+		mutable vector<Cache> m_slab_caches;
+
+		mutable vector<float> m_last_field;
+		mutable vector<vec3> m_last_colour;
+		mutable float m_last_isolation = 0.f;
 
 	public:
 		constr_ MarchingCubes(uint32_t resolution);
 
 		// immediate render mode simulator
 		uint8_t classify(size_t q, float isol) const;
-		uint8_t polygonize(Cache& cache, const vec3& p, size_t q, float isol) const;
-		uint32_t triangulate(MeshAdapter& output, Cache& cache, uint8_t cubeindex) const;
-		uint32_t triangulate(MeshPacker& output, Cache& cache, uint8_t cubeindex) const;
+		void classify4(size_t q, float isol, uint8_t* cubeindices) const;
+		void polygonize(Cache& cache, const vec3& p, size_t q, float isol, uint8_t cubeindex) const;
+		uint32_t triangulate(Block& output, Cache& cache, uint8_t cubeindex) const;
 
 		meth_ void reset();
 
-		void begin(Cache& cache) const;
+		void begin(Cache& cache, uint32_t z0, uint32_t z1) const;
+
+		// remesh the blocks whose field changed since the last call, one job per z-slab of blocks
+		uint32_t remesh() const;
+		void remesh_slab(uint32_t slab, bool force) const;
+		bool changed(const uvec3& lo, const uvec3& hi) const;
+		void mesh_block(Cache& cache, Block& block, const uvec3& lo, const uvec3& hi) const;
 
 		meth_ uint32_t count() const;
 		meth_ void direct(MeshAdapter& output) const;
@@ -17,6 +17,8 @@ namespace stl
 	template class TWO_GEOM_EXPORT vector<IcoSphere>;
 	template class TWO_GEOM_EXPORT vector<ProcShape>;
 	template class TWO_GEOM_EXPORT vector<MarchingCubes::Cache::Normal>;
+	template class TWO_GEOM_EXPORT vector<MarchingCubes::Cache>;
+	template class TWO_GEOM_EXPORT vector<MarchingCubes::Block>;
 	template class TWO_GEOM_EXPORT vector<Distribution::Point>;
 	template class TWO_GEOM_EXPORT vector<vector<Distribution::Point>>;
 	template class TWO_GEOM_EXPORT vector<vector<Distribution::Point>*>;
@@ -7,6 +7,7 @@ export import std.core;
 export import std.threading;
 export import std.regex;
 
+export import two.jobs;
 export import two.type;
 export import two.math;
 
@@ -11,6 +11,7 @@ module two.gfx-edit;
 #else
 #include <infra/ToString.h>
 #include <stl/algorithm.h>
+#include <stl/vector.hpp>
 #include <type/Vector.h>
 #include <type/DispatchDecl.h>
 #include <pool/ObjectPool.h>
@@ -209,52 +210,69 @@ namespace two
 		return self;
 	}
 
+	struct AssetEntry { cstring m_icon; const string* m_name; Ref m_asset; bool m_viewer; };
+
+	// per browser : the filters, and the entry list reused between frames
+	struct AssetBrowserState : public NodeState
+	{
+		bool m_textures = true;
+		bool m_programs = true;
+		bool m_materials = true;
+		bool m_models = true;
+		bool m_particles = true;
+		bool m_prefabs = true;
+		vector<AssetEntry> m_assets;
+	};
+
 	void asset_browser(Widget& parent, GfxSystem& gfx, vector<Ref>& selection)
 	{
 		Section& self = section(parent, "Assets");
+		AssetBrowserState& state = self.state<AssetBrowserState>();
 
-		static bool textures = true;
-		static bool programs = true;
-		static bool materials = true;
-		static bool models = true;
-		static bool particles = true;
-		static bool prefabs = true;
-
-		ui::toggle(*self.m_toolbar, textures, "tex");
-		ui::toggle(*self.m_toolbar, programs, "prg");
-		ui::toggle(*self.m_toolbar, materials, "mat");
-		ui::toggle(*self.m_toolbar, models, "mdl");
-		ui::toggle(*self.m_toolbar, particles, "ptc");
-		ui::toggle(*self.m_toolbar, prefabs, "pfb");
-
-		ui::Sequence& sequence = ui::sequence(*self.m_body);
-		sequence.m_selection = &selection;
+		ui::toggle(*self.m_toolbar, state.m_textures, "tex");
+		ui::toggle(*self.m_toolbar, state.m_programs, "prg");
+		ui::toggle(*self.m_toolbar, state.m_materials, "mat");
+		ui::toggle(*self.m_toolbar, state.m_models, "mdl");
+		ui::toggle(*self.m_toolbar, state.m_particles, "ptc");
+		ui::toggle(*self.m_toolbar, state.m_prefabs, "pfb");
 
-		if(materials)
+		// the stores can change under the browser at any time : the entries point into them, so they are gathered again every frame
+		vector<AssetEntry>& assets = state.m_assets;
+		assets.clear();
+
+		if(state.m_materials)
 			for(Material* material : gfx.materials().m_vector)
 				if(!material->m_builtin)
-				{
-					asset_element(sequence, "(material)", material->m_name, Ref(material));
-				}
+					assets.push_back({ "(material)", &material->m_name, Ref(material), true });
 
-		if(programs)
+		if(state.m_programs)
 			for(Program* program : gfx.programs().m_vector)
-			{
-				Widget& element = ui::element(sequence, Ref(program));
-				ui::multi_item(element, { "(program)", program->m_name.c_str() });
-			}
+				assets.push_back({ "(program)", &program->m_name, Ref(program), false });
 
-		if(models)
+		if(state.m_models)
 			for(Model* model : gfx.models().m_vector)
-			{
-				asset_element(sequence, "(model)", model->m_name, Ref(model));
-			}
+				assets.push_back({ "(model)", &model->m_name, Ref(model), true });
 
-		if(particles)
+		if(state.m_particles)
 			for(Flow* particle : gfx.flows().m_vector)
+				assets.push_back({ "(particles)", &particle->m_name, Ref(particle), true });
+
+		ui::VirtualSequence& sequence = ui::virtual_sequence(*self.m_body, assets.size(), 22.f, true);
+		sequence.m_selection = &selection;
+
+		for(size_t i = sequence.m_first; i < sequence.m_last; ++i)
+		{
+			const AssetEntry& asset = assets[i];
+			if(asset.m_viewer)
+			{
+				asset_element(sequence, asset.m_icon, *asset.m_name, asset.m_asset);
+			}
+			else
 			{
-				asset_element(sequence, "(particles)", particle->m_name, Ref(particle));
+				Widget& element = ui::element(*sequence.m_body, asset.m_asset);
+				ui::multi_item(element, { asset.m_icon, asset.m_name->c_str() });
 			}
+		}
 	}
 
 	void asset_browser(Widget& parent, GfxSystem& gfx)
@@ -147,7 +147,7 @@ namespace two
 				else
 				{
 					string path = state.m_path + "/" + state.m_file;
-					Texture& texture = state.m_gfx.textures().file_at(path.c_str(), image.uri.c_str());
+					Texture& texture = state.m_gfx.texture_streamer().file_at(path, image.uri);
 					//Texture& texture = state.m_gfx.textures().file(image.uri.c_str());
 					state.m_images.push_back(&texture);
 				}
@@ -114,7 +114,7 @@ namespace two
 			{
 				// @todo replace backslashes with slashes ?
 				if(gfx.locate_file("textures/" + path))
-					return gfx.textures().file(path);
+					return gfx.texture_streamer().file(path);
 				else
 					return nullptr;
 			};
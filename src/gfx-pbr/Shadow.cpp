@@ -75,49 +75,24 @@ namespace two
 		return pass_rect;
 	}
 
-	template <class T_Filter>
-	vector<Item*> filter_cull(Scene& scene, T_Filter filter, bool nofilter = false)
+	bool shadow_caster(const Item& item)
 	{
-		vector<Item*> culled;
-		scene.m_pool->pool<Item>().iterate([&](Item& item) {
-			if(nofilter || filter(item))
-			{
-				culled.push_back(&item);
-			}
-		});
-		return culled;
+		return item.m_visible && item.m_model->m_geometry[PrimitiveType::Triangles] && (item.m_flags & ItemFlag::Shadows) != 0;
 	}
 
-	template <class T_Filter>
-	vector<Item*> frustum_cull(Scene& scene, const Plane6& frustum_planes, T_Filter filter, bool nofilter = false)
+	void cull_shadow_render(span<Item*> casters, vector<Item*>& result, const Plane6& planes)
 	{
-		vector<Item*> culled;
-		scene.m_pool->pool<Item>().iterate([&](Item& item) {
-			if(nofilter || filter(item))
-			{
-				if(frustum_aabb_intersection(frustum_planes, item.m_aabb))
-					culled.push_back(&item);
-			}
-		});
-		return culled;
+		for(Item* item : casters)
+			if(frustum_aabb_intersection(planes, item->m_aabb))
+				result.push_back(item);
 	}
 
-	void cull_shadow_render(Render& render, vector<Item*>& result, const Plane6& planes)
+	void shadow_depth(span<Item*> items, const Plane6& planes)
 	{
-		auto filter = [](Item& item) { return item.m_visible && item.m_model->m_geometry[PrimitiveType::Triangles] && (item.m_flags & ItemFlag::Shadows) != 0; };
-		result = filter_cull(*render.m_scene, filter);
-		//result = frustum_cull(items, planes, filter);
-
-		for(Item* item : result)
+		for(Item* item : items)
 			item->m_depth = distance(planes.m_near, item->m_aabb.m_center);
 	}
 
-	void cull_shadow_render(Render& render, vector<Item*>& result, const mat4& projection, const mat4& transform)
-	{
-		Plane6 planes = frustum_planes(projection, transform);
-		cull_shadow_render(render, result, planes);
-	}
-
 #if 0
 	void BlockShadow::light_shadow_block(Light& light, const uvec4& shadow_rect, const mat4& projection, const mat4& transform)
 	{
@@ -153,7 +128,41 @@ namespace two
 		light_bounds.max.z = zmax;
 	}
 
-	void light_slice_cull(Render& render, Light& light, LightBounds& light_bounds, vector<Item*>& result)
+	bool light_slice_receivers(span<Item*> receivers, const FrustumSlice& slice, const mat4& light_transform, LightBounds& light_bounds)
+	{
+		LightBounds bounds;
+		bool any = false;
+
+		for(Item* item : receivers)
+		{
+			if(!frustum_aabb_intersection(slice.m_frustum.m_planes, item->m_aabb))
+				continue;
+
+			const vec3 lo = item->m_aabb.bmin();
+			const vec3 hi = item->m_aabb.bmax();
+			for(uint i = 0; i < 8; i++)
+			{
+				const vec3 corner = { (i & 1) ? hi.x : lo.x, (i & 2) ? hi.y : lo.y, (i & 4) ? hi.z : lo.z };
+				const vec3 corner_light = vec3(light_transform * vec4(corner, 1.f));
+
+				bounds.min = min(bounds.min, corner_light);
+				bounds.max = max(bounds.max, corner_light);
+			}
+			any = true;
+		}
+
+		if(!any)
+			return false;
+
+		// casters outside of the receivers light-space footprint can't shadow anything visible in this slice
+		light_bounds.min.x = max(light_bounds.min.x, bounds.min.x);
+		light_bounds.min.y = max(light_bounds.min.y, bounds.min.y);
+		light_bounds.max.x = min(light_bounds.max.x, bounds.max.x);
+		light_bounds.max.y = min(light_bounds.max.y, bounds.max.y);
+		return light_bounds.min.x <= light_bounds.max.x && light_bounds.min.y <= light_bounds.max.y;
+	}
+
+	void light_slice_cull(span<Item*> casters, Light& light, LightBounds& light_bounds, vector<Item*>& result)
 	{
 		vec3 x = light.m_node->axis(x3);
 		vec3 y = light.m_node->axis(y3);
@@ -169,7 +178,8 @@ namespace two
 			{ -z, -light_bounds.min.z }
 		};
 
-		cull_shadow_render(render, result, light_frustum_planes);
+		cull_shadow_render(casters, result, light_frustum_planes);
+		shadow_depth(result, light_frustum_planes);
 
 		for(Item* item : result)
 		{
@@ -222,7 +232,7 @@ namespace two
 		return light_proj * light_crop;
 	}
 	
-	void update_csm_slice(Render& render, Light& light, const mat4& light_transform, const mat4& light_proj, 
+	void update_csm_slice(Render& render, span<Item*> casters, Light& light, const mat4& light_transform, const mat4& light_proj, 
 						  CSMSlice& slice, CSMShadow& csm, const vec4& atlas_rect, uint csm_size)
 	{
 		slice.m_light = &light;
@@ -230,8 +240,16 @@ namespace two
 		
 		slice.m_light_bounds = light_slice_bounds(slice.m_frustum, light_transform);
 
-		slice.m_items = render.m_shot.m_items;
-		light_slice_cull(render, light, slice.m_light_bounds, slice.m_items);
+		LightBounds cull_bounds = slice.m_light_bounds;
+		const bool optimize = (light.m_shadow_flags & CSM_Optimize) != 0;
+		const bool receivers = !optimize || light_slice_receivers(render.m_shot.m_items, slice, light_transform, cull_bounds);
+
+		slice.m_items.clear();
+		if(receivers)
+			light_slice_cull(casters, light, cull_bounds, slice.m_items);
+		slice.m_light_bounds.max.z = max(slice.m_light_bounds.max.z, cull_bounds.max.z);
+
+		light.m_shadow_casters += uint32_t(slice.m_items.size());
 
 		if(false)//light.m_shadow_flags == CSM_Stabilize)
 		{
@@ -271,7 +289,7 @@ namespace two
 		for(size_t i = 0; i < csm.m_slices.size(); ++i)
 		{
 			CSMSlice& slice = csm.m_slices[i];
-			update_csm_slice(render, light, light_transform, light_proj, slice, csm, slot.m_rect, slot.m_trect.width);
+			update_csm_slice(render, m_casters, light, light_transform, light_proj, slice, csm, slot.m_rect, slot.m_trect.width);
 			slice.m_fbo = &m_atlas.m_fbo;
 			slice.m_depth_method = depth_method();
 		  //slice.m_depth_method = DepthMethod::DepthPacked;
@@ -366,6 +384,106 @@ namespace two
 #endif
 	}
 
+	void BlockShadow::gather_casters(Render& render)
+	{
+		m_casters.clear();
+		m_dynamic_casters.clear();
+		m_static_casters.clear();
+
+		// static casters are gathered whether they are visible or not : the caster caches follow their visibility themselves
+		render.m_scene->m_pool->pool<Item>().iterate([&](Item& item)
+		{
+			const bool caster = item.m_model->m_geometry[PrimitiveType::Triangles] && (item.m_flags & ItemFlag::Shadows) != 0;
+			if(caster && (item.m_flags & ItemFlag::Static) != 0)
+				m_static_casters.push_back(&item);
+			if(!shadow_caster(item))
+				return;
+			m_casters.push_back(&item);
+			if((item.m_flags & ItemFlag::Static) == 0)
+				m_dynamic_casters.push_back(&item);
+		});
+	}
+
+	void BlockShadow::light_dynamic_casters(Light& light, vector<Item*>& result)
+	{
+		const vec3 position = light.m_node->position();
+		for(Item* item : m_dynamic_casters)
+			if(sphere_aabb_intersection(position, light.m_range, item->m_aabb))
+				result.push_back(item);
+	}
+
+	ShadowCasterCache& BlockShadow::caster_cache(Render& render, Light& light, span<Plane6> faces)
+	{
+		ShadowCasterCache& cache = m_caster_caches[&light];
+
+		auto visibility = [](span<Item*> items)
+		{
+			uint64_t hash = 14695981039346656037ULL;
+			for(Item* item : items)
+				hash = (hash ^ uint64_t(item->m_visible)) * 1099511628211ULL;
+			return hash;
+		};
+
+		// the static version is checked first : if it changed, cached items might have been destroyed
+		const bool stale = cache.m_static_version != render.m_scene->m_static_version
+						|| cache.m_transform != light.m_node->m_transform
+						|| cache.m_range != light.m_range
+						|| cache.m_spot_angle != light.m_spot_angle
+						|| cache.m_bias != light.m_shadow_bias
+						|| cache.m_normal_bias != light.m_shadow_normal_bias
+						|| cache.m_faces.size() != faces.size()
+						|| cache.m_visibility != visibility(cache.m_statics);
+
+		if(!stale)
+			return cache;
+
+		cache.m_static_version = render.m_scene->m_static_version;
+		cache.m_transform = light.m_node->m_transform;
+		cache.m_range = light.m_range;
+		cache.m_spot_angle = light.m_spot_angle;
+		cache.m_bias = light.m_shadow_bias;
+		cache.m_normal_bias = light.m_shadow_normal_bias;
+		cache.m_valid = false;
+
+		const vec3 position = light.m_node->position();
+
+		cache.m_statics.clear();
+		for(Item* item : m_static_casters)
+			if(sphere_aabb_intersection(position, light.m_range, item->m_aabb))
+				cache.m_statics.push_back(item);
+
+		cache.m_visibility = visibility(cache.m_statics);
+
+		vector<Item*> visible;
+		for(Item* item : cache.m_statics)
+			if(item->m_visible)
+				visible.push_back(item);
+
+		cache.m_faces.resize(faces.size());
+		for(size_t i = 0; i < faces.size(); ++i)
+		{
+			cache.m_faces[i].clear();
+			cull_shadow_render(visible, cache.m_faces[i], faces[i]);
+		}
+
+		return cache;
+	}
+
+	bool BlockShadow::update_cache(Render& render, ShadowCasterCache& cache, span<Item*> dynamics, const vec4& rect)
+	{
+		// the atlas slot must have been held continuously by this light for its content to be reused
+		const uint32_t frame = render.m_frame->m_frame;
+		const bool held = cache.m_frame + 1 == frame && cache.m_rect == rect;
+
+		const bool cached = cache.m_valid && held && !cache.m_dynamic && dynamics.empty();
+
+		cache.m_frame = frame;
+		cache.m_rect = rect;
+		cache.m_valid = true;
+		cache.m_dynamic = !dynamics.empty();
+		return cached;
+	}
+
 	void BlockShadow::setup_shadows(Render& render)
 	{
 		span<Light*> lights = render.m_shot.m_lights;
@@ -374,11 +492,15 @@ namespace two
 		m_csm_shadows.clear();
 		m_shadows.clear();
 
+		this->gather_casters(render);
+
 		for(size_t index = 0; index < lights.size(); ++index)
 		{
 			Light& light = *lights[index];
 			if(!light.m_shadows) continue;
 
+			light.m_shadow_casters = 0;
+
 			if(light.m_type == LightType::Direct)
 			{
 				CSMShadow& csm = push(m_csm_shadows);
@@ -415,10 +537,29 @@ namespace two
 				m_block_light.m_gpu_lights[index].shadow.atlas_slot = slot_coord;
 				m_block_light.m_gpu_lights[index].shadow.atlas_subdiv = slot_size;
 
+				// up stays up for all sides of the cube except when looking down (where it's forward aka -Z) or up (back aka Z)
+				static const table<SignedAxis, vec3> view_up = { y3, y3, z3, -z3, y3, y3 };
+
+				const vec3& position = light.m_node->position();
+
+				mat4 transforms[6];
+				Plane6 faces[6];
 				for(SignedAxis axis : c_signed_axes)
 				{
-					// up stays up for all sides of the cube except when looking down (where it's forward aka -Z) or up (back aka Z)
-					static const table<SignedAxis, vec3> view_up = { y3, y3, z3, -z3, y3, y3 };
+					transforms[size_t(axis)] = bxlookat(position, position + to_vec3(axis), view_up[axis]);
+					faces[size_t(axis)] = frustum_planes(projection, transforms[size_t(axis)]);
+				}
+
+				ShadowCasterCache& cache = this->caster_cache(render, light, faces);
+
+				vector<Item*> dynamics;
+				this->light_dynamic_casters(light, dynamics);
+
+				const bool cached = this->update_cache(render, cache, dynamics, atlas_rect);
+
+				for(SignedAxis axis : c_signed_axes)
+				{
+					const size_t face = size_t(axis);
 
 					LightShadow& shadow = push(m_shadows);
 					shadow.m_light = &light;
@@ -426,17 +567,20 @@ namespace two
 					shadow.m_far = light.m_range;
 					shadow.m_depth_method = DepthMethod::Distance;
 
-					const vec3& position = light.m_node->position();
-					shadow.m_transform = bxlookat(position, position + to_vec3(axis), view_up[axis]);
+					shadow.m_transform = transforms[face];
 					shadow.m_proj = projection;
 					//shadow.m_light_bounds = 
 
-					shadow.m_items = render.m_shot.m_items;
-					cull_shadow_render(render, shadow.m_items, shadow.m_proj, shadow.m_transform);
+					shadow.m_items = cache.m_faces[face];
+					cull_shadow_render(dynamics, shadow.m_items, faces[face]);
+					shadow_depth(shadow.m_items, faces[face]);
+					shadow.m_cached = cached;
 
 					shadow.m_fbo = &m_atlas.m_fbo;
 
 					shadow.m_shadow_matrix = bxtranslation(-position);
+
+					light.m_shadow_casters += uint32_t(shadow.m_items.size());
 				}
 			}
 			else if(light.m_type == LightType::Spot)
@@ -449,15 +593,36 @@ namespace two
 				shadow.m_proj = bxproj(light.m_spot_angle * 2.f, 1.f, 0.01f, light.m_range, bgfx::getCaps()->homogeneousDepth);
 				shadow.m_transform = light.m_node->m_transform;
 
-				shadow.m_items = render.m_shot.m_items;
-				cull_shadow_render(render, shadow.m_items, shadow.m_proj, shadow.m_transform);
+				Plane6 planes = frustum_planes(shadow.m_proj, shadow.m_transform);
+
+				ShadowCasterCache& cache = this->caster_cache(render, light, { &planes, 1 });
+
+				vector<Item*> dynamics;
+				this->light_dynamic_casters(light, dynamics);
+
+				shadow.m_items = cache.m_faces[0];
+				cull_shadow_render(dynamics, shadow.m_items, planes);
+				shadow_depth(shadow.m_items, planes);
+				shadow.m_cached = this->update_cache(render, cache, dynamics, shadow.m_rect);
 
 				shadow.m_fbo = &m_atlas.m_fbo;
 				shadow.m_shadow_matrix = light.m_node->m_transform;
 
+				light.m_shadow_casters += uint32_t(shadow.m_items.size());
+
 				//m_block_light.m_gpu_shadows[index].matrix = m_shadows.size() - 1;
 			}
+
+			render.m_frame->m_num_shadow_casters += light.m_shadow_casters;
 		}
+
+		// forget lights that stopped casting shadows
+		vector<Light*> expired;
+		for(auto& light_cache : m_caster_caches)
+			if(light_cache.second.m_frame + 1 < render.m_frame->m_frame)
+				expired.push_back(light_cache.first);
+		for(Light* light : expired)
+			m_caster_caches.erase(light);
 	}
 
 	void BlockShadow::commit_shadows(Render& render, const mat4& view)
@@ -606,6 +771,14 @@ namespace two
 
 		auto render_shadow = [&](LightShadow& shadow, const vec4& rect)
 		{
+			if(shadow.m_cached)
+			{
+				render.m_frame->m_num_shadow_cached++;
+				return;
+			}
+
+			render.m_frame->m_num_shadow_maps++;
+
 			Camera camera = Camera(shadow.m_transform, shadow.m_proj);
 			Viewport viewport = Viewport(camera, *render.m_scene, rect);
 
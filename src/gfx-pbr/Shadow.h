@@ -99,6 +99,29 @@ namespace two
 		LightBounds m_light_bounds;
 
 		vector<Item*> m_items;
+
+		// shadowmap content from a previous frame is still valid : skip rendering
+		bool m_cached = false;
+	};
+
+	// static casters of a non-directional light, rebuilt when the light or any static item moves
+	export_ struct ShadowCasterCache
+	{
+		mat4 m_transform = {};
+		float m_range = 0.f;
+		float m_spot_angle = 0.f;
+		float m_bias = 0.f;
+		float m_normal_bias = 0.f;
+		uint32_t m_static_version = UINT32_MAX;
+		uint32_t m_frame = 0;
+
+		vector<Item*> m_statics;				// visible or not, in range of the light
+		uint64_t m_visibility = 0;				// hash of the visibility of the statics
+		vector<vector<Item*>> m_faces;
+
+		vec4 m_rect = vec4(0.f);
+		bool m_valid = false;
+		bool m_dynamic = false;
 	};
 
 	export_ struct refl_ TWO_GFX_PBR_EXPORT CSMSlice : public LightShadow, public FrustumSlice
@@ -137,6 +160,11 @@ namespace two
 
 		void update_csm(Render& render, Light& light, CSMShadow& csm);
 
+		void gather_casters(Render& render);
+		ShadowCasterCache& caster_cache(Render& render, Light& light, span<Plane6> faces);
+		void light_dynamic_casters(Light& light, vector<Item*>& result);
+		bool update_cache(Render& render, ShadowCasterCache& cache, span<Item*> dynamics, const vec4& rect);
+
 		DepthMethod depth_method()
 		{
 #if SHADOW_SAMPLER || SHADOW_DEPTH
@@ -183,6 +211,11 @@ namespace two
 		vector<CSMShadow> m_csm_shadows;
 		vector<LightShadow> m_shadows;
 
+		vector<Item*> m_casters;
+		vector<Item*> m_dynamic_casters;
+		vector<Item*> m_static_casters;
+		map<Light*, ShadowCasterCache> m_caster_caches;
+
 		vector<mat4> m_shadow_matrices;
 	};
 }
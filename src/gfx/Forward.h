@@ -73,6 +73,7 @@ namespace two
     struct LocatedFile;
     class GfxSystem;
     class Texture;
+    class TextureStreamer;
     struct ShaderDefine;
     struct ShaderBlock;
 	struct ProgramMode;
@@ -63,6 +63,7 @@ namespace two
 		unique<TPool<Rig>> m_rigs;
 		unique<TPool<Animation>> m_animations;
 
+		unique<TextureStreamer> m_texture_streamer;		// outlives the textures it streams
 		unique<AssetStore<Texture>> m_textures;
 		unique<AssetStore<Program>> m_programs;
 		unique<AssetStore<Material>> m_materials;
@@ -134,6 +135,7 @@ namespace two
 	TPool<Animation>& GfxSystem::animations() { return *m_impl->m_animations; }
 
 	AssetStore<Texture>& GfxSystem::textures() { return *m_impl->m_textures; }
+	TextureStreamer& GfxSystem::texture_streamer() { return *m_impl->m_texture_streamer; }
 	AssetStore<Program>& GfxSystem::programs() { return *m_impl->m_programs; }
 	AssetStore<Material>& GfxSystem::materials() { return *m_impl->m_materials; }
 	AssetStore<Model>& GfxSystem::models() { return *m_impl->m_models; }
@@ -160,6 +162,8 @@ namespace two
 		m_impl->m_rigs = make_unique<TPool<Rig>>();
 		m_impl->m_animations = make_unique<TPool<Animation>>();
 		
+		m_impl->m_texture_streamer = make_unique<TextureStreamer>(*this);
+
 		auto load_tex = [&](Texture& texture, const string& path, const NoConfig& config) { texture.load(*this, path); };
 
 		m_impl->m_textures = make_unique<AssetStore<Texture>>(*this, "textures/", load_tex);
@@ -258,6 +262,12 @@ namespace two
 				program->update(*this);
 		}
 
+		{
+			ZoneScopedNC("textures", tracy::Color::Cyan);
+
+			m_impl->m_texture_streamer->update();
+		}
+
 		{
 			ZoneScopedNC("renderers", tracy::Color::Cyan);
 
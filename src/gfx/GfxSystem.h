@@ -136,6 +136,8 @@ namespace two
 		attr_ AssetStore<Flow>& flows();
 		attr_ AssetStore<Prefab>& prefabs();
 
+		TextureStreamer& texture_streamer();
+
 		void add_importer(ModelFormat format, Importer& importer);
 		Importer* importer(ModelFormat format);
 
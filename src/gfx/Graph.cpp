@@ -70,6 +70,8 @@ namespace two
 		}
 		if(m_item)
 		{
+			if((m_item->m_flags & ItemFlag::Static) != 0)
+				m_scene->m_static_version++;
 			m_scene->m_pool->pool<Item>().tdestroy(*m_item);
 			m_item = nullptr;
 		}
@@ -179,17 +181,23 @@ namespace gfx
 	{
 		Gnode& self = parent.suba<Gnode>();
 		bool update = (flags & ItemFlag::NoUpdate) == 0;
+		bool moved = false;
 		if(!self.m_item)
 		{
 			self.m_item = &create<Item>(*self.m_scene, *self.m_attach, model, flags, material);
 			update = true;
+			moved = true;
 		}
 		self.m_item->m_model = const_cast<Model*>(&model);
 		self.m_item->m_material = material;
 		if(update)
 		{
+			const Aabb aabb = self.m_item->m_aabb;
 			self.m_item->update_aabb();
+			moved |= aabb.m_center != self.m_item->m_aabb.m_center || aabb.m_extents != self.m_item->m_aabb.m_extents;
 		}
+		if(moved && (self.m_item->m_flags & ItemFlag::Static) != 0)
+			self.m_scene->m_static_version++;
 		return *self.m_item;
 	}
 
@@ -213,7 +221,10 @@ namespace gfx
 			item.m_batch = self.m_batch;
 		}
 		self.m_batch->transforms(transforms);
+		const Aabb aabb = item.m_aabb;
 		self.m_batch->update_aabb(transforms);
+		if((item.m_flags & ItemFlag::Static) != 0 && (aabb.m_center != item.m_aabb.m_center || aabb.m_extents != item.m_aabb.m_extents))
+			self.m_scene->m_static_version++;
 		return *self.m_batch;
 	}
 
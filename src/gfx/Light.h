@@ -60,6 +60,9 @@ namespace two
 		attr_ float m_shadow_normal_bias = 0.1f;
 		attr_ float m_shadow_bias = 0.f;
 
+		// number of casters rendered in this light shadow maps last frame
+		attr_ uint32_t m_shadow_casters = 0;
+
 		size_t m_shot_index = 0;
 
 		uint32_t m_index = 0;
@@ -214,16 +214,14 @@ namespace two
 		: m_gfx(gfx)
 		, m_block(*gfx.m_renderer.block<BlockParticles>())
 		, m_emitters(emitters)
-		, m_program(gfx.programs().fetch("particle").default_version())
+		, m_program(gfx.programs().fetch("particle"))
 	{}
 
 	ParticleSystem::~ParticleSystem()
 	{}
 
 	void ParticleSystem::shutdown()
-	{
-		bgfx::destroy(m_program);
-	}
+	{}
 
 	void ParticleSystem::update(float _dt)
 	{
@@ -282,7 +280,7 @@ namespace two
 			encoder.setVertexBuffer(0, &vertex_buffer);
 			encoder.setIndexBuffer(&index_buffer);
 			encoder.setTexture(uint8_t(TextureSampler::Color), m_block.s_color, m_block.m_texture);
-			encoder.submit(pass, m_program);
+			encoder.submit(pass, m_program.default_version());
 		}
 	}
 
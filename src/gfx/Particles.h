@@ -148,7 +148,7 @@ namespace two
 		
 		TPool<Flare>& m_emitters;
 
-		bgfx::ProgramHandle m_program;
+		Program& m_program;
 
 		uint32_t m_num = 0;
 	};
@@ -27,10 +27,16 @@ module two.gfx;
 #include <gfx/Shader.h>
 #include <gfx/Renderer.h>
 #include <gfx/Pipeline.h>
+#include <gfx/Asset.h>
+#include <jobs/JobSystem.h>
+#include <jobs/Job.h>
 #endif
 
 #include <cstring>
 #include <cstdio>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace bgfx
 {
@@ -110,11 +116,68 @@ namespace two
 		return gfx.m_resource_path + "/shaders/" + name + suffix;
 	}
 
+	static uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for(size_t i = 0; i < size; ++i)
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		return hash;
+	}
+
+	static uint64_t fnv1a(const string& text, uint64_t hash) { return fnv1a(text.data(), text.size(), hash); }
+
+	// the headers included by the shaders, hashed once per run : reloading a program recompiles its versions regardless of the cache
+	static uint64_t includes_hash(GfxSystem& gfx)
+	{
+		static bool hashed = false;
+		static uint64_t hash = 0;
+		if(hashed)
+			return hash;
+
+		const string path = gfx.m_resource_path + "/shaders/";
+		hash = fnv1a(read_text_file(path + "varying.def.sc"), 14695981039346656037ULL);
+
+		// files are visited in no particular order : their hashes are combined in a way that doesn't depend on it
+		if(directory_exists(path))
+			visit_files(path, [&](const string& file)
+			{
+				if(file.size() > 3 && strcmp(file.c_str() + file.size() - 3, ".sh") == 0)
+					hash ^= fnv1a(read_text_file(path + file), fnv1a(file, 14695981039346656037ULL));
+			});
+
+		hashed = true;
+		return hash;
+	}
+
+	// a compilation that runs on a worker thread : it holds copies of everything it needs, so that the program is never touched
+	struct ProgramCompile
+	{
+		enum State : int { Compiling, Compiled, Failed };
+
+		uint64_t m_version = 0;
+		uint32_t m_update = 0;
+		bool m_compute = false;
+		bool m_geometry = false;
+		string m_resource_path;
+		string m_name;
+		string m_full_name;
+		string m_defines;
+		string m_output;
+		table<ShaderType, string> m_sources = {};
+
+		std::atomic<int> m_state = { Compiling };
+
+		void run();
+	};
+
 #ifdef TWO_LIVE_SHADER_COMPILER
-	bool compile_shader(GfxSystem& gfx, const string& name, const string& suffix, ShaderType shader_type, const string& defines_in, const string& source)
+	// shaderc keeps its state in globals, and the sources are written to the same files for all versions : shaders compile one at a time
+	static std::mutex s_compile_lock;
+
+	bool compile_shader(const string& resource_path, const string& name, ShaderType shader_type, const string& defines_in, const string& source, const string& output)
 	{
 		string defines = defines_in;
-		string source_path = shader_path(gfx, name, shader_type);
+		string source_path = resource_path + "/shaders/" + name + c_shader_suffixes[shader_type];
 
 		if(source != "")
 		{
@@ -129,15 +192,14 @@ namespace two
 
 		static table<ShaderType, cstring> output_suffixes = { "_cs", "_fs", "_gs", "_vs" };
 
-		string output_suffix = output_suffixes[shader_type];
-		string output_path = gfx.m_resource_path + "/shaders/compiled/" + name + suffix + output_suffix;
+		string output_path = output + output_suffixes[shader_type];
 
 		create_file_tree(output_path);
 
 		info("gfx - compiling shader : %s", source_path.c_str());
 
-		string include = gfx.m_resource_path + "/shaders/";
-		string varying_path = gfx.m_resource_path + "/shaders/varying.def.sc";
+		string include = resource_path + "/shaders/";
+		string varying_path = resource_path + "/shaders/varying.def.sc";
 
 		enum class Target { GLSL, ESSL, HLSL, Metal, SPIRV };
 
@@ -224,9 +286,108 @@ namespace two
 	}
 #endif
 
+	void ProgramCompile::run()
+	{
+		bool compiled = false;
+#ifdef TWO_LIVE_SHADER_COMPILER
+		std::lock_guard<std::mutex> lock(s_compile_lock);
+
+		compiled = true;
+		if(m_compute)
+		{
+			compiled &= compile_shader(m_resource_path, m_name, ShaderType::Compute, m_defines, m_sources[ShaderType::Compute], m_output);
+		}
+		else
+		{
+			compiled &= compile_shader(m_resource_path, m_name, ShaderType::Vertex, m_defines, m_sources[ShaderType::Vertex], m_output);
+			compiled &= compile_shader(m_resource_path, m_name, ShaderType::Fragment, m_defines, m_sources[ShaderType::Fragment], m_output);
+
+			if(m_geometry)
+				compiled &= compile_shader(m_resource_path, m_name, ShaderType::Geometry, m_defines, m_sources[ShaderType::Geometry], m_output);
+		}
+#endif
+		m_state.store(compiled ? Compiled : Failed, std::memory_order_release);
+	}
+
+	static uint32_t popcount(uint32_t bits)
+	{
+		uint32_t count = 0;
+		for(; bits; bits &= bits - 1)
+			++count;
+		return count;
+	}
+
 	struct Program::Impl
 	{
+		~Impl()
+		{
+			// the compile jobs write to their task until they complete
+			for(unique<ProgramCompile>& compile : m_compiles)
+				while(compile->m_state.load(std::memory_order_acquire) == ProgramCompile::Compiling)
+					std::this_thread::yield();
+		}
+
 		map<uint64_t, Version> m_versions;
+		vector<unique<ProgramCompile>> m_compiles;
+
+		uint32_t m_base_options = 0;		// the options that change the vertex inputs or the outputs : a fallback must have the same
+
+		uint64_t m_source_hash = 0;
+		uint32_t m_source_update = 0;
+
+		// the cache is content addressed : its entries are named after a hash of the sources, the included headers, the defines and the renderer
+		string cache_path(GfxSystem& gfx, Program& program, const string& defines)
+		{
+			if(m_source_update != program.m_update)
+			{
+				uint64_t hash = includes_hash(gfx);
+				for(ShaderType type = ShaderType(0); type != ShaderType::Count; type = ShaderType(unsigned(type) + 1))
+				{
+					const string path = shader_path(gfx, program.m_name, type);
+					const string& source = program.m_sources[type];
+					const string file = source.empty() && file_exists(path) ? read_text_file(path) : string();
+					hash = fnv1a(source.empty() ? file : source, fnv1a(&type, sizeof(type), hash));
+				}
+				m_source_hash = hash;
+				m_source_update = program.m_update;
+			}
+
+			const uint32_t renderer = uint32_t(bgfx::getRendererType());
+			const uint64_t key = fnv1a(defines, fnv1a(&renderer, sizeof(renderer), m_source_hash));
+
+			char hex[17];
+			snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)key);
+			return gfx.m_resource_path + "/shaders/cache/" + hex;
+		}
+
+		// the compiled version with the fewest differing options and modes
+		bgfx::ProgramHandle fallback(uint64_t version)
+		{
+			const uint32_t options = uint32_t(version);
+			const uint32_t modes = uint32_t(version >> 32);
+
+			bgfx::ProgramHandle nearest = BGFX_INVALID_HANDLE;
+			uint32_t nearest_distance = UINT32_MAX;
+			for(auto& hash_version : m_versions)
+			{
+				const Version& other = hash_version.second;
+				const uint32_t other_options = uint32_t(other.m_version);
+				const uint32_t other_modes = uint32_t(other.m_version >> 32);
+				if(!bgfx::isValid(other.m_program) || ((options ^ other_options) & m_base_options) != 0)
+					continue;
+
+				uint32_t distance = popcount(options ^ other_options);
+				for(uint32_t shift = 0; shift < 32; shift += 8)
+					distance += ((modes >> shift) & 0xff) != ((other_modes >> shift) & 0xff) ? 1 : 0;
+
+				if(distance < nearest_distance)
+				{
+					nearest = other.m_program;
+					nearest_distance = distance;
+				}
+			}
+			return nearest;
+		}
 	};
 
 	GfxSystem* Program::ms_gfx = nullptr;
@@ -253,6 +414,7 @@ namespace two
 	{
 		static string options[] = { "INSTANCING", "BILLBOARD", "SKELETON", "MORPHTARGET", "QNORMALS", "VFLIP", "MRT", "DEFERRED", "CLUSTERED" };
 		this->register_options(0, options);
+		m_impl->m_base_options = (1 << uint32_t(m_options.size())) - 1;
 
 		this->set_block(MaterialBlock::Base);
 
@@ -375,7 +537,7 @@ namespace two
 		return config;
 	}
 
-	void Program::compile(GfxSystem& gfx, Version& version, bool compute)
+	void Program::compile(GfxSystem& gfx, Version& version, bool compute, bool background)
 	{
 		const ProgramVersion config = this->program(version);
 
@@ -383,45 +545,115 @@ namespace two
 		const string defines = this->defines(config);
 
 		const string full_name = m_name + suffix;
+		const string cache_path = m_impl->cache_path(gfx, *this, defines);
+
+		// a version that was compiled before is being reloaded : the headers it includes might have changed since
+		const bool reload = version.m_update > 0;
+		if(!reload && file_exists(cache_path + (compute ? "_cs" : "_fs")))
+		{
+			this->load(gfx, version, cache_path, m_update);
+			return;
+		}
 
+#ifdef TWO_LIVE_SHADER_COMPILER
 		info("gfx - compiling program %s", full_name.c_str());
 		info("gfx - with defines: %s", defines.c_str());
 
-		bool compiled = true;
-#ifdef TWO_LIVE_SHADER_COMPILER
-		if(compute)
+		unique<ProgramCompile> compile = construct<ProgramCompile>();
+		compile->m_version = version.m_version;
+		compile->m_update = m_update;
+		compile->m_compute = compute;
+		compile->m_geometry = !compute && file_exists(shader_path(gfx, m_name, ShaderType::Geometry).c_str());
+		compile->m_resource_path = gfx.m_resource_path;
+		compile->m_name = m_name;
+		compile->m_full_name = full_name;
+		compile->m_defines = defines;
+		compile->m_output = cache_path;
+		compile->m_sources = m_sources;
+
+		create_file_tree(cache_path);
+
+		// without a job system, or when no job is available, the version is compiled right away
+		if(background && gfx.m_job_system)
 		{
-			compiled &= compile_shader(gfx, m_name, suffix, ShaderType::Compute, defines, m_sources[ShaderType::Compute]);
+			ProgramCompile* task = compile.get();
+			Job* job = gfx.m_job_system->job(nullptr, [task](JobSystem& js, Job* job) { UNUSED(js); UNUSED(job); task->run(); });
+			if(job)
+			{
+				version.m_pending = m_update;
+				m_impl->m_compiles.push_back(move(compile));
+				gfx.m_job_system->run(job);
+				return;
+			}
 		}
-		else
-		{
-			compiled &= compile_shader(gfx, m_name, suffix, ShaderType::Vertex, defines, m_sources[ShaderType::Vertex]);
-			compiled &= compile_shader(gfx, m_name, suffix, ShaderType::Fragment, defines, m_sources[ShaderType::Fragment]);
 
-			if(file_exists(shader_path(gfx, m_name, ShaderType::Geometry).c_str()))
-				compiled &= compile_shader(gfx, m_name, suffix, ShaderType::Geometry, defines, m_sources[ShaderType::Geometry]);
-		}
-#endif
+		compile->run();
 
-		if(!compiled)
+		if(compile->m_state == ProgramCompile::Failed)
 		{
 			warn("gfx - failed to compile program %s : using last valid version instead", full_name.c_str());
 			version.m_update = m_update;
 			return;
 		}
 
+		this->load(gfx, version, cache_path, m_update);
+#else
+		// binaries compiled before the cache existed are named after the program version
 		const string compiled_path = gfx.m_resource_path + "/shaders/compiled/" + full_name;
-		version.m_program = compute ? load_compute_program(gfx.file_reader(), compiled_path)
-									: load_program(gfx.file_reader(), compiled_path);
-		version.m_update = m_update;
+		this->load(gfx, version, compiled_path, m_update);
+#endif
+	}
+
+	void Program::load(GfxSystem& gfx, Version& version, const string& path, uint32_t update)
+	{
+		bgfx::ProgramHandle program = m_compute ? load_compute_program(gfx.file_reader(), path)
+												: load_program(gfx.file_reader(), path);
+
+		// the previous program might still be used by this frame : bgfx defers its destruction until the frame is done
+		if(bgfx::isValid(program))
+		{
+			if(bgfx::isValid(version.m_program))
+				bgfx::destroy(version.m_program);
+			version.m_program = program;
+		}
+
+		version.m_update = update;
 	}
 
 	void Program::update(GfxSystem& gfx)
 	{
+		vector<unique<ProgramCompile>>& compiles = m_impl->m_compiles;
+		for(size_t i = 0; i < compiles.size();)
+		{
+			ProgramCompile& compile = *compiles[i];
+			const int state = compile.m_state.load(std::memory_order_acquire);
+			if(state == ProgramCompile::Compiling)
+			{
+				++i;
+				continue;
+			}
+
+			Version& version = m_impl->m_versions[compile.m_version];
+			if(version.m_pending == compile.m_update)
+				version.m_pending = 0;
+
+			if(state == ProgramCompile::Failed)
+			{
+				warn("gfx - failed to compile program %s : using last valid version instead", compile.m_full_name.c_str());
+				version.m_update = compile.m_update;
+			}
+			else
+			{
+				this->load(gfx, version, compile.m_output, compile.m_update);
+			}
+
+			compiles.erase(compiles.begin() + i);
+		}
+
 		for(auto& hash_version : m_impl->m_versions)
 		{
 			Version& version = hash_version.second;
-			if(version.m_update < m_update)
+			if(version.m_update < m_update && version.m_pending != m_update)
 			{
 				this->compile(gfx, version, m_compute);
 			}
@@ -431,6 +663,25 @@ namespace two
 	bgfx::ProgramHandle Program::default_version()
 	{
 		ProgramVersion config = { *this };
+		uint64_t version_hash = config.hash();
+
+		// the default version has no fallback to draw with : a precompile of it is waited for, otherwise it is compiled here
+		Version& version = m_impl->m_versions[version_hash];
+		if(!bgfx::isValid(version.m_program) && version.m_pending != 0)
+		{
+			for(unique<ProgramCompile>& compile : m_impl->m_compiles)
+				if(compile->m_version == version_hash)
+					while(compile->m_state.load(std::memory_order_acquire) == ProgramCompile::Compiling)
+						std::this_thread::yield();
+			this->update(*ms_gfx);
+		}
+
+		if(!bgfx::isValid(version.m_program) && version.m_update < m_update)
+		{
+			version.m_version = version_hash;
+			this->compile(*ms_gfx, version, m_compute, false);
+		}
+
 		return this->version(config);
 	}
 
@@ -439,12 +690,82 @@ namespace two
 		uint64_t version_hash = config.hash();
 
 		Version& version = m_impl->m_versions[version_hash];
-		if(version.m_update < m_update)
+		if(version.m_update < m_update && version.m_pending != m_update)
 		{
 			version.m_version = version_hash;
 			this->compile(*ms_gfx, version, m_compute);
 		}
 
+		if(!bgfx::isValid(version.m_program) && version.m_pending != 0)
+			return m_impl->fallback(version_hash);
+
 		return version.m_program;
 	}
+
+	void Program::precompile(uint64_t version_hash)
+	{
+		Version& version = m_impl->m_versions[version_hash];
+		if(version.m_update < m_update && version.m_pending != m_update)
+		{
+			version.m_version = version_hash;
+			this->compile(*ms_gfx, version, m_compute);
+		}
+	}
+
+	void Program::precompile(const ProgramVersion& base, span<uint8_t> options)
+	{
+		assert(options.size() < 32);
+		for(uint32_t combination = 0; combination < (1U << options.size()); ++combination)
+		{
+			ProgramVersion config = base;
+			for(size_t i = 0; i < options.size(); ++i)
+				config.set(options[i], (combination & (1U << i)) != 0);
+			this->precompile(config.hash());
+		}
+	}
+
+	vector<uint64_t> Program::versions() const
+	{
+		vector<uint64_t> versions;
+		for(auto& hash_version : m_impl->m_versions)
+			versions.push_back(hash_version.first);
+		return versions;
+	}
+
+	size_t Program::pending() const
+	{
+		return m_impl->m_compiles.size();
+	}
+
+	void save_program_variants(GfxSystem& gfx, const string& path)
+	{
+		string variants;
+		for(Program* program : gfx.programs().m_vector)
+			for(uint64_t version : program->versions())
+			{
+				char line[32];
+				snprintf(line, sizeof(line), " %llu\n", (unsigned long long)version);
+				variants += program->m_name + line;
+			}
+
+		write_file(path, variants);
+	}
+
+	void precompile_program_variants(GfxSystem& gfx, const string& path)
+	{
+		read_text_file(path, [&](const string& line)
+		{
+			char name[256];
+			unsigned long long version;
+			if(sscanf(line.c_str(), "%255s %llu", name, &version) != 2)
+				return true;
+
+			Program* program = gfx.programs().get(name);
+			if(program)
+				program->precompile(uint64_t(version));
+			else
+				warn("gfx - no program %s to precompile", name);
+			return true;
+		});
+	}
 }
@@ -112,6 +112,7 @@ namespace two
 			Version() {}
 			uint64_t m_version = 0;
 			uint32_t m_update = 0;
+			uint32_t m_pending = 0;		// the update being compiled in the background, if any
 			bgfx::ProgramHandle m_program = BGFX_INVALID_HANDLE;
 		};
 
@@ -129,13 +130,27 @@ namespace two
 
 		void reload() { m_update++; }
 
-		void compile(GfxSystem& gfx, Version& version, bool compute = false);
+		// a background compile leaves the version to its fallback until update() promotes it
+		void compile(GfxSystem& gfx, Version& version, bool compute = false, bool background = true);
 
+		// promotes the versions compiled in the background, and recompiles the versions of a reloaded program
 		void update(GfxSystem& gfx);
 
+		// the default version is compiled right away : the handle is replaced when the program reloads, so fetch it every frame
 		bgfx::ProgramHandle default_version();
+		// while a version is compiled in the background, the nearest compiled version is returned instead
 		bgfx::ProgramHandle version(const ProgramVersion& config);
 
+		// compiles a version ahead of its first use, so that rendering doesn't have to wait for it
+		void precompile(uint64_t version);
+		// precompiles every combination of the given options over a base version
+		void precompile(const ProgramVersion& base, span<uint8_t> options);
+
+		// the versions requested so far
+		vector<uint64_t> versions() const;
+		// the number of versions being compiled in the background
+		size_t pending() const;
+
 		ProgramVersion program(Version& version);
 
 		meth_ void register_blocks(const Program& program);
@@ -169,7 +184,14 @@ namespace two
 		static GfxSystem* ms_gfx;
 
 	private:
+		void load(GfxSystem& gfx, Version& version, const string& path, uint32_t update);
+
 		struct Impl;
 		unique<Impl> m_impl;
 	};
+
+	// a variants file lists the versions requested from each program, one per line : it's written after a run that went through
+	// the content, and read at boot to precompile these versions, or offline to fill the shader cache before shipping
+	export_ TWO_GFX_EXPORT void save_program_variants(GfxSystem& gfx, const string& path);
+	export_ TWO_GFX_EXPORT void precompile_program_variants(GfxSystem& gfx, const string& path);
 }
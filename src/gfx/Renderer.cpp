@@ -26,6 +26,7 @@ module two.gfx;
 #include <gfx/Skeleton.h>
 #include <gfx/RenderTarget.h>
 #include <gfx/Material.h>
+#include <gfx/Texture.h>
 #include <gfx/Frustum.h>
 #include <gfx/GfxSystem.h>
 #include <gfx/Filter.h>
@@ -178,6 +179,8 @@ namespace two
 
 		render.m_viewport->render(render);
 		render.m_viewport->cull(render);
+
+		m_gfx.texture_streamer().gather(render);
 	}
 
 	void Renderer::submit(Render& render, RenderFunc renderer)
@@ -159,6 +159,10 @@ namespace two
 		attr_ uint32_t m_num_draw_calls = 0;
 		attr_ uint32_t m_num_vertices = 0;
 		attr_ uint32_t m_num_triangles = 0;
+
+		attr_ uint32_t m_num_shadow_casters = 0;
+		attr_ uint32_t m_num_shadow_maps = 0;
+		attr_ uint32_t m_num_shadow_cached = 0;
 	};
 
 	using RenderFunc = void(*)(GfxSystem&, Render&);
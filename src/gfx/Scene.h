@@ -114,6 +114,9 @@ namespace two
 		attr_ Zone m_env;
 		attr_ Ref m_user;
 
+		// bumped whenever an ItemFlag::Static item is created, moved or destroyed
+		uint32_t m_static_version = 0;
+
 		meth_ Gnode& begin();
 		meth_ void update();
 
@@ -0,0 +1,37 @@
+$input v_color, v_ui_stroke, v_ui_uv, v_ui_shape, v_ui_corners, v_ui_mode
+
+#include <bgfx_shader.sh>
+
+SAMPLER2D(s_ui_image, 0);
+SAMPLER2D(s_ui_glyphs, 1);
+
+// signed distance to a box with one radius per corner : top left, top right, bottom right, bottom left
+float round_box(vec2 p, vec2 b, vec4 corners)
+{
+    float r = p.x > 0.0 ? (p.y > 0.0 ? corners.z : corners.y) : (p.y > 0.0 ? corners.w : corners.x);
+    vec2 q = abs(p) - b + r;
+    return min(max(q.x, q.y), 0.0) + length(max(q, 0.0)) - r;
+}
+
+void main()
+{
+    if(v_ui_mode > 1.5)
+    {
+        // glyph : the distance field edge is at 0.5, smoothed over a screen pixel
+        float dist = texture2D(s_ui_glyphs, v_ui_uv.xy).r;
+        float width = max(fwidth(dist), 0.0001);
+        float alpha = smoothstep(0.5 - width, 0.5 + width, dist);
+        gl_FragColor = vec4(v_color.rgb, v_color.a * alpha);
+    }
+    else
+    {
+        // shape : the box distance gives the antialiased (or blurred) edge, and the border inside it
+        float d = round_box(v_ui_uv.zw, v_ui_shape.xy, v_ui_corners);
+        float coverage = clamp(0.5 - d / v_ui_shape.w, 0.0, 1.0);
+        float inner = clamp(0.5 - (d + v_ui_shape.z), 0.0, 1.0);
+        vec4 color = v_ui_shape.z > 0.0 ? mix(v_ui_stroke, v_color, inner) : v_color;
+        if(v_ui_mode > 0.5)
+            color *= texture2D(s_ui_image, v_ui_uv.xy);
+        gl_FragColor = vec4(color.rgb, color.a * coverage);
+    }
+}
@@ -0,0 +1,15 @@
+$input a_position, a_texcoord0, a_texcoord1, a_tangent, a_weight, a_color0, a_color1, a_texcoord2
+$output v_color, v_ui_stroke, v_ui_uv, v_ui_shape, v_ui_corners, v_ui_mode
+
+#include <bgfx_shader.sh>
+
+void main()
+{
+    gl_Position = mul(u_viewProj, vec4(a_position.xy, 0.0, 1.0));
+    v_color = a_color0;
+    v_ui_stroke = a_color1;
+    v_ui_uv = vec4(a_texcoord0, a_texcoord1);
+    v_ui_shape = a_tangent;
+    v_ui_corners = a_weight;
+    v_ui_mode = a_texcoord2.x;
+}
@@ -19,6 +19,12 @@ float v_line_distance : TEXCOORD6 = 0.0;
 
 vec4 v_mirrored     : TEXCOORD4 = vec4(0.0, 0.0, 0.0, 0.0);
 
+vec4 v_ui_uv        : TEXCOORD0 = vec4(0.0, 0.0, 0.0, 0.0);
+vec4 v_ui_shape     : TEXCOORD1 = vec4(0.0, 0.0, 0.0, 1.0);
+vec4 v_ui_corners   : TEXCOORD2 = vec4(0.0, 0.0, 0.0, 0.0);
+vec4 v_ui_stroke    : TEXCOORD3 = vec4(0.0, 0.0, 0.0, 0.0);
+float v_ui_mode     : TEXCOORD4 = 0.0;
+
 vec3 v_sundir       : TEXCOORD4 = vec3(0.0, 0.0, -1.0);
 vec2 v_sunp0        : TEXCOORD5 = vec2(0.0, 0.0);
 vec3 v_betaR        : TEXCOORD6 = vec3(0.0, 0.0, 0.0);
@@ -31,6 +37,7 @@ vec4 g_color        : COLOR0    = vec4(1.0, 1.0, 1.0, 1.0);
 
 vec4 a_position     : POSITION;
 vec4 a_color0       : COLOR0;
+vec4 a_color1       : COLOR1;
 vec3 a_normal       : NORMAL;
 vec4 a_tangent      : TANGENT;
 vec2 a_texcoord0    : TEXCOORD0;
@@ -15,17 +15,33 @@
 module two.gfx;
 #else
 #include <stl/string.h>
+#include <stl/algorithm.h>
+#include <math/Math.h>
+#include <math/Vec.hpp>
 #include <infra/Log.h>
 #include <infra/Vector.h>
 #include <infra/File.h>
 #include <gfx/Texture.h>
 #include <gfx/GfxSystem.h>
+#include <gfx/Asset.h>
 #include <gfx/Node3.h>
 #include <gfx/Renderer.h>
+#include <gfx/RenderTarget.h>
+#include <gfx/Camera.h>
+#include <gfx/Shot.h>
+#include <gfx/Item.h>
+#include <gfx/Model.h>
+#include <gfx/Material.h>
+#include <jobs/JobSystem.h>
+#include <jobs/Job.h>
 #endif
 
 #include <cstdio>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 namespace two
 {
@@ -205,6 +221,32 @@ namespace two
 		save_bgfx_texture(gfx, path, bgfx_target_format, tex.m_tex, bgfx_format, uint16_t(tex.m_size.x), uint16_t(tex.m_size.y), tex.m_depth ? tex.m_depth : 1);
 	}
 
+	struct TextureStream
+	{
+		enum State : int { Decoding, Decoded, Failed };
+
+		TextureStreamer* m_streamer = nullptr;
+		Texture* m_texture = nullptr;
+		string m_path;
+		bool m_srgb = false;
+
+		bx::AllocatorI* m_allocator = nullptr;
+		bimg::ImageContainer* m_image = nullptr;		// all mips, decoded by a job
+		std::atomic<int> m_state = { Decoding };
+
+		uint8_t m_num_mips = 0;
+		uint8_t m_base = 0;					// the largest mip that is always resident
+		uint8_t m_resident = UINT8_MAX;		// the largest resident mip, none until the image is decoded
+		uint8_t m_desired = 0;				// the largest mip wanted on screen
+		uint8_t m_target = 0;				// the largest mip that fits in the budget
+		float m_pixels = 0.f;				// requested size on screen, this frame
+		float m_screen = 0.f;				// requested size on screen, last time the texture was used
+		uint32_t m_last_used = 0;
+		size_t m_bytes[32] = {};			// size of the mip chain starting at each mip
+
+		void decode();
+	};
+
 	Texture::Texture(const string& name)
 		: m_name(name)
 	{}
@@ -241,8 +283,33 @@ namespace two
 		m_is_depth = bformat >= bgfx::TextureFormat::D16 && bformat <= bgfx::TextureFormat::D0S8;
 	}
 
+	Texture::Texture(Texture&& other)
+		: Texture(other)
+	{
+		other.m_tex = BGFX_INVALID_HANDLE;
+		other.m_stream = nullptr;
+		if(m_stream)
+			m_stream->m_texture = this;
+	}
+
+	Texture& Texture::operator=(Texture&& other)
+	{
+		bgfx::TextureHandle tex = m_tex;
+		TextureStream* stream = m_stream;
+		*this = other;
+		other.m_tex = tex;
+		other.m_stream = stream;
+		if(m_stream)
+			m_stream->m_texture = this;
+		if(other.m_stream)
+			other.m_stream->m_texture = &other;
+		return *this;
+	}
+
 	Texture::~Texture()
 	{
+		if(m_stream)
+			m_stream->m_streamer->remove(*this);
 		if(bgfx::isValid(m_tex))
 			bgfx::destroy(m_tex);
 	}
@@ -301,7 +368,23 @@ namespace two
 
 	void Texture::reload(GfxSystem& gfx, bool srgb, bool mips)
 	{
-		this->load(gfx, m_location, srgb, mips);
+		if(m_stream)
+			this->stream(gfx, m_location, srgb);
+		else
+			this->load(gfx, m_location, srgb, mips);
+	}
+
+	void Texture::stream(GfxSystem& gfx, const string& path, bool srgb)
+	{
+		// cubemaps are loaded whole
+		if(file_extension(path) == "cube")
+		{
+			this->load(gfx, path, srgb, true);
+			return;
+		}
+
+		m_location = path;
+		gfx.texture_streamer().add(*this, path, srgb);
 	}
 
 	void Texture::load_float(const uvec2& size, const bgfx::Memory& memory, uint8_t num_components)
@@ -349,4 +432,363 @@ namespace two
 			memcpy(memory->data, data.m_pointer, data.m_count * sizeof(float));
 		this->load_float(size, *memory);
 	}
+
+	void TextureStream::decode()
+	{
+		// the file reader of the gfx system belongs to the main thread
+		bx::FileReader reader;
+		uint32_t size = 0;
+		void* data = load_mem(&reader, m_allocator, m_path.c_str(), &size);
+		bimg::ImageContainer* image = data ? bimg::imageParse(m_allocator, data, size) : nullptr;
+		if(data)
+			BX_FREE(m_allocator, data);
+
+		// as in load_bgfx_image : uncompressed images without mips get them generated
+		bool need_mips = image && (image->m_format == bimg::TextureFormat::R8
+			|| image->m_format == bimg::TextureFormat::RGB8
+			|| image->m_format == bimg::TextureFormat::RGBA8);
+
+		if(need_mips && image->m_numMips <= 1 && !image->m_cubeMap && image->m_depth == 1)
+		{
+			bimg::ImageContainer* rgba8 = bimg::imageConvert(m_allocator, bimg::TextureFormat::RGBA8, *image);
+			bimg::ImageContainer* mips = bimg::imageGenerateMips(m_allocator, *rgba8);
+			bimg::imageFree(rgba8);
+			if(mips != nullptr)
+			{
+				bimg::imageFree(image);
+				image = mips;
+			}
+		}
+
+		m_image = image;
+		m_state.store(image ? Decoded : Failed, std::memory_order_release);
+	}
+
+	TextureStreamer::TextureStreamer(GfxSystem& gfx)
+		: m_gfx(gfx)
+	{}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		for(unique<TextureStream>& stream : m_streams)
+		{
+			while(stream->m_state.load(std::memory_order_acquire) == TextureStream::Decoding)
+				std::this_thread::yield();
+			if(stream->m_image)
+				bimg::imageFree(stream->m_image);
+			stream->m_texture->m_stream = nullptr;
+		}
+	}
+
+	Texture* TextureStreamer::file(const string& name)
+	{
+		AssetStore<Texture>& textures = m_gfx.textures();
+		if(Texture* texture = textures.get(name))
+			return texture;
+
+		LocatedFile location = m_gfx.locate_file("textures/" + name);
+		if(!location)
+			return nullptr;
+
+		return &this->load(textures.create(name), location.path(false));
+	}
+
+	Texture& TextureStreamer::file_at(const string& path, const string& name)
+	{
+		AssetStore<Texture>& textures = m_gfx.textures();
+		if(Texture* texture = textures.get(name))
+			return *texture;
+
+		return this->load(textures.create(name), path + "/" + name);
+	}
+
+	Texture& TextureStreamer::load(Texture& texture, const string& path)
+	{
+		if(m_enabled)
+			texture.stream(m_gfx, path);
+		else
+			texture.load(m_gfx, path);
+		return texture;
+	}
+
+	void TextureStreamer::add(Texture& texture, const string& path, bool srgb)
+	{
+		this->remove(texture);
+
+		unique<TextureStream> stream = construct<TextureStream>();
+		stream->m_streamer = this;
+		stream->m_texture = &texture;
+		stream->m_path = path;
+		stream->m_srgb = srgb;
+		stream->m_allocator = &m_gfx.allocator();
+
+		TextureStream* decode = stream.get();
+		texture.m_stream = decode;
+		m_streams.push_back(move(stream));
+
+		// without a job system, or when no job is available, the image is decoded right away
+		Job* job = m_gfx.m_job_system ? m_gfx.m_job_system->job(nullptr, [decode](JobSystem& js, Job* job) { UNUSED(js); UNUSED(job); decode->decode(); })
+									  : nullptr;
+		if(job)
+			m_gfx.m_job_system->run(job);
+		else
+			decode->decode();
+	}
+
+	void TextureStreamer::remove(Texture& texture)
+	{
+		TextureStream* stream = texture.m_stream;
+		if(!stream)
+			return;
+
+		// the decoding job writes to the stream until it completes
+		while(stream->m_state.load(std::memory_order_acquire) == TextureStream::Decoding)
+			std::this_thread::yield();
+
+		if(stream->m_image)
+			bimg::imageFree(stream->m_image);
+
+		texture.m_stream = nullptr;
+		remove_if(m_streams, [&](unique<TextureStream>& s) { return s.get() == stream; });
+	}
+
+	void TextureStreamer::request(Texture& texture, float pixels)
+	{
+		TextureStream& stream = *texture.m_stream;
+		stream.m_pixels = max(stream.m_pixels, pixels);
+		stream.m_last_used = m_frame;
+	}
+
+	static void request_textures(TextureStreamer& streamer, const Material& material, float pixels)
+	{
+		Texture* textures[] =
+		{
+			material.m_alpha.m_alpha.m_texture, material.m_solid.m_colour.m_texture, material.m_fresnel.m_value.m_texture,
+			material.m_lit.m_emissive.m_texture, material.m_lit.m_normal.m_texture, material.m_lit.m_bump.m_texture,
+			material.m_lit.m_displace.m_texture, material.m_lit.m_occlusion.m_texture,
+			material.m_pbr.m_albedo.m_texture, material.m_pbr.m_metallic.m_texture, material.m_pbr.m_roughness.m_texture,
+			material.m_pbr.m_depth.m_texture,
+			material.m_phong.m_diffuse.m_texture, material.m_phong.m_specular.m_texture, material.m_phong.m_shininess.m_texture,
+			material.m_user.m_tex0, material.m_user.m_tex1, material.m_user.m_tex2,
+			material.m_user.m_tex3, material.m_user.m_tex4, material.m_user.m_tex5,
+		};
+
+		for(Texture* texture : textures)
+			if(texture && texture->m_stream)
+				streamer.request(*texture, pixels);
+	}
+
+	void TextureStreamer::gather(Render& render)
+	{
+		if(m_streams.empty() || !render.m_camera || !render.m_target)
+			return;
+
+		// the textures are assumed to cover their item once : the size of the item on screen is the size of the texture
+		const Camera& camera = *render.m_camera;
+		const float height = render.m_rect.height * float(render.m_target->m_size.y);
+		const float scale = camera.m_orthographic ? height / camera.m_height
+												  : height / (2.f * tanf(to_radians(camera.m_fov) * 0.5f));
+
+		for(Item* item : render.m_shot.m_items)
+		{
+			if(!item->m_model || item->m_aabb.m_empty)
+				continue;
+
+			const float diameter = 2.f * length(item->m_aabb.m_extents);
+			const float distance = max(length(item->m_aabb.m_center - camera.m_eye), camera.m_near);
+			const float pixels = camera.m_orthographic ? diameter * scale : diameter * scale / distance;
+
+			for(const ModelElem& elem : item->m_model->m_items)
+			{
+				const Material* material = item->m_material ? item->m_material : elem.m_material;
+				if(material)
+					request_textures(*this, *material, pixels);
+			}
+		}
+	}
+
+	void TextureStreamer::create(TextureStream& stream, uint8_t mip)
+	{
+		bimg::ImageContainer& image = *stream.m_image;
+
+		// the mips of a single 2d image are stored from the largest to the smallest : the chain from a mip is the end of the data
+		bimg::ImageMip top;
+		bimg::imageGetRawData(image, 0, mip, image.m_data, image.m_size, top);
+		const uint32_t offset = uint32_t(top.m_data - static_cast<const uint8_t*>(image.m_data));
+
+		const bgfx::Memory* mem = bgfx::copy(top.m_data, image.m_size - offset);
+		const uint64_t flags = stream.m_srgb || image.m_srgb ? BGFX_TEXTURE_SRGB : BGFX_TEXTURE_NONE;
+		bgfx::TextureHandle handle = bgfx::createTexture2D(uint16_t(top.m_width), uint16_t(top.m_height), stream.m_num_mips - mip > 1, 1,
+														   bgfx::TextureFormat::Enum(image.m_format), flags, mem);
+		if(!bgfx::isValid(handle))
+			return;
+
+		// the previous texture might still be used by this frame : bgfx defers its destruction until the frame is done
+		Texture& texture = *stream.m_texture;
+		if(bgfx::isValid(texture.m_tex))
+			bgfx::destroy(texture.m_tex);
+
+		texture.m_tex = handle;
+		texture.m_memsize = uint32_t(stream.m_bytes[mip]);
+		bgfx::setName(handle, texture.m_name.c_str());
+
+		stream.m_resident = mip;
+	}
+
+	bool TextureStreamer::start(TextureStream& stream)
+	{
+		Texture& texture = *stream.m_texture;
+		bimg::ImageContainer* image = stream.m_image;
+		if(!image)
+		{
+			warn("gfx - failed to decode image %s for streaming : loading it whole instead", stream.m_path.c_str());
+			texture.load(m_gfx, stream.m_path, stream.m_srgb);
+			return false;
+		}
+
+		// cubemaps, arrays, volumes and images without mips are created whole, and don't stream
+		const bool streamable = !image->m_cubeMap && image->m_depth == 1 && image->m_numLayers == 1 && image->m_numMips > 1;
+		if(!streamable)
+		{
+			stream.m_image = nullptr;
+
+			bgfx::TextureInfo texture_info;
+			bgfx::TextureHandle handle = load_bgfx_image(m_gfx, *image, stream.m_path, stream.m_srgb ? BGFX_TEXTURE_SRGB : BGFX_TEXTURE_NONE, &texture_info, false);
+			if(bgfx::isValid(handle) && bgfx::isValid(texture.m_tex))
+				bgfx::destroy(texture.m_tex);
+			texture.init(handle, texture_info);
+			return false;
+		}
+
+		stream.m_num_mips = uint8_t(min(uint32_t(image->m_numMips), 32U));
+		for(uint8_t mip = 0; mip < stream.m_num_mips; ++mip)
+		{
+			bimg::ImageMip chain;
+			bimg::imageGetRawData(*image, 0, mip, image->m_data, image->m_size, chain);
+			stream.m_bytes[mip] = image->m_size - size_t(chain.m_data - static_cast<const uint8_t*>(image->m_data));
+		}
+
+		const uint32_t size = max(image->m_width, image->m_height);
+		stream.m_base = 0;
+		while(stream.m_base < stream.m_num_mips - 1 && (size >> stream.m_base) > m_base_size)
+			stream.m_base++;
+
+		texture.m_size = uvec2(image->m_width, image->m_height);
+		texture.m_format = TextureFormat(image->m_format);
+		texture.m_bits_per_pixel = bimg::getBitsPerPixel(image->m_format);
+		texture.m_is_cube = false;
+		texture.m_is_array = false;
+		texture.m_mips = true;
+
+		info("gfx - streaming image %s srgb(%i) of size %s in memory", stream.m_path.c_str(), int(image->m_srgb), readable_file_size(image->m_size).c_str());
+
+		stream.m_desired = stream.m_base;
+		stream.m_target = stream.m_base;
+		this->create(stream, stream.m_base);
+		return stream.m_resident != UINT8_MAX;
+	}
+
+	void TextureStreamer::update()
+	{
+		TextureStreamStats stats;
+
+		// decoded images get their smallest mips first
+		m_order.clear();
+		for(size_t i = 0; i < m_streams.size();)
+		{
+			TextureStream& stream = *m_streams[i];
+			if(stream.m_resident == UINT8_MAX)
+			{
+				if(stream.m_state.load(std::memory_order_acquire) == TextureStream::Decoding)
+				{
+					stats.m_decoding++;
+					++i;
+					continue;
+				}
+
+				if(!this->start(stream))
+				{
+					if(stream.m_image)
+						bimg::imageFree(stream.m_image);
+					stream.m_texture->m_stream = nullptr;
+					m_streams.erase(m_streams.begin() + i);
+					continue;
+				}
+			}
+
+			m_order.push_back(&stream);
+			++i;
+		}
+
+		// mips that aren't wanted anymore stay resident until the budget needs them
+		size_t total = 0;
+		for(TextureStream* stream : m_order)
+		{
+			if(stream->m_last_used == m_frame)
+			{
+				const float size = float(max(stream->m_image->m_width, stream->m_image->m_height));
+				const float level = log2f(size / max(stream->m_pixels, 1.f)) + m_bias;
+				stream->m_desired = uint8_t(clamp(int(floorf(level)), 0, int(stream->m_base)));
+				stream->m_screen = stream->m_pixels;
+			}
+
+			stream->m_pixels = 0.f;
+			stream->m_target = min(stream->m_desired, stream->m_resident);
+			total += stream->m_bytes[stream->m_target];
+
+			stats.m_desired_bytes += stream->m_bytes[stream->m_desired];
+			stats.m_image_bytes += stream->m_image->m_size;
+			if(stream->m_desired < stream->m_resident)
+				stats.m_requests++;
+		}
+
+		// least important first : used the longest time ago, then smallest on screen
+		std::sort(m_order.begin(), m_order.end(), [](TextureStream* a, TextureStream* b)
+		{
+			return a->m_last_used != b->m_last_used ? a->m_last_used < b->m_last_used : a->m_screen < b->m_screen;
+		});
+
+		for(TextureStream* stream : m_order)
+		{
+			if(total <= m_budget)
+				break;
+			while(total > m_budget && stream->m_target < stream->m_base)
+			{
+				total -= stream->m_bytes[stream->m_target] - stream->m_bytes[stream->m_target + 1];
+				stream->m_target++;
+			}
+		}
+
+		for(TextureStream* stream : m_order)
+			if(stream->m_target > stream->m_resident)
+			{
+				this->create(*stream, stream->m_target);
+				stats.m_evictions++;
+			}
+
+		// most important first, the uploads that don't fit in this frame are retried next frame
+		for(size_t i = m_order.size(); i > 0; --i)
+		{
+			TextureStream& stream = *m_order[i - 1];
+			if(stream.m_target >= stream.m_resident)
+				continue;
+
+			const size_t bytes = stream.m_bytes[stream.m_target];
+			if(stats.m_uploads > 0 && stats.m_uploaded_bytes + bytes > m_upload_budget)
+				continue;
+
+			this->create(stream, stream.m_target);
+			stats.m_uploaded_bytes += bytes;
+			stats.m_uploads++;
+		}
+
+		for(TextureStream* stream : m_order)
+			stats.m_resident_bytes += stream->m_bytes[stream->m_resident];
+
+		stats.m_textures = uint32_t(m_streams.size());
+		m_stats = stats;
+
+		m_frame++;
+	}
 }
+
@@ -8,6 +8,8 @@
 #include <stl/string.h>
 #include <stl/span.h>
 #include <stl/swap.h>
+#include <stl/vector.h>
+#include <stl/memory.h>
 #include <math/Vec.h>
 #endif
 #include <gfx/Forward.h>
@@ -66,6 +68,8 @@ namespace two
 
 	export_ TWO_GFX_EXPORT void save_texture(GfxSystem& gfx, Texture& texture, const string& path, TextureFormat target_format = TextureFormat::None);
 
+	struct TextureStream;
+
 	export_ class refl_ TWO_GFX_EXPORT Texture
 	{
 	public:
@@ -75,8 +79,8 @@ namespace two
 		Texture(const uvec3& size, bool mips, TextureFormat format, uint64_t flags = 0U);
 		~Texture();
 
-		Texture(Texture&& other) : Texture(other) { other.m_tex = BGFX_INVALID_HANDLE; }
-		Texture& operator=(Texture&& other) { bgfx::TextureHandle tex = m_tex; *this = other; other.m_tex = tex; return *this; }
+		Texture(Texture&& other);
+		Texture& operator=(Texture&& other);
 
 		attr_ string m_name;
 		attr_ string m_location;
@@ -97,6 +101,9 @@ namespace two
 		meth_ void load(GfxSystem& gfx, const string& path, bool srgb = false, bool mips = false);
 		meth_ void reload(GfxSystem& gfx, bool srgb = false, bool mips = false);
 
+		// loads the smallest mips first, then the texture streamer raises and lowers the resident mips as the texture is used on screen
+		meth_ void stream(GfxSystem& gfx, const string& path, bool srgb = false);
+
 		meth_ void load_mem(GfxSystem& gfx, span<uint8_t> data);
 
 		void load_rgba(const uvec2& size, const bgfx::Memory& data);
@@ -129,6 +136,8 @@ namespace two
 
 		bgfx::TextureHandle m_tex = BGFX_INVALID_HANDLE;
 
+		TextureStream* m_stream = nullptr;
+
 		operator bgfx::TextureHandle() const { return m_tex; }
 
 	protected:
@@ -136,6 +145,66 @@ namespace two
 		Texture& operator=(const Texture& other) = default;
 	};
 
+	export_ struct TextureStreamStats
+	{
+		size_t m_resident_bytes = 0;		// gpu memory of the resident mips
+		size_t m_desired_bytes = 0;			// gpu memory the mips wanted on screen would take, without a budget
+		size_t m_image_bytes = 0;			// system memory of the decoded images, that mips are uploaded from
+		size_t m_uploaded_bytes = 0;		// this frame
+		uint32_t m_textures = 0;
+		uint32_t m_decoding = 0;
+		uint32_t m_requests = 0;			// textures wanting more mips than are resident, this frame
+		uint32_t m_uploads = 0;				// textures that were given more mips, this frame
+		uint32_t m_evictions = 0;			// textures that gave up mips, this frame
+	};
+
+	// streamed textures are decoded on jobs, and created with their smallest mips only : the renderer requests mips for the textures
+	// of the visible items from their size on screen, and each frame, the streamer fits the requested mips within a byte budget,
+	// taking mips from the textures that were used least recently and that are the smallest on screen first
+	// a texture gets new mips by creating a new texture with them from the decoded image, which stays in system memory
+	export_ class TWO_GFX_EXPORT TextureStreamer
+	{
+	public:
+		TextureStreamer(GfxSystem& gfx);
+		~TextureStreamer();
+
+		TextureStreamer(const TextureStreamer& other) = delete;
+		TextureStreamer& operator=(const TextureStreamer& other) = delete;
+
+		GfxSystem& m_gfx;
+
+		bool m_enabled = false;						// the textures fetched through file() are streamed, otherwise they are loaded whole
+		size_t m_budget = 256 * 1024 * 1024;		// gpu memory of all streamed textures
+		size_t m_upload_budget = 16 * 1024 * 1024;	// bytes uploaded per frame, at least one texture is always uploaded
+		uint16_t m_base_size = 64;					// mips up to this size are always resident
+		float m_bias = 0.f;							// added to the requested mip levels, a positive bias lowers the resolution
+
+		TextureStreamStats m_stats;
+
+		// fetches a texture of the asset store : the model importers fetch their material textures here, as only these are requested
+		Texture* file(const string& name);
+		Texture& file_at(const string& path, const string& name);
+
+		void add(Texture& texture, const string& path, bool srgb);
+		void remove(Texture& texture);
+
+		// the texture covers about that many pixels in height on screen
+		void request(Texture& texture, float pixels);
+		// requests the textures of the visible items of a render
+		void gather(Render& render);
+
+		void update();
+
+	private:
+		Texture& load(Texture& texture, const string& path);
+		bool start(TextureStream& stream);
+		void create(TextureStream& stream, uint8_t mip);
+
+		vector<unique<TextureStream>> m_streams;
+		vector<TextureStream*> m_order;
+		uint32_t m_frame = 0;
+	};
+
 	struct GpuTexture
 	{
 		Texture texture;
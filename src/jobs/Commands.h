@@ -0,0 +1,120 @@
+#pragma once
+
+#include <stl/vector.h>
+#include <stl/memory.h>
+#include <stl/move.h>
+#include <stl/new.h>
+#include <jobs/JobSystem.h>
+
+#include <stdint.h>
+
+namespace two
+{
+	// a list of deferred commands, recorded by one thread and applied later in recording order by another
+	// commands are stored inline in fixed size pages that never move, so that recording doesn't allocate in the steady state
+	class CommandBuffer
+	{
+	public:
+		static constexpr size_t c_page_size = 16 * 1024;
+		static constexpr size_t c_align = 16;
+
+		CommandBuffer() {}
+		~CommandBuffer() { this->clear(); }
+
+		CommandBuffer(CommandBuffer&& other) = default;
+		CommandBuffer& operator=(CommandBuffer&& other) = default;
+
+		CommandBuffer(const CommandBuffer& other) = delete;
+		CommandBuffer& operator=(const CommandBuffer& other) = delete;
+
+		template <class T>
+		void push(T command)
+		{
+			static_assert(sizeof(T) <= c_page_size, "command too large");
+			static_assert(alignof(T) <= c_align, "command over-aligned");
+
+			auto apply = [](void* user) { (*static_cast<T*>(user))(); };
+			auto destroy = [](void* user) { static_cast<T*>(user)->~T(); };
+
+			void* storage = this->alloc(sizeof(T));
+			new(stl::placeholder(), storage) T(move(command));
+			m_commands.push_back({ storage, apply, destroy });
+		}
+
+		// applies all commands in recording order, then clears the buffer, keeping its pages for the next frame
+		void apply()
+		{
+			for(size_t i = 0; i < m_commands.size(); ++i)
+				m_commands[i].m_apply(m_commands[i].m_storage);
+			this->clear();
+		}
+
+		void clear()
+		{
+			for(Command& command : m_commands)
+				command.m_destroy(command.m_storage);
+			m_commands.clear();
+			m_page = 0;
+			m_used = 0;
+		}
+
+		size_t size() const { return m_commands.size(); }
+		bool empty() const { return m_commands.empty(); }
+
+	private:
+		void* alloc(size_t size)
+		{
+			const size_t offset = (m_used + c_align - 1) & ~(c_align - 1);
+			if(m_page < m_pages.size() && offset + size <= c_page_size)
+			{
+				m_used = offset + size;
+				return m_pages[m_page]->m_data + offset;
+			}
+
+			if(m_used > 0)
+				m_page++;
+			if(m_page >= m_pages.size())
+			{
+				m_pages.push_back(construct<Page>());
+				m_page = m_pages.size() - 1;
+			}
+			m_used = size;
+			return m_pages[m_page]->m_data;
+		}
+
+		struct alignas(c_align) Page
+		{
+			uint8_t m_data[c_page_size];
+		};
+
+		struct Command
+		{
+			void* m_storage;
+			void(*m_apply)(void*);
+			void(*m_destroy)(void*);
+		};
+
+		vector<Command> m_commands;
+		vector<unique<Page>> m_pages;
+		size_t m_page = 0;
+		size_t m_used = 0;
+	};
+
+	// one command buffer per thread of a job system : jobs record to the buffer of the thread they run on without locking,
+	// and the owner applies them all once the jobs are complete, thread by thread, each in recording order
+	class ThreadCommands
+	{
+	public:
+		ThreadCommands(JobSystem& js) : m_buffers(js.m_state_count) {}
+
+		CommandBuffer& operator[](uint32_t thread) { return m_buffers[thread]; }
+
+		void apply()
+		{
+			for(CommandBuffer& buffer : m_buffers)
+				buffer.apply();
+		}
+
+		vector<CommandBuffer> m_buffers;
+	};
+}
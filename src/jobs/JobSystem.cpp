@@ -175,6 +175,7 @@ namespace two
 		num_threads = min(uint16_t(HAS_THREADING ? 32 : 0), num_threads);
 
 		m_thread_count = num_threads;
+		m_state_count = num_threads + adoptable_threads;
 		m_parallel_split_count = (uint8_t)ceil(log2f(float(num_threads + adoptable_threads)));
 
 		m_impl->init(*this, num_threads, adoptable_threads);
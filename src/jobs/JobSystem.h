@@ -82,6 +82,7 @@ namespace two
 
 	public:
 		uint16_t m_thread_count = 0;            // total # of threads in the pool
+		uint16_t m_state_count = 0;             // # of worker and adoptable threads, the range of thread()
 		uint8_t m_parallel_split_count = 0;     // # of split allowable in parallel_for
 	private:
 		Job* m_master_job = nullptr;
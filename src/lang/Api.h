@@ -1,6 +1,8 @@
 #include <lang/Forward.h>
+#include <lang/CallFrame.h>
 #include <lang/Lua.h>
 #include <lang/Script.h>
+#include <lang/ScriptPool.h>
 #include <lang/Stream.h>
 #include <lang/Types.h>
 #include <lang/VisualBlocks.h>
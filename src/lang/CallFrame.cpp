@@ -0,0 +1,84 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#ifdef TWO_MODULES
+module;
+#include <infra/Cpp20.h>
+module two.lang;
+#else
+#include <stl/memory.h>
+#include <stl/vector.hpp>
+#include <refl/Method.h>
+#include <refl/Meta.h>
+#include <lang/Types.h>
+#include <lang/CallFrame.h>
+#endif
+
+namespace two
+{
+	FrameValue frame_value(const Type& type)
+	{
+		if(type.is<bool>()) return FrameValue::Bool;
+		else if(type.is<int>()) return FrameValue::Int;
+		else if(type.is<uint32_t>()) return FrameValue::UInt;
+		else if(type.is<float>()) return FrameValue::Float;
+		else if(type.is<double>()) return FrameValue::Double;
+		else if(!g_meta[type.m_id]) return FrameValue::Generic;
+		else if(is_struct(type)) return FrameValue::Struct;
+		else if(is_object(type)) return FrameValue::Object;
+		else return FrameValue::Generic;
+	}
+
+	CallFrame::CallFrame(const Callable& callable)
+		: m_callable(&callable)
+		, m_num_args(uint32_t(callable.m_params.size()))
+	{
+		m_direct = m_num_args <= c_max_args;
+		for(size_t i = 0; i < m_num_args && m_direct; ++i)
+		{
+			m_params[i] = frame_value(*callable.m_params[i].m_type);
+			m_direct &= m_params[i] != FrameValue::Generic;
+			m_args[i] = &m_scalars[i];
+		}
+
+		if(!callable.m_return_type.isvoid())
+		{
+			const Type& return_type = *callable.m_return_type.m_type;
+			m_return = frame_value(return_type);
+			m_return_ref = (callable.m_return_type.m_flags & (QualType::Pointer | QualType::Reference)) != 0;
+			m_return_type = &return_type;
+			m_direct &= m_return != FrameValue::Generic;
+
+			// objects are only ever returned by reference
+			m_direct &= m_return != FrameValue::Object || m_return_ref;
+
+			if(!meta(return_type).m_empty_var.none())
+				m_result = meta(return_type).m_empty_var;
+			else
+				m_result = Ref(return_type);
+		}
+	}
+
+	void* CallFrame::call(size_t num_args)
+	{
+		for(size_t i = num_args; i < m_num_args; ++i)
+			m_args[i] = m_callable->m_params[i].m_default;
+
+		// reference returns overwrite the result pointer, so that the storage of the frame is left untouched
+		void* result = m_result.m_ref.m_value;
+		(*m_callable)(span<void*>(m_args, m_num_args), result);
+		return result;
+	}
+
+	CallFrame& call_frame(const Callable& callable)
+	{
+		thread_local vector<unique<CallFrame>> frames;
+		if(callable.m_index >= frames.size())
+			frames.resize(callable.m_index + 1);
+
+		if(!frames[callable.m_index])
+			frames[callable.m_index] = construct<CallFrame>(callable);
+		return *frames[callable.m_index];
+	}
+}
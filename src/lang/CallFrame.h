@@ -0,0 +1,67 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#pragma once
+
+#ifndef TWO_MODULES
+#include <stdint.h>
+#include <type/Var.h>
+#endif
+#include <lang/Forward.h>
+
+namespace two
+{
+	// how a value crosses the boundary between a script and a reflected callable
+	export_ enum class FrameValue : unsigned char
+	{
+		None,		// no value : a callable returning void
+		Bool,
+		Int,
+		UInt,
+		Float,
+		Double,
+		Struct,		// copied to and from the memory owned by the script
+		Object,		// passed by reference to the memory owned by the script, or to the engine
+		Generic		// anything else goes through the dispatch of the binding
+	};
+
+	export_ TWO_LANG_EXPORT FrameValue frame_value(const Type& type);
+
+	// an argument frame for calling a reflected callable from a script, sized once per callable :
+	// scalar arguments are stored in the frame itself, struct and object arguments point to the script memory,
+	// and the return value is written to storage owned by the frame, so that a direct call doesn't allocate
+	export_ struct TWO_LANG_EXPORT CallFrame
+	{
+		static constexpr size_t c_max_args = 16;
+
+		CallFrame(const Callable& callable);
+
+		const Callable* m_callable;
+		uint32_t m_num_args = 0;
+
+		// all parameters and the return value are converted by the binding without going through its dispatch
+		bool m_direct = true;
+
+		FrameValue m_params[c_max_args] = {};
+		FrameValue m_return = FrameValue::None;
+		bool m_return_ref = false;
+		const Type* m_return_type = nullptr;
+
+		union Scalar { bool b; int i; uint32_t u; float f; double d; };
+		Scalar m_scalars[c_max_args] = {};
+		void* m_args[c_max_args] = {};
+
+		// built once from the meta of the return type, larger values than the inline storage of Any are boxed here only
+		Var m_result;
+
+		Scalar& scalar(size_t index) { m_args[index] = &m_scalars[index]; return m_scalars[index]; }
+		void object(size_t index, void* object) { m_args[index] = object; }
+
+		// missing arguments are taken from the parameter defaults, returns a pointer to the result
+		void* call(size_t num_args);
+	};
+
+	// frames are cached by callable index, and shared by all the bindings running on the same thread
+	export_ TWO_LANG_EXPORT CallFrame& call_frame(const Callable& callable);
+}
@@ -16,12 +16,15 @@ namespace two
     enum class Language : unsigned int;
     enum StreamModifier : unsigned int;
     enum ValveKind : unsigned int;
+    enum class FrameValue : unsigned char;
     
+    struct CallFrame;
     class Script;
     class TextScript;
 	struct ScriptError;
     class Interpreter;
     class ScriptClass;
+    class ScriptPool;
     class LuaInterpreter;
     struct StreamLocation;
     class StreamBranch;
@@ -30,6 +33,9 @@ namespace two
     class Pipe;
     class Process;
     class VisualScript;
+    struct VisualInstruction;
+    struct VisualParam;
+    class VisualPlan;
     class ProcessInput;
     class ProcessOutput;
     class ProcessValue;
@@ -34,6 +34,7 @@ module two.lang;
 #include <refl/Module.h>
 #include <refl/System.h>
 #include <lang/Types.h>
+#include <lang/CallFrame.h>
 #include <lang/Lua.h>
 #endif
 
@@ -188,7 +189,8 @@ namespace two
 
 	inline Call& lua_cached_call(const Callable& callable)
 	{
-		static vector<unique<Call>> lua_call_table;
+		// calls hold their argument storage, so each thread that runs a vm has its own
+		thread_local vector<unique<Call>> lua_call_table;
 		if(callable.m_index >= lua_call_table.size())
 			lua_call_table.resize(callable.m_index + 1);
 
@@ -498,8 +500,115 @@ namespace two
 		return Stack{ state, 0 };
 	}
 
+	// numbers with a fractional part are truncated rather than rejected
+	inline lua_Integer to_integer(lua_State* state, int index, int* success)
+	{
+		lua_Integer value = lua_tointegerx(state, index, success);
+		if(!*success)
+			value = lua_Integer(lua_tonumberx(state, index, success));
+		return value;
+	}
+
+	inline bool read_scalar(lua_State* state, int index, FrameValue value, CallFrame::Scalar& scalar)
+	{
+		int success = 1;
+		switch(value)
+		{
+		case FrameValue::Bool: scalar.b = lua_toboolean(state, index) != 0; break;
+		case FrameValue::Int: scalar.i = int(to_integer(state, index, &success)); break;
+		case FrameValue::UInt: scalar.u = uint32_t(to_integer(state, index, &success)); break;
+		case FrameValue::Float: scalar.f = float(lua_tonumberx(state, index, &success)); break;
+		case FrameValue::Double: scalar.d = double(lua_tonumberx(state, index, &success)); break;
+		default: return false;
+		}
+		return success != 0;
+	}
+
+	inline bool read_frame_object(lua_State* state, int index, const Param& param, void*& object)
+	{
+		object = nullptr;
+		if(lua_isnil(state, index))
+			return param.nullable();
+		if(!lua_isuserdata(state, index))
+			return false;
+		Ref ref = userdata(state, index);
+		Ref upcast = cls(ref).upcast(ref, *param.m_type);
+		if(!upcast.m_type->is(*param.m_type))
+			return false;
+		object = upcast.m_value;
+		return object != nullptr || param.nullable();
+	}
+
+	// reads the arguments straight into the frame : scalars are converted in place, structs and objects are passed by pointer to the userdata
+	inline bool read_frame(lua_State* state, CallFrame& frame, int first, size_t num_arguments, size_t skip = 0)
+	{
+		const Callable& callable = *frame.m_callable;
+		for(size_t i = skip; i < skip + num_arguments; ++i)
+		{
+			const int index = first + int(i - skip);
+			const FrameValue value = frame.m_params[i];
+
+			bool success = false;
+			if(value == FrameValue::Struct || value == FrameValue::Object)
+			{
+				void* object = nullptr;
+				success = read_frame_object(state, index, callable.m_params[i], object);
+				frame.object(i, object);
+			}
+			else
+				success = read_scalar(state, index, value, frame.scalar(i));
+
+			if(!success)
+			{
+				error("lua -> %s wrong argument %s, expect %s, got %s\n", callable.m_name, callable.m_params[i].m_name, callable.m_params[i].m_type->m_name, luaL_typename(state, index));
+				return false;
+			}
+		}
+		return true;
+	}
+
+	inline Stack push_frame_value(lua_State* state, FrameValue value, const Type& type, void* result)
+	{
+		if(value != FrameValue::None && result == nullptr)
+			return push_null(state);
+
+		switch(value)
+		{
+		case FrameValue::None: return Stack{ state, 0 };
+		case FrameValue::Bool: lua_pushboolean(state, *static_cast<bool*>(result)); break;
+		case FrameValue::Int: lua_pushinteger(state, *static_cast<int*>(result)); break;
+		case FrameValue::UInt: lua_pushinteger(state, *static_cast<uint32_t*>(result)); break;
+		case FrameValue::Float: lua_pushnumber(state, *static_cast<float*>(result)); break;
+		case FrameValue::Double: lua_pushnumber(state, *static_cast<double*>(result)); break;
+		case FrameValue::Struct: return push_object(state, Ref(result, type));
+		case FrameValue::Object: return push_ref(state, Ref(result, type));
+		case FrameValue::Generic: return push_value(state, Ref(result, type));
+		}
+		return Stack{ state, 1 };
+	}
+
+	inline Stack call_cpp(lua_State* state, CallFrame& frame, size_t num_arguments)
+	{
+		const int first = lua_gettop(state) - int(num_arguments) + 1;
+		const bool arguments = num_arguments >= frame.m_callable->m_num_required && num_arguments <= frame.m_num_args;
+		if(arguments && read_frame(state, frame, first, num_arguments))
+		{
+			void* result = frame.call(num_arguments);
+#if TWO_LUA_DEBUG
+			printf("Lua -> called %s\n", frame.m_callable->m_name);
+#endif
+			return push_frame_value(state, frame.m_return, frame.m_return_type ? *frame.m_return_type : type<void>(), result);
+		}
+		lua_printf("[ERROR] lua -> %s wrong arguments\n", frame.m_callable->m_name); // lua_printf
+		return Stack{ state, 0 };
+	}
+
 	inline Stack call_cpp(lua_State* state, Callable& callable, size_t num_arguments)
 	{
+		CallFrame& frame = call_frame(callable);
+		if(frame.m_direct)
+			return call_cpp(state, frame, num_arguments);
+
 		Call& call = lua_cached_call(callable);
 		return call_cpp(state, call, num_arguments);
 	}
@@ -510,6 +619,63 @@ namespace two
 		return call_cpp(state, callable, lua_gettop(state)).release();
 	}
 
+	inline void get_metafield(lua_State* state, int object, int key)
+	{
+		lua_getmetatable(state, object);
+		lua_pushvalue(state, key);
+		lua_gettable(state, -2);
+	}
+
+	// the reflected members of a type resolved by __index and __newindex, slotted by the address of the interned lua string of their name
+	// the address alone doesn't identify the name once its string is collected, so a hit also compares the name itself
+	// methods are not cached : the metatable already resolves them to a closure in a single lookup
+	struct LuaIndexCache
+	{
+		struct Entry
+		{
+			const char* m_key = nullptr;
+			const Member* m_member = nullptr;
+			FrameValue m_value = FrameValue::Generic;
+		};
+
+		static constexpr size_t c_size = 32;
+		Entry m_entries[c_size];
+
+		Entry& slot(const char* key) { return m_entries[(uintptr_t(key) >> 4) % c_size]; }
+	};
+
+	// only short strings are interned by lua (LUAI_MAXSHORTLEN), so that their address identifies the name
+	constexpr size_t c_lua_short_string = 40;
+
+	inline LuaIndexCache& index_cache(lua_State* state)
+	{
+		return *static_cast<LuaIndexCache*>(lua_touserdata(state, lua_upvalueindex(2)));
+	}
+
+	inline const char* index_key(lua_State* state, int key_index)
+	{
+		if(lua_type(state, key_index) != LUA_TSTRING)
+			return nullptr;
+		size_t length = 0;
+		const char* key = lua_tolstring(state, key_index, &length);
+		return length <= c_lua_short_string ? key : nullptr;
+	}
+
+	inline LuaIndexCache::Entry* cached_member(lua_State* state, const char* key)
+	{
+		LuaIndexCache::Entry& entry = index_cache(state).slot(key);
+		return entry.m_key == key && strcmp(entry.m_member->m_name, key) == 0 ? &entry : nullptr;
+	}
+
+	inline void cache_member(lua_State* state, const char* key, const Member& member)
+	{
+		// only members holding a scalar value are accessed directly, the others go through the dispatch
+		const FrameValue value = frame_value(*member.m_type);
+		if(member.is_pointer() || value == FrameValue::Struct || value == FrameValue::Object || value == FrameValue::Generic)
+			return;
+		index_cache(state).slot(key) = { key, &member, value };
+	}
+
 	inline int get_member(lua_State* state, int object_index)
 	{
 		const Member& member = val<Member>(userdata(state, -1));
@@ -534,7 +700,19 @@ namespace two
 		const Class& c = cls(type);
 		size_t num_args = lua_gettop(state) - 1;
 		const Constructor* constructor = c.constructor(num_args);
-		if(constructor)
+		CallFrame* frame = constructor ? &call_frame(*constructor) : nullptr;
+		if(frame && frame->m_direct)
+		{
+			// the object is constructed in place in a new userdata, once the arguments are read
+			if(read_frame(state, *frame, 2, num_args, 1))
+			{
+				frame->object(0, alloc_object(state, type).m_value);
+				frame->call(num_args + 1);
+			}
+			else
+				lua_pushnil(state);
+		}
+		else if(constructor)
 		{
 			Call& construct = lua_cached_call(*constructor);
 			if(read_params(state, *construct.m_callable, { construct.m_args, 1, num_args }, 1))
@@ -553,27 +731,46 @@ namespace two
 		return 1;
 	}
 
-	inline void get_metafield(lua_State* state, int object, int key)
-	{
-		lua_getmetatable(state, object);
-		lua_pushvalue(state, key);
-		lua_gettable(state, -2);
-	}
-
 	inline int index_function(lua_State* state)
 	{
+		const char* key = index_key(state, 2);
+		if(LuaIndexCache::Entry* entry = key ? cached_member(state, key) : nullptr)
+		{
+			Ref value = entry->m_member->cast_get(userdata(state, 1));
+			return push_frame_value(state, entry->m_value, *entry->m_member->m_type, value.m_value).release();
+		}
+
 		get_metafield(state, 1, 2);
 		if(lua_isuserdata(state, -1))
+		{
+			if(key && userdata(state, -1).m_type->is<Member>())
+				cache_member(state, key, val<Member>(userdata(state, -1)));
 			return get_member(state, 1);
+		}
 		// if function or nil, just return it
 		return 1;
 	};
 
 	inline int newindex_function(lua_State* state)
 	{
+		const char* key = index_key(state, 2);
+		if(LuaIndexCache::Entry* entry = key ? cached_member(state, key) : nullptr)
+		{
+			const Member& member = *entry->m_member;
+			CallFrame::Scalar scalar;
+			if(!read_scalar(state, 3, entry->m_value, scalar))
+				return luaL_error(state, "lua -> %s wrong value for member %s, expect %s, got %s", userdata(state, 1).m_type->m_name, member.m_name, member.m_type->m_name, luaL_typename(state, 3));
+			member.cast_set(userdata(state, 1), Ref(&scalar, *member.m_type));
+			return 0;
+		}
+
 		get_metafield(state, 1, 2);
 		if(lua_isuserdata(state, -1))
+		{
+			if(key && userdata(state, -1).m_type->is<Member>())
+				cache_member(state, key, val<Member>(userdata(state, -1)));
 			return set_member(state, 1, 3);
+		}
 		return 0;
 	};
 
@@ -616,6 +813,15 @@ namespace two
 		lua_settable(state, -3);
 	}
 
+	inline void set_cache_closure(lua_State* state, cstring name, lua_CFunction func, const Type& type, LuaIndexCache& cache)
+	{
+		lua_pushstring(state, name);
+		lua_pushlightuserdata(state, (void*)&type);
+		lua_pushlightuserdata(state, &cache);
+		lua_pushcclosure(state, func, 2);
+		lua_settable(state, -3);
+	}
+
 	inline void create_type_metatable(lua_State* state, const Type& type)
 	{
 		lua_pushlightuserdata(state, (void*)&type);
@@ -625,8 +831,12 @@ namespace two
 		set_type_closure(state, "__call", construct_function, type);
 		lua_setmetatable(state, -2);
 
-		set_type_closure(state, "__index", index_function, type);
-		set_type_closure(state, "__newindex", newindex_function, type);
+		// the cache lives in a userdata kept alive by the metatable, and is handed to the accessors as a light userdata
+		LuaIndexCache* cache = new (stl::placeholder(), lua_newuserdata(state, sizeof(LuaIndexCache))) LuaIndexCache();
+		lua_setfield(state, -2, "cpp_index_cache");
+
+		set_cache_closure(state, "__index", index_function, type, *cache);
+		set_cache_closure(state, "__newindex", newindex_function, type, *cache);
 		set_type_closure(state, "__tostring", tostring_function, type);
 		set_type_closure(state, "__eq", eq_function, type);
 		if(g_class[type.m_id] && !cls(type).m_destructor.empty())
@@ -649,7 +859,7 @@ namespace two
 	template <class T>
 	inline void read_integer(lua_State* state, int index, Ref result)
 	{
-		int success; lua_Integer value = lua_tointegerx(state, index, &success);
+		int success; lua_Integer value = to_integer(state, index, &success);
 		if(success)
 			val<T>(result) = static_cast<T>(value);
 	}
@@ -1002,4 +1212,11 @@ namespace two
 #endif
 	}
 
+	void LuaInterpreter::call_function(cstring name, span<Var> args, Var* result)
+	{
+		lua_State* state = m_context->m_state;
+		lua_getglobal(state, name);
+		call_lua(state, Stack{ state, 1 }, args, result);
+	}
+
 }
@@ -30,6 +30,7 @@ namespace two
 		virtual void setx(span<cstring> path, const Var& value) final;
 
 		virtual void call(const string& code, Var* result = nullptr) final;
+		virtual void call_function(cstring name, span<Var> args, Var* result = nullptr) final;
 
 		unique<LuaContext> m_context;
 	};
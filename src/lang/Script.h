@@ -80,6 +80,9 @@ namespace two
 		virtual void call(const string& code, Var* result = nullptr) = 0;
 		virtual void virtual_call(Method& method, Ref object, span<Var> args) { UNUSED(method); UNUSED(object); UNUSED(args); }
 
+		// calls a function declared globally by code previously run in this interpreter, without compiling anything
+		virtual void call_function(cstring name, span<Var> args, Var* result = nullptr) { UNUSED(name); UNUSED(args); UNUSED(result); }
+
 		//void call(const TextScript& script, span<Var> args, Var* result = nullptr);
 		void call(const TextScript& script, span<void*> args, void*& result);
 
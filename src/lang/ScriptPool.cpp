@@ -0,0 +1,44 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#ifdef TWO_MODULES
+module;
+#include <infra/Cpp20.h>
+module two.lang;
+#else
+#include <stl/vector.hpp>
+#include <lang/Types.h>
+#include <lang/ScriptPool.h>
+#include <lang/Lua.h>
+#include <lang/Wren.h>
+#endif
+
+namespace two
+{
+	inline unique<Interpreter> create_interpreter(Language language, bool import_symbols)
+	{
+		if(language == Language::Lua)
+			return construct<LuaInterpreter>(import_symbols);
+		else if(language == Language::Wren)
+			return construct<WrenInterpreter>(import_symbols);
+		return nullptr;
+	}
+
+	ScriptPool::ScriptPool(Language language, size_t count, bool import_symbols)
+		: m_language(language)
+	{
+		// interpreters are created on the calling thread : declaring the types only reads the system
+		for(size_t i = 0; i < count; ++i)
+			m_interpreters.push_back(create_interpreter(language, import_symbols));
+	}
+
+	ScriptPool::~ScriptPool()
+	{}
+
+	void ScriptPool::load(const string& code)
+	{
+		for(unique<Interpreter>& interpreter : m_interpreters)
+			interpreter->call(code);
+	}
+}
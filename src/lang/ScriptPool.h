@@ -0,0 +1,35 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#pragma once
+
+#ifndef TWO_MODULES
+#include <stl/string.h>
+#include <stl/vector.h>
+#include <stl/memory.h>
+#endif
+#include <lang/Forward.h>
+#include <lang/Script.h>
+
+namespace two
+{
+	// independent interpreters of the same language, one per worker thread, sharing the reflected types of the system :
+	// the system must not be modified (no module loaded or unloaded) while the interpreters of a pool are running
+	// when used from jobs, the pool is sized to the number of threads of the job system, and each thread runs the interpreter at its index
+	export_ class TWO_LANG_EXPORT ScriptPool
+	{
+	public:
+		ScriptPool(Language language, size_t count, bool import_symbols = true);
+		~ScriptPool();
+
+		Language m_language;
+		vector<unique<Interpreter>> m_interpreters;
+
+		size_t size() const { return m_interpreters.size(); }
+		Interpreter& interpreter(size_t index) { return *m_interpreters[index]; }
+
+		// runs the same code in all interpreters, typically to declare the functions later called by the jobs
+		void load(const string& code);
+	};
+}
@@ -29,6 +29,15 @@ namespace two
 		: ProcessValue(script, meta(type).m_empty_var)
 	{}
 
+	bool ProcessValue::compile(VisualPlan& plan)
+	{
+		// constants are read in place, from the stream of the value
+		if(!m_output.m_stream.m_branches.empty())
+			return false;
+		plan.point(m_output, *m_output.m_stream.m_type, m_output.m_stream.m_value.m_ref.m_value);
+		return true;
+	}
+
 	ProcessCreate::ProcessCreate(VisualScript& script, Type& type, const Constructor& constructor)
 		: Process(script, meta(type).m_name, two::type<ProcessCreate>())
 		, m_object_type(type)
@@ -113,6 +122,32 @@ namespace two
 			}
 	}
 
+	bool ProcessCallable::compile(VisualPlan& plan)
+	{
+		VisualInstruction& instruction = plan.instruction(VisualInstruction::CallVirtual);
+		instruction.m_callable = &m_callable;
+
+		for(const Param& param : m_callable.m_params)
+		{
+			Valve& valve = *m_params[param.m_index];
+			const uint32_t reg = param.output() ? plan.own(valve, valve.m_stream.m_default) : plan.read(valve);
+			if(reg == UINT32_MAX)
+				return false;
+			plan.operand(instruction, reg, !param.output() && !param.nullable());
+		}
+
+		if(m_result)
+		{
+			const QualType& result = m_callable.m_return_type;
+			instruction.m_reference = (result.m_flags & (QualType::Pointer | QualType::Reference)) != 0;
+			instruction.m_result = instruction.m_reference ? plan.point(*m_result, *result.m_type)
+														   : plan.own(*m_result, meta(*result.m_type).m_empty_var);
+			if(instruction.m_result == UINT32_MAX)
+				return false;
+		}
+		return true;
+	}
+
 	ProcessScript::ProcessScript(VisualScript& script, VisualScript& target)
 		: ProcessCallable(script, target)
 		, m_target(target)
@@ -123,6 +158,16 @@ namespace two
 		, m_function(function)
 	{}
 
+	bool ProcessFunction::compile(VisualPlan& plan)
+	{
+		if(!ProcessCallable::compile(plan))
+			return false;
+		VisualInstruction& instruction = plan.m_instructions.back();
+		instruction.m_op = VisualInstruction::CallFunction;
+		instruction.m_function = m_function.m_call;
+		return true;
+	}
+
 	ProcessMethod::ProcessMethod(VisualScript& script, Method& method)
 		: ProcessCallable(script, method)
 		, m_method(method)
@@ -137,6 +182,19 @@ namespace two
 		m_object.m_stream.write(branch, m_parameters[0]);
 	}
 
+	bool ProcessMethod::compile(VisualPlan& plan)
+	{
+		if(!ProcessCallable::compile(plan))
+			return false;
+		VisualInstruction& instruction = plan.m_instructions.back();
+		instruction.m_op = VisualInstruction::CallMethod;
+		instruction.m_method = m_method.m_call;
+		instruction.m_required |= 1U;
+		// the object passes through
+		plan.bind(m_object, plan.m_operands[instruction.m_first]);
+		return true;
+	}
+
 	ProcessGetMember::ProcessGetMember(VisualScript& script, Member& member)
 		: Process(script, member.m_name, type<ProcessGetMember>())
 		, m_member(member)
@@ -152,6 +210,20 @@ namespace two
 		value = m_member.get(object.m_ref);
 	}
 
+	bool ProcessGetMember::compile(VisualPlan& plan)
+	{
+		const uint32_t object = plan.read(m_input_object);
+		if(object == UINT32_MAX)
+			return false;
+
+		VisualInstruction& instruction = plan.instruction(VisualInstruction::GetMember);
+		instruction.m_member = &m_member;
+		plan.operand(instruction, object, true);
+		instruction.m_reference = true;
+		instruction.m_result = plan.point(m_output, *m_member.m_type);
+		return true;
+	}
+
 	ProcessSetMember::ProcessSetMember(VisualScript& script, Member& member)
 		: Process(script, member.m_name, type<ProcessSetMember>())
 		, m_member(member)
@@ -169,6 +241,21 @@ namespace two
 		m_output_object.m_stream.write(branch, object);
 	}
 
+	bool ProcessSetMember::compile(VisualPlan& plan)
+	{
+		const uint32_t object = plan.read(m_input_object);
+		const uint32_t value = plan.read(m_input_value);
+		if(object == UINT32_MAX || value == UINT32_MAX)
+			return false;
+
+		VisualInstruction& instruction = plan.instruction(VisualInstruction::SetMember);
+		instruction.m_member = &m_member;
+		plan.operand(instruction, object, true);
+		plan.operand(instruction, value, !m_member.is_pointer());
+		plan.bind(m_output_object, object);
+		return true;
+	}
+
 	ProcessDisplay::ProcessDisplay(VisualScript& script)
 		: Process(script, "Display", type<ProcessDisplay>())
 		, m_input_value(*this, "input", INPUT_VALVE)
@@ -180,4 +267,11 @@ namespace two
 		if(m_update_display)
 			m_update_display(*this);
 	}
+
+	bool ProcessDisplay::compile(VisualPlan& plan)
+	{
+		// displays only exist for the editor, a compiled call has nothing to show
+		UNUSED(plan);
+		return true;
+	}
 }
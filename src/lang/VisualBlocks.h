@@ -22,6 +22,8 @@ namespace two
 		constr_ ProcessValue(VisualScript& script, const Var& value);
 		ProcessValue(VisualScript& script, Type& type);
 
+		virtual bool compile(VisualPlan& plan) override;
+
 		Valve m_output;
 	};
 
@@ -51,6 +53,7 @@ namespace two
 		constr_ ProcessCallable(VisualScript& script, Callable& callable);
 
 		virtual void process(const StreamLocation& branch) override;
+		virtual bool compile(VisualPlan& plan) override;
 
 	protected:
 		vector<Var> m_parameters;
@@ -75,6 +78,8 @@ namespace two
 	public:
 		constr_ ProcessFunction(VisualScript& script, Function& function);
 
+		virtual bool compile(VisualPlan& plan) override;
+
 		Function& m_function;
 	};
 
@@ -84,6 +89,7 @@ namespace two
 		constr_ ProcessMethod(VisualScript& script, Method& method);
 
 		virtual void process(const StreamLocation& branch) override;
+		virtual bool compile(VisualPlan& plan) override;
 
 		Method& m_method;
 		Valve m_object;
@@ -95,6 +101,7 @@ namespace two
 		constr_ ProcessGetMember(VisualScript& script, Member& member);
 
 		virtual void process(const StreamLocation& branch);
+		virtual bool compile(VisualPlan& plan) override;
 
 		Member& m_member;
 		Valve m_input_object;
@@ -107,6 +114,7 @@ namespace two
 		constr_ ProcessSetMember(VisualScript& script, Member& member);
 
 		virtual void process(const StreamLocation& branch);
+		virtual bool compile(VisualPlan& plan) override;
 
 		Member& m_member;
 		Valve m_input_object;
@@ -120,6 +128,7 @@ namespace two
 		ProcessDisplay(VisualScript& script);
 
 		virtual void process(const StreamLocation& branch);
+		virtual bool compile(VisualPlan& plan) override;
 
 		Valve m_input_value;
 		using Handler = void(*)(ProcessDisplay&); Handler m_update_display;
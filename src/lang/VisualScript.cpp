@@ -14,6 +14,8 @@ module two.lang;
 #include <infra/Reverse.h>
 #include <infra/Sort.h>
 #include <refl/Convert.h>
+#include <refl/Meta.h>
+#include <refl/Member.h>
 #include <lang/Types.h>
 #include <lang/VisualScript.h>
 #endif
@@ -370,6 +372,173 @@ namespace two
 		return m_order;
 	}
 
+	void VisualPlan::clear()
+	{
+		m_valid = false;
+		m_instructions.clear();
+		m_operands.clear();
+		m_registers.clear();
+		m_types.clear();
+		m_owners.clear();
+		m_values.clear();
+		m_inputs.clear();
+		m_outputs.clear();
+		m_args.clear();
+		m_owned.clear();
+	}
+
+	uint32_t VisualPlan::read(Valve& input)
+	{
+		// pipes with a modifier reshape the branches of a stream, which a plan doesn't have
+		if(!input.m_stream.m_branches.empty())
+			return UINT32_MAX;
+
+		if(input.m_pipes.empty())
+			return this->point(input, *input.m_stream.m_type, input.m_stream.m_value.m_ref.m_value);
+
+		Pipe& pipe = *input.m_pipes[0];
+		const uint32_t reg = pipe.m_output.m_register;
+		if(pipe.m_modifier != SM_NONE || reg == UINT32_MAX)
+			return UINT32_MAX;
+
+		// values that would need a conversion are left to the interpreter
+		const Type& source = *m_types[reg];
+		const Type& expected = *input.m_stream.m_type;
+		if(!expected.is<Ref>() && !source.is<Ref>() && !source.is(expected))
+			return UINT32_MAX;
+
+		input.m_register = reg;
+		return reg;
+	}
+
+	uint32_t VisualPlan::own(Valve& output, const Var& value)
+	{
+		if(value.m_mode != VarMode::Val)
+			return UINT32_MAX;
+
+		const uint32_t reg = uint32_t(m_registers.size());
+		m_registers.push_back(nullptr);
+		m_types.push_back(&type(value));
+		m_owners.push_back(uint32_t(m_values.size()));
+		m_values.push_back(value);
+		output.m_register = reg;
+		return reg;
+	}
+
+	uint32_t VisualPlan::point(Valve& output, const Type& type, void* pointer)
+	{
+		const uint32_t reg = uint32_t(m_registers.size());
+		m_registers.push_back(pointer);
+		m_types.push_back(&type);
+		m_owners.push_back(UINT32_MAX);
+		output.m_register = reg;
+		return reg;
+	}
+
+	void VisualPlan::bind(Valve& output, uint32_t reg)
+	{
+		output.m_register = reg;
+	}
+
+	VisualInstruction& VisualPlan::instruction(VisualInstruction::Op op)
+	{
+		m_instructions.push_back({});
+		VisualInstruction& instruction = m_instructions.back();
+		instruction.m_op = op;
+		instruction.m_first = uint32_t(m_operands.size());
+		return instruction;
+	}
+
+	void VisualPlan::operand(VisualInstruction& instruction, uint32_t reg, bool required)
+	{
+		if(required && instruction.m_count < 32)
+			instruction.m_required |= 1U << instruction.m_count;
+		m_operands.push_back(reg);
+		instruction.m_count++;
+	}
+
+	void VisualPlan::finalize()
+	{
+		// the owned values don't move anymore, their registers can point to them
+		for(size_t i = 0; i < m_registers.size(); ++i)
+			if(m_owners[i] != UINT32_MAX)
+			{
+				m_registers[i] = m_values[m_owners[i]].m_ref.m_value;
+				m_owned.push_back(uint32_t(i));
+			}
+
+		uint32_t max_operands = 0;
+		for(const VisualInstruction& instruction : m_instructions)
+			max_operands = max(max_operands, instruction.m_count);
+		m_args.resize(max_operands);
+
+		m_valid = true;
+	}
+
+	void VisualPlan::execute(span<void*> args, void*& result)
+	{
+		void** registers = m_registers.data();
+		void** operands = m_args.data();
+
+		// the results of the calls that didn't happen last run were nulled : they point back to their value
+		for(uint32_t reg : m_owned)
+			registers[reg] = m_values[m_owners[reg]].m_ref.m_value;
+
+		for(const VisualParam& input : m_inputs)
+			registers[input.m_register] = args[input.m_param];
+
+		for(const VisualInstruction& instruction : m_instructions)
+		{
+			const uint32_t* first = m_operands.data() + instruction.m_first;
+
+			uint32_t missing = 0;
+			for(uint32_t i = 0; i < instruction.m_count; ++i)
+			{
+				operands[i] = registers[first[i]];
+				missing |= operands[i] == nullptr ? (1U << i) : 0U;
+			}
+
+			void* none = nullptr;
+			void*& output = instruction.m_result != UINT32_MAX ? registers[instruction.m_result] : none;
+
+			// as in the interpreter, a call that doesn't happen leaves no value downstream, rather than the value of a previous run
+			if((missing & instruction.m_required) != 0)
+			{
+				output = nullptr;
+				continue;
+			}
+
+			switch(instruction.m_op)
+			{
+			case VisualInstruction::CallFunction:
+				instruction.m_function({ operands, instruction.m_count }, output);
+				break;
+			case VisualInstruction::CallMethod:
+				instruction.m_method(operands[0], { operands + 1, instruction.m_count - 1 }, output);
+				break;
+			case VisualInstruction::CallVirtual:
+				(*instruction.m_callable)({ operands, instruction.m_count }, output);
+				break;
+			case VisualInstruction::GetMember:
+				output = instruction.m_member->get(Ref(operands[0], *instruction.m_member->m_object_type)).m_value;
+				break;
+			case VisualInstruction::SetMember:
+				instruction.m_member->set(Ref(operands[0], *instruction.m_member->m_object_type), Ref(operands[1], *instruction.m_member->m_type));
+				break;
+			}
+		}
+
+		for(const VisualParam& output : m_outputs)
+		{
+			void* value = registers[output.m_register];
+			void* dest = output.m_return ? result : args[output.m_param];
+			if(output.m_return && output.m_reference)
+				result = value;
+			else if(dest && value)
+				output.m_meta->m_copy_assign(dest, value);
+		}
+	}
+
 	VisualScript::VisualScript(const string& name, const Signature& signature)
 		: Script(type<VisualScript>(), name, signature)
 	{
@@ -385,6 +554,7 @@ namespace two
 
 	void VisualScript::remove(Process& process)
 	{
+		this->invalidate();
 		remove_pt(m_processes, process);
 
 		size_t index = 0;
@@ -395,11 +565,13 @@ namespace two
 	void VisualScript::lock()
 	{
 		m_locked = true;
+		this->invalidate();
 	}
 
 	void VisualScript::unlock(bool execute)
 	{
 		m_locked = false;
+		this->invalidate();
 		if(execute)
 		{
 			this->reorder();
@@ -424,8 +596,44 @@ namespace two
 		std::sort(m_execution.begin(), m_execution.end(), [](Process* lhs, Process* rhs) { return lhs->m_order < rhs->m_order; });
 	}
 
+	void VisualScript::invalidate()
+	{
+		m_plan.clear();
+		m_compiled = false;
+	}
+
+	bool VisualScript::compile()
+	{
+		m_plan.clear();
+		m_compiled = true;
+		if(!m_locked)
+			return false;
+
+		this->reorder();
+
+		for(Process* process : m_execution)
+		{
+			for(Valve* valve : process->m_inputs)
+				valve->m_register = UINT32_MAX;
+			for(Valve* valve : process->m_outputs)
+				valve->m_register = UINT32_MAX;
+		}
+
+		for(Process* process : m_execution)
+			if(!process->compile(m_plan))
+			{
+				warn("vislang - process %s can't be compiled, script %s will be interpreted", process->m_title.c_str(), m_name.c_str());
+				m_plan.clear();
+				return false;
+			}
+
+		m_plan.finalize();
+		return true;
+	}
+
 	void VisualScript::connect(Valve& output, Valve& input, StreamModifier modifier)
 	{
+		this->invalidate();
 		object<Pipe> pipe = input.try_connect(output, modifier);
 		if(pipe)
 			m_pipes.push_back(move(pipe));
@@ -435,6 +643,7 @@ namespace two
 
 	void VisualScript::disconnect(Pipe& pipe)
 	{
+		this->invalidate();
 		remove_pt(m_pipes, pipe);
 	}
 
@@ -463,10 +672,21 @@ namespace two
 	{
 		// @kludge: ugly cast until we decide something on this callable constness mess
 		VisualScript& self = const_cast<VisualScript&>(*this);
-		self.lock();
+		if(m_locked && !m_compiled)
+			self.compile();
+
+		if(m_plan.m_valid)
+		{
+			self.m_plan.execute(args, result);
+			return;
+		}
+
+		// a locked graph that can't be compiled is interpreted, and stays locked
+		const bool locked = m_locked;
+		self.m_locked = true;
 		for(size_t i = 0; i < m_inputs.size(); ++i)
 			m_inputs[i]->m_output.m_stream.write(Ref(args[i], *m_signature.m_params[i].m_type));
-		self.unlock(false);
+		self.m_locked = locked;
 
 		self.reorder();
 		self.execute(false);
@@ -481,6 +701,14 @@ namespace two
 		script.m_inputs.push_back(this);
 	}
 
+	bool ProcessInput::compile(VisualPlan& plan)
+	{
+		// the register is bound to the argument on each call
+		const uint32_t reg = plan.point(m_output, *Param::m_type);
+		plan.m_inputs.push_back({ reg, Param::m_index, &meta(*Param::m_type), false, Param::reference() });
+		return true;
+	}
+
 	ProcessOutput::ProcessOutput(VisualScript& script, const Param& param)
 		: Process(script, param.m_name, type<ProcessOutput>())
 		, Param(param)
@@ -488,4 +716,13 @@ namespace two
 	{
 		script.m_outputs.push_back(this);
 	}
+
+	bool ProcessOutput::compile(VisualPlan& plan)
+	{
+		const uint32_t reg = plan.read(m_input);
+		if(reg == UINT32_MAX)
+			return false;
+		plan.m_outputs.push_back({ reg, Param::m_index, &meta(*Param::m_type), !Param::output(), Param::reference() });
+		return true;
+	}
 }
@@ -8,6 +8,7 @@
 #include <stl/vector.h>
 #include <type/Unique.h>
 #include <type/Var.h>
+#include <refl/Method.h>
 #endif
 #include <lang/Forward.h>
 #include <lang/Stream.h>
@@ -41,6 +42,9 @@ namespace two
 
 		bool m_edit;
 
+		// register of the valve in the compiled plan of the script
+		uint32_t m_register = UINT32_MAX;
+
 		string error_info();
 		string param_info();
 
@@ -124,6 +128,9 @@ namespace two
 		virtual void clear() {}
 		virtual void process(const StreamLocation& branch) { UNUSED(branch); }
 
+		// emit the instructions of the process in the plan, returns false if the process can't be compiled
+		virtual bool compile(VisualPlan& plan) { UNUSED(plan); return false; }
+
 		Valve& find_master_input();
 
 		Process& flow(Valve& valve);
@@ -136,6 +143,80 @@ namespace two
 		int visit_order();
 	};
 
+	// one call of a compiled plan, with its operands and result in fixed registers
+	export_ struct VisualInstruction
+	{
+		enum Op : uint8_t
+		{
+			CallFunction,
+			CallMethod,
+			CallVirtual,
+			GetMember,
+			SetMember
+		};
+
+		Op m_op;
+		FunctionFunc m_function = nullptr;
+		MethodFunc m_method = nullptr;
+		const Callable* m_callable = nullptr;
+		const Member* m_member = nullptr;
+
+		uint32_t m_first = 0;
+		uint32_t m_count = 0;
+		uint32_t m_result = UINT32_MAX;
+		// operands that must not be null for the call to happen
+		uint32_t m_required = 0;
+		// the result register points to an object returned by the call
+		bool m_reference = false;
+	};
+
+	export_ struct VisualParam
+	{
+		uint32_t m_register;
+		size_t m_param;
+		Meta* m_meta;
+		bool m_return;
+		bool m_reference;
+	};
+
+	// a locked graph flattened to a list of instructions in topological order
+	// each register is a pointer to a value : either a value owned by the plan, or a value owned elsewhere
+	// like an argument of the call, a constant in the graph, or an object returned by reference
+	export_ class TWO_LANG_EXPORT VisualPlan
+	{
+	public:
+		void clear();
+
+		uint32_t read(Valve& input);
+		uint32_t own(Valve& output, const Var& value);
+		uint32_t point(Valve& output, const Type& type, void* pointer = nullptr);
+		void bind(Valve& output, uint32_t reg);
+
+		VisualInstruction& instruction(VisualInstruction::Op op);
+		void operand(VisualInstruction& instruction, uint32_t reg, bool required);
+
+		void finalize();
+
+		void execute(span<void*> args, void*& result);
+
+		bool m_valid = false;
+
+		vector<VisualInstruction> m_instructions;
+		vector<uint32_t> m_operands;
+
+		vector<void*> m_registers;
+		vector<const Type*> m_types;
+		vector<uint32_t> m_owners;
+		vector<Var> m_values;
+
+		vector<VisualParam> m_inputs;
+		vector<VisualParam> m_outputs;
+
+	private:
+		vector<void*> m_args;
+		vector<uint32_t> m_owned;
+	};
+
 	export_ class refl_ TWO_LANG_EXPORT VisualScript final : public Script
 	{
 	public:
@@ -152,6 +233,10 @@ namespace two
 		vector<ProcessInput*> m_inputs;
 		vector<ProcessOutput*> m_outputs;
 
+		VisualPlan m_plan;
+		// a compile was tried since the graph was last locked or edited
+		bool m_compiled = false;
+
 		using Callable::operator();
 		virtual void operator()(span<void*> args, void*& result) const;
 
@@ -160,6 +245,13 @@ namespace two
 
 		void reorder();
 
+		// flatten the locked graph to a plan that calls run through, until the graph is unlocked or edited
+		// fails if a process has no compiled form, or if the graph carries streams of more than one branch
+		// a locked graph is compiled on its first call
+		bool compile();
+		// drops the plan when the graph is edited
+		void invalidate();
+
 		void execute(bool uncomputed = true);
 
 		void connect(Valve& output, Valve& input, StreamModifier modifier = SM_NONE);
@@ -172,6 +264,7 @@ namespace two
 		template <class T, class... Types>
 		T& node(Types&&... args)
 		{
+			this->invalidate();
 			m_processes.push_back(oconstruct<T>(*this, static_cast<Types&&>(args)...)); return as<T>(*m_processes.back());
 		}
 
@@ -202,6 +295,8 @@ namespace two
 	public:
 		ProcessInput(VisualScript& script, const Param& param);
 
+		virtual bool compile(VisualPlan& plan) override;
+
 		Valve m_output;
 	};
 
@@ -210,6 +305,8 @@ namespace two
 	public:
 		ProcessOutput(VisualScript& script, const Param& param);
 
+		virtual bool compile(VisualPlan& plan) override;
+
 		Valve m_input;
 	};
 }
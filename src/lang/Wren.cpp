@@ -38,6 +38,7 @@ module two.lang;
 #include <refl/VirtualMethod.h>
 #include <refl/System.h>
 #include <lang/Types.h>
+#include <lang/CallFrame.h>
 #include <lang/Wren.h>
 #endif
 
@@ -109,7 +110,8 @@ namespace two
 
 	inline Call& cached_call(const Callable& callable)
 	{
-		static vector<unique<Call>> call_table;
+		// calls hold their argument storage, so each thread that runs a vm has its own
+		thread_local vector<unique<Call>> call_table;
 		if(callable.m_index >= call_table.size())
 			call_table.resize(callable.m_index + 1);
 
@@ -118,13 +120,20 @@ namespace two
 		return *call_table[callable.m_index];
 	}
 
-	vector<WrenHandle*> g_wren_types = vector<WrenHandle*>(c_max_types);
-	vector<WrenHandle*> g_wren_classes = vector<WrenHandle*>(c_max_types);
-	vector<WrenHandle*> g_wren_methods = vector<WrenHandle*>(c_max_types * 8);
-	vector<WrenHandle*> g_construct_handles;
+	// handles are owned by the vm they were made from : each interpreter keeps its own, so that several vms can run side by side
+	struct WrenHandles
+	{
+		vector<WrenHandle*> m_types = vector<WrenHandle*>(c_max_types);
+		vector<WrenHandle*> m_classes = vector<WrenHandle*>(c_max_types);
+		vector<WrenHandle*> m_methods = vector<WrenHandle*>(c_max_types * 8);
+		vector<WrenHandle*> m_constructs;
+		vector<WrenHandle*> m_calls;
+
+		//map<void*, WrenHandle*> m_objects;
+		unordered_map<void*, WrenHandle*> m_objects;
+	};
 
-	//map<void*, WrenHandle*> g_wren_objects;
-	unordered_map<void*, WrenHandle*> g_wren_objects;
+	inline WrenHandles& wren_handles(WrenVM* vm);
 
 	string signature(cstring name, size_t num_args)
 	{
@@ -200,11 +209,11 @@ namespace two
 	{
 		int class_slot = wrenGetSlotCount(vm);
 		wrenEnsureSlots(vm, class_slot + 1);
-		wrenSetSlotHandle(vm, class_slot, g_wren_classes[type.m_id]);
+		wrenSetSlotHandle(vm, class_slot, wren_handles(vm).m_classes[type.m_id]);
 		Ref object = alloc_object(vm, slot, class_slot, type);
 #ifdef TWO_WREN_CACHE_HANDLES
-		assert(g_wren_objects[object.m_value] == nullptr);
-		g_wren_objects[object.m_value] = wrenGetSlotHandle(vm, slot);
+		assert(wren_handles(vm).m_objects[object.m_value] == nullptr);
+		wren_handles(vm).m_objects[object.m_value] = wrenGetSlotHandle(vm, slot);
 #endif
 		return object;
 	}
@@ -213,11 +222,11 @@ namespace two
 	{
 		int class_slot = wrenGetSlotCount(vm);
 		wrenEnsureSlots(vm, class_slot + 1);
-		wrenSetSlotHandle(vm, class_slot, g_wren_classes[type(ref).m_id]);
+		wrenSetSlotHandle(vm, class_slot, wren_handles(vm).m_classes[type(ref).m_id]);
 		Ref object = alloc_ref(vm, slot, class_slot, ref);
 #ifdef TWO_WREN_CACHE_HANDLES
-		assert(g_wren_objects[object.m_value] == nullptr);
-		g_wren_objects[object.m_value] = wrenGetSlotHandle(vm, slot);
+		assert(wren_handles(vm).m_objects[object.m_value] == nullptr);
+		wren_handles(vm).m_objects[object.m_value] = wrenGetSlotHandle(vm, slot);
 #endif
 		return object;
 	}
@@ -226,7 +235,7 @@ namespace two
 	{
 		if(!object) push_null(vm, slot);
 #ifdef TWO_WREN_CACHE_HANDLES
-		WrenHandle*& handle = g_wren_objects[object.m_value];
+		WrenHandle*& handle = wren_handles(vm).m_objects[object.m_value];
 		if(!handle)
 			alloc_ref(vm, slot, object);
 		wrenSetSlotHandle(vm, slot, handle);
@@ -321,14 +330,136 @@ namespace two
 			error("wren -> %s wrong arguments\n", call.m_callable->m_name);
 	}
 
+	inline bool read_scalar(WrenVM* vm, int slot, FrameValue value, CallFrame::Scalar& scalar)
+	{
+		const WrenType slot_type = wrenGetSlotType(vm, slot);
+		if(value == FrameValue::Bool)
+		{
+			scalar.b = slot_type == WREN_TYPE_BOOL && wrenGetSlotBool(vm, slot);
+			return slot_type == WREN_TYPE_BOOL;
+		}
+		else if(slot_type != WREN_TYPE_NUM)
+			return false;
+
+		const double number = wrenGetSlotDouble(vm, slot);
+		switch(value)
+		{
+		case FrameValue::Int: scalar.i = int(number); break;
+		case FrameValue::UInt: scalar.u = uint32_t(number); break;
+		case FrameValue::Float: scalar.f = float(number); break;
+		case FrameValue::Double: scalar.d = number; break;
+		default: return false;
+		}
+		return true;
+	}
+
+	inline bool read_frame_object(WrenVM* vm, int slot, const Param& param, void*& object)
+	{
+		object = nullptr;
+		const WrenType slot_type = wrenGetSlotType(vm, slot);
+		if(slot_type == WREN_TYPE_NULL)
+			return param.nullable();
+		if(slot_type != WREN_TYPE_FOREIGN)
+			return false;
+		Ref ref = wren_ref(vm, slot);
+		Ref upcast = cls(ref).upcast(ref, *param.m_type);
+		if(!upcast.m_type->is(*param.m_type))
+			return false;
+		object = upcast.m_value;
+		return object != nullptr || param.nullable();
+	}
+
+	// reads the arguments straight into the frame : scalars are converted in place, structs and objects are passed by pointer to the foreign storage
+	inline bool read_frame(WrenVM* vm, CallFrame& frame, size_t offset, size_t first_slot, size_t num_args)
+	{
+		const Callable& callable = *frame.m_callable;
+		for(size_t i = offset; i < offset + num_args; ++i)
+		{
+			const int slot = int(first_slot - offset + i);
+			const FrameValue value = frame.m_params[i];
+
+			bool success = false;
+			if(value == FrameValue::Struct || value == FrameValue::Object)
+			{
+				void* object = nullptr;
+				success = read_frame_object(vm, slot, callable.m_params[i], object);
+				frame.object(i, object);
+			}
+			else
+				success = read_scalar(vm, slot, value, frame.scalar(i));
+
+			if(!success)
+			{
+#ifdef TWO_WREN_DEBUG
+				error("wren -> wrong argument %s, expect type %s\n", callable.m_params[i].m_name, callable.m_params[i].m_type->m_name);
+#endif
+				return false;
+			}
+		}
+		return true;
+	}
+
+	inline void push_frame_value(WrenVM* vm, int slot, const CallFrame& frame, void* result)
+	{
+		if(result == nullptr)
+			return push_null(vm, slot);
+
+		switch(frame.m_return)
+		{
+		case FrameValue::None: break;
+		case FrameValue::Bool: wrenSetSlotBool(vm, slot, *static_cast<bool*>(result)); break;
+		case FrameValue::Int: wrenSetSlotDouble(vm, slot, double(*static_cast<int*>(result))); break;
+		case FrameValue::UInt: wrenSetSlotDouble(vm, slot, double(*static_cast<uint32_t*>(result))); break;
+		case FrameValue::Float: wrenSetSlotDouble(vm, slot, double(*static_cast<float*>(result))); break;
+		case FrameValue::Double: wrenSetSlotDouble(vm, slot, *static_cast<double*>(result)); break;
+		case FrameValue::Struct:
+		case FrameValue::Object:
+			if(frame.m_return_ref)
+				push_ref(vm, slot, Ref(result, *frame.m_return_type));
+			else
+			{
+				// values are copied to a foreign owned by wren, without registering a handle : nothing refers to them by address
+				int class_slot = wrenGetSlotCount(vm);
+				wrenEnsureSlots(vm, class_slot + 1);
+				wrenSetSlotHandle(vm, class_slot, wren_handles(vm).m_classes[frame.m_return_type->m_id]);
+				Ref object = alloc_object(vm, slot, class_slot, *frame.m_return_type);
+				copy_construct(object, Ref(result, *frame.m_return_type));
+			}
+			break;
+		case FrameValue::Generic: push_value(vm, slot, Ref(result, *frame.m_return_type)); break;
+		}
+	}
+
+	inline void call_cpp(WrenVM* vm, CallFrame& frame, size_t first, size_t num_arguments)
+	{
+		const bool arguments = num_arguments >= frame.m_callable->m_num_required && num_arguments <= frame.m_num_args;
+		if(arguments && read_frame(vm, frame, 0, first, num_arguments))
+		{
+			void* result = frame.call(num_arguments);
+			if(frame.m_return != FrameValue::None)
+				push_frame_value(vm, 0, frame, result);
+		}
+		else
+			error("wren -> %s wrong arguments\n", frame.m_callable->m_name);
+	}
+
+	inline void call_cpp(WrenVM* vm, const Callable& callable, size_t first, size_t num_arguments)
+	{
+		CallFrame& frame = call_frame(callable);
+		if(frame.m_direct)
+			return call_cpp(vm, frame, first, num_arguments);
+
+		Call& call = cached_call(callable);
+		call_cpp(vm, call, first, num_arguments);
+	}
+
 	inline void call_function(WrenVM* vm, size_t num_args)
 	{
 		const Callable& callable = val<Callable>(wren_ref(vm, 0));
 #ifdef TWO_WREN_DEBUG
 		info("wren -> call function %s\n", callable.m_name);
 #endif
-		Call& call = cached_call(callable);
-		call_cpp(vm, call, 1, num_args);
+		call_cpp(vm, callable, 1, num_args);
 	}
 
 	template <size_t num_args>
@@ -343,8 +474,7 @@ namespace two
 #ifdef TWO_WREN_DEBUG
 		info("wren -> call method %s\n", callable.m_name);
 #endif
-		Call& call = cached_call(callable);
-		call_cpp(vm, call, 1, num_args + 1);
+		call_cpp(vm, callable, 1, num_args + 1);
 	}
 
 	template <size_t num_args>
@@ -369,8 +499,8 @@ namespace two
 #ifdef TWO_WREN_DEBUG
 		info("wren -> call wren %s\n", method.m_name);
 #endif
-		WrenHandle* hmethod = g_wren_methods[method.m_index];
-		WrenHandle* hobject = g_wren_objects[object.m_value];
+		WrenHandle* hmethod = wren_handles(vm).m_methods[method.m_index];
+		WrenHandle* hobject = wren_handles(vm).m_objects[object.m_value];
 		call_wren(vm, hmethod, hobject, parameters);
 	}
 
@@ -419,6 +549,15 @@ namespace two
 		assign(member.m_value, result);
 	}
 
+	// a call with wrong arguments aborts the fiber, otherwise the script goes on with whatever was left in the return slot
+	inline void abort_call(WrenVM* vm, const Callable& callable)
+	{
+		string message = "wren -> " + string(callable.m_name) + " wrong arguments";
+		error("%s\n", message.c_str());
+		wrenSetSlotString(vm, 0, message.c_str());
+		wrenAbortFiber(vm, 0);
+	}
+
 	inline void construct(WrenVM* vm)
 	{
 		const Constructor* constructor = &val<Constructor>(read_ref(vm, 0));
@@ -426,12 +565,28 @@ namespace two
 #ifdef TWO_WREN_DEBUG
 		info("wren -> construct %s\n", constructor->m_name);
 #endif
+		CallFrame& frame = call_frame(*constructor);
+		if(frame.m_direct)
+		{
+			const size_t num_args = wrenGetSlotCount(vm) - 2;
+			if(read_frame(vm, frame, 1, 2, num_args))
+			{
+				frame.object(0, alloc_object(vm, 0, 1, *constructor->m_object_type).m_value);
+				frame.call(num_args + 1);
+			}
+			else
+				abort_call(vm, *constructor);
+			return;
+		}
+
 		Call& construct = cached_call(*constructor);
 		if(read_params(vm, *construct.m_callable, construct.m_args, 1, 2))
 		{
 			Ref object = alloc_object(vm, 0, 1, *constructor->m_object_type);
 			construct(object);
 		}
+		else
+			abort_call(vm, *constructor);
 	}
 
 	inline void copy_construct(WrenVM* vm)
@@ -462,8 +617,8 @@ namespace two
 		{
 			Ref object = alloc_object(vm, 0, 1, *constructor->m_object_type);
 			construct(object);
-			assert(g_wren_objects[object.m_value] == nullptr);
-			g_wren_objects[object.m_value] = wrenGetSlotHandle(vm, 0);
+			assert(wren_handles(vm).m_objects[object.m_value] == nullptr);
+			wren_handles(vm).m_objects[object.m_value] = wrenGetSlotHandle(vm, 0);
 			wren->create_virtual(object);
 		}
 	}
@@ -633,8 +788,8 @@ namespace two
 		wrenBegin(vm);
 		wrenEnsureSlots(vm, 1);
 		wrenGetVariable(vm, module.c_str(), name.c_str(), 0);
-		assert(g_wren_classes[type.m_id] == nullptr);
-		g_wren_classes[type.m_id] = wrenGetSlotHandle(vm, 0);
+		assert(wren_handles(vm).m_classes[type.m_id] == nullptr);
+		wren_handles(vm).m_classes[type.m_id] = wrenGetSlotHandle(vm, 0);
 	}
 
 	Function* find_function(cstring nemespace, cstring name, size_t num_args)
@@ -668,12 +823,12 @@ namespace two
 			{
 				const char* name = wrenGetSlotString(vm, 1);
 				Type* type = system().find_type(name);
-				if(g_wren_types[type->m_id] != nullptr)
+				if(wren_handles(vm).m_types[type->m_id] != nullptr)
 					warn("type %s already fetched", name);
 				else
 				{
 					alloc_ref(vm, 0, 0, Ref(type));
-					g_wren_types[type->m_id] = wrenGetSlotHandle(vm, 0);
+					wren_handles(vm).m_types[type->m_id] = wrenGetSlotHandle(vm, 0);
 				}
 			};
 		}
@@ -754,7 +909,7 @@ namespace two
 				for(Method& method : cls(*type).m_methods)
 				{
 					string sig = signature(method.m_name, method.m_params.size() - 1);
-					g_wren_methods[method.m_index] = wrenMakeCallHandle(vm, sig.c_str());
+					wren_handles(vm).m_methods[method.m_index] = wrenMakeCallHandle(vm, sig.c_str());
 				}
 			};
 		}
@@ -801,8 +956,8 @@ namespace two
 				const char* name = wrenGetSlotString(vm, 1);
 				Ref t = alloc_object(vm, 0, 0, type<Type>());
 				Type* type = new (stl::placeholder(), t.m_value) Type(name);
-				assert(g_wren_types[type->m_id] == nullptr);
-				g_wren_types[type->m_id] = wrenGetSlotHandle(vm, 0);
+				assert(wren_handles(vm).m_types[type->m_id] == nullptr);
+				wren_handles(vm).m_types[type->m_id] = wrenGetSlotHandle(vm, 0);
 			};
 		}
 
@@ -1038,16 +1193,17 @@ namespace two
 					}
 			};
 
-			release(g_wren_types);
-			release(g_wren_classes);
-			release(g_wren_methods);
-			release(g_construct_handles);
+			release(m_handles.m_types);
+			release(m_handles.m_classes);
+			release(m_handles.m_methods);
+			release(m_handles.m_constructs);
+			release(m_handles.m_calls);
 
-			for(auto& object_handle : g_wren_objects)
+			for(auto& object_handle : m_handles.m_objects)
 				wrenReleaseHandle(m_vm, object_handle.second);
 
-			g_construct_handles.clear();
-			g_wren_objects.clear();
+			m_handles.m_constructs.clear();
+			m_handles.m_objects.clear();
 
 			assert(m_vm);
 			wrenFreeVM(m_vm);
@@ -1062,7 +1218,7 @@ namespace two
 					signature += "_" + (i == num_args - 1 ? string("") : string(","));
 				signature += ")";
 
-				g_construct_handles.push_back(wrenMakeCallHandle(m_vm, signature.c_str()));
+				m_handles.m_constructs.push_back(wrenMakeCallHandle(m_vm, signature.c_str()));
 			}
 
 			string primitives =
@@ -1148,8 +1304,18 @@ namespace two
 			wrenBegin(m_vm);
 			wrenEnsureSlots(m_vm, 1);
 			wrenGetVariable(m_vm, "main", "Type", 0);
-			assert(g_wren_classes[type<Type>().m_id] == nullptr);
-			g_wren_classes[type<Type>().m_id] = wrenGetSlotHandle(m_vm, 0);
+			assert(m_handles.m_classes[type<Type>().m_id] == nullptr);
+			m_handles.m_classes[type<Type>().m_id] = wrenGetSlotHandle(m_vm, 0);
+		}
+
+		// a function stored in a variable is called through the call(...) method of the wren function object
+		WrenHandle* call_handle(size_t num_args)
+		{
+			if(num_args >= m_handles.m_calls.size())
+				m_handles.m_calls.resize(num_args + 1);
+			if(!m_handles.m_calls[num_args])
+				m_handles.m_calls[num_args] = wrenMakeCallHandle(m_vm, signature("call", num_args).c_str());
+			return m_handles.m_calls[num_args];
 		}
 
 		span<cstring> namespace_path(Namespace& location)
@@ -1259,8 +1425,12 @@ namespace two
 
 		set<string> m_variables;
 
+		WrenHandles m_handles;
+
 		WrenVM* m_vm;
 	};
+
+	inline WrenHandles& wren_handles(WrenVM* vm) { return wren(vm)->m_context->m_handles; }
 }
 
 namespace two
@@ -1348,6 +1518,19 @@ namespace two
 		wrenInterpret(m_context->m_vm, "main", code.c_str());
 	}
 
+	void WrenInterpreter::call_function(cstring name, span<Var> args, Var* result)
+	{
+		WrenVM* vm = m_context->m_vm;
+		WrenHandle* call = m_context->call_handle(args.size());
+		wrenBegin(vm);
+		wrenEnsureSlots(vm, int(args.size() + 1));
+		wrenGetVariable(vm, "main", name, 0);
+		for(size_t i = 0; i < args.size(); ++i)
+			push_value(vm, int(i + 1), args[i]);
+		wrenCall(vm, call);
+		if(result) read_value(vm, 0, *result);
+	}
+
 	void WrenInterpreter::virtual_call(Method& method, Ref object, span<Var> args)
 	{
 		m_script = m_virtual_scripts[object.m_value];
@@ -37,6 +37,7 @@ namespace two
 		virtual void setx(span<cstring> path, const Var& value) final;
 
 		virtual void call(const string& code, Var* result = nullptr) final;
+		virtual void call_function(cstring name, span<Var> args, Var* result = nullptr) final;
 		virtual void virtual_call(Method& method, Ref object, span<Var> args) final;
 
 		unique<WrenContext> m_context;
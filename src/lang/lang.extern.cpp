@@ -22,10 +22,16 @@ namespace stl
 	template class TWO_LANG_EXPORT vector<TextScript*>;
 	template class TWO_LANG_EXPORT vector<StreamBranch>;
 	template class TWO_LANG_EXPORT vector<StreamModifier>;
+	template class TWO_LANG_EXPORT vector<VisualInstruction>;
+	template class TWO_LANG_EXPORT vector<VisualParam>;
+	template class TWO_LANG_EXPORT vector<const Type*>;
+	template class TWO_LANG_EXPORT vector<uint32_t>;
 	template class TWO_LANG_EXPORT vector<unique<Valve>>;
 	template class TWO_LANG_EXPORT vector<unique<Pipe>>;
 	template class TWO_LANG_EXPORT vector<unique<Process>>;
 	template class TWO_LANG_EXPORT vector<unique<Call>>;
+	template class TWO_LANG_EXPORT vector<unique<CallFrame>>;
+	template class TWO_LANG_EXPORT vector<unique<Interpreter>>;
 	template class TWO_LANG_EXPORT unordered_map<int, ScriptError>;
 	template class TWO_LANG_EXPORT unordered_map<void*, const TextScript*>;
 	template class TWO_LANG_EXPORT unordered_map<string, WrenFunctionDecl>;
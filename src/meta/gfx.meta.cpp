@@ -1589,6 +1589,9 @@ namespace two
 		static uint32_t nudraw_calls_default = 0;
 		static uint32_t nuvertices_default = 0;
 		static uint32_t nutriangles_default = 0;
+		static uint32_t nushadow_casters_default = 0;
+		static uint32_t nushadow_maps_default = 0;
+		static uint32_t nushadow_cached_default = 0;
 		// constructors
 		static Constructor constructors[] = {
 			{ t, two_RenderFrame__construct_0, {} }
@@ -1605,7 +1608,10 @@ namespace two
 			{ t, offsetof(two::RenderFrame, m_render_pass), type<uint8_t>(), "render_pass", nullptr, Member::Value, nullptr },
 			{ t, offsetof(two::RenderFrame, m_num_draw_calls), type<uint32_t>(), "nudraw_calls", &nudraw_calls_default, Member::Value, nullptr },
 			{ t, offsetof(two::RenderFrame, m_num_vertices), type<uint32_t>(), "nuvertices", &nuvertices_default, Member::Value, nullptr },
-			{ t, offsetof(two::RenderFrame, m_num_triangles), type<uint32_t>(), "nutriangles", &nutriangles_default, Member::Value, nullptr }
+			{ t, offsetof(two::RenderFrame, m_num_triangles), type<uint32_t>(), "nutriangles", &nutriangles_default, Member::Value, nullptr },
+			{ t, offsetof(two::RenderFrame, m_num_shadow_casters), type<uint32_t>(), "nushadow_casters", &nushadow_casters_default, Member::Value, nullptr },
+			{ t, offsetof(two::RenderFrame, m_num_shadow_maps), type<uint32_t>(), "nushadow_maps", &nushadow_maps_default, Member::Value, nullptr },
+			{ t, offsetof(two::RenderFrame, m_num_shadow_cached), type<uint32_t>(), "nushadow_cached", &nushadow_cached_default, Member::Value, nullptr }
 		};
 		// methods
 		// static members
@@ -3046,6 +3052,7 @@ namespace two
 		static float shadow_split_distribution_default = 0.6f;
 		static float shadow_normal_bias_default = 0.1f;
 		static float shadow_bias_default = 0.f;
+		static uint32_t shadow_casters_default = 0;
 		static two::LightType construct_0_type_default = two::LightType::Point;
 		static bool construct_0_shadows_default = false;
 		static two::Colour construct_0_colour_default = two::Colour::White;
@@ -3077,7 +3084,8 @@ namespace two
 			{ t, offsetof(two::Light, m_shadow_num_splits), type<uint8_t>(), "shadow_nusplits", &shadow_nusplits_default, Member::Value, nullptr },
 			{ t, offsetof(two::Light, m_shadow_split_distribution), type<float>(), "shadow_split_distribution", &shadow_split_distribution_default, Member::Value, nullptr },
 			{ t, offsetof(two::Light, m_shadow_normal_bias), type<float>(), "shadow_normal_bias", &shadow_normal_bias_default, Member::Value, nullptr },
-			{ t, offsetof(two::Light, m_shadow_bias), type<float>(), "shadow_bias", &shadow_bias_default, Member::Value, nullptr }
+			{ t, offsetof(two::Light, m_shadow_bias), type<float>(), "shadow_bias", &shadow_bias_default, Member::Value, nullptr },
+			{ t, offsetof(two::Light, m_shadow_casters), type<uint32_t>(), "shadow_casters", &shadow_casters_default, Member::Value, nullptr }
 		};
 		// methods
 		// static members
@@ -4,23 +4,50 @@
 
 #include <infra/Cpp20.h>
 #include <climits>
+#include <random>
 
 #ifdef TWO_MODULES
 module two.noise;
 #else
+#include <stl/math.h>
 #include <math/Random.h>
+#include <jobs/JobLoop.hpp>
 #include <noise/Noise.h>
 #endif
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define TWO_NOISE_SSE 1
+#define TWO_NOISE_NEON 0
+#include <emmintrin.h>
+#elif defined __ARM_NEON || defined __ARM_NEON__
+#define TWO_NOISE_SSE 0
+#define TWO_NOISE_NEON 1
+#include <arm_neon.h>
+#else
+#define TWO_NOISE_SSE 0
+#define TWO_NOISE_NEON 0
+#endif
+
+#define TWO_NOISE_SIMD (TWO_NOISE_SSE || TWO_NOISE_NEON)
+
 namespace two
 {
 	Noise::Noise(int seed)
 		: FastNoise(seed)
 	{}
-	
+
+	Noise::Noise(int seed, NoiseType noise_type, float frequency, Interp interp)
+		: FastNoise(seed)
+	{
+		this->SetNoiseType(noise_type);
+		this->SetFrequency(frequency);
+		this->SetInterp(interp);
+	}
+
+	// the scalar helpers keep one generator per thread, so that concurrent callers don't race on its settings
 	float noise_2d(float x, float y, Noise::NoiseType noise_type, float frequency, Noise::Interp interp)
 	{
-		static Noise n = { randi(INT_MIN, INT_MAX) };
+		thread_local Noise n = { randi(INT_MIN, INT_MAX) };
 		n.SetNoiseType(noise_type);
 		n.SetFrequency(frequency);
 		n.SetInterp(interp);
@@ -29,7 +56,7 @@ namespace two
 
 	float noise_3d(float x, float y, float z, Noise::NoiseType noise_type, float frequency, Noise::Interp interp)
 	{
-		static Noise n = { randi(INT_MIN, INT_MAX) };
+		thread_local Noise n = { randi(INT_MIN, INT_MAX) };
 		n.SetNoiseType(noise_type);
 		n.SetFrequency(frequency);
 		n.SetInterp(interp);
@@ -39,7 +66,7 @@ namespace two
 	float noise_fract_2d(float x, float y, Noise::NoiseType noise_type, float frequency, Noise::Interp interp, 
 									  Noise::FractalType fractal_type, int octaves, float lacunarity, float gain)
 	{
-		static Noise n = { randi(INT_MIN, INT_MAX) };
+		thread_local Noise n = { randi(INT_MIN, INT_MAX) };
 		n.SetNoiseType(noise_type);
 		n.SetFrequency(frequency);
 		n.SetInterp(interp);
@@ -53,7 +80,7 @@ namespace two
 	float noise_fract_3d(float x, float y, float z, Noise::NoiseType noise_type, float frequency, Noise::Interp interp,
 									  Noise::FractalType fractal_type, int octaves, float lacunarity, float gain)
 	{
-		static Noise n = { randi(INT_MIN, INT_MAX) };
+		thread_local Noise n = { randi(INT_MIN, INT_MAX) };
 		n.SetNoiseType(noise_type);
 		n.SetFrequency(frequency);
 		n.SetInterp(interp);
@@ -64,22 +91,509 @@ namespace two
 		return n.GetNoise(x, y, z);
 	}
 
-	void noise_field_2d(vector3d<float>& output_values, Noise::NoiseType noise_type, float frequency, Noise::Interp interp)
+	// fields built from a noise type share one seed per run, like the generators of the scalar helpers
+	static int field_seed()
+	{
+		static const int seed = randi(INT_MIN, INT_MAX);
+		return seed;
+	}
+
+#if TWO_NOISE_SSE
+	using f4 = __m128;
+	using i4 = __m128i;
+
+	inline f4 f4_splat(float f) { return _mm_set1_ps(f); }
+	inline f4 f4_load(const float* p) { return _mm_loadu_ps(p); }
+	inline void f4_store(float* p, f4 v) { _mm_storeu_ps(p, v); }
+	inline void i4_store(int* p, i4 v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+	inline f4 f4_add(f4 a, f4 b) { return _mm_add_ps(a, b); }
+	inline f4 f4_sub(f4 a, f4 b) { return _mm_sub_ps(a, b); }
+	inline f4 f4_mul(f4 a, f4 b) { return _mm_mul_ps(a, b); }
+	inline f4 f4_max(f4 a, f4 b) { return _mm_max_ps(a, b); }
+	inline f4 f4_abs(f4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+	inline f4 f4_float(i4 a) { return _mm_cvtepi32_ps(a); }
+	// same rounding as FastNoise FastFloor() : truncate, minus one for negative values
+	inline i4 f4_floor(f4 a) { return _mm_add_epi32(_mm_cvttps_epi32(a), _mm_castps_si128(_mm_cmplt_ps(a, _mm_setzero_ps()))); }
+#elif TWO_NOISE_NEON
+	using f4 = float32x4_t;
+	using i4 = int32x4_t;
+
+	inline f4 f4_splat(float f) { return vdupq_n_f32(f); }
+	inline f4 f4_load(const float* p) { return vld1q_f32(p); }
+	inline void f4_store(float* p, f4 v) { vst1q_f32(p, v); }
+	inline void i4_store(int* p, i4 v) { vst1q_s32(p, v); }
+	inline f4 f4_add(f4 a, f4 b) { return vaddq_f32(a, b); }
+	inline f4 f4_sub(f4 a, f4 b) { return vsubq_f32(a, b); }
+	inline f4 f4_mul(f4 a, f4 b) { return vmulq_f32(a, b); }
+	inline f4 f4_max(f4 a, f4 b) { return vmaxq_f32(a, b); }
+	inline f4 f4_abs(f4 a) { return vabsq_f32(a); }
+	inline f4 f4_float(i4 a) { return vcvtq_f32_s32(a); }
+	inline i4 f4_floor(f4 a) { return vaddq_s32(vcvtq_s32_f32(a), vreinterpretq_s32_u32(vcltq_f32(a, vdupq_n_f32(0.f)))); }
+#endif
+
+#if TWO_NOISE_SIMD
+	inline f4 f4_lerp(f4 a, f4 b, f4 t) { return f4_add(a, f4_mul(t, f4_sub(b, a))); }
+
+	static const float c_grad_x[] = { 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0 };
+	static const float c_grad_y[] = { 1, 1, -1, -1, 0, 0, 0, 0, 1, -1, 1, -1 };
+	static const float c_grad_z[] = { 0, 0, 0, 0, 1, 1, -1, -1, 1, 1, -1, -1 };
+
+	// evaluates the gradient noises (perlin and simplex, single or fractal) four samples at a time
+	// the lattice math follows FastNoise, and the permutation tables are rebuilt from the seed the way FastNoise::SetSeed() does, so the lanes match GetNoise()
+	// the gradient lookups stay scalar : SSE2 and NEON have no gather
+	struct NoiseLanes
 	{
-		for(size_t x = 0; x < output_values.m_x; ++x)
-			for(size_t y = 0; y < output_values.m_y; ++y)
+		NoiseLanes(const Noise& noise)
+			: m_type(noise.GetNoiseType())
+			, m_interp(noise.GetInterp())
+			, m_fractal_type(noise.GetFractalType())
+			, m_octaves(noise.GetFractalOctaves())
+			, m_frequency(noise.GetFrequency())
+			, m_lacunarity(noise.GetFractalLacunarity())
+			, m_gain(noise.GetFractalGain())
+		{
+			m_simplex = m_type == Noise::Simplex || m_type == Noise::SimplexFractal;
+			m_fractal = m_type == Noise::PerlinFractal || m_type == Noise::SimplexFractal;
+			m_enabled = m_simplex || m_type == Noise::Perlin || m_type == Noise::PerlinFractal;
+
+			std::mt19937_64 gen(noise.GetSeed());
+			for(int i = 0; i < 256; i++)
+				m_perm[i] = uint8_t(i);
+			for(int j = 0; j < 256; j++)
+			{
+				const int k = int(gen() % (256 - j)) + j;
+				const uint8_t l = m_perm[j];
+				m_perm[j] = m_perm[j + 256] = m_perm[k];
+				m_perm[k] = l;
+				m_perm12[j] = m_perm12[j + 256] = m_perm[j] % 12;
+			}
+
+			float amp = m_gain;
+			float amp_fractal = 1.f;
+			for(int i = 1; i < m_octaves; i++)
+			{
+				amp_fractal += amp;
+				amp *= m_gain;
+			}
+			m_bounding = 1.f / amp_fractal;
+		}
+
+		Noise::NoiseType m_type;
+		Noise::Interp m_interp;
+		Noise::FractalType m_fractal_type;
+		int m_octaves;
+		float m_frequency;
+		float m_lacunarity;
+		float m_gain;
+		float m_bounding;
+		bool m_simplex;
+		bool m_fractal;
+		bool m_enabled;
+
+		uint8_t m_perm[512];
+		uint8_t m_perm12[512];
+
+		template <bool Is3D>
+		void sample(const float* xs, float y, float z, float* dest) const
+		{
+			const f4 x = f4_load(xs);
+			f4_store(dest, Is3D ? this->noise(x, f4_splat(y), f4_splat(z))
+								: this->noise(x, f4_splat(y)));
+		}
+
+		f4 noise(f4 x, f4 y) const
+		{
+			const f4 frequency = f4_splat(m_frequency);
+			x = f4_mul(x, frequency);
+			y = f4_mul(y, frequency);
+
+			auto single = [&](uint8_t offset) { return m_simplex ? this->simplex(offset, x, y) : this->perlin(offset, x, y); };
+			if(!m_fractal)
+				return single(0);
+
+			const f4 lacunarity = f4_splat(m_lacunarity);
+			return this->fractal(single, [&] { x = f4_mul(x, lacunarity); y = f4_mul(y, lacunarity); });
+		}
+
+		f4 noise(f4 x, f4 y, f4 z) const
+		{
+			const f4 frequency = f4_splat(m_frequency);
+			x = f4_mul(x, frequency);
+			y = f4_mul(y, frequency);
+			z = f4_mul(z, frequency);
+
+			auto single = [&](uint8_t offset) { return m_simplex ? this->simplex(offset, x, y, z) : this->perlin(offset, x, y, z); };
+			if(!m_fractal)
+				return single(0);
+
+			const f4 lacunarity = f4_splat(m_lacunarity);
+			return this->fractal(single, [&] { x = f4_mul(x, lacunarity); y = f4_mul(y, lacunarity); z = f4_mul(z, lacunarity); });
+		}
+
+		template <class T_Single, class T_Next>
+		f4 fractal(const T_Single& single, const T_Next& next) const
+		{
+			const f4 one = f4_splat(1.f);
+			const f4 two = f4_splat(2.f);
+			auto octave = [&](uint8_t offset) -> f4
+			{
+				const f4 n = single(offset);
+				if(m_fractal_type == Noise::Billow) return f4_sub(f4_mul(f4_abs(n), two), one);
+				else if(m_fractal_type == Noise::RigidMulti) return f4_sub(one, f4_abs(n));
+				else return n;
+			};
+
+			f4 sum = octave(m_perm[0]);
+			float amp = 1.f;
+			for(int i = 1; i < m_octaves; ++i)
+			{
+				next();
+				amp *= m_gain;
+				const f4 o = f4_mul(octave(m_perm[i]), f4_splat(amp));
+				sum = m_fractal_type == Noise::RigidMulti ? f4_sub(sum, o) : f4_add(sum, o);
+			}
+
+			return m_fractal_type == Noise::RigidMulti ? sum : f4_mul(sum, f4_splat(m_bounding));
+		}
+
+		f4 interp(f4 t) const
+		{
+			if(m_interp == Noise::Hermite)
+				return f4_mul(f4_mul(t, t), f4_sub(f4_splat(3.f), f4_mul(f4_splat(2.f), t)));
+			else if(m_interp == Noise::Quintic)
+				return f4_mul(f4_mul(f4_mul(t, t), t), f4_add(f4_mul(t, f4_sub(f4_mul(t, f4_splat(6.f)), f4_splat(15.f))), f4_splat(10.f)));
+			else
+				return t;
+		}
+
+		f4 grad(uint8_t offset, const int* x, const int* y, f4 xd, f4 yd) const
+		{
+			float gx[4], gy[4];
+			for(int l = 0; l < 4; ++l)
+			{
+				const uint8_t i = m_perm12[(x[l] & 0xff) + m_perm[(y[l] & 0xff) + offset]];
+				gx[l] = c_grad_x[i];
+				gy[l] = c_grad_y[i];
+			}
+			return f4_add(f4_mul(xd, f4_load(gx)), f4_mul(yd, f4_load(gy)));
+		}
+
+		f4 grad(uint8_t offset, const int* x, const int* y, const int* z, f4 xd, f4 yd, f4 zd) const
+		{
+			float gx[4], gy[4], gz[4];
+			for(int l = 0; l < 4; ++l)
+			{
+				const uint8_t i = m_perm12[(x[l] & 0xff) + m_perm[(y[l] & 0xff) + m_perm[(z[l] & 0xff) + offset]]];
+				gx[l] = c_grad_x[i];
+				gy[l] = c_grad_y[i];
+				gz[l] = c_grad_z[i];
+			}
+			return f4_add(f4_add(f4_mul(xd, f4_load(gx)), f4_mul(yd, f4_load(gy))), f4_mul(zd, f4_load(gz)));
+		}
+
+		// lattice coordinates of the four lanes, and the next cell along the axis
+		struct Cells { int c[4]; int n[4]; };
+
+		static Cells cells(i4 v, int step = 1)
+		{
+			Cells cells;
+			i4_store(cells.c, v);
+			for(int l = 0; l < 4; ++l)
+				cells.n[l] = cells.c[l] + step;
+			return cells;
+		}
+
+		f4 perlin(uint8_t offset, f4 x, f4 y) const
+		{
+			const i4 ix = f4_floor(x);
+			const i4 iy = f4_floor(y);
+			const Cells cx = cells(ix);
+			const Cells cy = cells(iy);
+
+			const f4 one = f4_splat(1.f);
+			const f4 xd0 = f4_sub(x, f4_float(ix));
+			const f4 yd0 = f4_sub(y, f4_float(iy));
+			const f4 xd1 = f4_sub(xd0, one);
+			const f4 yd1 = f4_sub(yd0, one);
+			const f4 xs = this->interp(xd0);
+			const f4 ys = this->interp(yd0);
+
+			const f4 xf0 = f4_lerp(grad(offset, cx.c, cy.c, xd0, yd0), grad(offset, cx.n, cy.c, xd1, yd0), xs);
+			const f4 xf1 = f4_lerp(grad(offset, cx.c, cy.n, xd0, yd1), grad(offset, cx.n, cy.n, xd1, yd1), xs);
+			return f4_lerp(xf0, xf1, ys);
+		}
+
+		f4 perlin(uint8_t offset, f4 x, f4 y, f4 z) const
+		{
+			const i4 ix = f4_floor(x);
+			const i4 iy = f4_floor(y);
+			const i4 iz = f4_floor(z);
+			const Cells cx = cells(ix);
+			const Cells cy = cells(iy);
+			const Cells cz = cells(iz);
+
+			const f4 one = f4_splat(1.f);
+			const f4 xd0 = f4_sub(x, f4_float(ix));
+			const f4 yd0 = f4_sub(y, f4_float(iy));
+			const f4 zd0 = f4_sub(z, f4_float(iz));
+			const f4 xd1 = f4_sub(xd0, one);
+			const f4 yd1 = f4_sub(yd0, one);
+			const f4 zd1 = f4_sub(zd0, one);
+			const f4 xs = this->interp(xd0);
+			const f4 ys = this->interp(yd0);
+			const f4 zs = this->interp(zd0);
+
+			const f4 xf00 = f4_lerp(grad(offset, cx.c, cy.c, cz.c, xd0, yd0, zd0), grad(offset, cx.n, cy.c, cz.c, xd1, yd0, zd0), xs);
+			const f4 xf10 = f4_lerp(grad(offset, cx.c, cy.n, cz.c, xd0, yd1, zd0), grad(offset, cx.n, cy.n, cz.c, xd1, yd1, zd0), xs);
+			const f4 xf01 = f4_lerp(grad(offset, cx.c, cy.c, cz.n, xd0, yd0, zd1), grad(offset, cx.n, cy.c, cz.n, xd1, yd0, zd1), xs);
+			const f4 xf11 = f4_lerp(grad(offset, cx.c, cy.n, cz.n, xd0, yd1, zd1), grad(offset, cx.n, cy.n, cz.n, xd1, yd1, zd1), xs);
+
+			const f4 yf0 = f4_lerp(xf00, xf10, ys);
+			const f4 yf1 = f4_lerp(xf01, xf11, ys);
+			return f4_lerp(yf0, yf1, zs);
+		}
+
+		// contribution of one simplex corner : max(0, r - |d|^2)^4 * dot(gradient, d)
+		static f4 corner(f4 r, f4 g, f4 x, f4 y)
+		{
+			f4 t = f4_max(f4_sub(f4_sub(r, f4_mul(x, x)), f4_mul(y, y)), f4_splat(0.f));
+			t = f4_mul(t, t);
+			return f4_mul(f4_mul(t, t), g);
+		}
+
+		static f4 corner(f4 r, f4 g, f4 x, f4 y, f4 z)
+		{
+			f4 t = f4_max(f4_sub(f4_sub(f4_sub(r, f4_mul(x, x)), f4_mul(y, y)), f4_mul(z, z)), f4_splat(0.f));
+			t = f4_mul(t, t);
+			return f4_mul(f4_mul(t, t), g);
+		}
+
+		f4 simplex(uint8_t offset, f4 x, f4 y) const
+		{
+			const float F2 = 1.f / 2.f;
+			const float G2 = 1.f / 4.f;
+
+			const f4 t = f4_mul(f4_add(x, y), f4_splat(F2));
+			const i4 i = f4_floor(f4_add(x, t));
+			const i4 j = f4_floor(f4_add(y, t));
+			const f4 fi = f4_float(i);
+			const f4 fj = f4_float(j);
+			const f4 t0 = f4_mul(f4_add(fi, fj), f4_splat(G2));
+			const f4 x0 = f4_sub(x, f4_sub(fi, t0));
+			const f4 y0 = f4_sub(y, f4_sub(fj, t0));
+
+			const Cells ci = cells(i);
+			const Cells cj = cells(j);
+
+			// the middle corner depends on which half of the cell each lane is in
+			float lx0[4], ly0[4], i1[4], j1[4];
+			int mi[4], mj[4];
+			f4_store(lx0, x0);
+			f4_store(ly0, y0);
+			for(int l = 0; l < 4; ++l)
+			{
+				const bool lower = lx0[l] > ly0[l];
+				i1[l] = lower ? 1.f : 0.f;
+				j1[l] = lower ? 0.f : 1.f;
+				mi[l] = ci.c[l] + (lower ? 1 : 0);
+				mj[l] = cj.c[l] + (lower ? 0 : 1);
+			}
+
+			const f4 g2 = f4_splat(G2);
+			const f4 x1 = f4_add(f4_sub(x0, f4_load(i1)), g2);
+			const f4 y1 = f4_add(f4_sub(y0, f4_load(j1)), g2);
+			const f4 x2 = f4_add(f4_sub(x0, f4_splat(1.f)), f4_splat(2.f * G2));
+			const f4 y2 = f4_add(f4_sub(y0, f4_splat(1.f)), f4_splat(2.f * G2));
+
+			const f4 r = f4_splat(0.5f);
+			const f4 n0 = corner(r, grad(offset, ci.c, cj.c, x0, y0), x0, y0);
+			const f4 n1 = corner(r, grad(offset, mi, mj, x1, y1), x1, y1);
+			const f4 n2 = corner(r, grad(offset, ci.n, cj.n, x2, y2), x2, y2);
+
+			return f4_mul(f4_splat(50.f), f4_add(f4_add(n0, n1), n2));
+		}
+
+		f4 simplex(uint8_t offset, f4 x, f4 y, f4 z) const
+		{
+			const float F3 = 1.f / 3.f;
+			const float G3 = 1.f / 6.f;
+
+			const f4 t = f4_mul(f4_add(f4_add(x, y), z), f4_splat(F3));
+			const i4 i = f4_floor(f4_add(x, t));
+			const i4 j = f4_floor(f4_add(y, t));
+			const i4 k = f4_floor(f4_add(z, t));
+			const f4 fi = f4_float(i);
+			const f4 fj = f4_float(j);
+			const f4 fk = f4_float(k);
+			const f4 t0 = f4_mul(f4_add(f4_add(fi, fj), fk), f4_splat(G3));
+			const f4 x0 = f4_sub(x, f4_sub(fi, t0));
+			const f4 y0 = f4_sub(y, f4_sub(fj, t0));
+			const f4 z0 = f4_sub(z, f4_sub(fk, t0));
+
+			const Cells ci = cells(i);
+			const Cells cj = cells(j);
+			const Cells ck = cells(k);
+
+			// the two middle corners depend on the ordering of the lane offsets
+			float lx0[4], ly0[4], lz0[4];
+			float i1[4], j1[4], k1[4], i2[4], j2[4], k2[4];
+			int ai[4], aj[4], ak[4], bi[4], bj[4], bk[4];
+			f4_store(lx0, x0);
+			f4_store(ly0, y0);
+			f4_store(lz0, z0);
+			for(int l = 0; l < 4; ++l)
+			{
+				int a[3], b[3];
+				const float px = lx0[l], py = ly0[l], pz = lz0[l];
+				if(px >= py)
 				{
-					output_values.at(x, y) = noise_2d(float(x) / 1.f, float(y) / 1.f, noise_type, frequency, interp);
+					if(py >= pz)      { a[0] = 1; a[1] = 0; a[2] = 0; b[0] = 1; b[1] = 1; b[2] = 0; }
+					else if(px >= pz) { a[0] = 1; a[1] = 0; a[2] = 0; b[0] = 1; b[1] = 0; b[2] = 1; }
+					else              { a[0] = 0; a[1] = 0; a[2] = 1; b[0] = 1; b[1] = 0; b[2] = 1; }
 				}
+				else
+				{
+					if(py < pz)       { a[0] = 0; a[1] = 0; a[2] = 1; b[0] = 0; b[1] = 1; b[2] = 1; }
+					else if(px < pz)  { a[0] = 0; a[1] = 1; a[2] = 0; b[0] = 0; b[1] = 1; b[2] = 1; }
+					else              { a[0] = 0; a[1] = 1; a[2] = 0; b[0] = 1; b[1] = 1; b[2] = 0; }
+				}
+
+				i1[l] = float(a[0]); j1[l] = float(a[1]); k1[l] = float(a[2]);
+				i2[l] = float(b[0]); j2[l] = float(b[1]); k2[l] = float(b[2]);
+				ai[l] = ci.c[l] + a[0]; aj[l] = cj.c[l] + a[1]; ak[l] = ck.c[l] + a[2];
+				bi[l] = ci.c[l] + b[0]; bj[l] = cj.c[l] + b[1]; bk[l] = ck.c[l] + b[2];
+			}
+
+			const f4 g3 = f4_splat(G3);
+			const f4 g32 = f4_splat(2.f * G3);
+			const f4 g33 = f4_splat(3.f * G3);
+			const f4 one = f4_splat(1.f);
+			const f4 x1 = f4_add(f4_sub(x0, f4_load(i1)), g3);
+			const f4 y1 = f4_add(f4_sub(y0, f4_load(j1)), g3);
+			const f4 z1 = f4_add(f4_sub(z0, f4_load(k1)), g3);
+			const f4 x2 = f4_add(f4_sub(x0, f4_load(i2)), g32);
+			const f4 y2 = f4_add(f4_sub(y0, f4_load(j2)), g32);
+			const f4 z2 = f4_add(f4_sub(z0, f4_load(k2)), g32);
+			const f4 x3 = f4_add(f4_sub(x0, one), g33);
+			const f4 y3 = f4_add(f4_sub(y0, one), g33);
+			const f4 z3 = f4_add(f4_sub(z0, one), g33);
+
+			const f4 r = f4_splat(0.6f);
+			const f4 n0 = corner(r, grad(offset, ci.c, cj.c, ck.c, x0, y0, z0), x0, y0, z0);
+			const f4 n1 = corner(r, grad(offset, ai, aj, ak, x1, y1, z1), x1, y1, z1);
+			const f4 n2 = corner(r, grad(offset, bi, bj, bk, x2, y2, z2), x2, y2, z2);
+			const f4 n3 = corner(r, grad(offset, ci.n, cj.n, ck.n, x3, y3, z3), x3, y3, z3);
+
+			return f4_mul(f4_splat(32.f), f4_add(f4_add(f4_add(n0, n1), n2), n3));
+		}
+	};
+#else
+	struct NoiseLanes
+	{
+		NoiseLanes(const Noise& noise) { UNUSED(noise); }
+		bool m_enabled = false;
+	};
+#endif
+
+	template <bool Is3D>
+	inline void noise_rows(const Noise& noise, const NoiseLanes& lanes, const NoiseGrid& grid, float* output, uint32_t start, uint32_t count)
+	{
+		const uint32_t width = grid.m_size.x;
+
+		// x coordinates are the same for every row
+		constexpr uint32_t max_width = 256;
+		float xs[max_width];
+
+		for(uint32_t x0 = 0; x0 < width; x0 += max_width)
+		{
+			const uint32_t run = min(width - x0, max_width);
+			for(uint32_t x = 0; x < run; ++x)
+				xs[x] = grid.m_origin.x + float(x0 + x) * grid.m_step.x;
+
+			for(uint32_t row = start; row < start + count; ++row)
+			{
+				const uint32_t y = row % grid.m_size.y;
+				const uint32_t z = row / grid.m_size.y;
+				const float fy = grid.m_origin.y + float(y) * grid.m_step.y;
+				const float fz = grid.m_origin.z + float(z) * grid.m_step.z;
+
+				float* dest = output + size_t(row) * width + x0;
+
+				uint32_t x = 0;
+#if TWO_NOISE_SIMD
+				if(lanes.m_enabled)
+					for(; x + 4 <= run; x += 4)
+						lanes.sample<Is3D>(xs + x, fy, fz, dest + x);
+#else
+				UNUSED(lanes);
+#endif
+				// scalar tail, and the noise types without a vectorized path
+				for(; x < run; ++x)
+					dest[x] = Is3D ? noise.GetNoise(xs[x], fy, fz)
+								   : noise.GetNoise(xs[x], fy);
+			}
+		}
+	}
+
+	template <bool Is3D>
+	void noise_field(const Noise& noise, const NoiseGrid& grid, float* output)
+	{
+		const uint32_t rows = grid.m_size.y * grid.m_size.z;
+		const size_t size = size_t(rows) * grid.m_size.x;
+
+		const NoiseLanes lanes = { noise };
+
+		constexpr size_t min_parallel = 64 * 64;
+
+		JobSystem* js = JobSystem::instance();
+		if(js && size >= min_parallel && rows > 1)
+		{
+			auto process = [&noise, &lanes, &grid, output](JobSystem& js, Job* job, uint32_t start, uint32_t count)
+			{
+				UNUSED(js); UNUSED(job);
+				noise_rows<Is3D>(noise, lanes, grid, output, start, count);
+			};
+
+			Job* job = split_jobs<16>(*js, nullptr, 0, rows, process);
+			js->complete(job);
+		}
+		else
+		{
+			noise_rows<Is3D>(noise, lanes, grid, output, 0, rows);
+		}
+	}
+
+	void noise_field_2d(const Noise& noise, const NoiseGrid& grid, float* output)
+	{
+		noise_field<false>(noise, grid, output);
+	}
+
+	void noise_field_3d(const Noise& noise, const NoiseGrid& grid, float* output)
+	{
+		noise_field<true>(noise, grid, output);
+	}
+
+	void noise_field_2d(const Noise& noise, vector3d<float>& output_values)
+	{
+		const NoiseGrid grid = { uvec3(uint32_t(output_values.m_x), uint32_t(output_values.m_y), uint32_t(output_values.m_z)) };
+		noise_field_2d(noise, grid, output_values.data());
+	}
+
+	void noise_field_3d(const Noise& noise, vector3d<float>& output_values)
+	{
+		const NoiseGrid grid = { uvec3(uint32_t(output_values.m_x), uint32_t(output_values.m_y), uint32_t(output_values.m_z)) };
+		noise_field_3d(noise, grid, output_values.data());
+	}
+
+	void noise_field_2d(vector3d<float>& output_values, Noise::NoiseType noise_type, float frequency, Noise::Interp interp)
+	{
+		const Noise noise = { field_seed(), noise_type, frequency, interp };
+		noise_field_2d(noise, output_values);
 	}
 
 	void noise_field_3d(vector3d<float>& output_values, Noise::NoiseType noise_type, float frequency, Noise::Interp interp)
 	{
-		for(size_t x = 0; x < output_values.m_x; ++x)
-			for(size_t y = 0; y < output_values.m_y; ++y)
-				for(size_t z = 0; z < output_values.m_z; ++z)
-				{
-					output_values.at(x, y, z) = noise_3d(float(x) / 1.f, float(y) / 1.f, float(z) / 1.f, noise_type, frequency, interp);
-				}
+		const Noise noise = { field_seed(), noise_type, frequency, interp };
+		noise_field_3d(noise, output_values);
 	}
 }
@@ -29,6 +29,7 @@ namespace two
 #endif
 	public:
 		Noise(int seed = 1337);
+		Noise(int seed, NoiseType noise_type, float frequency = 0.01f, Interp interp = Quintic);
 
 #if 0 //def TWO_META_GENERATOR
 		meth_ float GetNoise(float x, float y) const;
@@ -74,4 +75,21 @@ namespace two
 
 	TWO_NOISE_EXPORT func_ void noise_field_2d(vector3d<float>& output_values, Noise::NoiseType noise_type, float frequency = 0.01f, Noise::Interp interp = Noise::Quintic);
 	TWO_NOISE_EXPORT func_ void noise_field_3d(vector3d<float>& output_values, Noise::NoiseType noise_type, float frequency = 0.01f, Noise::Interp interp = Noise::Quintic);
+
+	// region of a noise field : sample (x, y, z) is evaluated at m_origin + (x, y, z) * m_step
+	export_ struct TWO_NOISE_EXPORT NoiseGrid
+	{
+		uvec3 m_size = uvec3(1U);
+		vec3 m_origin = vec3(0.f);
+		vec3 m_step = vec3(1.f);
+	};
+
+	// batched evaluation : output is filled in memory order (x, then y, then z) and must hold m_size.x * m_size.y * m_size.z floats
+	// the noise is only read, so one configured Noise can be shared by concurrent calls
+	// large grids are split in rows across the calling thread's job system
+	TWO_NOISE_EXPORT void noise_field_2d(const Noise& noise, const NoiseGrid& grid, float* output);
+	TWO_NOISE_EXPORT void noise_field_3d(const Noise& noise, const NoiseGrid& grid, float* output);
+
+	TWO_NOISE_EXPORT void noise_field_2d(const Noise& noise, vector3d<float>& output_values);
+	TWO_NOISE_EXPORT void noise_field_3d(const Noise& noise, vector3d<float>& output_values);
 }
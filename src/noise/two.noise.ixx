@@ -8,6 +8,7 @@ export import std.threading;
 export import std.regex;
 
 export import two.infra;
+export import two.jobs;
 export import two.type;
 export import two.math;
 export import two.geom;
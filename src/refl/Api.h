@@ -10,6 +10,7 @@
 #include <refl/Method.h>
 #include <refl/VirtualMethod.h>
 #include <refl/Module.h>
+#include <refl/NameIndex.h>
 #include <refl/Namespace.h>
 #include <refl/Sequence.h>
 #include <refl/System.h>
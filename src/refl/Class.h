@@ -9,6 +9,7 @@
 #include <refl/Forward.h>
 #include <refl/Method.h>
 #include <refl/Member.h>
+#include <refl/NameIndex.h>
 
 namespace two
 {
@@ -85,6 +86,10 @@ namespace two
 		vector<cstring> m_field_names;
 		vector<Ref> m_field_values;
 
+		// members and methods hashed by name in setup_class(), the first one declared wins for overloaded names
+		NameIndex m_member_index;
+		NameIndex m_method_index;
+
 		// Deep Reflection
 		vector<Member*> m_components;
 		vector<Member*> m_deep_members;
@@ -39,6 +39,8 @@ namespace two
     class Iterable;
     class Sequence;
     class Namespace;
+    class NameIndex;
+    class Names;
     class Module;
     class System;
 	class Prototype;
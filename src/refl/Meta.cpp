@@ -199,8 +199,13 @@ namespace two
 
 			m_field_names.push_back(member.m_name);
 			m_field_values.push_back(member.m_default_value);
+
+			m_member_index.add(intern(member.m_name), &member);
 		}
 
+		for(Method& method : m_methods)
+			m_method_index.add(intern(method.m_name), &method);
+
 		for(Member* component : m_components)
 			if(g_class[component->m_type->m_id])
 			{
@@ -237,6 +242,8 @@ namespace two
 
 	Member& Class::member(cstring name)
 	{
+		if(Member* member = m_member_index.get<Member>(name))
+			return *member;
 		for(Member& member : m_members)
 			if(strcmp(member.m_name, name) == 0)
 				return member;
@@ -245,6 +252,8 @@ namespace two
 
 	Method& Class::method(cstring name)
 	{
+		if(Method* method = m_method_index.get<Method>(name))
+			return *method;
 		for(Method& method : m_methods)
 			if(strcmp(method.m_name, name) == 0)
 				return method;
@@ -269,11 +278,15 @@ namespace two
 
 	bool Class::has_member(cstring name)
 	{
+		if(m_member_index.size() > 0)
+			return m_member_index.find(name) != nullptr;
 		return has_pred(m_members, [&](const Member& member) { return strcmp(member.m_name, name) == 0; });
 	}
 
 	bool Class::has_method(cstring name)
 	{
+		if(m_method_index.size() > 0)
+			return m_method_index.find(name) != nullptr;
 		return has_pred(m_methods, [&](const Method& method) { return strcmp(method.m_name, name) == 0; });
 	}
 
@@ -0,0 +1,153 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#ifdef TWO_MODULES
+module;
+#include <infra/Cpp20.h>
+module two.refl;
+#else
+#include <stl/vector.hpp>
+#include <refl/NameIndex.h>
+#endif
+
+#include <cstring>
+
+namespace two
+{
+	constexpr uint64_t c_fnv_basis = 14695981039346656037ULL;
+	constexpr uint64_t c_fnv_prime = 1099511628211ULL;
+
+	inline uint64_t fnv1a(cstring name, uint64_t hash)
+	{
+		for(const char* c = name; *c; ++c)
+			hash = (hash ^ uint64_t(uint8_t(*c))) * c_fnv_prime;
+		return hash;
+	}
+
+	uint64_t name_hash(cstring name)
+	{
+		return fnv1a(name, c_fnv_basis);
+	}
+
+	uint64_t name_hash(cstring scope, cstring name)
+	{
+		if(!scope)
+			return name_hash(name);
+		// the separator keeps ("a", "bc") and ("ab", "c") apart
+		const uint64_t hash = (fnv1a(scope, c_fnv_basis) ^ uint64_t(':')) * c_fnv_prime;
+		return fnv1a(name, hash);
+	}
+
+	inline bool same_scope(cstring first, cstring second)
+	{
+		if(!first || !second)
+			return first == second;
+		return first == second || strcmp(first, second) == 0;
+	}
+
+	void NameIndex::clear()
+	{
+		m_slots.clear();
+		m_count = 0;
+	}
+
+	void NameIndex::rehash(size_t capacity)
+	{
+		vector<Slot> slots = move(m_slots);
+		m_slots = vector<Slot>(capacity);
+		m_count = 0;
+		for(const Slot& slot : slots)
+			if(slot.m_name)
+				this->add(slot.m_scope, slot.m_name, slot.m_value);
+	}
+
+	bool NameIndex::add(cstring scope, cstring name, void* value)
+	{
+		// kept at most half full, so that probes stay short
+		if((m_count + 1) * 2 > m_slots.size())
+			this->rehash(m_slots.empty() ? 64 : m_slots.size() * 2);
+
+		const uint64_t hash = name_hash(scope, name);
+		const size_t mask = m_slots.size() - 1;
+		for(size_t i = size_t(hash) & mask;; i = (i + 1) & mask)
+		{
+			Slot& slot = m_slots[i];
+			if(!slot.m_name)
+			{
+				slot = { hash, scope, name, value };
+				m_count++;
+				return true;
+			}
+			if(slot.m_hash == hash && strcmp(slot.m_name, name) == 0 && same_scope(slot.m_scope, scope))
+				return false;
+		}
+	}
+
+	void* NameIndex::find(cstring scope, cstring name) const
+	{
+		if(m_slots.empty() || !name)
+			return nullptr;
+
+		const uint64_t hash = name_hash(scope, name);
+		const size_t mask = m_slots.size() - 1;
+		for(size_t i = size_t(hash) & mask;; i = (i + 1) & mask)
+		{
+			const Slot& slot = m_slots[i];
+			if(!slot.m_name)
+				return nullptr;
+			if(slot.m_hash == hash && (slot.m_name == name || strcmp(slot.m_name, name) == 0) && same_scope(slot.m_scope, scope))
+				return slot.m_value;
+		}
+	}
+
+	Names::Names()
+	{}
+
+	Names::~Names()
+	{
+		for(char* page : m_pages)
+			delete[] page;
+	}
+
+	cstring Names::intern(cstring name)
+	{
+		if(cstring interned = this->find(name))
+			return interned;
+
+		const size_t size = strlen(name) + 1;
+		char* storage = nullptr;
+		if(size > c_page_size / 4)
+		{
+			// long names get their own allocation, so that pages are not wasted
+			storage = new char[size];
+			m_pages.push_back(storage);
+		}
+		else
+		{
+			if(!m_page || m_page_used + size > c_page_size)
+			{
+				m_page = new char[c_page_size];
+				m_pages.push_back(m_page);
+				m_page_used = 0;
+			}
+			storage = m_page + m_page_used;
+			m_page_used += size;
+		}
+
+		memcpy(storage, name, size);
+		m_index.add(storage, storage);
+		return storage;
+	}
+
+	cstring Names::find(cstring name) const
+	{
+		return static_cast<cstring>(m_index.find(name));
+	}
+
+	Names& names()
+	{
+		static Names names;
+		return names;
+	}
+}
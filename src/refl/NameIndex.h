@@ -0,0 +1,74 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#pragma once
+
+#include <stdint.h>
+#include <stl/vector.h>
+#include <refl/Forward.h>
+
+namespace two
+{
+	export_ using cstring = const char*;
+
+	export_ TWO_REFL_EXPORT uint64_t name_hash(cstring name);
+	export_ TWO_REFL_EXPORT uint64_t name_hash(cstring scope, cstring name);
+
+	// an open addressing index of reflected symbols by name, optionally scoped (by a namespace or a class name)
+	// the first symbol added under a name is kept, so that lookups return the same symbol as a linear scan in load order
+	export_ class TWO_REFL_EXPORT NameIndex
+	{
+	public:
+		struct Slot
+		{
+			uint64_t m_hash = 0;
+			cstring m_scope = nullptr;
+			cstring m_name = nullptr;
+			void* m_value = nullptr;
+		};
+
+		void clear();
+		bool add(cstring scope, cstring name, void* value);
+		void* find(cstring scope, cstring name) const;
+
+		bool add(cstring name, void* value) { return this->add(nullptr, name, value); }
+		void* find(cstring name) const { return this->find(nullptr, name); }
+
+		template <class T>
+		T* get(cstring name) const { return static_cast<T*>(this->find(nullptr, name)); }
+
+		template <class T>
+		T* get(cstring scope, cstring name) const { return static_cast<T*>(this->find(scope, name)); }
+
+		size_t size() const { return m_count; }
+
+	private:
+		void rehash(size_t capacity);
+
+		vector<Slot> m_slots;
+		size_t m_count = 0;
+	};
+
+	// each distinct reflected name is stored once : interned names outlive the modules they were read from, and compare by pointer
+	export_ class TWO_REFL_EXPORT Names
+	{
+	public:
+		Names();
+		~Names();
+
+		cstring intern(cstring name);
+		cstring find(cstring name) const;
+
+	private:
+		static constexpr size_t c_page_size = 16 * 1024;
+
+		NameIndex m_index;
+		vector<char*> m_pages;
+		char* m_page = nullptr;
+		size_t m_page_used = 0;
+	};
+
+	export_ TWO_REFL_EXPORT Names& names();
+	export_ inline cstring intern(cstring name) { return names().intern(name); }
+}
@@ -163,12 +163,18 @@ namespace two
 			load_module(*dep);
 
 		for(Type* type : m.m_types)
+		{
 			m_types.push_back(type);
+			this->index(*type);
+		}
 		for(Alias* alias : m.m_aliases)
 			m_aliases.push_back(alias);
 
 		for(Function* function : m.m_functions)
+		{
 			m_functions.push_back(function);
+			this->index(*function);
+		}
 
 		for(Type* type : m.m_types)
 			if(g_class[type->m_id])
@@ -187,6 +193,9 @@ namespace two
 		for(Function* function : m.m_functions)
 			remove(m_functions, function);
 
+		// the open addressing indexes don't support removal, and unloading is rare enough to rebuild them
+		this->reindex();
+
 		two::unload_module(m);
 	}
 
@@ -199,28 +208,43 @@ namespace two
 		return reloaded;
 	}
 
-	Type* System::find_type(cstring name)
+	void System::index(Type& type)
+	{
+		m_type_index.add(intern(type.m_name), &type);
+	}
+
+	void System::index(Function& function)
+	{
+		cstring name = intern(function.m_name);
+		m_function_index.add(name, &function);
+		m_namespace_function_index.add(intern(function.m_namespace->m_name), name, &function);
+	}
+
+	void System::reindex()
 	{
+		m_type_index.clear();
+		m_function_index.clear();
+		m_namespace_function_index.clear();
+
 		for(Type* type : m_types)
-			if(strcmp(type->m_name, name) == 0)
-				return type;
-		return nullptr;
+			this->index(*type);
+		for(Function* function : m_functions)
+			this->index(*function);
+	}
+
+	Type* System::find_type(cstring name)
+	{
+		return m_type_index.get<Type>(name);
 	}
 
 	Function* System::find_function(cstring name)
 	{
-		for(Function* function : m_functions)
-			if(strcmp(function->m_name, name) == 0)
-				return function;
-		return nullptr;
+		return m_function_index.get<Function>(name);
 	}
 
 	Function* System::find_function(cstring nemespace, cstring name)
 	{
-		for(Function* function : m_functions)
-			if(function->m_namespace->m_name == string(nemespace) && function->m_name == string(name))
-				return function;
-		return nullptr;
+		return m_namespace_function_index.get<Function>(nemespace, name);
 	}
 
 	Function& System::function(FunctionPointer identity)
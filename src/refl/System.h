@@ -7,6 +7,7 @@
 #include <stl/vector.h>
 #include <refl/Forward.h>
 #include <refl/Namespace.h>
+#include <refl/NameIndex.h>
 
 namespace two
 {
@@ -51,6 +52,15 @@ namespace two
 		Function* find_function(cstring name);
 		Function* find_function(cstring nemespace, cstring name);
 
+		// symbols are hashed by name as modules are loaded, and the indexes are rebuilt when a module is unloaded
+		NameIndex m_type_index;
+		NameIndex m_function_index;
+		NameIndex m_namespace_function_index;
+
+		void index(Type& type);
+		void index(Function& function);
+		void reindex();
+
 		static System& instance() { static System instance; return instance; }
 	};
 
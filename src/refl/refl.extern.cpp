@@ -31,5 +31,7 @@ namespace stl
 	template class TWO_REFL_EXPORT vector<Method>;
 	template class TWO_REFL_EXPORT vector<Member>;
 	template class TWO_REFL_EXPORT vector<Static>;
+	template class TWO_REFL_EXPORT vector<NameIndex::Slot>;
+	template class TWO_REFL_EXPORT vector<char*>;
 }
 #endif
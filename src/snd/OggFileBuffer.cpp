@@ -40,6 +40,7 @@ namespace two
 		vorbis_comment* m_vorbis_comment = nullptr;
 
 		ov_callbacks m_ogg_callbacks;
+		bool m_open = false;
 	};
 
 	OggFileBuffer::OggFileBuffer()
@@ -47,9 +48,11 @@ namespace two
 	{}
 
 	OggFileBuffer::~OggFileBuffer()
-	{}
+	{
+		this->close();
+	}
 
-	void OggFileBuffer::open(const string& filename)
+	bool OggFileBuffer::open(const string& filename)
 	{
 		m_impl->m_ogg_callbacks.read_func = ogg_read;
 		m_impl->m_ogg_callbacks.close_func = ogg_close;
@@ -64,23 +67,28 @@ namespace two
 		int result = ov_fopen(filename.c_str(), &m_impl->m_ogg_file);
 
 		if(result < 0)
-			return;
+			return false;
 
+		m_impl->m_open = true;
 		m_impl->m_vorbis_info = ov_info(&m_impl->m_ogg_file, -1);
 		m_impl->m_vorbis_comment = ov_comment(&m_impl->m_ogg_file, -1);
 
 		m_duration = static_cast<float>(ov_time_total(&m_impl->m_ogg_file, -1));
 		m_seekable = (ov_seekable(&m_impl->m_ogg_file) != 0);
+		m_rate = ALsizei(m_impl->m_vorbis_info->rate);
 
 		if(!this->read_buffer_info())
-			return;
+			return false;
 
 		m_mono = ((m_format==AL_FORMAT_MONO16) || (m_format==AL_FORMAT_MONO8));
+		return true;
 	}
 
 	void OggFileBuffer::close()
 	{
-		ov_clear(&m_impl->m_ogg_file);
+		if(m_impl->m_open)
+			ov_clear(&m_impl->m_ogg_file);
+		m_impl->m_open = false;
 	}
 
 	void OggFileBuffer::reopen()
@@ -99,63 +107,46 @@ namespace two
 		ov_raw_seek(&m_impl->m_ogg_file, pos);
 	}
 
-	void OggFileBuffer::fill(ALuint buffer)
+	size_t OggFileBuffer::read(char* data, size_t size)
 	{
-		vector<char> data;
-		vector<char> chunk = vector<char>(m_chunk_size);
-
-		int size_read = 1;
-		int last_pos = 0;
+		size_t read = 0;
 		int section;
 
-		while(size_read > 0)
+		while(read < size)
 		{
-			//printf("reading : " << size_read << " at pos : " << last_pos );
-			size_read = ov_read(&m_impl->m_ogg_file, chunk.data(), int(m_chunk_size), 0, 2, 1, &section);
-			data.insert(data.end(), chunk.begin(), chunk.begin() + size_read);
-			last_pos += size_read;
+			long result = ov_read(&m_impl->m_ogg_file, data + read, int(size - read), 0, 2, 1, &section);
+			// zero is the end of the stream, negative values are holes or corrupt data
+			if(result <= 0)
+				break;
+			read += size_t(result);
 		}
 
-		alGetError();
-		alBufferData(buffer, m_format, &data[0], last_pos, m_impl->m_vorbis_info->rate);
-	}
-
-	bool OggFileBuffer::fill_chunk(ALuint buffer)
-	{
-		vector<char> chunk = vector<char>(m_chunk_size);
-		
-		bool last_chunk = this->read_chunk(chunk.data(), m_chunk_size);
-
-		alBufferData(buffer, m_format, chunk.data(), ALsizei(m_chunk_size), m_impl->m_vorbis_info->rate);
-		alGetError();
-
-		return last_chunk;
+		return read;
 	}
 
-	bool OggFileBuffer::read_chunk(char* data_chunk, size_t chunk_size)
+	void OggFileBuffer::decode(vector<char>& pcm)
 	{
-		UNUSED(chunk_size);
-		size_t size = 0;
-		int section;
-		int result;
-		bool last_chunk = true;
-
-		while(size < m_chunk_size)
+		// seekable files know their length upfront : samples are decoded in place, without growing the vector
+		const ogg_int64_t samples = ov_pcm_total(&m_impl->m_ogg_file, -1);
+		if(samples > 0)
 		{
-			result = ov_read(&m_impl->m_ogg_file, data_chunk + size, int(m_chunk_size - size), 0, 2, 1, &section);
+			pcm.resize(size_t(samples) * size_t(m_impl->m_vorbis_info->channels) * 2);
+			pcm.resize(this->read(pcm.data(), pcm.size()));
+			return;
+		}
 
-			if(result > 0)
-				size += result;
-			else if(result == 0)
-				last_chunk = false;
-			else if(result < 0)
+		pcm.clear();
+		while(true)
+		{
+			const size_t offset = pcm.size();
+			pcm.resize(offset + m_chunk_size);
+			const size_t size = this->read(pcm.data() + offset, m_chunk_size);
+			pcm.resize(offset + size);
+			if(size < m_chunk_size)
 				break;
 		}
-
-		return last_chunk;
 	}
 
-
 	bool OggFileBuffer::read_buffer_info()
 	{
 		/** Calculates buffer size and format.
@@ -17,21 +17,18 @@ namespace two
 		OggFileBuffer();
 		~OggFileBuffer();
 
-		size_t m_chunk_size = 0;			// Size of audio buffer (250ms)
-
-		virtual void open(const string& filename) override;
+		virtual bool open(const string& filename) override;
 		virtual void close() override;
 		virtual void reopen() override;
 
 		virtual void seek_time(float time) override;
 		virtual void seek_bytes(long pos) override;
 
-		virtual void fill(ALuint buffer) override;
-		virtual bool fill_chunk(ALuint buffer) override;
+		virtual size_t read(char* data, size_t size) override;
+		virtual void decode(vector<char>& pcm) override;
 
 	protected:
-		bool read_buffer_info();		
-		bool read_chunk(char* chunk, size_t chunk_size);
+		bool read_buffer_info();
 
 	private:
 		struct Impl;
@@ -12,23 +12,51 @@
 namespace two
 {
 	SharedBuffer::SharedBuffer(const string& filename, SoundManager& manager)
-		: m_al_buffer(AL_NONE)
+		: m_filename(filename)
 		, m_manager(&manager)
 	{
 		if(filename.find(".ogg") != filename.npos || filename.find(".OGG") != filename.npos)
 			m_file_buffer = make_unique<OggFileBuffer>();
+	}
+
+	SharedBuffer::~SharedBuffer()
+	{
+		if(m_al_buffer != AL_NONE)
+			alDeleteBuffers(1, &m_al_buffer);
+	}
+
+	bool SharedBuffer::begin_decode()
+	{
+		int unloaded = Unloaded;
+		return m_state.compare_exchange_strong(unloaded, Decoding, std::memory_order_acq_rel);
+	}
 
+	void SharedBuffer::decode()
+	{
+		bool success = m_file_buffer && m_file_buffer->open(m_filename);
+		if(success)
+			m_file_buffer->decode(m_pcm);
+		if(m_file_buffer)
+			m_file_buffer->close();
+
+		m_state.store(success ? Decoded : Failed, std::memory_order_release);
+	}
+
+	void SharedBuffer::upload()
+	{
 		alGenBuffers(1, &m_al_buffer);
+		alBufferData(m_al_buffer, m_file_buffer->m_format, m_pcm.data(), ALsizei(m_pcm.size()), m_file_buffer->m_rate);
+		openal_check_error();
 
-		m_file_buffer->open(filename.c_str());
-		m_file_buffer->fill(m_al_buffer);
+		m_pcm = vector<char>();
+		m_state.store(Uploaded, std::memory_order_release);
 	}
 
-	SharedBuffer::~SharedBuffer()
+	void SharedBuffer::unload()
 	{
 		alDeleteBuffers(1, &m_al_buffer);
-
-		m_file_buffer->close();
+		m_al_buffer = AL_NONE;
+		m_state.store(Unloaded, std::memory_order_release);
 	}
 
 	void SharedBuffer::use()
@@ -5,20 +5,48 @@
 #pragma once
 
 #include <type/Unique.h>
+#include <stl/vector.h>
 #include <snd/SoundFileBuffer.h>
 #include <snd/OggFileBuffer.h>
 
+#include <atomic>
+
 namespace two
 {
+	// a fully decoded sound, shared by all the static sounds playing the same file
+	// it is decoded on any thread (a job, or the audio thread), then uploaded to OpenAL by the audio thread
+	// the state is the only field shared between threads : whoever moves it out of Unloaded owns the decoding
 	class SharedBuffer
 	{
 	public:
-		SharedBuffer(const string& fileName, SoundManager& manager);
+		enum State : int
+		{
+			Unloaded,
+			Decoding,
+			Decoded,
+			Uploaded,
+			Failed
+		};
+
+		SharedBuffer(const string& filename, SoundManager& manager);
 		~SharedBuffer();
 
+		string m_filename;
 		unique<SoundFileBuffer> m_file_buffer;
+		vector<char> m_pcm;
+
+		ALuint m_al_buffer = 0;
+
+		std::atomic<int> m_state = { Unloaded };
+
+		State state() const { return State(m_state.load(std::memory_order_acquire)); }
+
+		bool begin_decode();
+		void decode();
 
-		ALuint m_al_buffer;
+		// audio thread only
+		void upload();
+		void unload();
 
 		void use();
 		void release();
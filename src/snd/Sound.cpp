@@ -11,6 +11,8 @@
 
 #include <AL/al.h>
 
+#include <cmath>
+
 namespace two
 {
 	bool operator < (Sound::Priority& rhs, Sound::Priority& lhs)
@@ -52,7 +54,7 @@ namespace two
 
 		if(state == AL_STOPPED)
 		{
-			stop();
+			m_manager.stop(*this);
 			return;
 		}
 
@@ -60,6 +62,7 @@ namespace two
 		{
 			alSource3f(m_source, AL_POSITION, m_position.x, m_position.y, m_position.z);
 			alSource3f(m_source, AL_DIRECTION, m_direction.x, m_direction.y, m_direction.z);
+			alSource3f(m_source, AL_VELOCITY, m_velocity.x, m_velocity.y, m_velocity.z);
 			m_update_transform = false;
 		}
 
@@ -72,6 +75,25 @@ namespace two
 		update_fade(fTime);
 	}
 
+	void Sound::update_virtual(float fTime)
+	{
+		if(!m_pause_on_disactivate)
+		{
+			m_cursor += fTime * m_pitch;
+			if(m_cursor >= m_duration)
+			{
+				if(!m_loop || m_duration <= 0.f)
+				{
+					m_manager.stop(*this);
+					return;
+				}
+				m_cursor = fmod(m_cursor, m_duration);
+			}
+		}
+
+		update_fade(fTime);
+	}
+
 	void Sound::check_error()
 	{
 		alGetError();
@@ -99,14 +121,20 @@ namespace two
 		m_state = PLAYING;
 
 		if(m_active)
-		{
-			clear_buffers();
-			fill_buffers();
+			start_source();
+	}
 
+	void Sound::start_source()
+	{
+		// streams seek to the cursor before filling their buffers, static sounds once their buffer is attached
+		clear_buffers();
+		m_update_cursor = true;
+		fill_buffers();
+
+		if(m_update_cursor)
 			update_play_cursor();
 
-			alSourcePlay(m_source);
-		}
+		alSourcePlay(m_source);
 	}
 
 	void Sound::stop_impl()
@@ -115,6 +143,7 @@ namespace two
 			return;
 
 		m_state = STOPPED;
+		m_cursor = 0.f;
 
 		if(m_active)
 		{
@@ -137,7 +166,7 @@ namespace two
 		}
 	}
 
-	void Sound::set_play_cursor(float seconds)
+	void Sound::set_play_cursor_impl(float seconds)
 	{
 		m_cursor = seconds;
 		m_update_cursor = true;
@@ -172,30 +201,103 @@ namespace two
 
 	void Sound::set_position(const vec3& pos)
 	{
-		m_position = pos;
-		m_update_transform = true;
+		m_manager.update_position(*this, pos);
 	}
 
 	void Sound::set_direction(const vec3& dir)
 	{
-		m_direction = dir;
-		m_update_transform = true;
+		m_manager.update_direction(*this, dir);
 	}
 
 	void Sound::set_velocity(const vec3& vel)
 	{
-		m_velocity = vel;
-
-		if(m_active)
-			alSource3f(m_source, AL_VELOCITY, vel.x, vel.y, vel.z);
+		m_manager.update_velocity(*this, vel);
 	}
 
 	void Sound::set_loop(bool loop)
 	{
-		m_loop = loop;
+		m_manager.update_param(*this, LOOP, loop ? 1.f : 0.f);
 	}
 
 	void Sound::set_volume(float gain)
+	{
+		m_manager.update_param(*this, VOLUME, gain);
+	}
+
+	void Sound::set_max_volume(float maxGain)
+	{
+		m_manager.update_param(*this, MAX_VOLUME, maxGain);
+	}
+
+	void Sound::set_min_volume(float minGain)
+	{
+		m_manager.update_param(*this, MIN_VOLUME, minGain);
+	}
+
+	void Sound::set_cone_angles(float insideAngle, float outsideAngle)
+	{
+		m_manager.update_param(*this, CONE_ANGLES, insideAngle, outsideAngle);
+	}
+
+	void Sound::set_outer_cone_volume(float gain)
+	{
+		m_manager.update_param(*this, OUTER_CONE_VOLUME, gain);
+	}
+
+	void Sound::set_max_distance(float maxDistance)
+	{
+		m_manager.update_param(*this, MAX_DISTANCE, maxDistance);
+	}
+
+	void Sound::set_rolloff_factor(float rolloffFactor)
+	{
+		m_manager.update_param(*this, ROLLOFF_FACTOR, rolloffFactor);
+	}
+
+	void Sound::set_reference_distance(float referenceDistance)
+	{
+		m_manager.update_param(*this, REFERENCE_DISTANCE, referenceDistance);
+	}
+
+	void Sound::set_pitch(float pitch)
+	{
+		m_manager.update_param(*this, PITCH, pitch);
+	}
+
+	void Sound::set_play_cursor(float seconds)
+	{
+		m_manager.update_param(*this, PLAY_CURSOR, seconds);
+	}
+
+	void Sound::start_fade(bool fDir, float fadeTime, FadeControl actionOnComplete)
+	{
+		m_manager.fade_sound(*this, fDir, fadeTime, actionOnComplete);
+	}
+
+	void Sound::set_param_impl(Param param, float value, float second)
+	{
+		switch(param)
+		{
+		case VOLUME:				this->set_volume_impl(value); break;
+		case MAX_VOLUME:			this->set_max_volume_impl(value); break;
+		case MIN_VOLUME:			this->set_min_volume_impl(value); break;
+		case CONE_ANGLES:			this->set_cone_angles_impl(value, second); break;
+		case OUTER_CONE_VOLUME:		this->set_outer_cone_volume_impl(value); break;
+		case MAX_DISTANCE:			this->set_max_distance_impl(value); break;
+		case ROLLOFF_FACTOR:		this->set_rolloff_factor_impl(value); break;
+		case REFERENCE_DISTANCE:	this->set_reference_distance_impl(value); break;
+		case PITCH:					this->set_pitch_impl(value); break;
+		case LOOP:					this->set_loop_impl(value != 0.f); break;
+		case PLAY_CURSOR:			this->set_play_cursor_impl(value); break;
+		}
+	}
+
+	void Sound::set_loop_impl(bool loop)
+	{
+		m_loop = loop;
+	}
+
+	void Sound::set_volume_impl(float gain)
 	{
 		m_gain = gain;
 
@@ -203,7 +305,7 @@ namespace two
 			alSourcef(m_source, AL_GAIN, m_gain);
 	}
 
-	void Sound::set_max_volume(float maxGain)
+	void Sound::set_max_volume_impl(float maxGain)
 	{
 		m_max_gain = maxGain;
 
@@ -211,7 +313,7 @@ namespace two
 			alSourcef(m_source, AL_MAX_GAIN, m_max_gain);
 	}
 
-	void Sound::set_min_volume(float minGain)
+	void Sound::set_min_volume_impl(float minGain)
 	{
 		m_min_gain = minGain;
 
@@ -219,7 +321,7 @@ namespace two
 			alSourcef(m_source, AL_MIN_GAIN, m_min_gain);
 	}
 
-	void Sound::set_cone_angles(float insideAngle, float outsideAngle)
+	void Sound::set_cone_angles_impl(float insideAngle, float outsideAngle)
 	{
 		m_inner_cone_angle = insideAngle;
 		m_outer_cone_angle = outsideAngle;
@@ -231,7 +333,7 @@ namespace two
 		}
 	}
 
-	void Sound::set_outer_cone_volume(float gain)
+	void Sound::set_outer_cone_volume_impl(float gain)
 	{
 		m_outer_cone_gain = gain;
 
@@ -239,7 +341,7 @@ namespace two
 			alSourcef (m_source, AL_CONE_OUTER_GAIN, m_outer_cone_gain);
 	}
 
-	void Sound::set_max_distance(float maxDistance)
+	void Sound::set_max_distance_impl(float maxDistance)
 	{
 		m_max_distance = maxDistance;
 
@@ -247,7 +349,7 @@ namespace two
 			alSourcef(m_source, AL_MAX_DISTANCE, m_max_distance);
 	}
 
-	void Sound::set_rolloff_factor(float rolloffFactor)
+	void Sound::set_rolloff_factor_impl(float rolloffFactor)
 	{
 		m_rolloff_factor = rolloffFactor;
 
@@ -255,7 +357,7 @@ namespace two
 			alSourcef(m_source, AL_ROLLOFF_FACTOR, m_rolloff_factor);		
 	}
 
-	void Sound::set_reference_distance(float referenceDistance)
+	void Sound::set_reference_distance_impl(float referenceDistance)
 	{
 		m_reference_distance = referenceDistance;
 
@@ -263,7 +365,7 @@ namespace two
 			alSourcef(m_source, AL_REFERENCE_DISTANCE, m_reference_distance);		
 	}
 
-	void Sound::set_pitch(float pitch)
+	void Sound::set_pitch_impl(float pitch)
 	{
 		m_pitch = pitch;
 
@@ -300,20 +402,18 @@ namespace two
 		m_active = true;
 		m_source = src;
 		init_source();
-		fill_buffers();
 
-		if(m_pause_on_disactivate)
-		{
-			play_impl();
-		}
+		// a virtual voice resumes where its cursor is
+		if(m_state == PLAYING)
+			start_source();
 	}
 
 	ALuint Sound::release_source()
 	{
 		ALuint source = m_source;
 
-		if(m_state != STOPPED && m_pause_on_disactivate)
-			pause_impl();
+		if(m_state == PLAYING)
+			m_cursor = get_play_cursor();
 
 		alSourceStop(m_source);
 		clear_buffers();
@@ -323,7 +423,7 @@ namespace two
 		return source;
 	}
 
-	void Sound::start_fade(bool fDir, float fadeTime, FadeControl actionOnComplete)
+	void Sound::start_fade_impl(bool fDir, float fadeTime, FadeControl actionOnComplete)
 	{
 		m_fade =
 		{
@@ -336,7 +436,7 @@ namespace two
 		};
 
 		if(fDir == true && !is_playing())
-			play();
+			m_manager.play(*this);
 	}
 
 	void Sound::update_fade(float fTime)
@@ -346,18 +446,18 @@ namespace two
 		m_fade.m_timer += fTime;
 		if(m_fade.m_timer >= m_fade.m_time)
 		{
-			set_volume(m_fade.m_end_vol);
+			set_volume_impl(m_fade.m_end_vol);
 			m_fade.m_fade = false;
 
 			if(m_fade.m_end_action == FC_PAUSE)
-				pause(); 
+				m_manager.pause(*this);
 			else if(m_fade.m_end_action == FC_STOP)
-				stop(); 
+				m_manager.stop(*this);
 		}
 		else
 		{
 			float vol = (m_fade.m_end_vol - m_fade.m_init_vol) * (m_fade.m_timer / m_fade.m_time);
-			set_volume(m_fade.m_init_vol + vol);
+			set_volume_impl(m_fade.m_init_vol + vol);
 		}
 	}
 }
@@ -31,8 +31,8 @@ namespace two
 
 		struct Priority
 		{
-			uint8_t m_level;
-			float m_distance;
+			uint8_t m_level = 0;
+			float m_distance = 0.f;
 
 			friend bool operator<(Priority& rhs, Priority& lhs);
 		};
@@ -44,6 +44,22 @@ namespace two
 			FC_STOP		= 0x02
 		};
 
+		// the source parameters set from the game thread, applied by the audio thread
+		enum Param : uint8_t
+		{
+			VOLUME,
+			MAX_VOLUME,
+			MIN_VOLUME,
+			CONE_ANGLES,
+			OUTER_CONE_VOLUME,
+			MAX_DISTANCE,
+			ROLLOFF_FACTOR,
+			REFERENCE_DISTANCE,
+			PITCH,
+			LOOP,
+			PLAY_CURSOR
+		};
+
 	// Thread-Safe externals
 	public:
 		Sound(SoundImplementer& manager, SoundCallback callback = {});
@@ -53,14 +69,33 @@ namespace two
 		void stop();
 		void pause();
 
-		// @check : are these thread-safe ???
 		void set_direction(const vec3& dir);
 		void set_position(const vec3& pos);
 		void set_velocity(const vec3& vel);
 
+		void set_loop(bool loop);
+
+		void set_volume(float gain);
+		void set_max_volume(float maxGain);
+		void set_min_volume(float minGain);
+
+		void set_cone_angles(float insideAngle, float outsideAngle);
+		void set_outer_cone_volume(float gain);
+		void set_max_distance(float maxDistance);
+		void set_rolloff_factor(float rolloffFactor);
+		void set_reference_distance(float referenceDistance);
+
+		void set_pitch(float pitch);
+
+		void set_play_cursor(float seconds);
+
+		void start_fade(bool fDir, float fadeTime, FadeControl actionOnComplete = FC_NONE);
+
 	// Thread-Exclusive externals
 	public:
 		void update(float fTime);
+		// a playing sound without a source only advances its cursor, without any decoding or OpenAL call
+		void update_virtual(float fTime);
 
 		void play_impl();
 		void stop_impl();
@@ -70,39 +105,42 @@ namespace two
 		void disable_3D();
 		void update_3D();
 
-		virtual void set_loop(bool loop);
+		void set_param_impl(Param param, float value, float second);
 
-		void set_volume(float gain);
-		void set_max_volume(float maxGain);
-		void set_min_volume(float minGain);
+		virtual void set_loop_impl(bool loop);
 
-		void set_cone_angles(float insideAngle, float outsideAngle);
-		void set_outer_cone_volume(float gain);
-		void set_max_distance(float maxDistance);
-		void set_rolloff_factor(float rolloffFactor);
-		void set_reference_distance(float referenceDistance);
+		void set_volume_impl(float gain);
+		void set_max_volume_impl(float maxGain);
+		void set_min_volume_impl(float minGain);
 
-		void set_pitch(float pitch);
+		void set_cone_angles_impl(float insideAngle, float outsideAngle);
+		void set_outer_cone_volume_impl(float gain);
+		void set_max_distance_impl(float maxDistance);
+		void set_rolloff_factor_impl(float rolloffFactor);
+		void set_reference_distance_impl(float referenceDistance);
+
+		void set_pitch_impl(float pitch);
 
 		void assign_source(ALuint src);
 		ALuint release_source();
 
-		void set_play_cursor(float seconds);
+		void set_play_cursor_impl(float seconds);
 
-		void start_fade(bool fDir, float fadeTime, FadeControl actionOnComplete = FC_NONE);
+		void start_fade_impl(bool fDir, float fadeTime, FadeControl actionOnComplete = FC_NONE);
 
 	public:
 		inline bool is_playing() const { return m_state == PLAYING; }
 		inline bool is_paused() const { return m_state == PAUSED; }
 		inline bool is_stopped() const { return m_state == STOPPED; }
+		inline bool is_virtual() const { return m_state == PLAYING && !m_active; }
 
 	public:
 		virtual void open(const string& filename) { UNUSED(filename); }
 		virtual void open(SharedBuffer& buffer) { UNUSED(buffer); }
 
-	protected:
 		virtual void release() {}
 
+	protected:
 		virtual void fill_buffers() = 0;
 		virtual void clear_buffers() = 0;
 		virtual void update_buffers() = 0;
@@ -113,6 +151,7 @@ namespace two
 
 	protected:
 		void init_source();
+		void start_source();
 
 		void check_error();
 
@@ -124,9 +163,13 @@ namespace two
 
 		ALuint m_source = 0;			// OpenAL Source
 		Priority m_priority;			// Priority assigned to source
-		bool m_active = false;
-		bool m_pause_on_disactivate = false;
-
+		bool m_active = false;			// has a source : a playing sound without one is a virtual voice
+		bool m_pause_on_disactivate = false;	// a virtual voice keeps its cursor instead of advancing it
+		bool m_audible = false;			// selected for a source by the last voice update
+		float m_audibility = 0.f;		// estimated gain at the listener
+		bool m_loaded = false;			// opened on the audio thread : static sounds wait for their buffer to be decoded
+		bool m_play_on_load = false;	// play was requested before the sound was loaded
+		bool m_destroyed = false;
 		float m_gain = 1.f;				// Current volume
 		float m_pitch = 1.f;			// Current pitch 
 
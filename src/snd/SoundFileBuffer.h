@@ -7,9 +7,11 @@
 #include <snd/Sound.h>
 #include <snd/Forward.h>
 #include <stl/string.h>
+#include <stl/vector.h>
 
 namespace two
 {
+	// decodes a sound file to 16 bits pcm samples, without any OpenAL call, so that it can run on any thread
 	class TWO_SND_EXPORT SoundFileBuffer
 	{
 	public:
@@ -17,18 +19,22 @@ namespace two
 
 		string m_filename = "";
 		ALenum m_format = 0;
+		ALsizei m_rate = 0;
+		size_t m_chunk_size = 0;			// Size of a streaming chunk (250ms), block aligned
 		bool m_seekable = true;
 		bool m_mono = false;
 		ALfloat m_duration = 0.f;
 
-		virtual void open(const string& filename) = 0;
+		virtual bool open(const string& filename) = 0;
 		virtual void close() = 0;
 		virtual void reopen() = 0;
 
 		virtual void seek_time(float time) = 0;
 		virtual void seek_bytes(long pos) = 0;
 
-		virtual void fill(ALuint buffer) = 0;
-		virtual bool fill_chunk(ALuint buffer) = 0;
+		// decodes up to size bytes, returns the number of bytes decoded : less than size only at the end of the file
+		virtual size_t read(char* data, size_t size) = 0;
+		// decodes the whole file
+		virtual void decode(vector<char>& pcm) = 0;
 	};
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <snd/Forward.h>
+#include <snd/Sound.h>
 
 namespace two
 {
@@ -17,5 +18,14 @@ namespace two
 		virtual void destroy_sound(Sound& sound) = 0;
 
 		virtual void update_position(Sound& sound, const vec3& position) = 0;
+		virtual void update_direction(Sound& sound, const vec3& direction) = 0;
+		virtual void update_velocity(Sound& sound, const vec3& velocity) = 0;
+		virtual void update_param(Sound& sound, Sound::Param param, float value, float second = 0.f) = 0;
+		virtual void fade_sound(Sound& sound, bool fade_in, float time, Sound::FadeControl action) = 0;
+
+		// implementations, only called from the thread updating the sounds
+		virtual void play(Sound& sound) = 0;
+		virtual void pause(Sound& sound) = 0;
+		virtual void stop(Sound& sound) = 0;
 	};
 }
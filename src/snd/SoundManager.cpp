@@ -9,8 +9,12 @@
 #include <infra/File.h>
 #include <math/Vec.hpp>
 
+#include <infra/Thread.h>
+#include <jobs/Job.h>
+
 #include <AL/al.h>
 #include <AL/alc.h>
+#include <AL/alext.h>
 
 #include <snd/StaticSound.h>
 #include <snd/StreamSound.h>
@@ -21,10 +25,12 @@
 
 #include <cstdio>
 #include <cstring>
+#include <algorithm>
+#include <chrono>
 
 namespace two
 {
-#define QUEUE_LIST_SIZE 64
+#define QUEUE_LIST_SIZE 1024
 
 	bool openal_check_error()
 	{
@@ -56,12 +62,11 @@ namespace two
 		return errors;
 	}
 
-	SoundManager::SoundManager(const string& resource_path)
+	SoundManager::SoundManager(const string& resource_path, JobSystem* job_system)
 		: m_resource_path(resource_path)
-#ifdef SOUND_THREADED
-		, m_actions(QUEUE_LIST_SIZE)
-		, m_delayed_actions(500)
-#endif
+		, m_job_system(job_system)
+		, m_commands(QUEUE_LIST_SIZE)
+		, m_distance_model(AL_INVERSE_DISTANCE_CLAMPED)
 	{}
 
 	SoundManager::~SoundManager()
@@ -69,11 +74,19 @@ namespace two
 		if(m_context == 0)
 			return;
 
-		m_shutting_down = true;
-#ifdef SOUND_THREADED
-		//mUpdateThread->join();
-		//delete m_updateThread;
-#endif
+		if(m_threaded)
+		{
+			m_running.store(false, std::memory_order_release);
+			m_thread.join();
+		}
+
+		// the audio thread is gone : its state is released from here
+		this->process();
+
+		// decoding jobs hold on to the buffers
+		for(auto& buffer : m_shared_buffers)
+			while(buffer.second->state() == SharedBuffer::Decoding)
+				std::this_thread::yield();
 
 		this->release_all();
 
@@ -84,14 +97,16 @@ namespace two
 
 	void SoundManager::clear_sources()
 	{
-		alDeleteSources(m_max_sources, &m_source_pool[0]);
+		if(!m_source_pool.empty())
+			alDeleteSources(ALsizei(m_source_pool.size()), &m_source_pool[0]);
 		m_source_pool.clear();
 	}
 
 	void SoundManager::clear_sounds()
 	{
 		for(auto& sound : m_sounds)
-			this->release_active(*sound);
+			this->destroy(*sound);
+		this->flush_destroyed();
 
 		m_sounds.clear();
 		m_paused_sounds.clear();
@@ -111,7 +126,7 @@ namespace two
 		this->clear_sources();
 	}
 
-	bool SoundManager::init(const string& device_name, unsigned int max_sources)
+	bool SoundManager::init(const string& device_name, unsigned int max_sources, bool threaded)
 	{
 		printf("[info] Init Sound Manager\n");
 
@@ -122,19 +137,60 @@ namespace two
 
 		this->enum_devices();
 
+		// devices that are not enumerated can still be opened by name, e.g. the null output device of OpenAL Soft
 		string name = device_name;
-		if(!name.empty() && find(m_devices.begin(), m_devices.end(), name) != m_devices.end())
+		if(!name.empty())
 			m_device = alcOpenDevice(name.c_str());
-		else if(m_devices.size() > 0)
+		if(!m_device && m_devices.size() > 0)
 			m_device = alcOpenDevice(m_devices.front().c_str());
-		else
+		if(!m_device)
 			m_device = alcOpenDevice(NULL);
 
 		if(!m_device)
 			return false;
 		
 		ALCint attributes[] = { 0 };
+		return this->init_context(attributes, max_sources, threaded);
+	}
+
+	bool SoundManager::init_loopback(int frequency, unsigned int max_sources, bool threaded)
+	{
+		printf("[info] Init Sound Manager on a loopback device\n");
+
+		if(m_device)
+			return true;
+
+		if(!alcIsExtensionPresent(NULL, "ALC_SOFT_loopback"))
+		{
+			printf("[ERROR] snd - OpenAL - ALC_SOFT_loopback not supported\n");
+			return false;
+		}
+
+		LPALCLOOPBACKOPENDEVICESOFT open_loopback = (LPALCLOOPBACKOPENDEVICESOFT)alcGetProcAddress(NULL, "alcLoopbackOpenDeviceSOFT");
+		m_render_samples = alcGetProcAddress(NULL, "alcRenderSamplesSOFT");
+
+		m_device = open_loopback(NULL);
+		if(!m_device)
+			return false;
+
+		ALCint attributes[] =
+		{
+			ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+			ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+			ALC_FREQUENCY, frequency,
+			0
+		};
+		return this->init_context(attributes, max_sources, threaded);
+	}
+
+	void SoundManager::render(void* samples, int frames)
+	{
+		if(m_render_samples)
+			((LPALCRENDERSAMPLESSOFT)m_render_samples)(m_device, samples, frames);
+	}
 
+	bool SoundManager::init_context(const int* attributes, unsigned int max_sources, bool threaded)
+	{
 		m_context = alcCreateContext(m_device, attributes);
 		if(!m_context)
 			return false;
@@ -146,7 +202,12 @@ namespace two
 
 		m_max_sources = create_source_pool(max_sources);
 
-		//m_update_thread = std::make_unique<std::thread>([=] { this->update(); });
+		m_threaded = threaded;
+		if(threaded)
+		{
+			m_running.store(true, std::memory_order_release);
+			m_thread = std::thread([this] { this->run(); });
+		}
 
 		return true;
 	}
@@ -179,37 +240,84 @@ namespace two
 	void SoundManager::enum_devices()
 	{
 		const ALCchar* devices = alcGetString(NULL, ALC_DEVICE_SPECIFIER);
+		if(!devices)
+			return;
 
 		// devices is a list separated by null characters and a double null at the end
-		while(*devices != 0)
+		for(; *devices != 0; devices += strlen(devices) + 1)
 		{
 			ALCdevice* device = alcOpenDevice(devices);
-			if(openalc_check_error(device))
+			if(!device || openalc_check_error(device))
 				continue;
 
 			ALCcontext* context = alcCreateContext(device, NULL);
 			if(openalc_check_error(device))
+			{
+				alcCloseDevice(device);
 				continue;
+			}
 
 			alcMakeContextCurrent(context);
-			if(openalc_check_error(device))
-				continue;
-
-			m_devices.push_back(alcGetString(device, ALC_DEVICE_SPECIFIER));
+			if(!openalc_check_error(device))
+				m_devices.push_back(alcGetString(device, ALC_DEVICE_SPECIFIER));
 
 			alcMakeContextCurrent(NULL);
 			alcDestroyContext(context);
 
 			alcCloseDevice(device);
-
-			devices += strlen(devices) + 1;
 		}
 	}
 
+	void SoundManager::post(const SoundCommand& command)
+	{
+		// the ring is full when the audio thread falls behind : commands wait on the game thread rather than blocking it
+		if(m_overflow.empty() && m_commands.push(command))
+			return;
+		m_overflow.push_back(command);
+	}
+
+	void SoundManager::update()
+	{
+		if(!m_device)
+			return;
+
+		size_t flushed = 0;
+		while(flushed < m_overflow.size() && m_commands.push(m_overflow[flushed]))
+			++flushed;
+		m_overflow.erase(m_overflow.begin(), m_overflow.begin() + flushed);
+
+		if(!m_threaded)
+			this->process();
+	}
+
 	void SoundManager::set_master_volume(ALfloat vol)
 	{
 		m_volume = vol;
-		alListenerf(AL_GAIN, vol);
+		SoundCommand command = { SoundCommand::Volume };
+		command.m_value = vol;
+		this->post(command);
+	}
+
+	SharedBuffer& SoundManager::load_buffer(const string& filename)
+	{
+		auto find = m_shared_buffers.find(filename);
+		if(find == m_shared_buffers.end())
+			find = m_shared_buffers.insert({ filename, construct<SharedBuffer>(filename, *this) }).first;
+
+		SharedBuffer& buffer = *find->second;
+
+		// without a job system, or when no job is available, the audio thread decodes the buffer itself
+		if(m_job_system && buffer.begin_decode())
+		{
+			SharedBuffer* decode = &buffer;
+			Job* job = m_job_system->job(nullptr, [decode](JobSystem& js, Job* job) { UNUSED(js); UNUSED(job); decode->decode(); });
+			if(job)
+				m_job_system->run(job);
+			else
+				buffer.m_state.store(SharedBuffer::Unloaded, std::memory_order_release);
+		}
+
+		return buffer;
 	}
 
 	Sound* SoundManager::create_sound(const string& filename, bool loop, bool stream, SoundCallback callback)
@@ -228,259 +336,471 @@ namespace two
 		else
 			sound = construct<StaticSound>(*this, callback);
 
-		sound->set_loop(loop);
+		// the audio thread doesn't know the sound yet : it can be set up directly until the create command is posted
+		sound->m_loop = loop;
+		sound->m_name = path;
 
-		Sound& result = *sound;
-#ifdef SOUND_THREADED
-		this->add_action([&, sound = move(sound)]() mutable { this->create(move(sound), path.c_str(), stream); });
-#else
-		this->create(move(sound), path.c_str(), stream);
-#endif
-		return &result;
-	}
-
-	void SoundManager::create(unique<Sound> sound, const string& filename, bool stream)
-	{
-		//printf("creating sound Impl : " << filename );
-		m_inactive_sounds.push_back(&*sound);
+		SharedBuffer* buffer = stream ? nullptr : &this->load_buffer(path);
 
-		if(!stream)
-			sound->open(get_buffer(filename));
-		else
-			sound->open(filename);
-
-		m_sounds.push_back(move(sound));
-
-		//printf("done" );
+		// the audio thread takes ownership of the sound when it creates it
+		Sound* result = sound.release();
+		this->post({ SoundCommand::Create, result, buffer });
+		return result;
 	}
 
 	void SoundManager::stop_all_sounds()
 	{
-		this->add_action([&]() { this->stop_all(); });
+		this->post({ SoundCommand::StopAll });
 	}
 
 	void SoundManager::set_global_pitch(float pitch)
 	{
 		m_global_pitch = pitch;
-
-		this->add_action([&]() { this->set_pitch(); });
+		SoundCommand command = { SoundCommand::Pitch };
+		command.m_value = pitch;
+		this->post(command);
 	}
 
 	void SoundManager::pause_all_sounds()
 	{
-		this->add_action([&]() { this->pause_all(); });
+		this->post({ SoundCommand::PauseAll });
 	}
 
 	void SoundManager::resume_all_sounds()
 	{
-		this->add_action([&]() { this->resume_all(); });
+		this->post({ SoundCommand::ResumeAll });
 	}
 
 	void SoundManager::mute_all_sounds()
 	{
-		alGetListenerf(AL_GAIN, &m_volume);
-		alListenerf(AL_GAIN, 0.f);
+		this->post({ SoundCommand::Mute });
 	}
 
 	void SoundManager::unmute_all_sounds()
 	{
-		alListenerf(AL_GAIN, m_volume);
+		SoundCommand command = { SoundCommand::Unmute };
+		command.m_value = m_volume;
+		this->post(command);
 	}
 
 	void SoundManager::destroy_sound(Sound& sound)
 	{
-		add_action([&]() { this->destroy(sound); });
+		this->post({ SoundCommand::Destroy, &sound });
 	}
 
 	void SoundManager::set_distance_model(ALenum value)
 	{
-		alDistanceModel(value);
+		SoundCommand command = { SoundCommand::DistanceModel };
+		command.m_enum = value;
+		this->post(command);
 	}
 
 	void SoundManager::set_speed_of_sound(float speed)
 	{
-		alSpeedOfSound(speed);
+		SoundCommand command = { SoundCommand::SpeedOfSound };
+		command.m_value = speed;
+		this->post(command);
+	}
+
+	void SoundManager::set_audibility_threshold(float gain)
+	{
+		SoundCommand command = { SoundCommand::AudibilityThreshold };
+		command.m_value = gain;
+		this->post(command);
 	}
 
 	void SoundManager::set_doppler_factor(float factor)
 	{
-		alDopplerFactor(factor);
+		SoundCommand command = { SoundCommand::DopplerFactor };
+		command.m_value = factor;
+		this->post(command);
 	}
 
-	void SoundManager::update_active(Sound& sound)
+	void SoundManager::set_listener(const vec3& position, const vec3& front, const vec3& up)
 	{
-		this->release_active(sound);
-		this->queue_active(sound);
+		SoundCommand command = { SoundCommand::Listener };
+		command.m_vectors[0] = position;
+		command.m_vectors[1] = front;
+		command.m_vectors[2] = up;
+		this->post(command);
 	}
 
-	void SoundManager::queue_active(Sound& sound)
+	void SoundManager::update_position(Sound& sound, const vec3& position)
 	{
-		size_t index = 0;
-		while(index != m_active_sounds.size() && m_active_sounds[index]->m_priority < sound.m_priority) { ++index; }
+		SoundCommand command = { SoundCommand::Position, &sound };
+		command.m_vectors[0] = position;
+		this->post(command);
+	}
 
-		if(m_active_sounds.size() < m_max_sources)
-		{
-			sound.assign_source(pop(m_source_pool));
-		}
-		else if(index <= m_max_sources)
+	void SoundManager::update_direction(Sound& sound, const vec3& direction)
+	{
+		SoundCommand command = { SoundCommand::Direction, &sound };
+		command.m_vectors[0] = direction;
+		this->post(command);
+	}
+
+	void SoundManager::update_velocity(Sound& sound, const vec3& velocity)
+	{
+		SoundCommand command = { SoundCommand::Velocity, &sound };
+		command.m_vectors[0] = velocity;
+		this->post(command);
+	}
+
+	void SoundManager::update_param(Sound& sound, Sound::Param param, float value, float second)
+	{
+		SoundCommand command = { SoundCommand::Param, &sound };
+		command.m_enum = param;
+		command.m_value = value;
+		command.m_second = second;
+		this->post(command);
+	}
+
+	void SoundManager::fade_sound(Sound& sound, bool fade_in, float time, Sound::FadeControl action)
+	{
+		SoundCommand command = { SoundCommand::Fade, &sound };
+		command.m_enum = action;
+		command.m_value = time;
+		command.m_second = fade_in ? 1.f : 0.f;
+		this->post(command);
+	}
+
+	void SoundManager::play_sound(Sound& sound)
+	{
+		this->post({ SoundCommand::Play, &sound });
+	}
+
+	void SoundManager::pause_sound(Sound& sound)
+	{
+		this->post({ SoundCommand::Pause, &sound });
+	}
+
+	void SoundManager::stop_sound(Sound& sound)
+	{
+		this->post({ SoundCommand::Stop, &sound });
+	}
+
+	void SoundManager::run()
+	{
+		set_thread_name("SoundManager::run");
+
+		while(m_running.load(std::memory_order_acquire))
 		{
-			Sound& release = *m_active_sounds[m_max_sources-1];
-			sound.assign_source(release.release_source());
+			this->process();
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
 		}
+	}
+
+	void SoundManager::process()
+	{
+		SoundCommand command;
+		while(m_commands.pop(command))
+			this->execute(command);
 
-		m_active_sounds.insert(m_active_sounds.begin() + index, &sound);
+		this->update_loading();
+		this->update_sounds();
+		this->flush_destroyed();
 	}
 
-	void SoundManager::activate(Sound& sound)
+	void SoundManager::execute(const SoundCommand& command)
 	{
-		this->queue_active(sound);
-		remove(m_inactive_sounds, &sound);
+		Sound* sound = command.m_sound;
+		switch(command.m_type)
+		{
+		case SoundCommand::Create:			this->create(*sound, command.m_buffer); break;
+		case SoundCommand::Destroy:			this->destroy(*sound); break;
+		case SoundCommand::Play:			this->play(*sound); break;
+		case SoundCommand::Stop:			this->stop(*sound); break;
+		case SoundCommand::Pause:			this->pause(*sound); break;
+		case SoundCommand::StopAll:			this->stop_all(); break;
+		case SoundCommand::PauseAll:		this->pause_all(); break;
+		case SoundCommand::ResumeAll:		this->resume_all(); break;
+		case SoundCommand::Volume:			alListenerf(AL_GAIN, command.m_value); break;
+		case SoundCommand::Pitch:			this->set_pitch(command.m_value); break;
+		case SoundCommand::Mute:			alListenerf(AL_GAIN, 0.f); break;
+		case SoundCommand::Unmute:			alListenerf(AL_GAIN, command.m_value); break;
+		case SoundCommand::DistanceModel:	alDistanceModel(command.m_enum); m_distance_model = command.m_enum; break;
+		case SoundCommand::DopplerFactor:	alDopplerFactor(command.m_value); break;
+		case SoundCommand::SpeedOfSound:	alSpeedOfSound(command.m_value); break;
+		case SoundCommand::AudibilityThreshold:	m_audibility_threshold = command.m_value; break;
+		case SoundCommand::Listener:
+			m_listener.set_transform(command.m_vectors[0], command.m_vectors[1], command.m_vectors[2]);
+			break;
+		case SoundCommand::Position:
+			sound->m_position = command.m_vectors[0];
+			sound->m_update_transform = true;
+			break;
+		case SoundCommand::Direction:
+			sound->m_direction = command.m_vectors[0];
+			sound->m_update_transform = true;
+			break;
+		case SoundCommand::Velocity:
+			sound->m_velocity = command.m_vectors[0];
+			sound->m_update_transform = true;
+			break;
+		case SoundCommand::Param:
+			sound->set_param_impl(Sound::Param(command.m_enum), command.m_value, command.m_second);
+			break;
+		case SoundCommand::Fade:
+			sound->start_fade_impl(command.m_second != 0.f, command.m_value, Sound::FadeControl(command.m_enum));
+			break;
+		case SoundCommand::None:
+			break;
+		}
 	}
 
-	void SoundManager::release_active(Sound& sound)
+	void SoundManager::create(Sound& sound, SharedBuffer* buffer)
 	{
-		if(m_sounds.size() <= m_max_sources)
+		m_sounds.push_back(unique<Sound>(&sound));
+
+		if(buffer)
 		{
-			m_source_pool.push_back(sound.release_source());
+			m_loading.push_back({ &sound, buffer });
+			return;
 		}
-		else
+
+		sound.open(sound.m_name);
+		sound.m_loaded = true;
+		m_inactive_sounds.push_back(&sound);
+	}
+
+	void SoundManager::update_loading()
+	{
+		for(size_t i = 0; i < m_loading.size();)
 		{
-			Sound& assign = *m_active_sounds[m_max_sources-1];
-			assign.assign_source(sound.release_source());
+			Sound& sound = *m_loading[i].m_sound;
+			SharedBuffer& buffer = *m_loading[i].m_buffer;
+
+			// a buffer released and reloaded in between is decoded here, off the game thread
+			if(buffer.state() == SharedBuffer::Unloaded && buffer.begin_decode())
+				buffer.decode();
+			if(buffer.state() == SharedBuffer::Decoded)
+				buffer.upload();
+
+			const SharedBuffer::State state = buffer.state();
+			if(state == SharedBuffer::Decoding)
+			{
+				++i;
+				continue;
+			}
+
+			m_loading.erase(m_loading.begin() + i);
+
+			if(state == SharedBuffer::Failed)
+			{
+				printf("[ERROR] Could not decode sound file %s\n", buffer.m_filename.c_str());
+				this->destroy(sound);
+				continue;
+			}
+
+			sound.open(buffer);
+			sound.m_loaded = true;
+			m_inactive_sounds.push_back(&sound);
+
+			if(sound.m_play_on_load)
+				this->play(sound);
 		}
 	}
 
-	void SoundManager::disactivate(Sound& sound)
+	void SoundManager::activate(Sound& sound)
 	{
-		this->release_active(sound);
-		m_inactive_sounds.push_back(&sound);
+		if(sound.m_active || m_source_pool.empty())
+			return;
+
+		sound.assign_source(pop(m_source_pool));
+		m_active_sounds.push_back(&sound);
+		remove(m_inactive_sounds, &sound);
 	}
 
-	void SoundManager::update_position(Sound& sound, const vec3& position)
+	void SoundManager::release_active(Sound& sound)
 	{
-		sound.m_priority.m_distance = distance(position, m_listener.m_position);
-		m_update_queue.push_back(&sound);
+		m_source_pool.push_back(sound.release_source());
+		remove(m_active_sounds, &sound);
 	}
 
-	void SoundManager::destroy(Sound& sound)
+	void SoundManager::disactivate(Sound& sound)
 	{
-		//printf("destroying sound " );
 		if(sound.m_active)
 			this->release_active(sound);
-		else
-			remove(m_inactive_sounds, &sound);
+		add(m_inactive_sounds, &sound);
+	}
 
-		if(sound.is_paused())
-			remove(m_paused_sounds, &sound);
+	static float distance_gain(int model, float distance, float reference, float range, float rolloff)
+	{
+		// the attenuation models of the OpenAL specification
+		const bool clamped = model == AL_INVERSE_DISTANCE_CLAMPED || model == AL_LINEAR_DISTANCE_CLAMPED || model == AL_EXPONENT_DISTANCE_CLAMPED;
+		if(clamped)
+			distance = range < reference ? reference : clamp(distance, reference, range);
+
+		switch(model)
+		{
+		case AL_INVERSE_DISTANCE:
+		case AL_INVERSE_DISTANCE_CLAMPED:
+			return reference / max(reference + rolloff * (distance - reference), 0.0001f);
+		case AL_LINEAR_DISTANCE:
+		case AL_LINEAR_DISTANCE_CLAMPED:
+			return range > reference ? clamp(1.f - rolloff * (min(distance, range) - reference) / (range - reference), 0.f, 1.f) : 1.f;
+		case AL_EXPONENT_DISTANCE:
+		case AL_EXPONENT_DISTANCE_CLAMPED:
+			return distance > 0.f && reference > 0.f ? pow(distance / reference, -rolloff) : 1.f;
+		default:
+			return 1.f;
+		}
 	}
 
-	void SoundManager::play_sound(Sound& sound)
+	float SoundManager::audibility(Sound& sound) const
 	{
-		this->add_action([&] { this->play(sound); });
+		const float dist = sound.m_source_relative ? length(sound.m_position) : distance(sound.m_position, m_listener.m_position);
+		sound.m_priority.m_distance = dist;
+
+		// sounds out of range are culled, even where the clamped models would keep them faintly audible
+		if(dist > sound.m_max_distance)
+			return 0.f;
+
+		const float gain = sound.m_gain * distance_gain(m_distance_model, dist, sound.m_reference_distance, sound.m_max_distance, sound.m_rolloff_factor);
+		return clamp(gain, sound.m_min_gain, sound.m_max_gain);
 	}
 
-	void SoundManager::pause_sound(Sound& sound)
+	void SoundManager::update_voices()
+	{
+		// a real voice is only replaced by a clearly more important one, so that sources don't flip between close candidates
+		static const float c_hysteresis = 1.25f;
+
+		m_voices.clear();
+
+		for(auto& sound : m_sounds)
+		{
+			sound->m_audible = false;
+			if(!sound->m_loaded || sound->m_destroyed || !sound->is_playing())
+				continue;
+
+			sound->m_audibility = this->audibility(*sound);
+			if(sound->m_audibility < m_audibility_threshold)
+				continue;
+
+			float score = sound->m_audibility * float(1 + sound->m_priority.m_level);
+			if(sound->m_active)
+				score *= c_hysteresis;
+			m_voices.push_back({ sound.get(), score });
+		}
+
+		const size_t count = min(m_voices.size(), size_t(m_max_sources));
+		if(count < m_voices.size())
+			std::nth_element(m_voices.begin(), m_voices.begin() + count, m_voices.end(), [](const Voice& a, const Voice& b) { return a.m_score > b.m_score; });
+
+		for(size_t i = 0; i < count; ++i)
+			m_voices[i].m_sound->m_audible = true;
+
+		// sources are released before they are assigned, so that the pool always has one for each selected sound
+		vector<Sound*> active = m_active_sounds;
+		for(Sound* sound : active)
+			if(!sound->m_audible)
+				this->disactivate(*sound);
+
+		for(size_t i = 0; i < count; ++i)
+			this->activate(*m_voices[i].m_sound);
+	}
+
+	void SoundManager::destroy(Sound& sound)
 	{
-		this->add_action([&] { this->pause(sound); });
+		// destruction is deferred to the end of the update, as sounds destroy themselves while being updated
+		if(sound.m_destroyed)
+			return;
+
+		sound.m_destroyed = true;
+		m_destroyed.push_back(&sound);
 	}
 
-	void SoundManager::stop_sound(Sound& sound)
+	void SoundManager::flush_destroyed()
 	{
-		this->add_action([&] { this->stop(sound); });
+		for(Sound* sound : m_destroyed)
+		{
+			//printf("destroying sound " );
+			if(sound->m_active)
+				this->release_active(*sound);
+
+			remove(m_inactive_sounds, sound);
+			remove(m_paused_sounds, sound);
+			remove_if(m_loading, [&](const Loading& loading) { return loading.m_sound == sound; });
+
+			sound->release();
+			remove_pt(m_sounds, *sound);
+		}
+		m_destroyed.clear();
 	}
 
 	void SoundManager::play(Sound& sound)
 	{
-		this->activate(sound);
+		if(!sound.m_loaded)
+		{
+			sound.m_play_on_load = true;
+			return;
+		}
+
+		remove(m_paused_sounds, &sound);
 		sound.play_impl();
+		m_update_voices = true;
 	}
 
 	void SoundManager::pause(Sound& sound)
 	{
+		sound.m_play_on_load = false;
+		if(!sound.m_loaded)
+			return;
+
 		sound.pause_impl();
-		m_paused_sounds.push_back(&sound);
+		add(m_paused_sounds, &sound);
 		this->disactivate(sound);
+		m_update_voices = true;
 	}
 
 	void SoundManager::stop(Sound& sound)
 	{
+		sound.m_play_on_load = false;
+		if(!sound.m_loaded)
+			return;
+
 		sound.stop_impl();
 		this->disactivate(sound);
+		m_update_voices = true;
 
 		if(sound.m_temporary)
-			this->destroy_sound(sound);
+			this->destroy(sound);
 	}
 
 	void SoundManager::stop_all()
 	{
-		for(Sound* sound : m_active_sounds)
-			this->stop(*sound);
+		// virtual voices are stopped too, and temporary sounds destroy themselves only after the update
+		for(auto& sound : m_sounds)
+			if(!sound->is_stopped() || sound->m_play_on_load)
+				this->stop(*sound);
 	}
 
 	void SoundManager::pause_all()
 	{
-		for(Sound* sound : m_active_sounds)
-			this->pause(*sound);
+		for(auto& sound : m_sounds)
+			if(sound->is_playing() || sound->m_play_on_load)
+				this->pause(*sound);
 	}
 
 	void SoundManager::resume_all()
 	{
-		for(Sound* sound : m_paused_sounds)
+		vector<Sound*> sounds = m_paused_sounds;
+		for(Sound* sound : sounds)
 			this->play(*sound);
 	}
 
-	void SoundManager::set_pitch()
+	void SoundManager::set_pitch(float pitch)
 	{
 		for(auto& sound : m_sounds)
-			sound->set_pitch(m_global_pitch);
-	}
-
-	SharedBuffer& SoundManager::create_buffer(const string& filename)
-	{
-		m_shared_buffers[filename] = make_unique<SharedBuffer>(filename, *this);
-		return *m_shared_buffers[filename];
-	}
-
-	SharedBuffer& SoundManager::get_buffer(const string& filename)
-	{
-		auto find = m_shared_buffers.find(filename);
-		if(find != m_shared_buffers.end())
-			return *(*find).second;
-		else
-			return this->create_buffer(filename);
+			sound->set_pitch_impl(pitch);
 	}
 
 	void SoundManager::release_buffer(SharedBuffer& buffer)
 	{
-		m_shared_buffers.erase(m_shared_buffers.find(buffer.m_file_buffer->m_filename));
-	}
-
-	void SoundManager::add_action(const SoundAction& action)
-	{
-#ifndef SOUND_THREADED
-		action();
-#else
-		if(!m_actions.push(action))
-			m_delayed_actions.push(action);
-#endif
+		// the buffer stays known to the game thread : it is decoded again the next time it's used
+		buffer.unload();
 	}
 
-#ifdef SOUND_THREADED
-	void SoundManager::process_actions()
-	{
-		int i = 0;
-		function<void ()> action;
-
-		if(!m_actions.empty())
-			while(((++i) < 5) && m_actions.pop(action))
-				action();
-
-		if(!m_delayed_actions.empty())
-			while(((++i) < 5) && m_delayed_actions.pop(action))
-				action();
-	}
-#endif
-
 	void SoundManager::update_sounds()
 	{
 		double time_step = m_clock.read();
@@ -488,26 +808,25 @@ namespace two
 		//while(openal_check_error());
 
 		m_listener.update();
-		
-		for(auto& sound : m_sounds)
-			sound->update(float(time_step));
 
-		m_clock.update();
-	}
+		// voices are ranked again at a fixed interval, or as soon as a sound starts or stops
+		m_voices_time += time_step;
+		if(m_update_voices || m_voices_time >= 0.05)
+		{
+			this->update_voices();
+			m_update_voices = false;
+			m_voices_time = 0.0;
+		}
 
-	void SoundManager::update()
-	{
-		if(!m_device)
-			return;
+		for(auto& sound : m_sounds)
+		{
+			if(sound->m_active)
+				sound->update(float(time_step));
+			else if(sound->is_virtual())
+				sound->update_virtual(float(time_step));
+		}
 
-		//while(!m_shutting_down)
-		//{
-			this->update_sounds();
-#ifdef SOUND_THREADED
-			this->process_actions();
-#endif
-			//std::this_thread::sleep(std::posix_time::milliseconds(10));
-		//}
+		m_clock.update();
 	}
 
 	void SoundManager::log_features()
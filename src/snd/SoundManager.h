@@ -4,12 +4,12 @@
 
 #pragma once
 
-#include <stl/function.h>
 #include <stl/string.h>
 #include <stl/vector.h>
 #include <stl/memory.h>
 #include <stl/map.h>
 #include <type/Unique.h>
+#include <type/Util/LocklessQueue.h>
 #include <math/Timer.h>
 #include <math/Vec.h>
 #include <snd/Forward.h>
@@ -17,33 +17,83 @@
 #include <snd/SoundListener.h>
 #include <snd/Sound.h>
 
-#ifdef SOUND_THREADED
-#include <type/Util/LocklessQueue.h>
-//#include <thread>
-//#include <memory>
-#endif
+#include <atomic>
+#include <thread>
 
 namespace two
 {
+	class JobSystem;
+
+	// called when a sound is destroyed, on the audio thread
 	using SoundCallback = void(*)(Sound&);
 
 	bool openal_check_error();
 
+	// a request from the game thread to the audio thread : commands are plain values, so that posting one never allocates
+	struct SoundCommand
+	{
+		enum Type : uint8_t
+		{
+			None,
+			Create,
+			Destroy,
+			Play,
+			Stop,
+			Pause,
+			StopAll,
+			PauseAll,
+			ResumeAll,
+			Volume,
+			Pitch,
+			Mute,
+			Unmute,
+			Position,
+			Direction,
+			Velocity,
+			Param,
+			Fade,
+			Listener,
+			DistanceModel,
+			DopplerFactor,
+			SpeedOfSound,
+			AudibilityThreshold
+		};
+
+		Type m_type = None;
+		Sound* m_sound = nullptr;
+		SharedBuffer* m_buffer = nullptr;
+		vec3 m_vectors[3];
+		float m_value = 0.f;
+		float m_second = 0.f;		// the outer cone angle, or the direction of a fade
+		int m_enum = 0;
+	};
+
+	// playing sounds compete for the limited OpenAL sources : each voice update gives them to the most important audible sounds,
+	// ranked by priority level and estimated gain at the listener. the others are virtual voices, which only advance their cursor
+
+	// once initialized, all OpenAL calls are made by the audio thread, which owns the sounds and their sources :
+	// the game thread only posts commands to it through a single producer single consumer ring, and never blocks on it
+	// static sounds are decoded by jobs when a job system is given, streams are decoded ahead of playback by the audio thread
 	class TWO_SND_EXPORT SoundManager : public SoundImplementer
 	{
 	public:
-		using SoundAction = function<void()>;
 		using SourceVector = vector<ALuint>;
 
 		// Thread-safe interface
 	public:
-		SoundManager(const string& resource_path = "");
+		SoundManager(const string& resource_path = "", JobSystem* job_system = nullptr);
 		~SoundManager();
 
 		SoundManager(const SoundManager& other) = delete;
 		SoundManager& operator=(const SoundManager& other) = delete;
 
-		bool init(const string& device_name = "", unsigned int max_sources = 100);
+		// with threaded = false, no audio thread is started, and update() does the audio work on the calling thread
+		bool init(const string& device_name = "", unsigned int max_sources = 100, bool threaded = true);
+
+		// a device that doesn't output anything but renders on demand with render(), for testing (requires ALC_SOFT_loopback)
+		bool init_loopback(int frequency = 44100, unsigned int max_sources = 100, bool threaded = true);
+		// renders interleaved 16 bits stereo samples from a loopback device
+		void render(void* samples, int frames);
 
 		Sound* create_sound(const string& file, bool loop = false, bool stream = false, SoundCallback callback = {});
 
@@ -54,6 +104,10 @@ namespace two
 		void set_distance_model(ALenum value);
 		void set_doppler_factor(float factor = 1.f);
 		void set_speed_of_sound(float speed = 363.f);
+		// sounds with a lower estimated gain at the listener are culled : they play as virtual voices
+		void set_audibility_threshold(float gain = 0.001f);
+
+		void set_listener(const vec3& position, const vec3& front, const vec3& up);
 
 	public:
 		void play_sound(Sound& sound);
@@ -62,6 +116,10 @@ namespace two
 		void destroy_sound(Sound& sound);
 
 		void update_position(Sound& sound, const vec3& position);
+		void update_direction(Sound& sound, const vec3& direction);
+		void update_velocity(Sound& sound, const vec3& velocity);
+		void update_param(Sound& sound, Sound::Param param, float value, float second = 0.f);
+		void fade_sound(Sound& sound, bool fade_in, float time, Sound::FadeControl action);
 
 		void stop_all_sounds();
 		void pause_all_sounds();
@@ -69,66 +127,73 @@ namespace two
 		void unmute_all_sounds();
 		void resume_all_sounds();
 
+		// called once per frame by the game thread
+		void update();
+
 	private:
 		void enum_devices();
+		bool init_context(const int* attributes, unsigned int max_sources, bool threaded);
 		int create_source_pool(int numSources);
 
+		void post(const SoundCommand& command);
+
 		void clear_sounds();
 		void clear_sources();
 		void clear_buffers();
 		void release_all();
 
+		SharedBuffer& load_buffer(const string& filename);
+
 	// Thread-safe implementation to be executed by one same unique thread
 	public:
-		void update();
+		void process();
 
-		void create(unique<Sound> sound, const string& filename, bool stream);
+		void create(Sound& sound, SharedBuffer* buffer);
 		void destroy(Sound& sound);
 
 		void play(Sound& sound);
 		void stop(Sound& sound);
 		void pause(Sound& sound);
 
-		void set_pitch();
+		void set_pitch(float pitch);
 
 		void stop_all();
 		void pause_all();
 		void resume_all();
 
 	private:
-		void update_active(Sound& sound);
+		void run();
+		void execute(const SoundCommand& command);
+
 		void release_active(Sound& sound);
-		void queue_active(Sound& sound);
-		
+
 		void activate(Sound& sound);
 		void disactivate(Sound& sound);
 
+		float audibility(Sound& sound) const;
+		void update_voices();
+
 		void log_features();
 
+		void update_loading();
+		void update_sounds();
+		void flush_destroyed();
+
 	public:
-		SharedBuffer& create_buffer(const string& filename);
-		SharedBuffer& get_buffer(const string& filename);
 		void release_buffer(SharedBuffer& buffer);
 
-	private:
-		void add_action(const SoundAction& action);
-
-		void update_sounds();
-
-#ifdef SOUND_THREADED
-		void process_actions();
-#endif
 	private:
 		string m_resource_path;
+		JobSystem* m_job_system = nullptr;
 
-#ifdef SOUND_THREADED
-		//std::unique_ptr<std::thread> m_update_thread = nullptr;
+		LocklessQueue<SoundCommand> m_commands;
+		vector<SoundCommand> m_overflow;		// commands that didn't fit in the ring, owned by the game thread, retried in order
 
-		LocklessQueue<SoundAction> m_actions;
-		LocklessQueue<SoundAction> m_delayed_actions;
-#endif
+		std::thread m_thread;
+		std::atomic<bool> m_running = { false };
+		bool m_threaded = false;
 
-		bool m_shutting_down = false;
+		void* m_render_samples = nullptr;		// alcRenderSamplesSOFT, for loopback devices
 
 	public:
 		vector<string> m_devices;			// List of available devices strings
@@ -137,20 +202,38 @@ namespace two
 
 		ALfloat	m_volume = 1.f;					// Main Volume
 		float m_global_pitch = 1.f;				// Global pitch modifier
-		SoundListener m_listener;				// Listener object
+		SoundListener m_listener;				// Listener object, owned by the audio thread : use set_listener()
 
 	private:
-		vector<unique<Sound>> m_sounds;			// list of all sounds : m_sounds.begin() to m_sounds[m_max_sources] are active
-		vector<Sound*> m_active_sounds;
+		struct Loading
+		{
+			Sound* m_sound;
+			SharedBuffer* m_buffer;
+		};
+
+		vector<unique<Sound>> m_sounds;			// list of all sounds
+		vector<Sound*> m_active_sounds;			// sounds with a source
 		vector<Sound*> m_inactive_sounds;
 		vector<Sound*> m_paused_sounds;				// list of sounds currently paused
-
-		vector<Sound*> m_update_queue;
+		vector<Loading> m_loading;				// static sounds waiting for their buffer
+		vector<Sound*> m_destroyed;				// destroyed during the update, deleted after it
 
 		unsigned int m_max_sources = 100;		// Maximum Number of sources to allocate
 		SourceVector m_source_pool;				// List of available sources
 
-		map<string, unique<SharedBuffer>> m_shared_buffers;
+		struct Voice
+		{
+			Sound* m_sound;
+			float m_score;
+		};
+
+		vector<Voice> m_voices;					// candidates of the last voice update
+		bool m_update_voices = false;			// a sound started or stopped : voices are updated without waiting for the interval
+		double m_voices_time = 0.0;
+		int m_distance_model = 0;				// mirrors the OpenAL distance model, to estimate gains
+		float m_audibility_threshold = 0.001f;	// -60 dB
+
+		map<string, unique<SharedBuffer>> m_shared_buffers;	// owned by the game thread, which starts the decoding
 
 		Clock m_clock;
 	};
@@ -21,7 +21,7 @@ namespace two
 
 	void StaticSound::open(SharedBuffer& buffer)
 	{
-		m_name = buffer.m_file_buffer->m_filename;
+		m_name = buffer.m_filename;
 		m_buffer = &buffer;
 		m_buffer->use();
 		m_duration = buffer.m_file_buffer->m_duration;
@@ -31,7 +31,9 @@ namespace two
 
 	void StaticSound::release()
 	{
-		m_buffer->release();
+		if(m_buffer)
+			m_buffer->release();
+		m_buffer = nullptr;
 	}
 
 	void StaticSound::update_buffers()
@@ -66,9 +68,9 @@ namespace two
 		return cursor;
 	}
 
-	void StaticSound::set_loop(bool loop)
+	void StaticSound::set_loop_impl(bool loop)
 	{
-		Sound::set_loop(loop);
+		Sound::set_loop_impl(loop);
 
 		if(m_active)
 			alSourcei(m_source, AL_LOOPING, loop);
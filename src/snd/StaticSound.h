@@ -26,7 +26,7 @@ namespace two
 		virtual void update_play_cursor() override;
 		virtual ALfloat get_play_cursor() override;
 
-		void set_loop(bool loop);
+		virtual void set_loop_impl(bool loop) override;
 
 	private:
 		SharedBuffer* m_buffer;
@@ -9,70 +9,90 @@
 
 #include <AL/al.h>
 
+#include <cstdio>
+
 namespace two
 {
-#define NUM_BUFFERS 3
-
 	StreamSound::StreamSound(SoundImplementer& manager, SoundCallback callback)
 		: Sound(manager, callback)
-		, m_numBuffers(NUM_BUFFERS)
-		, m_aLBuffers(m_numBuffers)
-		, m_lastOffset(0)
 	{
 		m_stream = true;
 	}
 
+	StreamSound::~StreamSound()
+	{}
+
 	void StreamSound::open(const string& filename)
 	{
 		//printf("opening stream sound" );
+		m_name = filename;
 
-		for(int i=0; i < m_numBuffers; i++)
-		{
-			m_aLBuffers[i] = AL_NONE;
-		}
-
-		alGenBuffers(m_numBuffers, &m_aLBuffers[0]);
+		alGenBuffers(ALsizei(c_num_buffers), m_al_buffers);
 
 		string name = filename;
 		if(name.find(".ogg") != name.npos || name.find(".OGG") != name.npos)
 			m_buffer = make_unique<OggFileBuffer>();
 
-		m_buffer->open(filename);
+		if(!m_buffer || !m_buffer->open(filename))
+		{
+			printf("[ERROR] Could not decode sound file %s\n", filename.c_str());
+			return;
+		}
+
+		m_chunk.resize(m_buffer->m_chunk_size);
 		m_duration = m_buffer->m_duration;
 		m_seekable = m_buffer->m_seekable;
 		m_mono = m_buffer->m_mono;
 	}
 
-	StreamSound::~StreamSound()
-	{}
-
-	void StreamSound::setup()
-	{
-
-	}
-
 	void StreamSound::release()
 	{
-		for(int i = 0; i < m_numBuffers; i++)
+		for(size_t i = 0; i < c_num_buffers; i++)
 		{
-			if(m_aLBuffers[i] != AL_NONE)
-				alDeleteBuffers(1, &m_aLBuffers[i]);
+			if(m_al_buffers[i] != AL_NONE)
+				alDeleteBuffers(1, &m_al_buffers[i]);
+			m_al_buffers[i] = AL_NONE;
 		}
 	}
 
-	void StreamSound::rewind()
+	void StreamSound::rewind_file()
 	{
 		if(m_buffer->m_seekable)
-		{
 			m_buffer->seek_time(0);
-			m_cursor = 0;
-		}
 		else
-		{
 			m_buffer->reopen();
+	}
+
+	void StreamSound::rewind()
+	{
+		if(!m_buffer)
+			return;
+
+		this->rewind_file();
+		m_cursor = 0;
+		m_last_offset = 0;
+	}
+
+	bool StreamSound::queue_chunk(ALuint buffer)
+	{
+		if(!m_buffer || m_chunk.empty())
+			return false;
+
+		size_t size = m_buffer->read(m_chunk.data(), m_chunk.size());
+
+		// a looping stream wraps around inside the chunk, so that there is no gap at the loop point
+		if(size < m_chunk.size() && m_loop)
+		{
+			this->rewind_file();
+			size += m_buffer->read(m_chunk.data() + size, m_chunk.size() - size);
 		}
 
-		m_lastOffset = 0;
+		if(size == 0)
+			return false;
+
+		alBufferData(buffer, m_buffer->m_format, m_chunk.data(), ALsizei(size), m_buffer->m_rate);
+		alSourceQueueBuffers(m_source, 1, &buffer);
+		return true;
 	}
 
 	void StreamSound::update_buffers()
@@ -93,29 +113,21 @@ namespace two
 			alGetBufferi(buffer, AL_CHANNELS, &channels);
 			alGetBufferi(buffer, AL_FREQUENCY, &freq);    
 
-			m_lastOffset += ((ALuint)size/channels/(bits/8)) / (ALfloat)freq;
-
-			bool ended = m_buffer->fill_chunk(buffer);
+			m_last_offset += ((ALuint)size/channels/(bits/8)) / (ALfloat)freq;
 
-			if(ended && m_loop)
-				rewind();
-
-			alSourceQueueBuffers(m_source, 1, &buffer);
+			// once the end is reached, buffers are left unqueued : the source stops when the last one is played
+			this->queue_chunk(buffer);
 		}
 	}
 
 	void StreamSound::fill_buffers()
 	{
-		int i = 0;
-		while(i < NUM_BUFFERS)
-		{
-			bool active = m_buffer->fill_chunk(m_aLBuffers[i]);
+		if(m_update_cursor)
+			this->update_play_cursor();
 
-			if(active)
-				alSourceQueueBuffers(m_source, 1, &m_aLBuffers[i++]);
-			else
+		for(size_t i = 0; i < c_num_buffers; ++i)
+			if(!this->queue_chunk(m_al_buffers[i]))
 				break;
-		}
 	}
 
 	void StreamSound::clear_buffers()
@@ -134,11 +146,11 @@ namespace two
 
 	void StreamSound::update_play_cursor()
 	{
-		if(m_buffer->m_seekable)
+		if(m_buffer && m_buffer->m_seekable)
 			m_buffer->seek_time(m_cursor);
 
 		m_update_cursor = false;
-		m_lastOffset = m_cursor;
+		m_last_offset = m_cursor;
 	}
 
 	ALfloat StreamSound::get_play_cursor()
@@ -146,9 +158,9 @@ namespace two
 		ALfloat pos;
 		alGetSourcef(m_source, AL_SEC_OFFSET, &pos);
 
-		if((m_lastOffset + pos) >= m_duration) 
-			return (m_lastOffset + pos) - m_duration;
+		if((m_last_offset + pos) >= m_duration) 
+			return (m_last_offset + pos) - m_duration;
 		else
-			return m_lastOffset + pos;
+			return m_last_offset + pos;
 	}
 }
@@ -12,14 +12,15 @@
 
 namespace two
 {
+	// a sound decoded chunk by chunk on the audio thread, ahead of playback, into a fixed ring of OpenAL buffers
 	class StreamSound : public Sound
 	{
 	public:
+		static constexpr size_t c_num_buffers = 4;
+
 		StreamSound(SoundImplementer& manager, SoundCallback callback = {});
 		~StreamSound();
 
-		void setup();
-
 		virtual void open(const string& filename) override;
 		virtual void release() override;
 
@@ -32,10 +33,13 @@ namespace two
 		virtual ALfloat get_play_cursor() override;
 
 	private:
-		int m_numBuffers;
-		vector<ALuint> m_aLBuffers;
+		bool queue_chunk(ALuint buffer);
+		void rewind_file();
+
+		ALuint m_al_buffers[c_num_buffers] = {};
+		vector<char> m_chunk;			// decoded samples of one chunk, reused for every chunk
 		unique<SoundFileBuffer> m_buffer;
 
-		ALfloat m_lastOffset;
+		ALfloat m_last_offset = 0.f;
 	};
 }
@@ -11,6 +11,7 @@ namespace stl
 {
 	using namespace two;
 	template class TWO_SND_EXPORT vector<unique<Sound>>;
+	template class TWO_SND_EXPORT vector<SoundCommand>;
 	template class TWO_SND_EXPORT unordered_map<string, unique<SharedBuffer>>;
 }
 #endif
@@ -6,6 +6,10 @@
 
 #include <tool/Forward.h>
 
+#ifndef TWO_MODULES
+#include <cstdio>
+#endif
+
 namespace two
 {
 	export_ class refl_ TWO_TOOL_EXPORT EditorAction
@@ -14,5 +18,12 @@ namespace two
 		virtual ~EditorAction() {}
 		virtual void apply() = 0;
 		virtual void undo() = 0;
+
+		// memory held by the action, counted against the budget of the action stack
+		virtual size_t size() const { return 0; }
+		// folds the next action into this one : returns false when they can't be merged
+		virtual bool merge(EditorAction& next) { UNUSED(next); return false; }
+		// writes the data of the action to a file, from which it is read back when the action is next applied or undone
+		virtual bool spill(FILE* file) { UNUSED(file); return false; }
 	};
 }
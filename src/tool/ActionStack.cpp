@@ -8,25 +8,373 @@ module;
 module two.tool;
 #else
 #include <stl/algorithm.h>
+#include <infra/Log.h>
+#include <refl/Class.h>
+#include <refl/Meta.h>
 #include <tool/Types.h>
 #include <tool/ActionStack.h>
+
+#include <chrono>
+#include <cstring>
 #endif
 
 namespace two
 {
+	static bool is_flat(const Type& type)
+	{
+		if(type.is<string>() || !g_meta[type.m_id])
+			return false;
+		else if(is_basic(type))
+			return true;
+		else if(!is_struct(type) || !g_class[type.m_id])
+			return false;
+
+		for(Member& member : cls(type).m_members)
+			if(member.m_get || (!member.is_pointer() && !is_flat(*member.m_type)))
+				return false;
+		return true;
+	}
+
+	static Var copy_value(Ref value)
+	{
+		Var result = meta(value).m_empty_var;
+		if(result)
+			meta(value).copy_assign(result.m_ref, value);
+		return result;
+	}
+
+	Transaction::Transaction()
+	{}
+
+	Transaction::~Transaction()
+	{}
+
+	void Transaction::record_bytes(void* address, size_t size)
+	{
+		const size_t offset = m_snapshot.size();
+		m_snapshot.resize(offset + size);
+		memcpy(m_snapshot.data() + offset, address, size);
+		m_recorded.push_back({ address, uint32_t(size), uint32_t(offset), 0 });
+	}
+
+	void Transaction::record(Ref value)
+	{
+		if(!value.m_value)
+			return;
+
+		if(is_flat(type(value)))
+			this->record_bytes(value.m_value, meta(value).m_size);
+		else if(Var before = copy_value(value))
+			m_copies.push_back({ value, before, Var() });
+	}
+
+	void Transaction::record(Ref object, Member& member)
+	{
+		Ref target = member.cast(object);
+		if(member.is_pointer())
+			this->record_bytes(member.ref(target).m_value, sizeof(void*));
+		else
+			this->record(member.get(target));
+	}
+
+	void Transaction::encode(void* address, const uint8_t* xored, size_t size)
+	{
+		// a run goes on over short stretches of unchanged bytes, which cost less than the header of a new run
+		static const size_t c_max_gap = 2 * sizeof(uint32_t);
+
+		Delta delta = { address, uint32_t(size), uint32_t(m_data.size()), 0 };
+
+		size_t i = 0;
+		while(i < size)
+		{
+			if(xored[i] == 0)
+			{
+				++i;
+				continue;
+			}
+
+			const uint32_t start = uint32_t(i);
+			size_t end = i + 1;
+			for(size_t gap = 0; i < size && gap <= c_max_gap; ++i)
+			{
+				if(xored[i] != 0)
+				{
+					end = i + 1;
+					gap = 0;
+				}
+				else
+					++gap;
+			}
+
+			const uint32_t count = uint32_t(end - start);
+			const size_t offset = m_data.size();
+			m_data.resize(offset + 2 * sizeof(uint32_t) + count);
+			memcpy(m_data.data() + offset, &start, sizeof(uint32_t));
+			memcpy(m_data.data() + offset + sizeof(uint32_t), &count, sizeof(uint32_t));
+			memcpy(m_data.data() + offset + 2 * sizeof(uint32_t), xored + start, count);
+			i = end;
+		}
+
+		delta.m_end = uint32_t(m_data.size());
+		if(delta.m_end > delta.m_begin)
+			m_deltas.push_back(delta);
+	}
+
+	template <class T_Visitor>
+	static void visit_runs(const uint8_t* data, uint32_t begin, uint32_t end, T_Visitor visitor)
+	{
+		for(uint32_t offset = begin; offset < end;)
+		{
+			uint32_t start, count;
+			memcpy(&start, data + offset, sizeof(uint32_t));
+			memcpy(&count, data + offset + sizeof(uint32_t), sizeof(uint32_t));
+			visitor(start, count, data + offset + 2 * sizeof(uint32_t));
+			offset += 2 * sizeof(uint32_t) + count;
+		}
+	}
+
+	bool Transaction::commit()
+	{
+		vector<uint8_t> xored;
+		for(const Delta& recorded : m_recorded)
+		{
+			const uint8_t* before = m_snapshot.data() + recorded.m_begin;
+			const uint8_t* after = static_cast<const uint8_t*>(recorded.m_address);
+
+			xored.resize(recorded.m_size);
+			for(size_t i = 0; i < recorded.m_size; ++i)
+				xored[i] = before[i] ^ after[i];
+			this->encode(recorded.m_address, xored.data(), recorded.m_size);
+		}
+
+		for(Copy& copy : m_copies)
+			copy.m_after = copy_value(copy.m_value);
+		remove_if(m_copies, [](Copy& copy) { return compare(copy.m_before, copy.m_after); });
+
+		m_recorded = {};
+		m_snapshot = {};
+		return !m_deltas.empty() || !m_copies.empty();
+	}
+
+	bool Transaction::restore()
+	{
+		if(!m_spill_file)
+			return true;
+
+		// the deltas are useless without all of their data : the transaction stays spilled, and isn't applied nor undone
+		m_data.resize(m_spill_size);
+		if(fseek(m_spill_file, m_spill_offset, SEEK_SET) != 0 || fread(m_data.data(), 1, m_spill_size, m_spill_file) != m_spill_size)
+		{
+			error("tool: could not read back %zu bytes of spilled action data", m_spill_size);
+			m_data = {};
+			return false;
+		}
+
+		m_spill_file = nullptr;
+		return true;
+	}
+
+	bool Transaction::toggle()
+	{
+		if(!this->restore())
+			return false;
+
+		for(const Delta& delta : m_deltas)
+		{
+			uint8_t* value = static_cast<uint8_t*>(delta.m_address);
+			visit_runs(m_data.data(), delta.m_begin, delta.m_end, [&](uint32_t start, uint32_t count, const uint8_t* xored)
+			{
+				for(uint32_t i = 0; i < count; ++i)
+					value[start + i] ^= xored[i];
+			});
+		}
+		return true;
+	}
+
+	void Transaction::apply()
+	{
+		if(!m_undone || !this->toggle())
+			return;
+
+		for(Copy& copy : m_copies)
+			meta(copy.m_value).copy_assign(copy.m_value, copy.m_after);
+		m_undone = false;
+	}
+
+	void Transaction::undo()
+	{
+		if(m_undone || !this->toggle())
+			return;
+
+		for(Copy& copy : m_copies)
+			meta(copy.m_value).copy_assign(copy.m_value, copy.m_before);
+		m_undone = true;
+	}
+
+	size_t Transaction::size() const
+	{
+		size_t size = sizeof(Transaction) + m_data.capacity() + m_deltas.capacity() * sizeof(Delta) + m_copies.capacity() * sizeof(Copy);
+		for(const Copy& copy : m_copies)
+			size += 2 * meta(copy.m_value).m_size;
+		return size;
+	}
+
+	bool Transaction::merge(EditorAction& action)
+	{
+		Transaction* next = dynamic_cast<Transaction*>(&action);
+		if(!next || m_undone || next->m_undone || m_spill_file || next->m_spill_file)
+			return false;
+
+		// only the edits of the same values are merged, e.g. the successive steps of a drag
+		auto find_delta = [](vector<Delta>& deltas, const Delta& delta) { return find_if(deltas.begin(), deltas.end(), [&](const Delta& d) { return d.m_address == delta.m_address && d.m_size == delta.m_size; }); };
+		auto find_copy = [](vector<Copy>& copies, const Copy& copy) { return find_if(copies.begin(), copies.end(), [&](const Copy& c) { return c.m_value == copy.m_value; }); };
+
+		for(const Delta& delta : next->m_deltas)
+			if(find_delta(m_deltas, delta) == m_deltas.end())
+				return false;
+		for(const Copy& copy : next->m_copies)
+			if(find_copy(m_copies, copy) == m_copies.end())
+				return false;
+
+		// xoring the deltas of both transactions gives the delta from the first old values to the last new ones
+		vector<Delta> deltas = move(m_deltas);
+		vector<uint8_t> data = move(m_data);
+		m_deltas = {};
+		m_data = {};
+
+		vector<uint8_t> xored;
+		for(const Delta& delta : deltas)
+		{
+			xored.resize(delta.m_size);
+			memset(xored.data(), 0, delta.m_size);
+			auto accumulate = [&](uint32_t start, uint32_t count, const uint8_t* bytes)
+			{
+				for(uint32_t i = 0; i < count; ++i)
+					xored[start + i] ^= bytes[i];
+			};
+
+			visit_runs(data.data(), delta.m_begin, delta.m_end, accumulate);
+			auto other = find_delta(next->m_deltas, delta);
+			if(other != next->m_deltas.end())
+				visit_runs(next->m_data.data(), other->m_begin, other->m_end, accumulate);
+			this->encode(delta.m_address, xored.data(), delta.m_size);
+		}
+
+		for(const Copy& copy : next->m_copies)
+			find_copy(m_copies, copy)->m_after = copy.m_after;
+
+		return true;
+	}
+
+	bool Transaction::spill(FILE* file)
+	{
+		if(m_spill_file || m_data.empty())
+			return false;
+
+		fseek(file, 0, SEEK_END);
+		m_spill_offset = ftell(file);
+		m_spill_size = m_data.size();
+		if(fwrite(m_data.data(), 1, m_data.size(), file) != m_data.size())
+			return false;
+
+		m_spill_file = file;
+		m_data = {};
+		return true;
+	}
+
+	static double time_seconds()
+	{
+		using namespace std::chrono;
+		return duration<double>(steady_clock::now().time_since_epoch()).count();
+	}
+
 	ActionStack::ActionStack()
 		: m_done()
 		, m_undone()
 	{}
 
 	ActionStack::~ActionStack()
-	{}
+	{
+		m_done.clear();
+		m_undone.clear();
+
+		if(m_spill_file)
+		{
+			fclose(m_spill_file);
+			::remove(m_spill_path.c_str());
+		}
+	}
+
+	void ActionStack::set_spill_path(const string& path)
+	{
+		// spilled actions read back from the file they were written to : it can't change once opened
+		if(m_spill_file)
+			return;
+
+		m_spill_path = path;
+		m_spill_file = fopen(path.c_str(), "w+b");
+		this->evict();
+	}
+
+	size_t ActionStack::action_size(EditorAction& action) const
+	{
+		static const size_t c_action_overhead = 64;
+		return c_action_overhead + action.size();
+	}
 
 	void ActionStack::push(object<EditorAction> action)
 	{
+		for(auto& undone : m_undone)
+			m_size -= this->action_size(*undone);
 		m_undone.clear();
 		//action->apply();
+
+		const double now = time_seconds();
+		const bool merge = !m_sealed && !m_done.empty() && now - m_last_push <= m_merge_window && action->size() <= m_merge_size;
+		m_last_push = now;
+
+		if(merge)
+		{
+			EditorAction& last = *m_done.back();
+			const size_t size = this->action_size(last);
+			if(last.merge(*action))
+			{
+				m_size = m_size - size + this->action_size(last);
+				this->evict();
+				return;
+			}
+		}
+
+		m_size += this->action_size(*action);
 		m_done.push_back(move(action));
+		m_sealed = false;
+		this->evict();
+	}
+
+	void ActionStack::evict()
+	{
+		// the last action is kept in memory, as it can still be merged with the next one
+		while(m_size > m_budget && m_spill_file && m_spill_count + 1 < m_done.size())
+		{
+			EditorAction& action = *m_done[m_spill_count++];
+			const size_t size = this->action_size(action);
+			if(action.spill(m_spill_file))
+			{
+				const size_t spilled = size - this->action_size(action);
+				m_size -= spilled;
+				m_spilled += spilled;
+			}
+		}
+
+		size_t count = 0;
+		while(m_size > m_budget && count + 1 < m_done.size())
+			m_size -= this->action_size(*m_done[count++]);
+
+		if(count > 0)
+		{
+			m_done.erase(m_done.begin(), m_done.begin() + count);
+			m_spill_count -= min(count, m_spill_count);
+		}
 	}
 
 	void ActionStack::redo()
@@ -34,8 +382,14 @@ namespace two
 		if(m_undone.empty())
 			return;
 
-		m_undone.back()->apply();
+		EditorAction& action = *m_undone.back();
+		const size_t size = this->action_size(action);
+		action.apply();
+		m_size = m_size - size + this->action_size(action);
+
 		m_done.push_back(pop(m_undone));
+		m_sealed = true;
+		this->evict();
 	}
 
 	void ActionStack::undo()
@@ -43,8 +397,14 @@ namespace two
 		if(m_done.empty())
 			return;
 
-		m_done.back()->undo();
+		EditorAction& action = *m_done.back();
+		const size_t size = this->action_size(action);
+		action.undo();
+		m_size = m_size - size + this->action_size(action);
+
 		m_undone.push_back(pop(m_done));
+		m_spill_count = min(m_spill_count, m_done.size());
+		m_sealed = true;
 	}
 
 	UndoTool::UndoTool(ToolContext& context)
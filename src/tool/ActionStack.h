@@ -4,11 +4,75 @@
 
 #pragma once
 
+#include <stl/vector.h>
+#include <stl/string.h>
+#include <type/Ref.h>
+#include <type/Var.h>
 #include <tool/Tool.h>
+#include <tool/Action.h>
 #include <tool/Forward.h>
 
 namespace two
 {
+	// records edits of reflected values as binary deltas : record() the values before editing them, then commit() the transaction
+	// only the bytes that changed are kept, xored between the old and new value, so that applying and undoing are the same operation
+	// values that aren't plain bytes (strings, sequences, objects) are kept as copies of the old and new value instead
+	export_ class TWO_TOOL_EXPORT Transaction : public EditorAction
+	{
+	public:
+		Transaction();
+		~Transaction();
+
+		// snapshots a value about to be edited : a member of an object is recorded with record(object, member)
+		void record(Ref value);
+		void record(Ref object, Member& member);
+
+		// computes the deltas of the recorded values, returns false when none of them changed
+		bool commit();
+
+		virtual void apply() override;
+		virtual void undo() override;
+
+		virtual size_t size() const override;
+		virtual bool merge(EditorAction& next) override;
+		virtual bool spill(FILE* file) override;
+
+	private:
+		void record_bytes(void* address, size_t size);
+		void encode(void* address, const uint8_t* xored, size_t size);
+		bool toggle();
+		bool restore();
+
+		struct Delta
+		{
+			void* m_address;
+			uint32_t m_size;			// size of the value
+			uint32_t m_begin;			// runs of changed bytes in m_data, each encoded as offset, size, xored bytes
+			uint32_t m_end;
+		};
+
+		struct Copy
+		{
+			Ref m_value;
+			Var m_before;
+			Var m_after;
+		};
+
+		vector<Delta> m_deltas;
+		vector<uint8_t> m_data;
+		vector<Copy> m_copies;
+		bool m_undone = false;
+
+		// snapshots of the recorded values until commit()
+		vector<Delta> m_recorded;
+		vector<uint8_t> m_snapshot;
+
+		// spilled data is read back from the file
+		FILE* m_spill_file = nullptr;
+		long m_spill_offset = 0;
+		size_t m_spill_size = 0;
+	};
+
 	export_ class TWO_TOOL_EXPORT ActionStack
 	{
 	public:
@@ -18,14 +82,39 @@ namespace two
 		ActionStack(const ActionStack& other) = delete;
 		ActionStack& operator=(const ActionStack& other) = delete;
 
+		// actions pushed within the merge window of the previous one are merged into it when both allow it
 		void push(object<EditorAction> action);
 
 		void redo();
 		void undo();
 
+		// ends the merging of the last action, e.g. when a drag is released
+		void seal() { m_sealed = true; }
+
+		// once the history goes over the budget, the oldest actions are spilled to the file if there is one, then dropped
+		void set_budget(size_t budget) { m_budget = budget; this->evict(); }
+		void set_spill_path(const string& path);
+
+		size_t m_budget = 64 * 1024 * 1024;
+		double m_merge_window = 0.5;		// seconds
+		size_t m_merge_size = 1024;			// actions larger than this are never merged
+
+		size_t m_size = 0;					// memory held by the history in bytes
+		size_t m_spilled = 0;				// bytes of history written to the spill file
+
 	private:
+		size_t action_size(EditorAction& action) const;
+		void evict();
+
 		vector<object<EditorAction>> m_done;
 		vector<object<EditorAction>> m_undone;
+		size_t m_spill_count = 0;			// the oldest actions of m_done that are spilled
+
+		double m_last_push = 0.0;
+		bool m_sealed = true;
+
+		string m_spill_path;
+		FILE* m_spill_file = nullptr;
 	};
 
 	export_ class refl_ TWO_TOOL_EXPORT UndoTool : public Tool
@@ -127,12 +127,26 @@ namespace two
 	{
 		Widget& self = section(parent, "Inspector");
 
-		if(!selection.objects.empty() && selection.objects[0])
+		if(selection.objects.size() > 1 && selection.objects[0])
+		{
+			Ref selected = selection.objects[0];
+			Widget& sheet = ui::widget(*self.m_body, styles().sheet, (void*)selected.m_type);
+			vector<Ref> objects = selection.objects;
+			bulk_object_edit(sheet, *selected.m_type, objects);
+		}
+		else if(!selection.objects.empty() && selection.objects[0])
 		{
 			Ref selected = selection.objects[0];
 			Widget& sheet = ui::widget(*self.m_body, styles().sheet, (void*)selected.m_value);
 			object_edit(sheet, selected);
 		}
+		else if(selection.entities.size() > 1 && selection.entities[0])
+		{
+			Entity selected = selection.entities[0];
+			Widget& sheet = ui::widget(*self.m_body, styles().sheet, (void*)uintptr_t(selected.m_stream + 1));
+			vector<Entity> entities = selection.entities;
+			bulk_entity_edit(sheet, entities);
+		}
 		else if(!selection.entities.empty() && selection.entities[0])
 		{
 			Entity selected = selection.entities[0];
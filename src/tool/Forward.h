@@ -35,6 +35,7 @@ namespace two
     class TransformAction;
     class TransformTool;
 	class TransformGizmo;
+    class Transaction;
     class ActionStack;
     class UndoTool;
     class RedoTool;
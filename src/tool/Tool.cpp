@@ -99,18 +99,54 @@ namespace two
 		: m_targets(to_vector(targets))
 	{}
 
+	TransformAction::~TransformAction()
+	{}
+
 	void TransformAction::apply()
 	{
+		if(m_transaction)
+			return m_transaction->apply();
+
 		for(Transform* transform : m_targets)
 			this->apply(*transform);
 	}
 
 	void TransformAction::undo()
 	{
+		if(m_transaction)
+			return m_transaction->undo();
+
 		for(Transform* transform : m_targets)
 			this->undo(*transform);
 	}
 
+	void TransformAction::finish()
+	{
+		if(m_transaction)
+			return;
+
+		for(Transform* transform : m_targets)
+			this->undo(*transform);
+
+		m_transaction = make_unique<Transaction>();
+		for(Transform* transform : m_targets)
+			m_transaction->record(Ref(transform));
+
+		for(Transform* transform : m_targets)
+			this->apply(*transform);
+		m_transaction->commit();
+	}
+
+	size_t TransformAction::size() const
+	{
+		return m_transaction ? m_transaction->size() : 0;
+	}
+
+	bool TransformAction::spill(FILE* file)
+	{
+		return m_transaction ? m_transaction->spill(file) : false;
+	}
+
 	TransformTool::TransformTool(ToolContext& context, cstring name, Type& type)
 		: SpatialTool(context, name, type)
 	{}
@@ -188,7 +224,7 @@ namespace two
 		if(MouseEvent event = screen.mouse_event(DeviceType::MouseLeft, EventType::DragEnded))
 		{
 			m_dragging = nullptr;
-			m_action->undo();
+			m_action->finish();
 			this->commit(move(m_action));
 			event.consume(screen);
 		}
@@ -120,21 +120,33 @@ namespace two
 	TWO_TOOL_EXPORT vec3 gizmo_grab_linear(Viewer& viewer, const Transform& space, Axis axis);
 	TWO_TOOL_EXPORT vec3 gizmo_grab_planar(Viewer& viewer, const Transform& space, Axis normal);
 
+	// the targets are transformed live while dragging, then finish() records the edit as a transaction :
+	// once finished, undoing and redoing restore the recorded transforms instead of replaying the operation
 	export_ class refl_ TWO_TOOL_EXPORT TransformAction : public EditorAction
 	{
 	public:
 		TransformAction(span<Transform*> targets);
+		~TransformAction();
 
 		virtual void apply() final;
 		virtual void undo() final;
 
+		virtual size_t size() const final;
+		virtual bool spill(FILE* file) final;
+
 		virtual void update(const vec3& start, const vec3& end) = 0;
 
 		virtual void apply(Transform& transform) = 0;
 		virtual void undo(Transform& transform) = 0;
 
+		// called with the last update applied
+		void finish();
+
 	public:
 		vector<Transform*> m_targets;
+
+	private:
+		unique<Transaction> m_transaction;
 	};
 
 	export_ class refl_ TWO_TOOL_EXPORT TransformTool : public SpatialTool
@@ -3,9 +3,69 @@
 //  This notice and the license may not be removed or altered from any source distribution.
 
 #include <infra/Cpp20.h>
+#ifndef TWO_CPP_20
+#include <new>
+#endif
 
 #include <infra/Config.h>
 #include <tree/Graph.h>
 
 namespace two
-{}
+{
+	struct NodePool
+	{
+		static constexpr size_t c_granularity = 16;
+		static constexpr size_t c_classes = 128;
+		static constexpr size_t c_max_free = 1024;
+
+		struct FreeNode { FreeNode* m_next; };
+
+		FreeNode* m_free[c_classes] = {};
+		size_t m_counts[c_classes] = {};
+		NodeAllocStats m_stats;
+	};
+
+	// the pool is never destroyed : nodes can still be freed by static destructors after the thread locals are gone
+	static thread_local NodePool s_node_pool;
+
+	inline size_t node_class(size_t size) { return (size + NodePool::c_granularity - 1) / NodePool::c_granularity; }
+
+	void* alloc_node(size_t size)
+	{
+		NodePool& pool = s_node_pool;
+		const size_t index = node_class(size);
+		if(index < NodePool::c_classes && pool.m_free[index])
+		{
+			NodePool::FreeNode* node = pool.m_free[index];
+			pool.m_free[index] = node->m_next;
+			pool.m_counts[index]--;
+			pool.m_stats.m_reuses++;
+			return node;
+		}
+
+		pool.m_stats.m_allocations++;
+		// allocate the whole size class, so that the block can be recycled for any node of the same class
+		return ::operator new(index < NodePool::c_classes ? index * NodePool::c_granularity : size);
+	}
+
+	void free_node(void* node, size_t size)
+	{
+		NodePool& pool = s_node_pool;
+		const size_t index = node_class(size);
+		pool.m_stats.m_frees++;
+		if(index < NodePool::c_classes && pool.m_counts[index] < NodePool::c_max_free)
+		{
+			NodePool::FreeNode* free = static_cast<NodePool::FreeNode*>(node);
+			free->m_next = pool.m_free[index];
+			pool.m_free[index] = free;
+			pool.m_counts[index]++;
+			return;
+		}
+		::operator delete(node);
+	}
+
+	NodeAllocStats& node_alloc_stats()
+	{
+		return s_node_pool.m_stats;
+	}
+}
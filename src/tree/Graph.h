@@ -7,6 +7,9 @@
 #include <stdint.h>
 #include <stl/vector.h>
 #include <stl/memory.h>
+#ifndef USE_STL
+#include <stl/new.h>
+#endif
 #include <infra/Config.h>
 
 #ifndef TWO_TREE_EXPORT
@@ -21,6 +24,18 @@ namespace two
 		virtual ~NodeState() {}
 	};
 
+	export_ struct NodeAllocStats
+	{
+		size_t m_allocations = 0;
+		size_t m_reuses = 0;
+		size_t m_frees = 0;
+	};
+
+	// graph nodes are recycled through per thread free lists, one per size class
+	export_ TWO_TREE_EXPORT void* alloc_node(size_t size);
+	export_ TWO_TREE_EXPORT void free_node(void* node, size_t size);
+	export_ TWO_TREE_EXPORT NodeAllocStats& node_alloc_stats();
+
 	export_ template <class T>
 	class Graph
 	{
@@ -32,6 +47,15 @@ namespace two
 		Graph(Graph<T>&& other) = default;
 		Graph<T>& operator=(Graph<T>&& other) = default;
 
+		static void* operator new(size_t size) { return alloc_node(size); }
+		static void operator delete(void* node, size_t size) { free_node(node, size); }
+		static void* operator new(size_t, void* where) { return where; }
+		static void operator delete(void*, void*) {}
+#ifndef USE_STL
+		static void* operator new(size_t, stl::placeholder, void* where) { return where; }
+		static void operator delete(void*, stl::placeholder, void*) {}
+#endif
+
 		inline T& impl() { return static_cast<T&>(*this); }
 
 		T* m_parent = nullptr;
@@ -40,6 +64,10 @@ namespace two
 		vector<unique<T>> m_nodes;
 		unique<NodeState> m_state;
 		uint16_t m_next = 0;
+
+		// nodes set aside on an identity mismatch, until they are matched again or the tree is cleaned
+		vector<unique<T>> m_pending;
+		uint16_t m_cursor = 0;
 		
 		template <class Child = T, class... Args>
 		inline Child& append(Args... args, void* identity = nullptr);
@@ -59,6 +87,12 @@ namespace two
 		template <class Child = T, class... Args>
 		inline Child& subi(void* identity, Args... args);
 
+		inline void detach(size_t index);
+		inline unique<T> take(void* identity);
+		inline void restore();
+
+		virtual void reordered() {}
+
 		inline T& root();
 
 		template <class T_State, class... Args>
@@ -6,6 +6,7 @@
 
 #include <tree/Graph.h>
 #include <stl/algorithm.h>
+#include <stl/move.h>
 
 namespace two
 {
@@ -33,8 +34,13 @@ namespace two
 	template <class Child, class... Args>
 	inline Child& Graph<T>::subx(uint16_t index, Args... args)
 	{
-		while (m_nodes.size() <= index)
-			append<Child, Args...>(args..., nullptr);
+		while(m_nodes.size() <= index)
+		{
+			if(unique<T> node = this->take(nullptr))
+				m_nodes.push_back(move(node));
+			else
+				append<Child, Args...>(args..., nullptr);
+		}
 		return static_cast<Child&>(update(*m_nodes[index]));
 	}
 
@@ -51,15 +57,57 @@ namespace two
 	{
 		uint16_t index = m_next++;
 
-		if(m_nodes.size() <= index)
-			append<Child, Args...>(args..., identity);
+		if(m_nodes.size() > index && m_nodes[index]->m_identity != identity)
+			this->detach(index);
 
-		if(m_nodes[index]->m_identity != identity)
-			m_nodes.insert(m_nodes.begin() + index, make_unique<Child>(&impl(), identity, args...));
+		if(m_nodes.size() <= index)
+		{
+			if(unique<T> node = this->take(identity))
+				m_nodes.push_back(move(node));
+			else
+				append<Child, Args...>(args..., identity);
+		}
 
 		return static_cast<Child&>(update(*m_nodes[index]));
 	}
 
+	template <class T>
+	inline void Graph<T>::detach(size_t index)
+	{
+		// the following nodes are matched by identity as the next children are declared, instead of shifting them on each insertion
+		for(size_t i = index; i < m_nodes.size(); ++i)
+			m_pending.push_back(move(m_nodes[i]));
+		m_nodes.erase(m_nodes.begin() + index, m_nodes.end());
+		this->reordered();
+	}
+
+	template <class T>
+	inline unique<T> Graph<T>::take(void* identity)
+	{
+		// the pending nodes are usually matched in order, so the search starts after the last match
+		const size_t count = m_pending.size();
+		for(size_t n = 0; n < count; ++n)
+		{
+			const size_t i = (m_cursor + n) % count;
+			if(m_pending[i] && m_pending[i]->m_identity == identity)
+			{
+				m_cursor = uint16_t(i + 1);
+				return move(m_pending[i]);
+			}
+		}
+		return nullptr;
+	}
+
+	template <class T>
+	inline void Graph<T>::restore()
+	{
+		for(unique<T>& node : m_pending)
+			if(node)
+				m_nodes.push_back(move(node));
+		m_pending.clear();
+		m_cursor = 0;
+	}
+
 	template <class T>
 	inline T& Graph<T>::root() { if(m_parent) return m_parent->root(); return impl(); }
 
@@ -75,6 +123,7 @@ namespace two
 	template <class T>
 	void Graph<T>::clean_tree(size_t heartbeat)
 	{
+		this->restore();
 		remove_if(m_nodes, [=](unique<T>& node) { return node->m_heartbeat < heartbeat; });
 		for(auto& child : m_nodes)
 			child->clean_tree(heartbeat);
@@ -83,6 +132,7 @@ namespace two
 	template <class T>
 	void Graph<T>::clean_tree_preserve(size_t heartbeat)
 	{
+		this->restore();
 		for(auto& child : m_nodes)
 		{
 			if(child->m_heartbeat < heartbeat)
@@ -5,19 +5,24 @@
 #pragma once
 
 #include <stl/stddef.h>
+#include <stl/move.h>
+
+#include <atomic>
 
 namespace two
 {
 	//! LocklessQueue template: as provid3ed by Lf3THn4D
 	//! Only 1 thread can push and 1 thread can pop it.
+	//! The head is only written by the producer and the tail by the consumer : each publishes its slot with a release store,
+	//! and the other side acquires it before touching that slot.
 	template <class T>
 	class LocklessQueue
 	{
 	private:
 		T* m_buffer = nullptr;
-		size_t m_head = 0;
-		size_t m_tail = 0;
 		size_t m_size;
+		std::atomic<size_t> m_head = { 0 };
+		std::atomic<size_t> m_tail = { 0 };
 
 	public:
 		inline LocklessQueue(size_t size)
@@ -28,23 +33,37 @@ namespace two
 
 		inline ~LocklessQueue() { delete[] m_buffer; }
 
-		inline bool empty() const { return (m_head == m_tail); }
+		LocklessQueue(const LocklessQueue& other) = delete;
+		LocklessQueue& operator=(const LocklessQueue& other) = delete;
+
+		inline bool empty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
 
 		inline bool push(const T& obj)
 		{
-			size_t next_head = (m_head + 1) % m_size;
-			if(next_head == m_tail) return false;
-			m_buffer[m_head] = obj;
-			m_head = next_head;
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			const size_t next_head = (head + 1) % m_size;
+			if(next_head == m_tail.load(std::memory_order_acquire)) return false;
+			m_buffer[head] = obj;
+			m_head.store(next_head, std::memory_order_release);
 			return true;
 		}
 
+		inline bool push(T&& obj)
+		{
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			const size_t next_head = (head + 1) % m_size;
+			if(next_head == m_tail.load(std::memory_order_acquire)) return false;
+			m_buffer[head] = move(obj);
+			m_head.store(next_head, std::memory_order_release);
+			return true;
+		}
 
 		inline bool pop(T& obj)
 		{
-			if(m_tail == m_head) return false;
-			obj = m_buffer[m_tail];
-			m_tail = (m_tail + 1) % m_size;
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			if(tail == m_head.load(std::memory_order_acquire)) return false;
+			obj = move(m_buffer[tail]);
+			m_tail.store((tail + 1) % m_size, std::memory_order_release);
 			return true;
 		}
 	};
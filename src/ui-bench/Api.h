@@ -0,0 +1 @@
+#include <ui-bench/UiBench.h>
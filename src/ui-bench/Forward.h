@@ -0,0 +1,20 @@
+#pragma once
+
+#include <infra/Config.h>
+
+#include <infra/Forward.h>
+#include <type/Forward.h>
+#include <math/Forward.h>
+#include <ctx/Forward.h>
+#include <ui/Forward.h>
+#include <ui-null/Forward.h>
+
+#ifndef TWO_UI_BENCH_EXPORT
+#define TWO_UI_BENCH_EXPORT TWO_IMPORT
+#endif
+
+namespace two
+{
+    struct BenchTiming;
+    class UiBench;
+}
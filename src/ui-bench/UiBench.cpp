@@ -0,0 +1,360 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#include <infra/Cpp20.h>
+#ifndef TWO_CPP_20
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <new>
+#endif
+
+#ifdef TWO_MODULES
+module two.ui.bench;
+#else
+#include <stl/vector.hpp>
+#include <stl/unordered_map.hpp>
+#include <infra/ToString.h>
+#include <infra/StringOps.h>
+#include <math/Vec.hpp>
+#include <ctx/InputDevice.h>
+#include <ui/Api.h>
+#include <ui-bench/UiBench.h>
+#endif
+
+namespace
+{
+	size_t g_allocations = 0;
+}
+
+// every allocation of the program goes through here, including the ones of the stl containers
+void* operator new(size_t size)
+{
+	g_allocations++;
+	if(void* ptr = malloc(size > 0 ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	g_allocations++;
+	if(void* ptr = malloc(size > 0 ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+
+namespace two
+{
+	size_t bench_allocations()
+	{
+		return g_allocations;
+	}
+
+	static const size_t c_table_rows = 10000;
+	static const size_t c_graph_nodes = 400;
+	static const size_t c_editor_lines = 2000;
+	static const size_t c_editors = 4;
+
+	static cstring c_phase_names[] = { "input", "layout", "declare", "render" };
+
+	UiBench::UiBench(const string& resource_path, const uvec2& size)
+		: m_render_system(resource_path, true)
+		, m_context(m_render_system, "ui bench", size)
+		, m_vg(resource_path.c_str())
+		, m_window(m_context, m_vg)
+	{
+		for(size_t i = 0; i < c_table_rows; ++i)
+		{
+			m_cells.push_back(to_string(i));
+			m_cells.push_back("row " + to_string(i));
+			m_cells.push_back("/path/to/item/" + to_string(i));
+			m_cells.push_back(i % 3 == 0 ? "dirty" : "....");
+		}
+
+		const uint columns = 20;
+		for(size_t i = 0; i < c_graph_nodes; ++i)
+			m_node_positions.push_back(vec2(float(i % columns) * 220.f, float(i / columns) * 160.f));
+
+		for(size_t e = 0; e < c_editors; ++e)
+		{
+			string text;
+			for(size_t i = 0; i < c_editor_lines; ++i)
+				text += "local value_" + to_string(i) + " = compute(" + to_string(i * e) + ", \"some string\") -- a comment\n";
+			m_texts.push_back(text);
+		}
+
+		m_window.init();
+		style_blendish_dark(m_window);
+	}
+
+	UiBench::~UiBench()
+	{}
+
+	UiBench::Scenario UiBench::scenario(const string& name)
+	{
+		if(name == "docks") return &UiBench::docks;
+		else if(name == "table") return &UiBench::table;
+		else if(name == "virtual_table") return &UiBench::virtual_table;
+		else if(name == "nodes") return &UiBench::nodes;
+		else if(name == "editors") return &UiBench::editors;
+		return nullptr;
+	}
+
+	void UiBench::docks(Widget& parent)
+	{
+		Widget& board = ui::board(parent);
+
+		Docker& dockspace = ui::dockspace(board, m_docksystem);
+		Docker& dockbar = ui::dockbar(board, m_docksystem);
+
+		m_docksystem.m_dockers = { &dockspace, &dockbar };
+
+		static cstring names[] = { "Scene", "Outliner", "Properties", "Assets", "Console", "Script" };
+
+		for(uint16_t i = 0; i < 6; ++i)
+			if(Widget* dock = ui::dockitem(dockspace, names[i], { 0U, uint16_t(i % 3), uint16_t(i / 3) }))
+			{
+				Widget& body = *ui::scroll_sheet(*dock).m_body;
+				for(size_t j = 0; j < 64; ++j)
+				{
+					Widget& row = ui::row(body);
+					ui::checkbox(row, m_checks[j]);
+					ui::label(row, m_cells[(i * 64 + j) * 4 + 1]);
+					ui::button(row, "Edit");
+				}
+			}
+
+		if(Widget* dock = ui::dockitem(dockbar, "Tools", { 0U }))
+			for(size_t j = 0; j < 16; ++j)
+				ui::button(*dock, m_cells[j * 4 + 1]);
+	}
+
+	void UiBench::table(Widget& parent)
+	{
+		Widget& body = *ui::scroll_sheet(parent).m_body;
+		Widget& table = ui::table(body, { "ID", "Name", "Path", "Flags" }, { 0.1f, 0.3f, 0.4f, 0.2f });
+
+		for(size_t i = 0; i < c_table_rows; ++i)
+		{
+			Widget& row = ui::table_row(table);
+			for(size_t c = 0; c < 4; ++c)
+				ui::label(row, m_cells[i * 4 + c]);
+		}
+	}
+
+	void UiBench::virtual_table(Widget& parent)
+	{
+		ui::VirtualSequence& sequence = ui::virtual_table(parent, { "ID", "Name", "Path", "Flags" }, { 0.1f, 0.3f, 0.4f, 0.2f }, c_table_rows, 22.f);
+
+		for(size_t i = sequence.m_first; i < sequence.m_last; ++i)
+		{
+			Widget& row = ui::virtual_table_row(sequence, i);
+			for(size_t c = 0; c < 4; ++c)
+				ui::label(row, m_cells[i * 4 + c]);
+		}
+	}
+
+	void UiBench::nodes(Widget& parent)
+	{
+		Canvas& canvas = ui::canvas(parent, c_graph_nodes);
+
+		NodePlug* previous = nullptr;
+		for(size_t i = 0; i < c_graph_nodes; ++i)
+		{
+			Node& node = ui::node(canvas, m_cells[i * 4 + 1].c_str(), m_node_positions[i]);
+			NodePlug& input = ui::node_input(node, "a", "", Colour::Cyan);
+			ui::node_input(node, "b");
+			ui::node_input(node, "c", "", Colour::Pink);
+			NodePlug& output = ui::node_output(node, "result");
+			ui::node_output(node, "error", "", Colour::Red);
+
+			if(previous)
+				ui::node_cable(canvas, *previous, input);
+			previous = &output;
+		}
+	}
+
+	void UiBench::editors(Widget& parent)
+	{
+		Widget& row = ui::row(parent);
+		for(string& text : m_texts)
+		{
+			Widget& body = *ui::scroll_sheet(row).m_body;
+			ui::code_edit(body, text, 40);
+		}
+	}
+
+	void UiBench::input(size_t frame)
+	{
+		Mouse& mouse = m_window.m_ui->m_mouse;
+		Keyboard& keyboard = m_window.m_ui->m_keyboard;
+
+		if(m_replaying)
+		{
+			m_replay.replay(uint32_t(frame), mouse, keyboard);
+			return;
+		}
+
+		// the pointer sweeps the window, with several motion events per frame as a real device would send
+		const vec2 size = vec2(m_context.m_fb_size);
+		for(size_t i = 0; i < 4; ++i)
+		{
+			const float t = float(frame * 4 + i) * 0.01f;
+			const vec2 pos = size * 0.5f + size * 0.45f * vec2(cos(t * 3.f), sin(t * 2.f));
+			mouse.moved(pos);
+		}
+
+		const vec2 pos = mouse.m_pos;
+		if(frame % 30 == 10)
+			mouse.m_buttons[LEFT_BUTTON].pressed(pos);
+		else if(frame % 30 == 11)
+			mouse.m_buttons[LEFT_BUTTON].released(pos);
+		else if(frame % 10 == 5)
+			mouse.wheeled(pos, frame % 20 < 10 ? -1.f : 1.f);
+	}
+
+	void UiBench::run(Scenario scenario, size_t frames)
+	{
+		using clock = std::chrono::steady_clock;
+
+		auto measure = [&](BenchPhase phase, auto work)
+		{
+			const size_t allocations = bench_allocations();
+			const clock::time_point start = clock::now();
+			work();
+			const double time = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+			BenchTiming& timing = m_phases[size_t(phase)];
+			timing.m_total += time;
+			timing.m_max = max(timing.m_max, time);
+			timing.m_allocations += bench_allocations() - allocations;
+		};
+
+		Ui& ui = *m_window.m_ui;
+		ui.m_record = m_record;
+
+		for(size_t frame = 0; frame < frames; ++frame)
+		{
+			measure(BenchPhase::Input, [&] { this->input(frame); ui.input_frame(); });
+			measure(BenchPhase::Layout, [&] { m_solved_frames += ui.m_frame.relayout(); });
+			measure(BenchPhase::Declare, [&] { (this->*scenario)(ui.begin()); });
+			measure(BenchPhase::Render, [&] { m_window.render_frame(0); });
+
+			m_draw_calls += m_vg.m_stats.draw_calls();
+			m_glyphs += m_vg.m_stats.m_glyphs;
+			m_frames++;
+		}
+
+		ui.m_record = nullptr;
+	}
+
+	void UiBench::print(const string& name) const
+	{
+		const double frames = double(max(m_frames, size_t(1)));
+
+		printf("ui bench - %s - %zu frames\n", name.c_str(), m_frames);
+		printf("%-10s %12s %12s %14s\n", "phase", "avg (ms)", "max (ms)", "allocs/frame");
+
+		BenchTiming total;
+		for(size_t i = 0; i < size_t(BenchPhase::Count); ++i)
+		{
+			const BenchTiming& timing = m_phases[i];
+			printf("%-10s %12.3f %12.3f %14.1f\n", c_phase_names[i], timing.m_total / frames, timing.m_max, double(timing.m_allocations) / frames);
+			total.m_total += timing.m_total;
+			total.m_allocations += timing.m_allocations;
+		}
+		printf("%-10s %12.3f %12s %14.1f\n", "frame", total.m_total / frames, "", double(total.m_allocations) / frames);
+
+		printf("draw calls/frame %.1f - glyphs/frame %.1f - solved frames/frame %.1f\n", double(m_draw_calls) / frames, double(m_glyphs) / frames, double(m_solved_frames) / frames);
+	}
+}
+
+using namespace two;
+
+int main(int argc, char *argv[])
+{
+	string scenario = "all";
+	size_t frames = 300;
+	string resource_path = "data/";
+	string record_path;
+	string replay_path;
+	bool immediate = false;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		cstring arg = argv[i];
+		if(strcmp(arg, "--frames") == 0 && i + 1 < argc)
+			frames = size_t(atoi(argv[++i]));
+		else if(strcmp(arg, "--resources") == 0 && i + 1 < argc)
+			resource_path = argv[++i];
+		else if(strcmp(arg, "--record") == 0 && i + 1 < argc)
+			record_path = argv[++i];
+		else if(strcmp(arg, "--replay") == 0 && i + 1 < argc)
+			replay_path = argv[++i];
+		else if(strcmp(arg, "--immediate") == 0)
+			immediate = true;
+		else if(arg[0] != '-')
+			scenario = arg;
+		else
+		{
+			printf("usage: ui_bench [docks|table|virtual_table|nodes|editors|all] [--frames N] [--resources path] [--record file] [--replay file] [--immediate]\n");
+			return 1;
+		}
+	}
+
+	// all runs every scenario in turn, each in a fresh bench : nesting them in one window would only ever show one of them
+	vector<string> scenarios = { scenario };
+	if(scenario == "all")
+	{
+		if(!record_path.empty() || !replay_path.empty())
+		{
+			printf("ui bench - recording and replaying input need a single scenario\n");
+			return 1;
+		}
+		scenarios = { "docks", "table", "virtual_table", "nodes", "editors" };
+	}
+
+	for(const string& name : scenarios)
+	{
+		UiBench::Scenario function = UiBench::scenario(name);
+		if(!function)
+		{
+			printf("ui bench - unknown scenario %s\n", name.c_str());
+			return 1;
+		}
+
+		UiBench bench(resource_path, uvec2(1600U, 900U));
+		bench.m_vg.m_retained = !immediate;
+
+		if(!replay_path.empty())
+		{
+			bench.m_replaying = bench.m_replay.load(replay_path);
+			if(!bench.m_replaying)
+			{
+				printf("ui bench - could not load input record %s\n", replay_path.c_str());
+				return 1;
+			}
+		}
+
+		InputRecord record;
+		if(!record_path.empty())
+			bench.m_record = &record;
+
+		bench.run(function, frames);
+		bench.print(name);
+
+		if(!record_path.empty())
+			record.save(record_path);
+	}
+
+	return 0;
+}
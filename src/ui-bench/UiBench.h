@@ -0,0 +1,88 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#pragma once
+
+#ifndef TWO_MODULES
+#include <stl/string.h>
+#include <stl/vector.h>
+#include <math/Vec.h>
+#include <ctx/InputRecord.h>
+#include <ui/DockStruct.h>
+#include <ui/UiWindow.h>
+#include <ui-null/VgNull.h>
+#include <ui-null/NullContext.h>
+#endif
+#include <ui-bench/Forward.h>
+
+namespace two
+{
+	export_ enum class BenchPhase : unsigned int
+	{
+		Input,		// device input and event dispatch
+		Layout,		// relayout of the frames declared in the previous frame
+		Declare,	// immediate declaration of the widgets
+		Render,		// recording of the draw calls and hit index
+		Count
+	};
+
+	export_ struct TWO_UI_BENCH_EXPORT BenchTiming
+	{
+		double m_total = 0.0;
+		double m_max = 0.0;
+		size_t m_allocations = 0;
+	};
+
+	// allocations made through the global operator new since the start of the program
+	export_ TWO_UI_BENCH_EXPORT size_t bench_allocations();
+
+	// drives a headless ui window over a synthetic scene for a number of frames, and measures each phase of the frame
+	export_ class TWO_UI_BENCH_EXPORT UiBench
+	{
+	public:
+		UiBench(const string& resource_path, const uvec2& size);
+		~UiBench();
+
+		using Scenario = void(UiBench::*)(Widget& parent);
+
+		static Scenario scenario(const string& name);
+
+		void run(Scenario scenario, size_t frames);
+		void print(const string& name) const;
+
+		void docks(Widget& parent);
+		void table(Widget& parent);
+		void virtual_table(Widget& parent);
+		void nodes(Widget& parent);
+		void editors(Widget& parent);
+
+		// the scene state is declared first, so that it outlives the widgets that reference it
+		Docksystem m_docksystem;
+		vector<string> m_cells;
+		vector<vec2> m_node_positions;
+		vector<string> m_texts;
+		bool m_checks[64] = {};
+
+		NullRenderSystem m_render_system;
+		NullContext m_context;
+		VgNull m_vg;
+		UiWindow m_window;
+
+		// when loaded, input is replayed from the record instead of generated
+		InputRecord m_replay;
+		bool m_replaying = false;
+
+		// when set, the input fed to the window is recorded, to be replayed later on
+		InputRecord* m_record = nullptr;
+
+		BenchTiming m_phases[size_t(BenchPhase::Count)];
+		size_t m_frames = 0;
+		size_t m_draw_calls = 0;
+		size_t m_glyphs = 0;
+		size_t m_solved_frames = 0;
+
+	private:
+		void input(size_t frame);
+	};
+}
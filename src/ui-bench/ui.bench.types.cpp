@@ -0,0 +1,13 @@
+#ifdef TWO_MODULES
+module;
+#include <infra/Cpp20.h>
+module two.ui.bench;
+#else
+#include <ui-bench/Types.h>
+#include <ui-bench/Api.h>
+#include <type/Vector.h>
+#endif
+
+namespace two
+{
+}
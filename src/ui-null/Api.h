@@ -0,0 +1,2 @@
+#include <ui-null/VgNull.h>
+#include <ui-null/NullContext.h>
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <infra/Config.h>
+
+#include <infra/Forward.h>
+#include <type/Forward.h>
+#include <math/Forward.h>
+#include <ctx/Forward.h>
+#include <ui/Forward.h>
+
+#ifndef TWO_UI_NULL_EXPORT
+#define TWO_UI_NULL_EXPORT TWO_IMPORT
+#endif
+
+namespace two
+{
+    struct VgNullStats;
+    class VgNull;
+    class NullRenderSystem;
+    class NullContext;
+}
@@ -0,0 +1,42 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#include <infra/Cpp20.h>
+
+#ifdef TWO_MODULES
+module two.ui.null;
+#else
+#include <math/Vec.hpp>
+#include <ctx/InputDevice.h>
+#include <ui-null/NullContext.h>
+#endif
+
+namespace two
+{
+	NullRenderSystem::NullRenderSystem(const string& resource_path, bool manual_render)
+		: RenderSystem(resource_path, manual_render)
+	{}
+
+	NullContext::NullContext(RenderSystem& render_system, const string& title, const uvec2& size)
+		: Context(render_system, title, size, false, true)
+	{
+		m_fb_size = size;
+	}
+
+	void NullContext::reset_fb(const uvec2& size)
+	{
+		m_fb_size = size;
+	}
+
+	void NullContext::init_input(Mouse& mouse, Keyboard& keyboard)
+	{
+		m_mouse = &mouse;
+		m_keyboard = &keyboard;
+	}
+
+	bool NullContext::begin_frame()
+	{
+		return !m_shutdown;
+	}
+}
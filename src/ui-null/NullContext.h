@@ -0,0 +1,42 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#pragma once
+
+#ifndef TWO_MODULES
+#include <stl/string.h>
+#include <ctx/Context.h>
+#endif
+#include <ui-null/Forward.h>
+
+namespace two
+{
+	export_ class TWO_UI_NULL_EXPORT NullRenderSystem : public RenderSystem
+	{
+	public:
+		NullRenderSystem(const string& resource_path, bool manual_render = true);
+
+		virtual bool begin_frame() override { return true; }
+		virtual void end_frame() override {}
+	};
+
+	// a context without a window : input is injected through the devices it was given
+	export_ class TWO_UI_NULL_EXPORT NullContext : public Context
+	{
+	public:
+		NullContext(RenderSystem& render_system, const string& title, const uvec2& size);
+
+		virtual void reset_fb(const uvec2& size) override;
+		virtual void init_input(Mouse& mouse, Keyboard& keyboard) override;
+
+		virtual bool begin_frame() override;
+		virtual void render_frame() override {}
+		virtual void end_frame() override {}
+
+		virtual void lock_mouse(bool locked) override { m_mouse_lock = locked; }
+
+		Mouse* m_mouse = nullptr;
+		Keyboard* m_keyboard = nullptr;
+	};
+}
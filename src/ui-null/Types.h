@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include <stl/string.h>
+#include <stl/vector.h>
+#include <ui-null/Forward.h>
+
+#if !defined TWO_MODULES || defined TWO_TYPE_LIB
+#include <type/Type.h>
+#endif
+
+#ifndef TWO_MODULES
+#include <infra/Types.h>
+#include <type/Types.h>
+#include <math/Types.h>
+#include <ui/Types.h>
+#endif
+
+namespace two
+{
+    // Exported types
+    
+    
+}
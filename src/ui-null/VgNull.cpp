@@ -0,0 +1,165 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#include <infra/Cpp20.h>
+
+#ifdef TWO_MODULES
+module two.ui.null;
+#else
+#include <stl/vector.hpp>
+#include <math/Vec.hpp>
+#include <math/Image.h>
+#include <ui/Style/Paint.h>
+#include <ui/Frame/Caption.h>
+#include <ui-null/VgNull.h>
+#endif
+
+namespace two
+{
+	VgNull::VgNull(cstring resource_path)
+		: Vg(resource_path)
+		, m_measure(*this)
+	{}
+
+	VgNull::~VgNull()
+	{}
+
+	void VgNull::load_default_font()
+	{
+		this->load_font("dejavu");
+	}
+
+	void VgNull::load_font(cstring name)
+	{
+		m_measure.font(name);
+	}
+
+	void VgNull::load_image_RGBA(Image& image, const unsigned char* data)
+	{
+		UNUSED(data);
+		image.d_handle = int(m_images++);
+	}
+
+	void VgNull::load_image(Image& image)
+	{
+		image.d_handle = int(m_images++);
+	}
+
+	void VgNull::unload_image(Image& image)
+	{
+		image.d_handle = -1;
+	}
+
+	void VgNull::begin_frame(uint16_t view, const vec4& rect, float pixel_ratio, const Colour& colour)
+	{
+		UNUSED(view); UNUSED(rect); UNUSED(pixel_ratio); UNUSED(colour);
+		m_stats = {};
+		m_state = State();
+		m_states.clear();
+	}
+
+	void VgNull::begin_target()
+	{
+		m_states.push_back(m_state);
+		m_state.m_offset = vec2(0.f);
+		m_state.m_scale = 1.f;
+	}
+
+	void VgNull::end_target()
+	{
+		m_state = m_states.back();
+		m_states.pop_back();
+	}
+
+	void VgNull::begin_layer(Layer& layer, const vec2& position, float scale)
+	{
+		UNUSED(layer);
+		m_stats.m_layers++;
+		this->begin_update(position, scale);
+	}
+
+	void VgNull::end_layer()
+	{
+		this->end_update();
+	}
+
+	void VgNull::begin_cached(Layer& layer)
+	{
+		UNUSED(layer);
+		m_stats.m_cached++;
+		m_states.push_back(m_state);
+		m_state = State();
+	}
+
+	void VgNull::end_cached()
+	{
+		m_state = m_states.back();
+		m_states.pop_back();
+	}
+
+	void VgNull::begin_update(const vec2& position, float scale)
+	{
+		m_states.push_back(m_state);
+		m_state.m_offset = this->transform(position);
+		m_state.m_scale *= scale;
+	}
+
+	void VgNull::end_update()
+	{
+		m_state = m_states.back();
+		m_states.pop_back();
+	}
+
+	bool VgNull::clipped(const vec4& rect)
+	{
+		const vec4 absolute = vec4(this->transform(vec2(rect.x, rect.y)), vec2(rect.width, rect.height) * m_state.m_scale);
+		return !rect_intersects(absolute, m_state.m_scissor);
+	}
+
+	void VgNull::clip(const vec4& rect)
+	{
+		m_stats.m_clips++;
+		const vec4 absolute = vec4(this->transform(vec2(rect.x, rect.y)), vec2(rect.width, rect.height) * m_state.m_scale);
+		const vec2 lo = max(vec2(m_state.m_scissor.x, m_state.m_scissor.y), vec2(absolute.x, absolute.y));
+		const vec2 hi = min(vec2(m_state.m_scissor.x + m_state.m_scissor.width, m_state.m_scissor.y + m_state.m_scissor.height), vec2(absolute.x + absolute.width, absolute.y + absolute.height));
+		m_state.m_scissor = vec4(lo, max(hi - lo, vec2(0.f)));
+	}
+
+	void VgNull::unclip()
+	{
+		m_state.m_scissor = State().m_scissor;
+	}
+
+	void VgNull::draw_text(const vec2& offset, const char* start, const char* end, const TextPaint& paint)
+	{
+		UNUSED(offset); UNUSED(paint);
+		m_stats.m_texts++;
+		m_stats.m_glyphs += size_t(end - start);
+	}
+
+	void VgNull::break_next_row(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row)
+	{
+		m_measure.break_next_row(text, first, end, rect, paint, row);
+	}
+
+	void VgNull::break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& row, vector<TextGlyph>& glyphs)
+	{
+		m_measure.break_glyphs(rect, paint, row, glyphs);
+	}
+
+	float VgNull::line_height(const TextPaint& paint)
+	{
+		return m_measure.line_height(paint);
+	}
+
+	vec2 VgNull::text_size(cstring text, size_t len, const TextPaint& paint)
+	{
+		return m_measure.text_size(text, len, paint);
+	}
+
+	float VgNull::text_size(cstring text, size_t len, Axis dim, const TextPaint& paint)
+	{
+		return dim == Axis::X ? text_size(text, len, paint).x : text_size(text, len, paint).y;
+	}
+}
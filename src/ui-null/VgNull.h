@@ -0,0 +1,131 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#pragma once
+
+#ifndef TWO_MODULES
+#include <stl/string.h>
+#include <stl/vector.h>
+#include <stl/memory.h>
+#endif
+#include <ui-null/Forward.h>
+#include <ui/UiRenderer.h>
+#include <ui/Frame/TextMeasure.h>
+
+namespace two
+{
+	// draw calls recorded since the last begin_frame
+	export_ struct TWO_UI_NULL_EXPORT VgNullStats
+	{
+		size_t m_layers = 0;
+		size_t m_cached = 0;
+		size_t m_clips = 0;
+		size_t m_paths = 0;
+		size_t m_fills = 0;
+		size_t m_strokes = 0;
+		size_t m_shadows = 0;
+		size_t m_textures = 0;
+		size_t m_texts = 0;
+		size_t m_glyphs = 0;
+
+		size_t draw_calls() const { return m_fills + m_strokes + m_shadows + m_textures + m_texts; }
+	};
+
+	// a renderer that draws nothing : draw calls are only counted, and text is measured from the font files
+	// so that layouts are the same as with a real renderer, without a window or a GPU
+	export_ class TWO_UI_NULL_EXPORT VgNull : public Vg
+	{
+	public:
+		VgNull(cstring resource_path);
+		~VgNull();
+
+		// init
+		virtual void setup_context() override {}
+		virtual void release_context() override {}
+
+		// setup
+		virtual void load_default_font() override;
+		virtual void load_font(cstring name) override;
+		virtual void load_image_RGBA(Image& image, const unsigned char* data) override;
+		virtual void load_image(Image& image) override;
+		virtual void unload_image(Image& image) override;
+		virtual uint16_t load_texture(uint16_t texture) override { return texture; }
+
+		// rendering
+		virtual void begin_frame(uint16_t view, const vec4& rect, float pixel_ratio, const Colour& colour = Colour(0.f)) override;
+		virtual void end_frame(uint16_t view) override { UNUSED(view); }
+
+		// drawing
+		virtual void begin_target() override;
+		virtual void end_target() override;
+
+		virtual void begin_layer(Layer& layer, const vec2& position, float scale) override;
+		virtual void end_layer() override;
+
+		virtual bool retained() const override { return m_retained; }
+		virtual void begin_cached(Layer& layer) override;
+		virtual void end_cached() override;
+
+		virtual void draw_layer(Layer& layer, const vec2& position, float scale) override { UNUSED(layer); UNUSED(position); UNUSED(scale); m_stats.m_layers++; }
+
+		virtual void begin_update(const vec2& position, float scale) override;
+		virtual void end_update() override;
+
+		virtual bool clipped(const vec4& rect) override;
+		virtual void clip(const vec4& rect) override;
+		virtual void unclip() override;
+
+		virtual void begin_path() override { m_stats.m_paths++; }
+		virtual void move_to(const vec2& p) override { UNUSED(p); }
+		virtual void line_to(const vec2& p) override { UNUSED(p); }
+		virtual void close_path() override {}
+
+		virtual void path_line(const vec2& p1, const vec2& p2) override { UNUSED(p1); UNUSED(p2); }
+		virtual void path_bezier(const vec2& p1, const vec2& c1, const vec2& c2, const vec2& p2, bool straighten) override { UNUSED(p1); UNUSED(c1); UNUSED(c2); UNUSED(p2); UNUSED(straighten); }
+		virtual void path_rect(const vec4& rect, const vec4& corners, float border) override { UNUSED(rect); UNUSED(corners); UNUSED(border); }
+		virtual void path_circle(const vec2& center, float r) override { UNUSED(center); UNUSED(r); }
+
+		virtual void fill(const Gradient& gradient, const vec2& start, const vec2& end) override { UNUSED(gradient); UNUSED(start); UNUSED(end); m_stats.m_fills++; }
+		virtual void fill(const Paint& paint) override { UNUSED(paint); m_stats.m_fills++; }
+		virtual void stroke(const Paint& paint) override { UNUSED(paint); m_stats.m_strokes++; }
+
+		virtual void stroke_gradient(const Gradient& paint, float width, const vec2& start, const vec2& end) override { UNUSED(paint); UNUSED(width); UNUSED(start); UNUSED(end); m_stats.m_strokes++; }
+
+		virtual void draw_shadow(const vec4& rect, const vec4& corner, const Shadow& shadows) override { UNUSED(rect); UNUSED(corner); UNUSED(shadows); m_stats.m_shadows++; }
+		virtual void draw_texture(uint16_t texture, const vec4& rect, const vec4& image_rect) override { UNUSED(texture); UNUSED(rect); UNUSED(image_rect); m_stats.m_textures++; }
+		virtual void draw_text(const vec2& offset, const char* start, const char* end, const TextPaint& paint) override;
+
+		virtual void draw_color_wheel(const vec2& center, float r0, float r1) override { UNUSED(center); UNUSED(r0); UNUSED(r1); m_stats.m_fills++; }
+		virtual void draw_color_triangle(const vec2& center, float r0, float hue, float s, float l) override { UNUSED(center); UNUSED(r0); UNUSED(hue); UNUSED(s); UNUSED(l); m_stats.m_fills++; }
+
+		virtual void break_next_row(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row) override;
+		virtual void break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& textRow, vector<TextGlyph>& glyphs) override;
+
+		virtual float line_height(const TextPaint& paint) override;
+		virtual float text_size(cstring text, size_t len, Axis dim, const TextPaint& paint) override;
+		virtual vec2 text_size(cstring text, size_t len, const TextPaint& paint) override;
+
+		// layers are recorded only when damaged, as with a retained renderer
+		bool m_retained = true;
+
+		VgNullStats m_stats;
+
+	private:
+		// the transform and clip rect are tracked as VgBatch does, so that culling of clipped frames is measured too
+		struct State
+		{
+			vec2 m_offset = vec2(0.f);
+			float m_scale = 1.f;
+			vec4 m_scissor = vec4(-1e6f, -1e6f, 2e6f, 2e6f);
+		};
+
+		vec2 transform(const vec2& p) const { return p * m_state.m_scale + m_state.m_offset; }
+
+		State m_state;
+		vector<State> m_states;
+
+		TextMeasure m_measure;
+		uint16_t m_images = 0;
+	};
+}
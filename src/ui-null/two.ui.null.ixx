@@ -0,0 +1,16 @@
+module;
+#include <cpp/preimport.h>
+#include <infra/Config.h>
+
+export module two.ui.null;
+export import std.core;
+export import std.threading;
+export import std.regex;
+
+export import two.infra;
+export import two.type;
+export import two.math;
+export import two.ctx;
+export import two.ui;
+
+#include <ui-null/Api.h>
@@ -0,0 +1,18 @@
+
+
+#ifdef TWO_MODULES
+module;
+#include <infra/Cpp20.h>
+module two.ui-null;
+#else
+#include <ui-null/Types.h>
+#include <ui-null/Api.h>
+#include <type/Vector.h>
+//#include <ecs/Proto.h>
+#endif
+
+namespace two
+{
+    // Exported types
+    
+}
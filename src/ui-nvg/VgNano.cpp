@@ -320,30 +320,30 @@ namespace two
 		VgRenderer::break_text(text, len, space, paint, text_rows);
 	}
 
-	void VgNano::break_next_row(const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row)
+	void VgNano::break_next_row(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row)
 	{
 		UNUSED(paint);
 		NVGtextRow nvgTextRow;
 		nvgTextBreakLines(m_ctx, first, end, rect.z, &nvgTextRow, 1);
 
-		row.m_start = nvgTextRow.start;
-		row.m_end = nvgTextRow.end;
-		row.m_rect = vec4{ rect.x, rect.y, nvgTextRow.width, m_line_height };
+		row = text_row(text, nvgTextRow.start, nvgTextRow.end, { rect.x, rect.y, nvgTextRow.width, m_line_height });
 	}
 
-	void VgNano::break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& textRow)
+	void VgNano::break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& textRow, vector<TextGlyph>& glyphs)
 	{
 		UNUSED(paint);
-		size_t numGlyphs = textRow.m_end - textRow.m_start;
-		vector<NVGglyphPosition> glyphs(numGlyphs);
-		textRow.m_glyphs.resize(numGlyphs);
+		const size_t numGlyphs = textRow.m_end - textRow.m_start;
+		vector<NVGglyphPosition> positions(numGlyphs);
 
-		nvgTextGlyphPositions(m_ctx, rect.x, rect.y, textRow.m_start, textRow.m_end, &glyphs.front(), glyphs.size());
+		const size_t first = glyphs.size();
+		glyphs.resize(first + numGlyphs);
 
-		for(size_t i = 0; i < glyphs.size(); ++i)
+		nvgTextGlyphPositions(m_ctx, rect.x, rect.y, textRow.m_start, textRow.m_end, positions.data(), int(numGlyphs));
+
+		for(size_t i = 0; i < numGlyphs; ++i)
 		{
-			textRow.m_glyphs[i].m_position = textRow.m_start + i;
-			textRow.m_glyphs[i].m_rect = vec4{ glyphs[i].minx, textRow.m_rect.y, glyphs[i].maxx - glyphs[i].minx, rect_h(textRow.m_rect) };
+			glyphs[first + i].m_index = textRow.m_start_index + i;
+			glyphs[first + i].m_rect = vec4{ positions[i].minx, textRow.m_rect.y, positions[i].maxx - positions[i].minx, textRow.m_rect.height };
 		}
 	}
 
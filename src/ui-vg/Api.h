@@ -1,2 +1,3 @@
 #include <ui-vg/VgVg.h>
+#include <ui-vg/VgBatch.h>
 
@@ -14,4 +14,5 @@
 namespace two
 {
     class VgVg;
+    class VgBatch;
 }
@@ -0,0 +1,989 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#include <infra/Cpp20.h>
+#ifndef TWO_CPP_20
+#include <cmath>
+#include <cstring>
+#endif
+
+#ifdef TWO_MODULES
+#define _GLIBCXX_TYPE_TRAITS
+#endif
+#include <bgfx/bgfx.h>
+
+// the glyphs distance fields are generated with stb_truetype, kept private to this backend
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <stb_truetype.h>
+
+#ifdef TWO_MODULES
+module two.ui.vg;
+#else
+#include <stb_image.h>
+
+#include <stl/vector.hpp>
+#include <stl/unordered_map.hpp>
+#include <infra/File.h>
+#include <infra/Log.h>
+#include <math/Math.h>
+#include <math/Vec.hpp>
+#include <math/Image.h>
+#include <ui/Style/Paint.h>
+#include <ui/Frame/Layer.h>
+#include <ui/Frame/Caption.h>
+#include <ui/Frame/TextMeasure.h>
+#include <ui-vg/VgBatch.h>
+#endif
+
+namespace two
+{
+	// glyphs are rasterized once at this size, and scaled from the distance field
+	static const float c_sdf_size = 32.f;
+	static const int c_sdf_padding = 4;
+	static const uint16_t c_glyph_atlas_size = 1024;
+
+	static const vec4 c_no_scissor = vec4(-1e6f, -1e6f, 2e6f, 2e6f);
+	static const vec4 c_no_shape = vec4(1e6f, 1e6f, 0.f, 1.f);
+
+	enum BatchMode : uint32_t { Shape = 0, Textured = 1, Glyph = 2 };
+
+	inline uint32_t lerp_abgr(uint32_t a, uint32_t b, float t)
+	{
+		uint32_t result = 0;
+		for(uint32_t shift = 0; shift < 32; shift += 8)
+		{
+			const float ca = float((a >> shift) & 0xFF);
+			const float cb = float((b >> shift) & 0xFF);
+			result |= uint32_t(ca + (cb - ca) * t + 0.5f) << shift;
+		}
+		return result;
+	}
+
+	inline uint32_t gradient_abgr(const vec2& p, const vec2& start, const vec2& end, uint32_t first, uint32_t last)
+	{
+		const vec2 axis = end - start;
+		const float length2 = dot(axis, axis);
+		if(length2 == 0.f || first == last)
+			return first;
+		return lerp_abgr(first, last, clamp(dot(p - start, axis) / length2, 0.f, 1.f));
+	}
+
+	void BatchList::clear()
+	{
+		m_vertices.clear();
+		m_indices.clear();
+		m_draws.clear();
+	}
+
+	void BatchList::release()
+	{
+		if(bgfx::isValid(m_vertex_buffer))
+			bgfx::destroy(m_vertex_buffer);
+		if(bgfx::isValid(m_index_buffer))
+			bgfx::destroy(m_index_buffer);
+		m_vertex_buffer = BGFX_INVALID_HANDLE;
+		m_index_buffer = BGFX_INVALID_HANDLE;
+	}
+
+	struct BatchGlyph
+	{
+		bool m_loaded = false;
+		vec4 m_quad;			// relative to the pen on the baseline, at the distance field size
+		vec4 m_uv;
+	};
+
+	// the glyphs rasterized from a measured font : the layout itself comes from the measured font
+	struct BatchFont
+	{
+		MeasuredFont* m_font = nullptr;
+		stbtt_fontinfo m_info;
+		bool m_loaded = false;
+
+		BatchGlyph m_ascii[128];
+		unordered_map<uint32_t, BatchGlyph> m_glyphs;
+	};
+
+	// shelf packed distance field atlas : glyphs are rasterized on first use and never evicted
+	struct VgBatch::GlyphAtlas
+	{
+		bgfx::TextureHandle m_texture = BGFX_INVALID_HANDLE;
+		uint16_t m_x = 0;
+		uint16_t m_y = 0;
+		uint16_t m_row = 0;
+
+		bool place(uint16_t width, uint16_t height, uint16_t& x, uint16_t& y)
+		{
+			if(m_x + width > c_glyph_atlas_size)
+			{
+				m_x = 0;
+				m_y += m_row;
+				m_row = 0;
+			}
+			if(m_y + height > c_glyph_atlas_size || width > c_glyph_atlas_size)
+				return false;
+			x = m_x;
+			y = m_y;
+			m_x += width + 1;
+			m_row = max(m_row, uint16_t(height + 1));
+			return true;
+		}
+	};
+
+	VgBatch::VgBatch(const string& resource_path, ProgramSource program)
+		: Vg(resource_path.c_str())
+		, m_resource_path(resource_path)
+		, m_program(move(program))
+		, m_glyph_atlas(make_unique<GlyphAtlas>())
+		, m_measure(*this)
+	{}
+
+	VgBatch::~VgBatch()
+	{}
+
+	void VgBatch::setup_context()
+	{
+		m_layout.begin()
+			.add(bgfx::Attrib::Position, 2, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::TexCoord1, 2, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::Tangent, 4, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::Weight, 4, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
+			.add(bgfx::Attrib::Color1, 4, bgfx::AttribType::Uint8, true)
+			.add(bgfx::Attrib::TexCoord2, 1, bgfx::AttribType::Float)
+			.end();
+
+		u_image = bgfx::createUniform("s_ui_image", bgfx::UniformType::Sampler);
+		u_glyphs = bgfx::createUniform("s_ui_glyphs", bgfx::UniformType::Sampler);
+
+		m_glyph_atlas->m_texture = bgfx::createTexture2D(c_glyph_atlas_size, c_glyph_atlas_size, false, 1, bgfx::TextureFormat::R8, BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP);
+
+		// handle 0 is a white texel, bound when a draw samples no image
+		const uint32_t white = 0xFFFFFFFF;
+		m_white = this->add_texture(bgfx::createTexture2D(1, 1, false, 1, bgfx::TextureFormat::RGBA8, 0, bgfx::copy(&white, sizeof(uint32_t))), true);
+	}
+
+	void VgBatch::release_context()
+	{
+		m_immediate.release();
+		for(auto& layer : m_layers)
+			if(layer) layer->release();
+
+		for(size_t i = 0; i < m_textures.size(); ++i)
+			if(m_owned[i] && bgfx::isValid(m_textures[i]))
+				bgfx::destroy(m_textures[i]);
+		m_textures.clear();
+		m_owned.clear();
+		m_free_textures.clear();
+
+		if(bgfx::isValid(m_glyph_atlas->m_texture))
+			bgfx::destroy(m_glyph_atlas->m_texture);
+		bgfx::destroy(u_image);
+		bgfx::destroy(u_glyphs);
+	}
+
+	void VgBatch::load_default_font()
+	{
+		this->load_font("dejavu");
+	}
+
+	void VgBatch::load_font(cstring name)
+	{
+		this->font(name);
+	}
+
+	BatchFont& VgBatch::font(cstring name)
+	{
+		MeasuredFont& measured = m_measure.font(name);
+		for(auto& font : m_fonts)
+			if(font->m_font == &measured)
+				return *font;
+
+		unique<BatchFont> font = make_unique<BatchFont>();
+		font->m_font = &measured;
+
+		// a font measured as monospace has no outlines : its text is laid out but draws no glyphs
+		const unsigned char* data = measured.m_data.data();
+		font->m_loaded = measured.m_loaded && stbtt_InitFont(&font->m_info, data, stbtt_GetFontOffsetForIndex(data, 0));
+
+		m_fonts.push_back(move(font));
+		return *m_fonts.back();
+	}
+
+	BatchGlyph& VgBatch::glyph(BatchFont& font, uint32_t codepoint)
+	{
+		GlyphAtlas& atlas = *m_glyph_atlas;
+		BatchGlyph& glyph = codepoint < 128 ? font.m_ascii[codepoint] : font.m_glyphs[codepoint];
+		if(glyph.m_loaded)
+			return glyph;
+
+		glyph.m_loaded = true;
+		if(!font.m_loaded)
+			return glyph;
+
+		int width, height, xoff, yoff;
+		const float scale = font.m_font->scale(c_sdf_size);
+		unsigned char* sdf = stbtt_GetCodepointSDF(&font.m_info, scale, int(codepoint), c_sdf_padding, 128, 128.f / float(c_sdf_padding), &width, &height, &xoff, &yoff);
+		if(!sdf)
+			return glyph;
+
+		uint16_t x, y;
+		if(atlas.place(uint16_t(width), uint16_t(height), x, y))
+		{
+			bgfx::updateTexture2D(atlas.m_texture, 0, 0, x, y, uint16_t(width), uint16_t(height), bgfx::copy(sdf, uint32_t(width * height)), uint16_t(width));
+
+			const float inv = 1.f / float(c_glyph_atlas_size);
+			glyph.m_quad = vec4(float(xoff), float(yoff), float(width), float(height));
+			glyph.m_uv = vec4(float(x) * inv, float(y) * inv, float(x + width) * inv, float(y + height) * inv);
+		}
+		else
+			warn("ui: glyph atlas is full");
+
+		stbtt_FreeSDF(sdf, nullptr);
+		return glyph;
+	}
+
+	uint16_t VgBatch::add_texture(bgfx::TextureHandle texture, bool owned)
+	{
+		if(!m_free_textures.empty())
+		{
+			const uint16_t index = m_free_textures.back();
+			m_free_textures.pop_back();
+			m_textures[index] = texture;
+			m_owned[index] = owned;
+			return index;
+		}
+
+		m_textures.push_back(texture);
+		m_owned.push_back(owned);
+		return uint16_t(m_textures.size() - 1);
+	}
+
+	void VgBatch::load_image_RGBA(Image& image, const unsigned char* data)
+	{
+		const uint64_t flags = image.d_filtering ? 0 : BGFX_SAMPLER_MIN_POINT | BGFX_SAMPLER_MAG_POINT;
+		const uint32_t size = image.d_size.x * image.d_size.y * 4;
+		image.d_handle = int(this->add_texture(bgfx::createTexture2D(uint16_t(image.d_size.x), uint16_t(image.d_size.y), false, 1, bgfx::TextureFormat::RGBA8, flags, bgfx::copy(data, size)), true));
+	}
+
+	void VgBatch::load_image(Image& image)
+	{
+		int w, h, n;
+		stbi_set_unpremultiply_on_load(1);
+		stbi_convert_iphone_png_to_rgb(1);
+		unsigned char* img = stbi_load(image.d_path.c_str(), &w, &h, &n, 4);
+		if(!img)
+			return;
+		image.d_size = uvec2(uint(w), uint(h));
+		this->load_image_RGBA(image, img);
+		stbi_image_free(img);
+	}
+
+	void VgBatch::unload_image(Image& image)
+	{
+		const size_t index = size_t(image.d_handle);
+		if(index < m_textures.size() && index != m_white && m_owned[index] && bgfx::isValid(m_textures[index]))
+		{
+			bgfx::destroy(m_textures[index]);
+			m_textures[index] = BGFX_INVALID_HANDLE;
+			m_free_textures.push_back(uint16_t(index));
+		}
+		image.d_handle = 0;
+	}
+
+	uint16_t VgBatch::load_texture(uint16_t texture)
+	{
+		for(size_t i = 0; i < m_textures.size(); ++i)
+			if(!m_owned[i] && m_textures[i].idx == texture)
+				return uint16_t(i);
+		return this->add_texture({ texture }, false);
+	}
+
+	void VgBatch::begin_frame(uint16_t view, const vec4& rect, float pixel_ratio, const Colour& colour)
+	{
+		m_view = view;
+		m_pixel_ratio = pixel_ratio;
+		m_draw_calls = 0;
+
+		bgfx::setViewClear(view, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, to_rgba(colour), 1.0f, 0);
+		bgfx::setViewRect(view, uint16_t(rect.x), uint16_t(rect.y), uint16_t(rect.width), uint16_t(rect.height));
+		bgfx::setViewMode(view, bgfx::ViewMode::Sequential);
+		bgfx::setViewName(view, "ui");
+
+		// geometry is in logical pixels : the projection alone maps it to the viewport
+		const float w = rect.width / pixel_ratio;
+		const float h = rect.height / pixel_ratio;
+		const float proj[16] = { 2.f / w, 0.f, 0.f, 0.f,  0.f, -2.f / h, 0.f, 0.f,  0.f, 0.f, 1.f, 0.f,  -1.f, 1.f, 0.f, 1.f };
+		bgfx::setViewTransform(view, nullptr, proj);
+		bgfx::touch(view);
+
+		m_state = State();
+		m_states.clear();
+		m_immediate.clear();
+		m_list = &m_immediate;
+	}
+
+	void VgBatch::end_frame(uint16_t view)
+	{
+		UNUSED(view);
+		this->submit(m_immediate, true);
+		m_immediate.clear();
+	}
+
+	void VgBatch::begin_target()
+	{
+		m_states.push_back(m_state);
+		m_state.m_offset = vec2(0.f);
+		m_state.m_scale = 1.f;
+	}
+
+	void VgBatch::end_target()
+	{
+		m_state = m_states.back();
+		m_states.pop_back();
+	}
+
+	void VgBatch::begin_layer(Layer& layer, const vec2& position, float scale)
+	{
+		UNUSED(layer);
+		this->begin_update(position, scale);
+	}
+
+	void VgBatch::end_layer()
+	{
+		this->end_update();
+	}
+
+	void VgBatch::begin_cached(Layer& layer)
+	{
+		if(layer.d_handle == SIZE_MAX)
+		{
+			if(!m_free_layers.empty())
+			{
+				layer.d_handle = m_free_layers.back();
+				m_free_layers.pop_back();
+			}
+			else
+			{
+				layer.d_handle = m_layers.size();
+				m_layers.push_back(make_unique<BatchList>());
+			}
+		}
+
+		m_list = m_layers[layer.d_handle].get();
+		m_list->clear();
+
+		m_states.push_back(m_state);
+		m_state = State();
+	}
+
+	void VgBatch::end_cached()
+	{
+		// the layer geometry lives in static buffers until the layer is recorded again
+		BatchList& list = *m_list;
+		list.release();
+		if(!list.m_indices.empty())
+		{
+			list.m_vertex_buffer = bgfx::createVertexBuffer(bgfx::copy(list.m_vertices.data(), uint32_t(list.m_vertices.size() * sizeof(BatchVertex))), m_layout);
+			list.m_index_buffer = bgfx::createIndexBuffer(bgfx::copy(list.m_indices.data(), uint32_t(list.m_indices.size() * sizeof(uint16_t))));
+		}
+
+		m_state = m_states.back();
+		m_states.pop_back();
+		m_list = &m_immediate;
+	}
+
+	void VgBatch::draw_layer(Layer& layer, const vec2& position, float scale)
+	{
+		UNUSED(position); UNUSED(scale);
+		// immediate geometry drawn before this layer must be submitted first to keep the draw order
+		this->submit(m_immediate, true);
+		m_immediate.clear();
+
+		if(layer.d_handle != SIZE_MAX)
+			this->submit(*m_layers[layer.d_handle], false);
+	}
+
+	void VgBatch::release_layer(Layer& layer)
+	{
+		if(layer.d_handle == SIZE_MAX) return;
+		BatchList& list = *m_layers[layer.d_handle];
+		list.release();
+		list.clear();
+		m_free_layers.push_back(uint32_t(layer.d_handle));
+		layer.d_handle = SIZE_MAX;
+	}
+
+	void VgBatch::submit(const BatchDraw& draw, bgfx::ProgramHandle program)
+	{
+		if(draw.m_scissor != c_no_scissor)
+		{
+			const vec4 scissor = draw.m_scissor * m_pixel_ratio;
+			const float x = max(0.f, floor(scissor.x));
+			const float y = max(0.f, floor(scissor.y));
+			const float w = max(0.f, ceil(scissor.x + scissor.width) - x);
+			const float h = max(0.f, ceil(scissor.y + scissor.height) - y);
+			bgfx::setScissor(uint16_t(x), uint16_t(y), uint16_t(min(w, 65535.f)), uint16_t(min(h, 65535.f)));
+		}
+
+		const uint64_t state = BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_BLEND_ALPHA;
+
+		const uint16_t texture = draw.m_texture == UINT16_MAX ? m_white : draw.m_texture;
+		bgfx::setTexture(0, u_image, bgfx::isValid(m_textures[texture]) ? m_textures[texture] : m_textures[m_white]);
+		bgfx::setTexture(1, u_glyphs, m_glyph_atlas->m_texture);
+		bgfx::setState(state);
+		bgfx::submit(m_view, program);
+		m_draw_calls++;
+	}
+
+	void VgBatch::submit(BatchList& list, bool transient)
+	{
+		if(list.m_indices.empty())
+			return;
+
+		const bgfx::ProgramHandle program = m_program();
+		if(!bgfx::isValid(program))
+			return;
+
+		if(!transient)
+		{
+			for(const BatchDraw& draw : list.m_draws)
+				if(draw.m_count > 0)
+				{
+					bgfx::setVertexBuffer(0, list.m_vertex_buffer, draw.m_base, draw.m_vertex_count);
+					bgfx::setIndexBuffer(list.m_index_buffer, draw.m_first, draw.m_count);
+					this->submit(draw, program);
+				}
+			return;
+		}
+
+		// draws are laid out in order in the vertex and index streams : when the transient buffers can't hold the whole list,
+		// it is split in runs of consecutive draws, each copied in its own transient buffers
+		const vector<BatchDraw>& draws = list.m_draws;
+		size_t first = 0;
+		while(first < draws.size())
+		{
+			const uint32_t base = draws[first].m_base;
+			const uint32_t first_index = draws[first].m_first;
+			const uint32_t avail_vertices = bgfx::getAvailTransientVertexBuffer(UINT32_MAX, m_layout);
+			const uint32_t avail_indices = bgfx::getAvailTransientIndexBuffer(UINT32_MAX);
+
+			size_t last = first;
+			while(last < draws.size()
+			   && draws[last].m_base + draws[last].m_vertex_count - base <= avail_vertices
+			   && draws[last].m_first + draws[last].m_count - first_index <= avail_indices)
+				last++;
+
+			if(last == first)
+			{
+				warn("ui: out of transient buffers, %zu draws dropped", draws.size() - first);
+				return;
+			}
+
+			const uint32_t num_vertices = draws[last - 1].m_base + draws[last - 1].m_vertex_count - base;
+			const uint32_t num_indices = draws[last - 1].m_first + draws[last - 1].m_count - first_index;
+
+			bgfx::TransientVertexBuffer vertices;
+			bgfx::TransientIndexBuffer indices;
+			bgfx::allocTransientVertexBuffer(&vertices, num_vertices, m_layout);
+			bgfx::allocTransientIndexBuffer(&indices, num_indices);
+			memcpy(vertices.data, list.m_vertices.data() + base, num_vertices * sizeof(BatchVertex));
+			memcpy(indices.data, list.m_indices.data() + first_index, num_indices * sizeof(uint16_t));
+
+			for(size_t i = first; i < last; ++i)
+			{
+				const BatchDraw& draw = draws[i];
+				if(draw.m_count == 0)
+					continue;
+
+				bgfx::setVertexBuffer(0, &vertices, draw.m_base - base, draw.m_vertex_count);
+				bgfx::setIndexBuffer(&indices, draw.m_first - first_index, draw.m_count);
+				this->submit(draw, program);
+			}
+
+			first = last;
+		}
+	}
+
+	void VgBatch::begin_update(const vec2& position, float scale)
+	{
+		m_states.push_back(m_state);
+		m_state.m_offset = this->transform(position);
+		m_state.m_scale *= scale;
+	}
+
+	void VgBatch::end_update()
+	{
+		m_state = m_states.back();
+		m_states.pop_back();
+	}
+
+	inline vec4 rect_intersection(const vec4& a, const vec4& b)
+	{
+		const vec2 lo = max(vec2(a.x, a.y), vec2(b.x, b.y));
+		const vec2 hi = min(vec2(a.x + a.width, a.y + a.height), vec2(b.x + b.width, b.y + b.height));
+		return vec4(lo, max(hi - lo, vec2(0.f)));
+	}
+
+	bool VgBatch::clipped(const vec4& rect)
+	{
+		// the clip state is tracked on the cpu, so culling holds when recording a layer too
+		const vec4 absolute = vec4(this->transform(vec2(rect.x, rect.y)), vec2(rect.width, rect.height) * m_state.m_scale);
+		return !rect_intersects(absolute, m_state.m_scissor);
+	}
+
+	void VgBatch::clip(const vec4& rect)
+	{
+		const vec4 absolute = vec4(this->transform(vec2(rect.x, rect.y)), vec2(rect.width, rect.height) * m_state.m_scale);
+		m_state.m_scissor = rect_intersection(m_state.m_scissor, absolute);
+	}
+
+	void VgBatch::unclip()
+	{
+		m_state.m_scissor = c_no_scissor;
+	}
+
+	BatchDraw& VgBatch::draw(uint16_t texture, uint32_t vertex_count)
+	{
+		BatchList& list = *m_list;
+
+		// a new draw only when the clip rect, or the image texture changes : shapes and glyphs join any draw
+		BatchDraw* last = list.m_draws.empty() ? nullptr : &list.m_draws.back();
+		const bool break_texture = last && texture != UINT16_MAX && last->m_texture != UINT16_MAX && last->m_texture != texture;
+		if(!last || last->m_scissor != m_state.m_scissor || break_texture || last->m_vertex_count + vertex_count > UINT16_MAX)
+		{
+			BatchDraw draw;
+			draw.m_base = uint32_t(list.m_vertices.size());
+			draw.m_first = uint32_t(list.m_indices.size());
+			draw.m_scissor = m_state.m_scissor;
+			list.m_draws.push_back(draw);
+			last = &list.m_draws.back();
+		}
+
+		if(texture != UINT16_MAX)
+			last->m_texture = texture;
+		return *last;
+	}
+
+	void VgBatch::push(const BatchVertex* vertices, uint32_t vertex_count, const uint16_t* indices, uint32_t index_count, uint16_t texture)
+	{
+		BatchDraw& draw = this->draw(texture, vertex_count);
+		BatchList& list = *m_list;
+
+		const uint16_t base = uint16_t(draw.m_vertex_count);
+		list.m_vertices.insert(list.m_vertices.end(), vertices, vertices + vertex_count);
+		for(uint32_t i = 0; i < index_count; ++i)
+			list.m_indices.push_back(uint16_t(base + indices[i]));
+
+		draw.m_vertex_count += vertex_count;
+		draw.m_count += index_count;
+	}
+
+	void VgBatch::push_quad(const vec2 corners[4], const vec4& uv, const BatchVertex& vertex, uint16_t texture)
+	{
+		static const uint16_t indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+		BatchVertex vertices[4] = { vertex, vertex, vertex, vertex };
+		const vec2 uvs[4] = { { uv.x, uv.y }, { uv.z, uv.y }, { uv.z, uv.w }, { uv.x, uv.w } };
+		for(int i = 0; i < 4; ++i)
+		{
+			vertices[i].x = corners[i].x;
+			vertices[i].y = corners[i].y;
+			vertices[i].u = uvs[i].x;
+			vertices[i].v = uvs[i].y;
+		}
+
+		this->push(vertices, 4, indices, 6, texture);
+	}
+
+	void VgBatch::push_shape(const vec4& rect, const vec4& corners, float border, float feather, uint32_t fill, uint32_t stroke, const ShapeGradient* gradient)
+	{
+		static const uint16_t indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+		const float scale = m_state.m_scale;
+		// antialiased edges fade over one pixel, blurred ones over the feather width
+		const float fade = feather > 0.f ? feather * scale : 1.f;
+		const float margin = feather > 0.f ? feather : 1.f / scale;
+
+		const vec2 center = vec2(rect.x, rect.y) + vec2(rect.width, rect.height) * 0.5f;
+		const vec2 half = vec2(rect.width, rect.height) * 0.5f;
+		const vec2 outer = half + margin;
+
+		BatchVertex vertex = {};
+		vertex.shape = vec4(half.x * scale, half.y * scale, border * scale, fade);
+		vertex.corners = corners * scale;
+		vertex.stroke = stroke;
+		vertex.mode = float(BatchMode::Shape);
+
+		const vec2 offsets[4] = { { -outer.x, -outer.y }, { outer.x, -outer.y }, { outer.x, outer.y }, { -outer.x, outer.y } };
+
+		BatchVertex vertices[4];
+		for(int i = 0; i < 4; ++i)
+		{
+			const vec2 local = center + offsets[i];
+			const vec2 position = this->transform(local);
+			vertices[i] = vertex;
+			vertices[i].x = position.x;
+			vertices[i].y = position.y;
+			vertices[i].lx = offsets[i].x * scale;
+			vertices[i].ly = offsets[i].y * scale;
+			vertices[i].fill = gradient ? gradient_abgr(local, gradient->m_start, gradient->m_end, fill, gradient->m_end_colour) : fill;
+		}
+
+		this->push(vertices, 4, indices, 6, UINT16_MAX);
+	}
+
+	void VgBatch::push_triangle(const vec2& a, const vec2& b, const vec2& c, uint32_t ca, uint32_t cb, uint32_t cc)
+	{
+		static const uint16_t indices[3] = { 0, 1, 2 };
+
+		BatchVertex vertex = {};
+		vertex.shape = c_no_shape;
+		vertex.mode = float(BatchMode::Shape);
+
+		BatchVertex vertices[3] = { vertex, vertex, vertex };
+		const vec2 points[3] = { a, b, c };
+		const uint32_t colours[3] = { ca, cb, cc };
+		for(int i = 0; i < 3; ++i)
+		{
+			vertices[i].x = points[i].x;
+			vertices[i].y = points[i].y;
+			vertices[i].fill = colours[i];
+		}
+
+		this->push(vertices, 3, indices, 3, UINT16_MAX);
+	}
+
+	void VgBatch::begin_path()
+	{
+		m_shape = PathShape::None;
+		m_points.clear();
+		m_subpaths.clear();
+	}
+
+	void VgBatch::move_to(const vec2& p)
+	{
+		m_shape = PathShape::Path;
+		m_subpaths.push_back({ uint32_t(m_points.size()), 0, false });
+		m_points.push_back(this->transform(p));
+		m_subpaths.back().m_count++;
+	}
+
+	void VgBatch::line_to(const vec2& p)
+	{
+		if(m_subpaths.empty())
+			return this->move_to(p);
+		m_points.push_back(this->transform(p));
+		m_subpaths.back().m_count++;
+	}
+
+	void VgBatch::close_path()
+	{
+		if(!m_subpaths.empty())
+			m_subpaths.back().m_closed = true;
+	}
+
+	void VgBatch::path_line(const vec2& p1, const vec2& p2)
+	{
+		this->begin_path();
+		this->move_to(p1);
+		this->line_to(p2);
+	}
+
+	void VgBatch::path_bezier(const vec2& p1, const vec2& c1, const vec2& c2, const vec2& p2, bool straighten)
+	{
+		this->begin_path();
+		this->move_to(p1);
+		if(straighten)
+		{
+			this->line_to(c1);
+			this->line_to(c2);
+			this->line_to(p2);
+			return;
+		}
+
+		const float length = distance(p1, c1) + distance(c1, c2) + distance(c2, p2);
+		const int segments = clamp(int(length * m_state.m_scale / 6.f), 4, 64);
+		for(int i = 1; i <= segments; ++i)
+		{
+			const float t = float(i) / float(segments);
+			const float u = 1.f - t;
+			this->line_to(p1 * (u * u * u) + c1 * (3.f * u * u * t) + c2 * (3.f * u * t * t) + p2 * (t * t * t));
+		}
+	}
+
+	void VgBatch::path_rect(const vec4& rect, const vec4& corners, float border)
+	{
+		this->begin_path();
+		m_shape = PathShape::Rect;
+		m_shape_rect = { rect.x + border * 0.5f, rect.y + border * 0.5f, rect.width - border, rect.height - border };
+		m_shape_corners = corners;
+	}
+
+	void VgBatch::path_circle(const vec2& center, float r)
+	{
+		this->begin_path();
+		m_shape = PathShape::Circle;
+		m_shape_rect = { center.x - r, center.y - r, r * 2.f, r * 2.f };
+		m_shape_corners = vec4(r);
+	}
+
+	void VgBatch::fill_path(uint32_t colour, const ShapeGradient* gradient)
+	{
+		// paths are filled as convex fans, as the vg backend does
+		for(const SubPath& path : m_subpaths)
+		{
+			if(path.m_count < 3)
+				continue;
+
+			const vec2* points = &m_points[path.m_first];
+			auto colour_at = [&](const vec2& p) { return gradient ? gradient_abgr(p, gradient->m_start, gradient->m_end, colour, gradient->m_end_colour) : colour; };
+			for(uint32_t i = 1; i + 1 < path.m_count; ++i)
+				this->push_triangle(points[0], points[i], points[i + 1], colour_at(points[0]), colour_at(points[i]), colour_at(points[i + 1]));
+		}
+	}
+
+	void VgBatch::stroke_path(float width, uint32_t colour, const ShapeGradient* gradient)
+	{
+		const float half = width * m_state.m_scale * 0.5f;
+
+		for(const SubPath& path : m_subpaths)
+		{
+			const vec2* points = &m_points[path.m_first];
+			const uint32_t segments = path.m_closed ? path.m_count : path.m_count - 1;
+			for(uint32_t i = 0; i < segments; ++i)
+			{
+				vec2 a = points[i];
+				vec2 b = points[(i + 1) % path.m_count];
+				const float length = distance(a, b);
+				if(length == 0.f)
+					continue;
+
+				const vec2 dir = (b - a) / length;
+				const vec2 normal = vec2(-dir.y, dir.x) * half;
+				// segments overlap by half the width at the joints to leave no gap
+				if(i > 0 || path.m_closed) a -= dir * half;
+				if(i + 1 < segments || path.m_closed) b += dir * half;
+
+				const uint32_t ca = gradient ? gradient_abgr(a, gradient->m_start, gradient->m_end, colour, gradient->m_end_colour) : colour;
+				const uint32_t cb = gradient ? gradient_abgr(b, gradient->m_start, gradient->m_end, colour, gradient->m_end_colour) : colour;
+				this->push_triangle(a + normal, b + normal, b - normal, ca, cb, cb);
+				this->push_triangle(a + normal, b - normal, a - normal, ca, cb, ca);
+			}
+		}
+	}
+
+	void VgBatch::fill(const Gradient& gradient, const vec2& start, const vec2& end)
+	{
+		const uint32_t first = to_abgr(gradient.m_start);
+		const uint32_t last = to_abgr(gradient.m_end);
+
+		if(m_shape == PathShape::Rect || m_shape == PathShape::Circle)
+		{
+			const ShapeGradient shape_gradient = { start, end, last };
+			this->push_shape(m_shape_rect, m_shape_corners, 0.f, 0.f, first, 0, &shape_gradient);
+		}
+		else
+		{
+			const ShapeGradient path_gradient = { this->transform(start), this->transform(end), last };
+			this->fill_path(first, &path_gradient);
+		}
+	}
+
+	void VgBatch::fill(const Paint& paint)
+	{
+		if(paint.m_fill_colour.a == 0.f)
+			return;
+
+		const uint32_t colour = to_abgr(paint.m_fill_colour);
+		if(m_shape == PathShape::Rect || m_shape == PathShape::Circle)
+			this->push_shape(m_shape_rect, m_shape_corners, 0.f, 0.f, colour, 0);
+		else
+			this->fill_path(colour, nullptr);
+	}
+
+	void VgBatch::stroke(const Paint& paint)
+	{
+		if(paint.m_stroke_width <= 0.f || paint.m_stroke_colour.a == 0.f)
+			return;
+
+		const uint32_t colour = to_abgr(paint.m_stroke_colour);
+		const float width = paint.m_stroke_width;
+		if(m_shape == PathShape::Rect || m_shape == PathShape::Circle)
+		{
+			// the stroke is centered on the path : the shape is the outer edge, and the border is the stroke width
+			const vec4 rect = { m_shape_rect.x - width * 0.5f, m_shape_rect.y - width * 0.5f, m_shape_rect.width + width, m_shape_rect.height + width };
+			vec4 corners = m_shape_corners;
+			for(int i = 0; i < 4; ++i)
+				corners[i] = corners[i] > 0.f ? corners[i] + width * 0.5f : 0.f;
+			this->push_shape(rect, corners, width, 0.f, colour & 0x00FFFFFF, colour);
+		}
+		else
+			this->stroke_path(width, colour, nullptr);
+	}
+
+	void VgBatch::stroke_gradient(const Gradient& paint, float width, const vec2& start, const vec2& end)
+	{
+		const ShapeGradient gradient = { this->transform(start), this->transform(end), to_abgr(paint.m_end) };
+		this->stroke_path(width, to_abgr(paint.m_start), &gradient);
+	}
+
+	void VgBatch::draw_shadow(const vec4& rect, const vec4& corners, const Shadow& shadow)
+	{
+		const vec4 shape = { rect.x + shadow.d_pos.x - shadow.d_spread, rect.y + shadow.d_pos.y - shadow.d_spread, rect.width + shadow.d_spread * 2.f, rect.height + shadow.d_spread * 2.f };
+		this->push_shape(shape, vec4(corners[0] + shadow.d_spread), 0.f, max(shadow.d_blur, 1.f), to_abgr(shadow.d_colour), 0);
+	}
+
+	void VgBatch::draw_texture(uint16_t texture, const vec4& rect, const vec4& image_rect)
+	{
+		// the image rect is where the whole texture lands : the rect samples its own part of it
+		const vec4 uv = { (rect.x - image_rect.x) / image_rect.width, (rect.y - image_rect.y) / image_rect.height,
+						  (rect.x + rect.width - image_rect.x) / image_rect.width, (rect.y + rect.height - image_rect.y) / image_rect.height };
+
+		const vec2 corners[4] = { this->transform({ rect.x, rect.y }), this->transform({ rect.x + rect.width, rect.y }),
+								  this->transform({ rect.x + rect.width, rect.y + rect.height }), this->transform({ rect.x, rect.y + rect.height }) };
+
+		BatchVertex vertex = {};
+		vertex.shape = c_no_shape;
+		vertex.fill = 0xFFFFFFFF;
+		vertex.mode = float(BatchMode::Textured);
+		this->push_quad(corners, uv, vertex, texture < m_textures.size() ? texture : m_white);
+	}
+
+	void VgBatch::draw_text(const vec2& offset, const char* start, const char* end, const TextPaint& paint)
+	{
+		static const uint16_t indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+		BatchFont& font = this->font(paint.m_font);
+		MeasuredFont& measured = *font.m_font;
+		const float scale = measured.scale(paint.m_size);
+		const float quad_scale = paint.m_size / c_sdf_size;
+		const float line_height = measured.line_height(paint.m_size);
+
+		// rows are vertically centered on the middle of the first line, as the vg backend does
+		const float middle = offset.y + ceil(paint.m_size * 0.5f);
+		float baseline = middle + (measured.m_ascent + measured.m_descent) * 0.5f * scale;
+
+		BatchVertex vertex = {};
+		vertex.shape = c_no_shape;
+		vertex.fill = to_abgr(paint.m_colour);
+		vertex.mode = float(BatchMode::Glyph);
+
+		const char* line = start;
+		while(line < end)
+		{
+			const char* line_end = line;
+			if(paint.m_text_break)
+				while(line_end < end && *line_end != '\n')
+					++line_end;
+			else
+				line_end = end;
+
+			// the pen advances with the measurer, so that glyphs land where the caption laid them out
+			float x = offset.x + align_offset(paint, m_measure.text_width(measured, line, line_end, paint.m_size));
+			uint32_t previous = 0;
+			for(const char* iter = line; iter < line_end;)
+			{
+				const uint32_t codepoint = decode_utf8(iter, line_end);
+				const float advance = m_measure.advance(measured, codepoint, previous, paint.m_size);
+				previous = codepoint;
+
+				const BatchGlyph& g = this->glyph(font, codepoint);
+				if(g.m_quad.width > 0.f)
+				{
+					const vec2 p0 = vec2(x + g.m_quad.x * quad_scale, baseline + g.m_quad.y * quad_scale);
+					const vec2 p1 = p0 + vec2(g.m_quad.width, g.m_quad.height) * quad_scale;
+					const vec2 corners[4] = { this->transform(p0), this->transform({ p1.x, p0.y }), this->transform(p1), this->transform({ p0.x, p1.y }) };
+
+					BatchVertex vertices[4] = { vertex, vertex, vertex, vertex };
+					const vec2 uvs[4] = { { g.m_uv.x, g.m_uv.y }, { g.m_uv.z, g.m_uv.y }, { g.m_uv.z, g.m_uv.w }, { g.m_uv.x, g.m_uv.w } };
+					for(int i = 0; i < 4; ++i)
+					{
+						vertices[i].x = corners[i].x;
+						vertices[i].y = corners[i].y;
+						vertices[i].u = uvs[i].x;
+						vertices[i].v = uvs[i].y;
+					}
+					this->push(vertices, 4, indices, 6, UINT16_MAX);
+				}
+
+				x += advance;
+			}
+
+			line = line_end + 1;
+			baseline += line_height;
+		}
+	}
+
+	void VgBatch::draw_color_wheel(const vec2& center, float r0, float r1)
+	{
+		static const int segments = 96;
+
+		for(int i = 0; i < segments; ++i)
+		{
+			const float a0 = float(i) / float(segments) * c_2pi;
+			const float a1 = float(i + 1) / float(segments) * c_2pi;
+			const vec2 d0 = vec2(cosf(a0), sinf(a0));
+			const vec2 d1 = vec2(cosf(a1), sinf(a1));
+
+			const uint32_t c0 = to_abgr(hsl(a0 / c_2pi, 1.0f, 0.55f));
+			const uint32_t c1 = to_abgr(hsl(a1 / c_2pi, 1.0f, 0.55f));
+
+			const vec2 in0 = this->transform(center + d0 * r0);
+			const vec2 in1 = this->transform(center + d1 * r0);
+			const vec2 out0 = this->transform(center + d0 * r1);
+			const vec2 out1 = this->transform(center + d1 * r1);
+
+			this->push_triangle(in0, out0, out1, c0, c0, c1);
+			this->push_triangle(in0, out1, in1, c0, c1, c1);
+		}
+	}
+
+	void VgBatch::draw_color_triangle(const vec2& center, float r0, float hue, float s, float l)
+	{
+		const float r = r0 - 6.f;
+		const float angle = hue * c_2pi;
+
+		auto point = [&](float a) { return center + vec2(cosf(angle + a), sinf(angle + a)) * r; };
+
+		// the hue corner, the white corner and the black corner : the colours interpolate across the triangle
+		const vec2 a = point(0.f);
+		const vec2 b = point(120.0f / 180.0f * c_pi);
+		const vec2 c = point(-120.0f / 180.0f * c_pi);
+		this->push_triangle(this->transform(a), this->transform(b), this->transform(c), to_abgr(hsl(hue, 1.0f, 0.5f)), to_abgr(Colour::White), to_abgr(Colour::Black));
+
+		// the selected colour sits where its hue, white and black weights interpolate to it
+		const float chroma = (1.f - abs(2.f * l - 1.f)) * s;
+		const vec2 selected = a * chroma + b * (l - chroma * 0.5f) + c * (1.f - l - chroma * 0.5f);
+		this->path_circle(selected, 5.f);
+		this->fill(Paint(hsl(hue, s, l)));
+		this->stroke(Paint(Colour::White, 2.f));
+	}
+
+	void VgBatch::break_next_row(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row)
+	{
+		m_measure.break_next_row(text, first, end, rect, paint, row);
+	}
+
+	void VgBatch::break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& row, vector<TextGlyph>& glyphs)
+	{
+		m_measure.break_glyphs(rect, paint, row, glyphs);
+	}
+
+	float VgBatch::line_height(const TextPaint& paint)
+	{
+		return m_measure.line_height(paint);
+	}
+
+	vec2 VgBatch::text_size(cstring text, size_t len, const TextPaint& paint)
+	{
+		return m_measure.text_size(text, len, paint);
+	}
+
+	float VgBatch::text_size(cstring text, size_t len, Axis dim, const TextPaint& paint)
+	{
+		return dim == Axis::X ? text_size(text, len, paint).x : text_size(text, len, paint).y;
+	}
+}
@@ -0,0 +1,228 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#pragma once
+
+#ifndef TWO_MODULES
+#include <stl/string.h>
+#include <stl/vector.h>
+#include <stl/memory.h>
+#include <stl/function.h>
+#endif
+#include <ui/Forward.h>
+#include <ui/UiRenderer.h>
+#include <ui/Frame/TextMeasure.h>
+
+#ifndef TWO_MODULES
+#include <bgfx/bgfx.h>
+#endif
+
+#ifndef TWO_UI_VG_EXPORT
+#define TWO_UI_VG_EXPORT TWO_IMPORT
+#endif
+
+namespace two
+{
+	// one vertex layout for every primitive : the fragment shader evaluates a rounded box distance for shapes,
+	// samples the image atlas for images, and the distance field atlas for glyphs
+	struct BatchVertex
+	{
+		float x, y;
+		float u, v;
+		float lx, ly;			// position relative to the shape center
+		vec4 shape;				// half size, border width, feather
+		vec4 corners;			// corner radii : top left, top right, bottom right, bottom left
+		uint32_t fill;
+		uint32_t stroke;
+		float mode;
+	};
+
+	struct BatchDraw
+	{
+		// indices are 16 bits and relative to the first vertex of the draw
+		uint32_t m_base = 0;
+		uint32_t m_vertex_count = 0;
+		uint32_t m_first = 0;
+		uint32_t m_count = 0;
+		vec4 m_scissor;
+		uint16_t m_texture = UINT16_MAX;
+	};
+
+	// the geometry of a layer, or of the immediate draws of a frame : one vertex stream, and one draw per clip rect and image texture
+	struct BatchList
+	{
+		vector<BatchVertex> m_vertices;
+		vector<uint16_t> m_indices;
+		vector<BatchDraw> m_draws;
+
+		bgfx::VertexBufferHandle m_vertex_buffer = BGFX_INVALID_HANDLE;
+		bgfx::IndexBufferHandle m_index_buffer = BGFX_INVALID_HANDLE;
+
+		void clear();
+		void release();
+	};
+
+	struct BatchFont;
+	struct BatchGlyph;
+
+	export_ class TWO_UI_VG_EXPORT VgBatch : public Vg
+	{
+	public:
+		// the program is fetched again on every submit : the owner may recompile or reload it
+		using ProgramSource = function<bgfx::ProgramHandle()>;
+
+		VgBatch(const string& resource_path, ProgramSource program);
+		~VgBatch();
+
+		// init
+		virtual void setup_context() override;
+		virtual void release_context() override;
+
+		// setup
+		virtual void load_default_font() override;
+		virtual void load_font(cstring name) override;
+		virtual void load_image_RGBA(Image& image, const unsigned char* data) override;
+		virtual void load_image(Image& image) override;
+		virtual void unload_image(Image& image) override;
+		virtual uint16_t load_texture(uint16_t texture) override;
+
+		// rendering
+		virtual void begin_frame(uint16_t view, const vec4& rect, float pixel_ratio, const Colour& colour = Colour(0.f)) override;
+		virtual void end_frame(uint16_t view) override;
+
+		// drawing
+		virtual void begin_target() override;
+		virtual void end_target() override;
+
+		virtual void begin_layer(Layer& layer, const vec2& position, float scale) override;
+		virtual void end_layer() override;
+
+		virtual bool retained() const override { return true; }
+		virtual void begin_cached(Layer& layer) override;
+		virtual void end_cached() override;
+
+		virtual void draw_layer(Layer& layer, const vec2& position, float scale) override;
+		virtual void release_layer(Layer& layer) override;
+
+		virtual void begin_update(const vec2& position, float scale) override;
+		virtual void end_update() override;
+
+		virtual bool clipped(const vec4& rect) override;
+		virtual void clip(const vec4& rect) override;
+		virtual void unclip() override;
+
+		virtual void begin_path() override;
+		virtual void move_to(const vec2& p) override;
+		virtual void line_to(const vec2& p) override;
+		virtual void close_path() override;
+
+		virtual void path_line(const vec2& p1, const vec2& p2) override;
+		virtual void path_bezier(const vec2& p1, const vec2& c1, const vec2& c2, const vec2& p2, bool straighten) override;
+		virtual void path_rect(const vec4& rect, const vec4& corners, float border) override;
+		virtual void path_circle(const vec2& center, float r) override;
+
+		virtual void fill(const Gradient& gradient, const vec2& start, const vec2& end) override;
+		virtual void fill(const Paint& paint) override;
+		virtual void stroke(const Paint& paint) override;
+
+		virtual void stroke_gradient(const Gradient& paint, float width, const vec2& start, const vec2& end) override;
+
+		virtual void draw_shadow(const vec4& rect, const vec4& corner, const Shadow& shadows) override;
+		virtual void draw_texture(uint16_t texture, const vec4& rect, const vec4& image_rect) override;
+		virtual void draw_text(const vec2& offset, const char* start, const char* end, const TextPaint& paint) override;
+
+		virtual void draw_color_wheel(const vec2& center, float r0, float r1) override;
+		virtual void draw_color_triangle(const vec2& center, float r0, float hue, float s, float l) override;
+
+		virtual void break_next_row(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row) override;
+		virtual void break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& textRow, vector<TextGlyph>& glyphs) override;
+
+		virtual float line_height(const TextPaint& paint) override;
+		virtual float text_size(cstring text, size_t len, Axis dim, const TextPaint& paint) override;
+		virtual vec2 text_size(cstring text, size_t len, const TextPaint& paint) override;
+
+		// bgfx draws submitted during the last frame
+		size_t m_draw_calls = 0;
+
+	private:
+		struct State
+		{
+			vec2 m_offset = vec2(0.f);
+			float m_scale = 1.f;
+			vec4 m_scissor = vec4(-1e6f, -1e6f, 2e6f, 2e6f);
+		};
+
+		struct SubPath
+		{
+			uint32_t m_first;
+			uint32_t m_count;
+			bool m_closed;
+		};
+
+		enum class PathShape { None, Rect, Circle, Path };
+
+		// linear gradient from the fill colour at start to the end colour at end
+		struct ShapeGradient
+		{
+			vec2 m_start;
+			vec2 m_end;
+			uint32_t m_end_colour;
+		};
+
+		BatchFont& font(cstring name);
+		BatchGlyph& glyph(BatchFont& font, uint32_t codepoint);
+
+		vec2 transform(const vec2& p) const { return p * m_state.m_scale + m_state.m_offset; }
+
+		uint16_t add_texture(bgfx::TextureHandle texture, bool owned);
+
+		BatchDraw& draw(uint16_t texture, uint32_t vertex_count);
+		void push(const BatchVertex* vertices, uint32_t vertex_count, const uint16_t* indices, uint32_t index_count, uint16_t texture);
+		void push_quad(const vec2 corners[4], const vec4& uv, const BatchVertex& vertex, uint16_t texture);
+		void push_shape(const vec4& rect, const vec4& corners, float border, float feather, uint32_t fill, uint32_t stroke, const ShapeGradient* gradient = nullptr);
+		void push_triangle(const vec2& a, const vec2& b, const vec2& c, uint32_t ca, uint32_t cb, uint32_t cc);
+		void fill_path(uint32_t colour, const ShapeGradient* gradient);
+		void stroke_path(float width, uint32_t colour, const ShapeGradient* gradient);
+
+		void submit(BatchList& list, bool transient);
+		void submit(const BatchDraw& draw, bgfx::ProgramHandle program);
+
+		string m_resource_path;
+
+		ProgramSource m_program;
+		bgfx::VertexLayout m_layout;
+		bgfx::UniformHandle u_image = BGFX_INVALID_HANDLE;
+		bgfx::UniformHandle u_glyphs = BGFX_INVALID_HANDLE;
+
+		uint16_t m_view = 0;
+		float m_pixel_ratio = 1.f;
+
+		State m_state;
+		vector<State> m_states;
+
+		// textures indexed by the handles given to images, unloaded slots are reused
+		vector<bgfx::TextureHandle> m_textures;
+		vector<uint8_t> m_owned;
+		vector<uint16_t> m_free_textures;
+		uint16_t m_white = 0;
+
+		struct GlyphAtlas;
+		unique<GlyphAtlas> m_glyph_atlas;
+		TextMeasure m_measure;
+		vector<unique<BatchFont>> m_fonts;
+
+		vector<unique<BatchList>> m_layers;
+		vector<uint32_t> m_free_layers;
+
+		BatchList m_immediate;
+		BatchList* m_list = &m_immediate;
+
+		// path being built, in absolute coordinates
+		PathShape m_shape = PathShape::None;
+		vec4 m_shape_rect;
+		vec4 m_shape_corners;
+		vector<vec2> m_points;
+		vector<SubPath> m_subpaths;
+	};
+}
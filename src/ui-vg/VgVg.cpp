@@ -141,12 +141,9 @@ namespace two
 
 	bool VgVg::clipped(const vec4& rect)
 	{
-#ifdef TWO_UI_DRAW_CACHE
-		UNUSED(rect);
-		return false;
-#else
+		if(m_recording)
+			return false;
 		return !vg::checkIntersectScissor(m_vg, RECT_FLOATS(rect));
-#endif
 	}
 
 	void VgVg::clip(const vec4& rect)
@@ -292,7 +289,6 @@ namespace two
 
 	void VgVg::draw_color_triangle(const vec2& center, float r0, float hue, float s, float l)
 	{
-		UNUSED(s); UNUSED(l);
 		vg::transformTranslate(m_vg, center.x, center.y);
 		vg::transformRotate(m_vg, hue * c_2pi);
 
@@ -312,6 +308,14 @@ namespace two
 		vg::GradientHandle paint2 = vg::createLinearGradient(m_vg, (r + a.x) * 0.5f, (0 + a.y) * 0.5f, b.x, b.y, vg::Colors::Transparent, vg::Colors::Black);
 		vg::fillPath(m_vg, paint2, vg::FillFlags::ConvexAA);
 
+		// the selected colour sits where its hue, white and black weights interpolate to it
+		const float chroma = (1.f - abs(2.f * l - 1.f)) * s;
+		const vec2 selected = vec2(r, 0.f) * chroma + a * (l - chroma * 0.5f) + b * (1.f - l - chroma * 0.5f);
+		vg::beginPath(m_vg);
+		vg::circle(m_vg, selected.x, selected.y, 5.f);
+		vg::fillPath(m_vg, vgColour(hsl(hue, s, l)), vg::FillFlags::ConvexAA);
+		vg::strokePath(m_vg, vg::Colors::White, 2.f, vg::StrokeFlags::ButtMiterAA);
+
 		//vg::strokePath(m_vg, vg::color4ub(0, 0, 0, 64), 1.f, vg::StrokeFlags::ButtMiterAA);
 	}
 
@@ -341,18 +345,21 @@ namespace two
 		row = text_row(text, vgTextRow.start, vgTextRow.end, { rect.x, rect.y, vgTextRow.width, line_height(paint) });
 	}
 
-	void VgVg::break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& textRow)
+	void VgVg::break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& textRow, vector<TextGlyph>& glyphs)
 	{
 		const size_t numGlyphs = textRow.m_end - textRow.m_start;
-		vector<vg::GlyphPosition> glyphs(numGlyphs);
-		textRow.m_glyphs.resize(numGlyphs);
+		m_glyph_positions.resize(numGlyphs);
+
+		const size_t first = glyphs.size();
+		glyphs.resize(first + numGlyphs);
 
-		vg::textGlyphPositions(m_vg, text_font(paint), rect.x, rect.y, textRow.m_start, textRow.m_end, &glyphs.front(), int(glyphs.size()));
+		vg::textGlyphPositions(m_vg, text_font(paint), rect.x, rect.y, textRow.m_start, textRow.m_end, m_glyph_positions.data(), int(numGlyphs));
 
-		for(size_t i = 0; i < glyphs.size(); ++i)
+		for(size_t i = 0; i < numGlyphs; ++i)
 		{
-			textRow.m_glyphs[i].m_position = textRow.m_start + i;
-			textRow.m_glyphs[i].m_rect = { glyphs[i].minx, textRow.m_rect.y, glyphs[i].maxx - glyphs[i].minx, textRow.m_rect.height };
+			const vg::GlyphPosition& position = m_glyph_positions[i];
+			glyphs[first + i].m_index = textRow.m_start_index + i;
+			glyphs[first + i].m_rect = { position.minx, textRow.m_rect.y, position.maxx - position.minx, textRow.m_rect.height };
 		}
 	}
 
@@ -377,12 +384,11 @@ namespace two
 		vg::popState(m_vg);
 	}
 
-#ifdef TWO_UI_DRAW_CACHE
 	vg::CommandListHandle VgVg::layer_cache(Layer& layer)
 	{
+		// layers are recorded in absolute coordinates and replayed untransformed, so their tessellation can be cached too
 		if(layer.d_handle == SIZE_MAX)
-			//layer.d_handle = vg::createCommandList(m_vg, vg::CommandListFlags::Cacheable).idx;
-			layer.d_handle = vg::createCommandList(m_vg, 0).idx;
+			layer.d_handle = vg::createCommandList(m_vg, vg::CommandListFlags::Cacheable).idx;
 		return { uint16_t(layer.d_handle) };
 	}
 
@@ -391,11 +397,20 @@ namespace two
 		vg::resetCommandList(m_vg, this->layer_cache(layer));
 		vg::beginCommandList(m_vg, this->layer_cache(layer));
 		vg::transformIdentity(m_vg);
+		m_recording = true;
 	}
 
 	void VgVg::end_cached()
 	{
 		vg::endCommandList(m_vg);
+		m_recording = false;
+	}
+
+	void VgVg::release_layer(Layer& layer)
+	{
+		if(m_null || layer.d_handle == SIZE_MAX) return;
+		vg::destroyCommandList(m_vg, { uint16_t(layer.d_handle) });
+		layer.d_handle = SIZE_MAX;
 	}
 
 	void VgVg::draw_layer(Layer& layer, const vec2& position, float scale)
@@ -407,7 +422,6 @@ namespace two
 		vg::submitCommandList(m_vg, this->layer_cache(layer));
 		vg::popState(m_vg);
 	}
-#endif
 
 	void VgVg::begin_layer(Layer& layer, const vec2& position, float scale)
 	{
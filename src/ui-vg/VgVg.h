@@ -6,6 +6,7 @@
 
 #ifndef TWO_MODULES
 #include <stl/string.h>
+#include <stl/vector.h>
 #include <stl/map.h>
 #endif
 #include <ui/Forward.h>
@@ -51,12 +52,13 @@ namespace two
 		virtual void begin_layer(Layer& layer, const vec2& position, float scale) override;
 		virtual void end_layer() override;
 
-#ifdef TWO_UI_DRAW_CACHE
+		virtual bool retained() const override { return !m_null; }
 		virtual void begin_cached(Layer& layer) override;
 		virtual void end_cached() override;
 
 		virtual void draw_layer(Layer& layer, const vec2& position, float scale) override;
-#endif
+		virtual void release_layer(Layer& layer) override;
+
 
 		virtual void begin_update(const vec2& position, float scale) override;
 		virtual void end_update() override;
@@ -90,7 +92,7 @@ namespace two
 		virtual void stroke_gradient(const Gradient& paint, float width, const vec2& start, const vec2& end) override;
 
 		virtual void break_next_row(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row) override;
-		virtual void break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& textRow) override;
+		virtual void break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& textRow, vector<TextGlyph>& glyphs) override;
 
 		virtual float line_height(const TextPaint& paint) override;
 		virtual float text_size(cstring text, size_t len, Axis dim, const TextPaint& paint) override;
@@ -100,9 +102,7 @@ namespace two
 		uint32_t text_align(const TextPaint& paint);
 		vg::TextConfig text_font(const TextPaint& paint);
 
-#ifdef TWO_UI_DRAW_CACHE
 		vg::CommandListHandle layer_cache(Layer& layer);
-#endif
 
 	protected:
 		bx::AllocatorI* m_allocator = nullptr;
@@ -110,8 +110,14 @@ namespace two
 
 		vg::FontHandle m_default_font = { UINT16_MAX };
 
+		// the scissor state can't be queried while recording a command list
+		bool m_recording = false;
+
 		map<string, vg::FontHandle> m_fonts;
 
+		// scratch positions reused by each break_glyphs call
+		vector<vg::GlyphPosition> m_glyph_positions;
+
 		//map<Layer*, NVGdisplayList*> m_layers;
 	};
 }
@@ -12,5 +12,8 @@ namespace stl
 	using namespace two;
 	template class TWO_UI_VG_EXPORT vector<vg::GlyphPosition>;
 	template class TWO_UI_VG_EXPORT unordered_map<string, vg::FontHandle>;
+	template class TWO_UI_VG_EXPORT vector<BatchVertex>;
+	template class TWO_UI_VG_EXPORT vector<BatchDraw>;
+	template class TWO_UI_VG_EXPORT vector<bgfx::TextureHandle>;
 }
 #endif
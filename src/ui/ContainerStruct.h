@@ -34,6 +34,19 @@ namespace ui
 		vector<Widget*> m_selection;
 #endif
 	};
+
+	export_ class TWO_UI_EXPORT VirtualSequence : public Sequence
+	{
+	public:
+		VirtualSequence(Widget* parent, void* identity) : Sequence(parent, identity) {}
+		size_t m_count = 0;
+		float m_row_height = 0.f;
+		bool m_estimated = false;
+		size_t m_overscan = 4;
+		float m_pitch = 0.f;
+		size_t m_first = 0;
+		size_t m_last = 0;
+	};
 }
 
 	export_ class refl_ TWO_UI_EXPORT Tabber : public Widget
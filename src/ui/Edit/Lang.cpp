@@ -11,6 +11,9 @@ module two.ui;
 #endif
 
 #include <stl/hash_base.hpp>
+#include <stl/math.h>
+
+#include <cctype>
 
 namespace two
 {
@@ -114,19 +117,157 @@ namespace two
 		}
 	}
 
-	void add_token_regex(LanguageDefinition& lang, const string& token, CodePalette index)
+	void build_symbols(LanguageDefinition& lang)
 	{
-		lang.m_regex_string_tokens.push_back({ token, PaletteIndex(index) });
-		lang.m_regex_tokens.push_back({ std::regex(token.c_str(), std::regex_constants::optimize), PaletteIndex(index) });
+		// punctuation takes precedence over operators
+		for(const string& op : lang.m_operators)
+			for(char c : op)
+				lang.m_symbols[uint8_t(c) & 0x7f] = PaletteIndex(CodePalette::Operator);
+		for(const string& punct : lang.m_punctuation)
+			for(char c : punct)
+				lang.m_symbols[uint8_t(c) & 0x7f] = PaletteIndex(CodePalette::Punctuation);
 	}
 
-	string list_regex(span<string> tokens)
+	inline bool is_word_start(char c) { return isalpha(uint8_t(c)) || c == '_'; }
+	inline bool is_word(char c) { return isalnum(uint8_t(c)) || c == '_'; }
+	inline bool is_digit(char c) { return isdigit(uint8_t(c)) != 0; }
+
+	inline bool starts_with(const string& text, size_t index, size_t end, const string& token)
 	{
-		string r = "[";
-		for(const string& token : tokens)
-			r += "\\" + token;
-		r += "]";
-		return r;
+		if(token.empty() || index + token.size() > end) return false;
+		for(size_t i = 0; i < token.size(); ++i)
+			if(text[index + i] != token[i]) return false;
+		return true;
+	}
+
+	inline size_t find_token(const string& text, size_t index, size_t end, const string& token)
+	{
+		for(; index + token.size() <= end; ++index)
+			if(starts_with(text, index, end, token))
+				return index;
+		return SIZE_MAX;
+	}
+
+	LexState tokenize_line(const LanguageDefinition& lang, const string& text, size_t begin, size_t end, LexState state, vector<Text::ColorSection>& sections)
+	{
+		auto section = [&](size_t first, size_t last, CodePalette colour) { sections.push_back({ first, last, PaletteIndex(colour) }); };
+
+		size_t i = begin;
+		bool preproc = false;
+		string name;
+
+		if(state == LexState::BlockComment)
+		{
+			const size_t close = find_token(text, i, end, lang.m_comment_end);
+			if(close == SIZE_MAX)
+			{
+				section(i, end, CodePalette::Comment);
+				return LexState::BlockComment;
+			}
+			i = close + lang.m_comment_end.size();
+			section(begin, i, CodePalette::Comment);
+		}
+
+		while(i < end)
+		{
+			const char c = text[i];
+			const size_t start = i;
+
+			if(isspace(uint8_t(c)))
+			{
+				++i;
+			}
+			else if(starts_with(text, i, end, lang.m_comment_start))
+			{
+				const size_t close = find_token(text, i + lang.m_comment_start.size(), end, lang.m_comment_end);
+				if(close == SIZE_MAX)
+				{
+					section(start, end, CodePalette::Comment);
+					return LexState::BlockComment;
+				}
+				i = close + lang.m_comment_end.size();
+				section(start, i, CodePalette::Comment);
+			}
+			else if(starts_with(text, i, end, lang.m_line_comment))
+			{
+				section(start, end, CodePalette::Comment);
+				break;
+			}
+			else if(lang.m_preprocessor && c == '#' && !preproc)
+			{
+				for(++i; i < end && (text[i] == ' ' || text[i] == '\t'); ++i);
+				for(; i < end && is_word(text[i]); ++i);
+				section(start, i, CodePalette::Preprocessor);
+				preproc = true;
+			}
+			else if(c == '"' || c == '\'')
+			{
+				for(++i; i < end && text[i] != c; ++i)
+					if(text[i] == '\\' && i + 1 < end)
+						++i;
+				i = min(i + 1, end);
+				section(start, i, c == '\'' && lang.m_char_literals ? CodePalette::CharLiteral : CodePalette::String);
+			}
+			else if(is_digit(c) || (c == '.' && i + 1 < end && is_digit(text[i + 1])))
+			{
+				if(c == '0' && i + 1 < end && (text[i + 1] == 'x' || text[i + 1] == 'X'))
+					for(i += 2; i < end && isxdigit(uint8_t(text[i])); ++i);
+				else
+				{
+					for(; i < end && (is_digit(text[i]) || text[i] == '.'); ++i);
+					if(i < end && (text[i] == 'e' || text[i] == 'E'))
+					{
+						++i;
+						if(i < end && (text[i] == '+' || text[i] == '-'))
+							++i;
+						for(; i < end && is_digit(text[i]); ++i);
+					}
+				}
+				for(; i < end && (text[i] == 'u' || text[i] == 'U' || text[i] == 'l' || text[i] == 'L' || text[i] == 'f' || text[i] == 'F'); ++i);
+				section(start, i, CodePalette::Number);
+			}
+			else if(is_word_start(c))
+			{
+				for(++i; i < end && is_word(text[i]); ++i);
+
+				CodePalette colour = CodePalette::Word;
+				if(lang.m_field_identifiers && c == '_')
+					colour = CodePalette::Field;
+				else if(lang.m_class_identifiers && isupper(uint8_t(c)))
+					colour = CodePalette::Identifier;
+				else if(lang.m_call_functions && i < end && text[i] == '(')
+					colour = CodePalette::Function;
+
+				name.assign(&text[start], i - start);
+				if(!lang.m_case_sensitive)
+					for(size_t k = 0; k < name.size(); ++k)
+						name[k] = char(toupper(uint8_t(name[k])));
+
+				const bool preproc_identifier = lang.m_preproc_identifiers.find(name) != lang.m_preproc_identifiers.end();
+				if(!preproc)
+				{
+					if(lang.m_keywords.find(name) != lang.m_keywords.end())
+						colour = CodePalette::Keyword;
+					else if(lang.m_identifiers.find(name) != lang.m_identifiers.end())
+						colour = CodePalette::Identifier;
+					else if(preproc_identifier)
+						colour = CodePalette::PreprocIdentifier;
+				}
+				else
+					colour = preproc_identifier ? CodePalette::PreprocIdentifier : CodePalette::Word;
+
+				section(start, i, colour);
+			}
+			else
+			{
+				++i;
+				const PaletteIndex symbol = uint8_t(c) < 128 ? lang.m_symbols[uint8_t(c)] : 0;
+				if(symbol != 0)
+					sections.push_back({ start, i, symbol });
+			}
+		}
+
+		return LexState::Code;
 	}
 
 	LanguageDefinition& LanguageCpp()
@@ -158,20 +299,12 @@ namespace two
 			builtin_keywords(lang, { keywords, size(keywords) });
 			builtin_identifiers(lang, { identifiers, size(identifiers) });
 
-			add_token_regex(lang, "//.*", CodePalette::Comment);
-			add_token_regex(lang, "[ \t]*#[ \\t]*[a-zA-Z_]+", CodePalette::Preprocessor);
-			add_token_regex(lang, "L?\\\"(\\\\.|[^\\\"])*\\\"", CodePalette::String);
-			add_token_regex(lang, "\\'\\\\?[^\\']\\'", CodePalette::CharLiteral);
-			add_token_regex(lang, "0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", CodePalette::Number);
-			add_token_regex(lang, "0[0-7]+[Uu]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "[+-]?[0-9]+[Uu]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "[a-zA-Z_][a-zA-Z0-9_]*", CodePalette::Word);
-			add_token_regex(lang, list_regex(lang.m_punctuation), CodePalette::Punctuation);
-			add_token_regex(lang, list_regex(lang.m_operators), CodePalette::Operator);
+			build_symbols(lang);
 
+			lang.m_line_comment = "//";
 			lang.m_comment_start = "/*";
 			lang.m_comment_end = "*/";
+			lang.m_preprocessor = true;
 
 			lang.m_case_sensitive = true;
 
@@ -231,20 +364,12 @@ namespace two
 			builtin_keywords(lang, { keywords, size(keywords) });
 			builtin_identifiers(lang, { identifiers, size(identifiers) });
 
-			add_token_regex(lang, "//.*", CodePalette::Comment);
-			add_token_regex(lang, "[ \t]*#[ \\t]*[a-zA-Z_]+", CodePalette::Preprocessor);
-			add_token_regex(lang, "L?\\\"(\\\\.|[^\\\"])*\\\"", CodePalette::String);
-			add_token_regex(lang, "\\'\\\\?[^\\']\\'", CodePalette::CharLiteral);
-			add_token_regex(lang, "[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", CodePalette::Number);
-			add_token_regex(lang, "[+-]?[0-9]+[Uu]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "0[0-7]+[Uu]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "[a-zA-Z_][a-zA-Z0-9_]*", CodePalette::Word);
-			add_token_regex(lang, list_regex(lang.m_punctuation), CodePalette::Punctuation);
-			add_token_regex(lang, list_regex(lang.m_operators), CodePalette::Operator);
+			build_symbols(lang);
 
+			lang.m_line_comment = "//";
 			lang.m_comment_start = "/*";
 			lang.m_comment_end = "*/";
+			lang.m_preprocessor = true;
 
 			lang.m_case_sensitive = true;
 
@@ -279,20 +404,12 @@ namespace two
 			builtin_keywords(lang, { keywords, size(keywords) });
 			builtin_identifiers(lang, { identifiers, size(identifiers) });
 
-			add_token_regex(lang, "//.*", CodePalette::Comment);
-			add_token_regex(lang, "[ \t]*#[ \\t]*[a-zA-Z_]+", CodePalette::Preprocessor);
-			add_token_regex(lang, "L?\\\"(\\\\.|[^\\\"])*\\\"", CodePalette::String);
-			add_token_regex(lang, "\\'\\\\?[^\\']\\'", CodePalette::CharLiteral);
-			add_token_regex(lang, "[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", CodePalette::Number);
-			add_token_regex(lang, "[+-]?[0-9]+[Uu]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "0[0-7]+[Uu]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "[a-zA-Z_][a-zA-Z0-9_]*", CodePalette::Word);
-			add_token_regex(lang, list_regex(lang.m_punctuation), CodePalette::Punctuation);
-			add_token_regex(lang, list_regex(lang.m_operators), CodePalette::Operator);
+			build_symbols(lang);
 
+			lang.m_line_comment = "//";
 			lang.m_comment_start = "/*";
 			lang.m_comment_end = "*/";
+			lang.m_preprocessor = true;
 
 			lang.m_case_sensitive = true;
 
@@ -327,20 +444,12 @@ namespace two
 			builtin_keywords(lang, { keywords, size(keywords) });
 			builtin_identifiers(lang, { identifiers, size(identifiers) });
 
-			add_token_regex(lang, "//.*", CodePalette::Comment);
-			add_token_regex(lang, "[ \t]*#[ \\t]*[a-zA-Z_]+", CodePalette::Preprocessor);
-			add_token_regex(lang, "L?\\\"(\\\\.|[^\\\"])*\\\"", CodePalette::String);
-			add_token_regex(lang, "\\'\\\\?[^\\']\\'", CodePalette::CharLiteral);
-			add_token_regex(lang, "[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", CodePalette::Number);
-			add_token_regex(lang, "[+-]?[0-9]+[Uu]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "0[0-7]+[Uu]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "[a-zA-Z_][a-zA-Z0-9_]*", CodePalette::Word);
-			add_token_regex(lang, list_regex(lang.m_punctuation), CodePalette::Punctuation);
-			add_token_regex(lang, list_regex(lang.m_operators), CodePalette::Operator);
+			build_symbols(lang);
 
+			lang.m_line_comment = "//";
 			lang.m_comment_start = "/*";
 			lang.m_comment_end = "*/";
+			lang.m_preprocessor = true;
 
 			lang.m_case_sensitive = true;
 
@@ -386,18 +495,12 @@ namespace two
 			builtin_identifiers(lang, { identifiers, size(identifiers) });
 			builtin_functions(lang, { functions, size(functions) });
 
-			add_token_regex(lang, "\\-\\-.*", CodePalette::Comment);
-			add_token_regex(lang, "L?\\\"(\\\\.|[^\\\"])*\\\"", CodePalette::String);
-			add_token_regex(lang, "\\\'[^\\\']*\\\'", CodePalette::String);
-			add_token_regex(lang, "0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", CodePalette::Number);
-			add_token_regex(lang, "[+-]?[0-9]+[Uu]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "[a-zA-Z_][a-zA-Z0-9_]*", CodePalette::Word);
-			add_token_regex(lang, list_regex(lang.m_punctuation), CodePalette::Punctuation);
-			add_token_regex(lang, list_regex(lang.m_operators), CodePalette::Operator);
+			build_symbols(lang);
 
-			lang.m_comment_start = "\\-\\-\\[\\[";
-			lang.m_comment_end = "\\]\\]";
+			lang.m_line_comment = "--";
+			lang.m_comment_start = "--[[";
+			lang.m_comment_end = "]]";
+			lang.m_char_literals = false;
 
 			lang.m_case_sensitive = true;
 
@@ -425,22 +528,14 @@ namespace two
 
 			builtin_keywords(lang, { keywords, size(keywords) });
 
-			add_token_regex(lang, "//.*", CodePalette::Comment);
-			add_token_regex(lang, "[A-Z][a-zA-Z0-9_]*", CodePalette::Identifier);
-			add_token_regex(lang, "[_][a-zA-Z0-9_]*", CodePalette::Field);
-			add_token_regex(lang, "[a-z0-9_]+(?=\\()", CodePalette::Function);
-			add_token_regex(lang, "[a-zA-Z_][a-zA-Z0-9_]*", CodePalette::Word);
-			add_token_regex(lang, list_regex(lang.m_punctuation), CodePalette::Punctuation);
-			add_token_regex(lang, list_regex(lang.m_operators), CodePalette::Operator);
-			add_token_regex(lang, "L?\\\"(\\\\.|[^\\\"])*\\\"", CodePalette::String);
-			add_token_regex(lang, "\\'\\\\?[^\\']\\'", CodePalette::CharLiteral);
-			add_token_regex(lang, "0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", CodePalette::Number);
-			add_token_regex(lang, "0[0-7]+[Uu]?[lL]?[lL]?", CodePalette::Number);
-			add_token_regex(lang, "[+-]?[0-9]+[Uu]?[lL]?[lL]?", CodePalette::Number);
+			build_symbols(lang);
 
+			lang.m_line_comment = "//";
 			lang.m_comment_start = "/*";
 			lang.m_comment_end = "*/";
+			lang.m_class_identifiers = true;
+			lang.m_field_identifiers = true;
+			lang.m_call_functions = true;
 
 			lang.m_case_sensitive = true;
 
@@ -13,8 +13,6 @@
 #include <ui/Forward.h>
 #include <ui/Edit/TypeIn.h>
 
-#include <regex>
-
 namespace two
 {
 	struct Identifier
@@ -32,17 +30,32 @@ namespace two
 		unordered_map<string, Identifier> m_identifiers;
 		unordered_map<string, Identifier> m_functions;
 		unordered_map<string, Identifier> m_preproc_identifiers;
+		string m_line_comment;
 		string m_comment_start;
 		string m_comment_end;
 
-		struct StringToken { string token; PaletteIndex color; };
-		struct RegexToken { std::regex token; PaletteIndex color; };
-		vector<StringToken> m_regex_string_tokens;
-		vector<RegexToken> m_regex_tokens;
+		bool m_preprocessor = false;
+		bool m_char_literals = true;		// single quotes delimit character literals, otherwise strings
+		bool m_class_identifiers = false;	// capitalized words are class names
+		bool m_field_identifiers = false;	// words starting with an underscore are fields
+		bool m_call_functions = false;		// words directly followed by a parenthesis are function calls
+
+		// palette of each single character symbol (punctuation and operators)
+		PaletteIndex m_symbols[128] = {};
 
 		bool m_case_sensitive;
 	};
 
+	// lexer state at the start of a line : the highlighter restarts at an edited line and stops once the state matches again
+	enum class LexState : uint8_t
+	{
+		Code,
+		BlockComment,
+		Unknown = 0xFF
+	};
+
+	LexState tokenize_line(const LanguageDefinition& lang, const string& text, size_t begin, size_t end, LexState state, vector<Text::ColorSection>& sections);
+
 	LanguageDefinition& LanguageCpp();
 	LanguageDefinition& LanguageHLSL();
 	LanguageDefinition& LanguageGLSL();
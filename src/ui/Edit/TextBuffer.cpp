@@ -0,0 +1,204 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#ifdef TWO_MODULES
+module;
+#include <infra/Cpp20.h>
+module two.ui;
+#else
+#include <stl/vector.hpp>
+#include <stl/math.h>
+#include <ui/Edit/TextBuffer.h>
+#endif
+
+namespace two
+{
+	TextBuffer::TextBuffer()
+	{
+		m_line_starts.push_back(0);
+	}
+
+	void TextBuffer::reset(const string& text)
+	{
+		m_original = text;
+		m_added.clear();
+		m_pieces.clear();
+		if(!text.empty())
+			m_pieces.push_back({ TextPiece::Original, 0, text.size() });
+		m_size = text.size();
+
+		m_line_starts.clear();
+		m_line_starts.push_back(0);
+		for(size_t i = 0; i < text.size(); ++i)
+			if(text[i] == '\n')
+				m_line_starts.push_back(i + 1);
+	}
+
+	size_t TextBuffer::size(span<TextPiece> pieces)
+	{
+		size_t result = 0;
+		for(const TextPiece& piece : pieces)
+			result += piece.m_size;
+		return result;
+	}
+
+	size_t TextBuffer::split(size_t index)
+	{
+		size_t offset = 0;
+		for(size_t i = 0; i < m_pieces.size(); ++i)
+		{
+			TextPiece& piece = m_pieces[i];
+			if(index == offset)
+				return i;
+			if(index < offset + piece.m_size)
+			{
+				const size_t cut = index - offset;
+				const TextPiece second = { piece.m_source, piece.m_start + cut, piece.m_size - cut };
+				piece.m_size = cut;
+				m_pieces.insert(m_pieces.begin() + i + 1, second);
+				return i + 1;
+			}
+			offset += piece.m_size;
+		}
+		return m_pieces.size();
+	}
+
+	void TextBuffer::insert(size_t index, const char* text, size_t size)
+	{
+		if(size == 0) return;
+
+		const TextPiece piece = { TextPiece::Added, m_added.size(), size };
+		m_added.append(text, text + size);
+
+		const size_t at = this->split(index);
+
+		// consecutive typing extends the last added piece instead of adding one piece per character
+		TextPiece* before = at > 0 ? &m_pieces[at - 1] : nullptr;
+		if(before && before->m_source == TextPiece::Added && before->m_start + before->m_size == piece.m_start)
+			before->m_size += size;
+		else
+			m_pieces.insert(m_pieces.begin() + at, piece);
+
+		m_size += size;
+		this->insert_lines(index, { const_cast<TextPiece*>(&piece), 1 }, size);
+	}
+
+	void TextBuffer::insert(size_t index, span<TextPiece> pieces)
+	{
+		const size_t size = TextBuffer::size(pieces);
+		if(size == 0) return;
+
+		const size_t at = this->split(index);
+		m_pieces.insert(m_pieces.begin() + at, pieces.begin(), pieces.end());
+
+		m_size += size;
+		this->insert_lines(index, pieces, size);
+	}
+
+	vector<TextPiece> TextBuffer::erase(size_t index, size_t size)
+	{
+		if(size == 0) return {};
+
+		const size_t first = this->split(index);
+		const size_t last = this->split(index + size);
+
+		vector<TextPiece> removed = vector<TextPiece>(m_pieces.begin() + first, m_pieces.begin() + last);
+		m_pieces.erase(m_pieces.begin() + first, m_pieces.begin() + last);
+
+		m_size -= size;
+		this->erase_lines(index, size);
+		return removed;
+	}
+
+	string TextBuffer::text() const
+	{
+		return this->text(m_pieces);
+	}
+
+	string TextBuffer::text(span<TextPiece> pieces) const
+	{
+		string result = "";
+		result.reserve(TextBuffer::size(pieces));
+		for(const TextPiece& piece : pieces)
+		{
+			const char* first = this->source(piece);
+			result.append(first, first + piece.m_size);
+		}
+		return result;
+	}
+
+	void TextBuffer::copy(size_t index, size_t size, string& output) const
+	{
+		output.clear();
+		size_t offset = 0;
+		for(const TextPiece& piece : m_pieces)
+		{
+			const size_t start = max(index, offset);
+			const size_t end = min(index + size, offset + piece.m_size);
+			if(start < end)
+			{
+				const char* first = this->source(piece) + (start - offset);
+				output.append(first, first + (end - start));
+			}
+			offset += piece.m_size;
+			if(offset >= index + size)
+				break;
+		}
+	}
+
+	size_t TextBuffer::line_at(size_t index) const
+	{
+		// last line starting at or before index
+		size_t lo = 0;
+		size_t hi = m_line_starts.size();
+		while(hi - lo > 1)
+		{
+			const size_t mid = (lo + hi) / 2;
+			if(m_line_starts[mid] <= index)
+				lo = mid;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	size_t TextBuffer::line_end(size_t line) const
+	{
+		return line + 1 < m_line_starts.size() ? m_line_starts[line + 1] - 1 : m_size;
+	}
+
+	void TextBuffer::insert_lines(size_t index, span<TextPiece> pieces, size_t size)
+	{
+		const size_t line = this->line_at(index);
+		for(size_t i = line + 1; i < m_line_starts.size(); ++i)
+			m_line_starts[i] += size;
+
+		vector<size_t> starts;
+		size_t offset = index;
+		for(const TextPiece& piece : pieces)
+		{
+			const char* first = this->source(piece);
+			for(size_t i = 0; i < piece.m_size; ++i)
+				if(first[i] == '\n')
+					starts.push_back(offset + i + 1);
+			offset += piece.m_size;
+		}
+
+		if(!starts.empty())
+			m_line_starts.insert(m_line_starts.begin() + line + 1, starts.begin(), starts.end());
+	}
+
+	void TextBuffer::erase_lines(size_t index, size_t size)
+	{
+		// lines starting inside the erased range were started by an erased newline
+		const size_t line = this->line_at(index);
+		size_t last = line + 1;
+		while(last < m_line_starts.size() && m_line_starts[last] <= index + size)
+			last++;
+
+		m_line_starts.erase(m_line_starts.begin() + line + 1, m_line_starts.begin() + last);
+		for(size_t i = line + 1; i < m_line_starts.size(); ++i)
+			m_line_starts[i] -= size;
+	}
+}
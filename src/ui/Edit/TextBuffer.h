@@ -0,0 +1,65 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#pragma once
+
+#ifndef TWO_MODULES
+#include <stl/string.h>
+#include <stl/vector.h>
+#include <stl/span.h>
+#endif
+#include <ui/Forward.h>
+
+namespace two
+{
+	export_ struct TWO_UI_EXPORT TextPiece
+	{
+		enum Source : uint32_t { Original, Added };
+
+		Source m_source;
+		size_t m_start;
+		size_t m_size;
+	};
+
+	// piece table : the text is a sequence of pieces referencing the original text or the append-only added text
+	// edits only split pieces, and removed pieces stay valid forever so undo stores pieces instead of copying text
+	export_ class TWO_UI_EXPORT TextBuffer
+	{
+	public:
+		TextBuffer();
+
+		void reset(const string& text);
+
+		void insert(size_t index, const char* text, size_t size);
+		void insert(size_t index, span<TextPiece> pieces);
+		vector<TextPiece> erase(size_t index, size_t size);
+
+		size_t size() const { return m_size; }
+		string text() const;
+		string text(span<TextPiece> pieces) const;
+		void copy(size_t index, size_t size, string& output) const;
+
+		size_t line_count() const { return m_line_starts.size(); }
+		size_t line_at(size_t index) const;
+		size_t line_start(size_t line) const { return m_line_starts[line]; }
+		size_t line_end(size_t line) const;
+
+		static size_t size(span<TextPiece> pieces);
+
+		string m_original;
+		string m_added;
+		vector<TextPiece> m_pieces;
+
+		// start offset of each line, kept up to date on each edit
+		vector<size_t> m_line_starts;
+
+	private:
+		const char* source(const TextPiece& piece) const { return (piece.m_source == TextPiece::Original ? m_original.c_str() : m_added.c_str()) + piece.m_start; }
+		size_t split(size_t index);
+		void insert_lines(size_t index, span<TextPiece> pieces, size_t size);
+		void erase_lines(size_t index, size_t size);
+
+		size_t m_size = 0;
+	};
+}
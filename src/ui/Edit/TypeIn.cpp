@@ -7,7 +7,6 @@
 #include <cctype>
 #include <locale>
 #include <chrono>
-#include <regex>
 #include <cmath>
 #endif
 
@@ -16,6 +15,7 @@ module two.ui;
 #else
 #include <stl/string.h>
 #include <stl/algorithm.h>
+#include <stl/vector.hpp>
 #include <infra/Log.h>
 #include <math/Math.h>
 #include <math/Vec.hpp>
@@ -44,6 +44,7 @@ namespace two
 		, m_allowed_chars(allowed_chars)
 	{
 		m_palette = OkaidaPalette();
+		m_line_states.push_back(uint8_t(LexState::Code));
 	}
 
 	TextEdit::~TextEdit()
@@ -90,6 +91,12 @@ namespace two
 		if(m_string == text) return;
 
 		m_text.set_text(text);
+		m_buffer.reset(text);
+
+		m_line_states.clear();
+		m_line_states.resize(m_buffer.line_count(), uint8_t(LexState::Unknown));
+		m_line_states[0] = uint8_t(LexState::Code);
+		m_text.m_sections.clear();
 
 		m_selection.m_cursor = m_text.to_cursor(min(size_t(m_selection.m_cursor), text.size()));
 		m_selection.m_start = min(size_t(m_selection.m_start), text.size());
@@ -110,7 +117,6 @@ namespace two
 	{
 		m_dirty[0] = min<uint>(m_dirty[0], uint(start));
 		m_dirty[1] = max<uint>(m_dirty[1], uint(end));
-		m_text.break_text_rows();
 		this->changed();
 	}
 
@@ -130,41 +136,77 @@ namespace two
 		}
 	}
 
-	void TextEdit::insert(size_t index, const string& text)
+	void TextEdit::edit_lines(size_t line, size_t removed, size_t added)
+	{
+		auto at = m_line_states.begin() + line + 1;
+		m_line_states.erase(at, at + removed);
+
+		// the state of the new lines is unknown until they are highlighted
+		vector<uint8_t> unknown = vector<uint8_t>(added, uint8_t(LexState::Unknown));
+		m_line_states.insert(m_line_states.begin() + line + 1, unknown.begin(), unknown.end());
+	}
+
+	void TextEdit::inserted(size_t index, const string& text)
 	{
+		size_t lines = 0;
+		for(char c : text)
+			lines += c == '\n' ? 1 : 0;
+
 		this->shift(index, int(text.size()));
 		m_string.insert(index, text);
+		this->edit_lines(m_buffer.line_at(index), 0, lines);
+		m_text.break_text_rows(index, 0, text.size());
 		this->mark_dirty(line_begin(m_string, index), line_end(m_string, index + text.size()));
 		m_follow_cursor = true;
 	}
 
-	void TextEdit::insert(size_t index, const string& text, size_t cursor, Action& action)
+	void TextEdit::insert(size_t index, const string& text)
 	{
-		action.mAdded = text;
-		action.mAddedStart = index;
-		action.mAddedEnd = index + text.size();
+		m_buffer.insert(index, text.c_str(), text.size());
+		this->inserted(index, text);
+	}
+
+	void TextEdit::restore(size_t index, span<TextPiece> pieces)
+	{
+		m_buffer.insert(index, pieces);
+		this->inserted(index, m_buffer.text(pieces));
+	}
 
+	void TextEdit::insert(size_t index, const string& text, size_t cursor, Action& action)
+	{
 		this->insert(index, text);
 		this->cursor(cursor);
+
+		// the inserted text is the tail of the added buffer
+		action.mAdded = { { TextPiece::Added, m_buffer.m_added.size() - text.size(), text.size() } };
+		action.mAddedStart = index;
+		action.mAddedEnd = index + text.size();
 	}
 
-	void TextEdit::erase(size_t start, size_t end)
+	vector<TextPiece> TextEdit::erase(size_t start, size_t end)
 	{
-		if(end == start) return;
+		if(end == start) return {};
+
+		const size_t line = m_buffer.line_at(start);
+		const size_t lines = m_buffer.line_count();
+
 		this->clear(start, end);
 		this->shift(start, int(start - end));
+		vector<TextPiece> removed = m_buffer.erase(start, end - start);
 		m_string.erase(start, end - start);
+		this->edit_lines(line, lines - m_buffer.line_count(), 0);
+		m_text.break_text_rows(start, end - start, 0);
 		this->mark_dirty(line_begin(m_string, start), line_end(m_string, start));
 		m_follow_cursor = true;
+		return removed;
 	}
 
 	void TextEdit::erase(size_t start, size_t end, size_t cursor, Action& action)
 	{
-		action.mRemoved = m_string.substr(start, end - start);
+		action.mRemoved = this->erase(start, end);
 		action.mRemovedStart = start;
 		action.mRemovedEnd = end;
 
-		this->erase(start, end);
 		this->cursor(cursor);
 	}
 
@@ -535,7 +577,9 @@ namespace two
 		if(!this->mouse_event(DeviceType::MouseLeft, EventType::Pressed))
 			m_word_selection_mode = false;
 
-		m_frame.layer().setForceRedraw(); // TextEdit must redraw each frame
+		// the caret blinks, so a focused TextEdit must redraw each frame
+		if(this->focused())
+			m_frame.layer().setForceRedraw();
 	}
 
 	void TextEdit::update_scroll(Frame& frame, Frame& content)
@@ -543,8 +587,8 @@ namespace two
 		if(MouseEvent event = this->mouse_event(DeviceType::MouseMiddle, EventType::Moved))
 		{
 			float overflow = content.m_size.y - frame.m_size.y;
-			content.m_position.y += event.m_deltaZ * 22.f * 3.f;
-			content.m_position.y = min(0.f, max(content.m_position.y, -overflow));
+			const float position = content.m_position.y + event.m_deltaZ * 22.f * 3.f;
+			content.set_position(Axis::Y, min(0.f, max(position, -overflow)));
 		}
 
 		if(m_follow_cursor)
@@ -606,71 +650,53 @@ namespace two
 			return;
 		}
 
-		std::match_results<const char*> results;
+		size_t first_line = m_buffer.line_at(from);
+		const size_t last_line = m_buffer.line_at(to);
+		while(first_line > 0 && m_line_states[first_line] == uint8_t(LexState::Unknown))
+			first_line--;
 
-		const size_t begin = line_begin(m_string, from);
-		const size_t end = line_end(m_string, to);
+		// lex from the first edited line until past the last one, and until a line starts in the state it had before
+		vector<Text::ColorSection> sections;
+		LexState state = m_line_states[first_line] == uint8_t(LexState::Unknown) ? LexState::Code : LexState(m_line_states[first_line]);
 
-		bool preproc = false;
+		const size_t num_lines = m_buffer.line_count();
+		size_t line = first_line;
+		while(line < num_lines)
+		{
+			state = tokenize_line(*m_language, m_string, m_buffer.line_start(line), m_buffer.line_end(line), state, sections);
+			line++;
+
+			if(line == num_lines)
+				break;
 
-		const char* first = &m_string.front();
-		const char* start = first + begin;
-		const char* last = first + end;
+			const bool synced = m_line_states[line] == uint8_t(state);
+			m_line_states[line] = uint8_t(state);
+			if(synced && line > last_line)
+				break;
+		}
 
-		// remove all sections that overlap range to colorize, and get iterator to insert the new ones
-		remove_if(m_text.m_sections, [=](Text::ColorSection& section) { return section.m_start >= begin && section.m_end <= end; });
-		auto start_section = find_if(m_text.m_sections, [=](const Text::ColorSection& section) { return section.m_start >= begin; });
+		const size_t begin = m_buffer.line_start(first_line);
+		const size_t end = line < num_lines ? m_buffer.line_start(line) : m_string.size();
 
-		for(const char* current = start; current != last; ++current)
+		// replace the sections in the lexed range, sections are sorted
+		auto lower = [&](size_t index)
 		{
-			for(auto& token_color : m_language->m_regex_tokens)
+			Text::ColorSection* first = m_text.m_sections.begin();
+			size_t count = m_text.m_sections.size();
+			while(count > 0)
 			{
-				if(std::regex_search<const char*>(current, last, results, token_color.token, std::regex_constants::match_continuous))
-				{
-					auto match = *results.begin();
-					string name = m_string.substr(match.first - first, match.second - match.first);
-					PaletteIndex color = token_color.color;
-
-					//if(color == uint16_t(CodePalette::Word))
-					{
-						if(!m_language->m_case_sensitive)
-							std::transform(name.begin(), name.end(), name.begin(), [](char c) { return char(toupper(c)); });
-						
-						if(!preproc)
-						{
-							if(m_language->m_keywords.find(name) != m_language->m_keywords.end())
-								color = uint16_t(CodePalette::Keyword);
-							else if(m_language->m_identifiers.find(name) != m_language->m_identifiers.end())
-								color = uint16_t(CodePalette::Identifier);
-							else if(m_language->m_preproc_identifiers.find(name) != m_language->m_preproc_identifiers.end())
-								color = uint16_t(CodePalette::PreprocIdentifier);
-						}
-						else
-						{
-							if(m_language->m_preproc_identifiers.find(name) != m_language->m_preproc_identifiers.end())
-								color = uint16_t(CodePalette::PreprocIdentifier);
-							else
-								color = uint16_t(CodePalette::Word);
-						}
-					}
-					//else
-					if(color == uint16_t(CodePalette::Preprocessor))
-					{
-						preproc = true;
-					}
-
-					const Text::ColorSection section = { size_t(match.first - first), size_t(match.second - first), color };
-					start_section = m_text.m_sections.insert(start_section, section);
-					start_section++;
-
-					current += name.size() - 1;
-					break;
-				}
+				const size_t step = count / 2;
+				if(first[step].m_start < index) { first += step + 1; count -= step + 1; }
+				else count = step;
 			}
+			return first;
+		};
 
-			if(*current == '\n')
-				preproc = false;
-		}
+		Text::ColorSection* erase_end = lower(end);
+		Text::ColorSection* erase_begin = lower(begin);
+		const size_t at = erase_begin - m_text.m_sections.begin();
+		m_text.m_sections.erase(erase_begin, erase_end);
+		m_text.m_sections.insert(m_text.m_sections.begin() + at, sections.begin(), sections.end());
 	}
 
 	void TextEdit::scroll_to_cursor(Frame& frame, Frame& content)
@@ -697,7 +723,7 @@ namespace two
 			aEditor->erase(mAddedStart, mAddedEnd);
 
 		if(!mRemoved.empty())
-			aEditor->insert(mRemovedStart, mRemoved);
+			aEditor->restore(mRemovedStart, mRemoved);
 		
 		aEditor->m_selection = mBefore;
 		aEditor->m_follow_cursor = true;
@@ -710,7 +736,7 @@ namespace two
 			aEditor->erase(mRemovedStart, mRemovedEnd);
 
 		if(!mAdded.empty())
-			aEditor->insert(mAddedStart, mAdded);
+			aEditor->restore(mAddedStart, mAdded);
 
 		aEditor->m_selection = mAfter;
 		aEditor->m_follow_cursor = true;
@@ -774,7 +800,6 @@ namespace ui
 		if(edit.key_stroke(Key::Tab) || selected)
 		{
 			edit.insert(string(completions[current]).substr(current_word.size()));
-			edit.m_text.break_text_rows();
 			edit.m_completing = false;
 			text = edit.m_string;
 		}
@@ -12,6 +12,7 @@
 #include <ui/Forward.h>
 #include <ui/WidgetStruct.h>
 #include <ui/Frame/Caption.h>
+#include <ui/Edit/TextBuffer.h>
 #include <ui/Style/Paint.h>
 
 namespace two
@@ -54,11 +55,12 @@ namespace two
 			void Undo(TextEdit* aEditor);
 			void Redo(TextEdit* aEditor);
 
-			string mAdded;
+			// pieces of the text buffer : undo never copies the edited text
+			vector<TextPiece> mAdded;
 			size_t mAddedStart;
 			size_t mAddedEnd;
 
-			string mRemoved;
+			vector<TextPiece> mRemoved;
 			size_t mRemovedStart;
 			size_t mRemovedEnd;
 
@@ -77,6 +79,9 @@ namespace two
 		TextSelection m_selection;
 		string& m_string;
 
+		// m_string is the contiguous copy the text is laid out and drawn from
+		TextBuffer m_buffer;
+
 		bool m_changed = false;
 		bool m_entered = false;
 
@@ -89,11 +94,13 @@ namespace two
 
 		void set_text(const string& text);
 
-		void erase(size_t start, size_t end);
+		vector<TextPiece> erase(size_t start, size_t end);
 		void erase(size_t start, size_t end, size_t cursor, Action& action);
 
+		void inserted(size_t index, const string& text);
 		void insert(size_t index, const string& text);
 		void insert(size_t index, const string& text, size_t cursor, Action& action);
+		void restore(size_t index, span<TextPiece> pieces);
 
 		void erase_selected(Action& action);
 
@@ -149,9 +156,13 @@ namespace two
 		void recolorize();
 		void colorize(size_t start, size_t end);
 		void mark_dirty(size_t start, size_t end);
+		void edit_lines(size_t line, size_t removed, size_t added);
 
 		uvec2 m_dirty;
 
+		// lexer state at the start of each line
+		vector<uint8_t> m_line_states;
+
 		template <class T_Func>
 		void CommitAction(T_Func func)
 		{
@@ -11,8 +11,6 @@
 #define TWO_UI_EXPORT TWO_IMPORT
 #endif
 
-#undef TWO_UI_DRAW_CACHE
-
 namespace two
 {
 namespace ui
@@ -38,6 +36,7 @@ namespace ui
     struct WindowStyles;
     struct FileStyles;
     class Sequence;
+    class VirtualSequence;
 }
 }
 
@@ -81,10 +80,13 @@ namespace two
     struct TextSelection;
     class Text;
     class TextEdit;
+    struct TextPiece;
+    class TextBuffer;
 	struct Clipboard;
     struct NodeConnection;
     class Vg;
     class UiRenderer;
+    struct UiRenderStats;
     class UiWindow;
     class User;
     struct KeyCombo;
@@ -92,6 +94,8 @@ namespace two
     struct Identifier;
     struct LanguageDefinition;
     class Layer;
+    struct HitEntry;
+    class HitIndex;
     struct Layout;
     class FrameSolver;
     class RowSolver;
@@ -7,6 +7,9 @@ module;
 #include <infra/Cpp20.h>
 module two.ui;
 #else
+#include <stl/vector.hpp>
+#include <stl/unordered_map.hpp>
+#include <stl/hash.h>
 #include <stl/math.h>
 #include <math/Vec.hpp>
 #include <ui/Frame/Caption.h>
@@ -16,6 +19,7 @@ module two.ui;
 #endif
 
 #include <cstdio>
+#include <cstring>
 
 namespace two
 {
@@ -148,20 +152,279 @@ namespace two
 		return result;
 	}
 
+	void bind_glyphs(span<TextRow> rows, vector<TextGlyph>& glyphs)
+	{
+		for(size_t i = 0; i < rows.size(); ++i)
+		{
+			TextRow& row = rows[i];
+			const size_t end = i + 1 < rows.size() ? rows[i + 1].m_first_glyph : glyphs.size();
+			row.m_glyphs = { glyphs.data() + row.m_first_glyph, end - row.m_first_glyph };
+		}
+	}
+
+	TextLayoutStats& text_layout_stats()
+	{
+		static TextLayoutStats stats;
+		return stats;
+	}
+
+	// least recently used cache of broken texts : most texts are static labels laid out again every frame
+	struct TextLayoutCache
+	{
+		static constexpr size_t max_entries = 256;
+		static constexpr size_t max_length = 1024;
+
+		struct Entry
+		{
+			size_t m_hash;
+			string m_text;
+			string m_font;
+			float m_size;
+			v2<Align> m_align;
+			bool m_text_break;
+			bool m_text_wrap;
+			float m_width;
+
+			vector<TextRow> m_rows;
+			vector<TextGlyph> m_glyphs;
+
+			uint32_t m_prev = UINT32_MAX;
+			uint32_t m_next = UINT32_MAX;
+		};
+
+		TextLayoutCache() { m_entries.reserve(max_entries); }
+
+		// entries are never reallocated : their rows point in their own string
+		vector<Entry> m_entries;
+		unordered_map<size_t, uint32_t> m_index;
+		uint32_t m_head = UINT32_MAX;
+		uint32_t m_tail = UINT32_MAX;
+
+		static float break_width(const TextPaint& paint, float width) { return paint.m_text_break && paint.m_text_wrap ? width : 0.f; }
+
+		static size_t key(const string& text, const TextPaint& paint, float width)
+		{
+			size_t h = stl::hash_string(text.c_str(), text.size());
+			const auto mix = [&](size_t v) { h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2); };
+			mix(stl::hash_string(paint.m_font, strlen(paint.m_font)));
+			mix(stl::hash_string((const char*)&paint.m_size, sizeof(float)));
+			mix(size_t(paint.m_align.x) << 8 | size_t(paint.m_align.y) << 4 | size_t(paint.m_text_break) << 1 | size_t(paint.m_text_wrap));
+			mix(stl::hash_string((const char*)&width, sizeof(float)));
+			return h;
+		}
+
+		static bool matches(const Entry& e, const string& text, const TextPaint& paint, float width)
+		{
+			return e.m_text == text && e.m_font == paint.m_font && e.m_size == paint.m_size && e.m_align == paint.m_align
+				&& e.m_text_break == paint.m_text_break && e.m_text_wrap == paint.m_text_wrap && e.m_width == width;
+		}
+
+		void unlink(uint32_t i)
+		{
+			Entry& e = m_entries[i];
+			if(e.m_prev != UINT32_MAX) m_entries[e.m_prev].m_next = e.m_next; else m_head = e.m_next;
+			if(e.m_next != UINT32_MAX) m_entries[e.m_next].m_prev = e.m_prev; else m_tail = e.m_prev;
+			e.m_prev = e.m_next = UINT32_MAX;
+		}
+
+		void push_front(uint32_t i)
+		{
+			Entry& e = m_entries[i];
+			e.m_next = m_head;
+			if(m_head != UINT32_MAX) m_entries[m_head].m_prev = i;
+			m_head = i;
+			if(m_tail == UINT32_MAX) m_tail = i;
+		}
+
+		bool fetch(Text& text, float width)
+		{
+			width = break_width(text.m_text_paint, width);
+			auto it = m_index.find(key(text.m_text, text.m_text_paint, width));
+			if(it == m_index.end() || !matches(m_entries[it->second], text.m_text, text.m_text_paint, width))
+				return false;
+
+			const uint32_t i = it->second;
+			unlink(i);
+			push_front(i);
+
+			// rows point in the cached string, rebase them in the text string
+			const Entry& e = m_entries[i];
+			const char* base = text.m_text.c_str();
+			text.m_text_rows = e.m_rows;
+			text.m_glyphs = e.m_glyphs;
+			for(TextRow& row : text.m_text_rows)
+			{
+				row.m_start = base + row.m_start_index;
+				row.m_end = base + row.m_end_index;
+			}
+			bind_glyphs(text.m_text_rows, text.m_glyphs);
+			return true;
+		}
+
+		void store(const Text& text, float width)
+		{
+			if(text.m_text.size() > max_length)
+				return;
+
+			width = break_width(text.m_text_paint, width);
+			const size_t hash = key(text.m_text, text.m_text_paint, width);
+
+			uint32_t i;
+			auto it = m_index.find(hash);
+			if(it != m_index.end())
+			{
+				i = it->second;
+				unlink(i);
+			}
+			else if(m_entries.size() < max_entries)
+			{
+				i = uint32_t(m_entries.size());
+				m_entries.emplace_back();
+			}
+			else
+			{
+				i = m_tail;
+				unlink(i);
+				m_index.erase(m_entries[i].m_hash);
+			}
+
+			Entry& e = m_entries[i];
+			e.m_hash = hash;
+			e.m_text = text.m_text;
+			e.m_font = text.m_text_paint.m_font;
+			e.m_size = text.m_text_paint.m_size;
+			e.m_align = text.m_text_paint.m_align;
+			e.m_text_break = text.m_text_paint.m_text_break;
+			e.m_text_wrap = text.m_text_paint.m_text_wrap;
+			e.m_width = width;
+
+			const char* base = e.m_text.c_str();
+			e.m_rows = text.m_text_rows;
+			e.m_glyphs = text.m_glyphs;
+			for(TextRow& row : e.m_rows)
+			{
+				row.m_start = base + row.m_start_index;
+				row.m_end = base + row.m_end_index;
+			}
+			bind_glyphs(e.m_rows, e.m_glyphs);
+
+			m_index[hash] = i;
+			push_front(i);
+		}
+	};
+
+	static TextLayoutCache s_layout_cache;
+
 	void Text::break_text_rows()
 	{
 		const vec2 padded_size = floor(m_frame.m_size - rect_sum(m_frame.d_inkstyle->m_padding));
+		d_break_width = padded_size.x;
 
-		if(!m_text.empty())
-			s_vg->break_text(m_text.c_str(), m_text.size(), padded_size, m_text_paint, m_text_rows);
-		else
+		if(m_text.empty())
+		{
 			m_text_rows.clear();
+			m_glyphs.clear();
+		}
+		else if(s_layout_cache.fetch(*this, padded_size.x))
+		{
+			text_layout_stats().m_hits++;
+		}
+		else
+		{
+			s_vg->break_text(m_text.c_str(), m_text.size(), padded_size, m_text_paint, m_text_rows, m_glyphs);
+			s_layout_cache.store(*this, padded_size.x);
+			text_layout_stats().m_misses++;
+		}
 
 		//return offset +  + rect_sum(m_frame.d_inkstyle->m_padding);
 		m_frame.m_content = this->compute_text_size();
 		m_frame.mark_dirty(DIRTY_LAYOUT);
 	}
 
+	void Text::break_text_rows(size_t start, size_t erased, size_t inserted)
+	{
+		// the text has already been edited : [start, start + erased) was replaced by [start, start + inserted)
+		const vec2 padded_size = floor(m_frame.m_size - rect_sum(m_frame.d_inkstyle->m_padding));
+		if(m_text_rows.empty() || m_text.empty() || !m_text_paint.m_text_break || padded_size.x != d_break_width)
+			return this->break_text_rows();
+
+		const ptrdiff_t delta = ptrdiff_t(inserted) - ptrdiff_t(erased);
+		const float line_height = this->line_height();
+
+		vector<TextRow> old_rows = move(m_text_rows);
+		vector<TextGlyph> old_glyphs = move(m_glyphs);
+
+		// the row before the edit is broken again too : wrapping can pull the edited word up a row
+		size_t first_row = 0;
+		while(first_row + 1 < old_rows.size() && old_rows[first_row].m_end_index < start)
+			first_row++;
+		if(first_row > 0)
+			first_row--;
+
+		const char* base = m_text.c_str();
+		const char* end = base + m_text.size();
+
+		// rows before the edit are unchanged, only their pointers move with the string
+		// the old rows point in the string before the edit, which may have been reallocated : only their indices are read
+		m_text_rows.reserve(old_rows.size() + 1);
+		m_glyphs.reserve(m_text.size());
+
+		auto rebase = [&](const TextRow& old_row, ptrdiff_t shift, size_t index)
+		{
+			TextRow row = old_row;
+			row.m_start_index = size_t(ptrdiff_t(row.m_start_index) + shift);
+			row.m_end_index = size_t(ptrdiff_t(row.m_end_index) + shift);
+			row.m_start = base + row.m_start_index;
+			row.m_end = base + row.m_end_index;
+			row.m_rect.y = index * line_height;
+			row.m_first_glyph = m_glyphs.size();
+			for(const TextGlyph& old_glyph : old_row.m_glyphs)
+			{
+				TextGlyph glyph = { size_t(ptrdiff_t(old_glyph.m_index) + shift), old_glyph.m_rect };
+				glyph.m_rect.y = row.m_rect.y;
+				m_glyphs.push_back(glyph);
+			}
+			m_text_rows.push_back(row);
+		};
+
+		for(size_t i = 0; i < first_row; ++i)
+			rebase(old_rows[i], 0, i);
+
+		const size_t edit_end = start + inserted;
+		size_t old_row = first_row;
+		const char* first = base + old_rows[first_row].m_start_index;
+
+		while(first < end)
+		{
+			// once past the edit, a row starting where an old row started (shifted) means the rest of the layout is unchanged
+			const size_t index = size_t(first - base);
+			if(index >= edit_end && index > start)
+			{
+				while(old_row < old_rows.size() && ptrdiff_t(old_rows[old_row].m_start_index) + delta < ptrdiff_t(index))
+					old_row++;
+				if(old_row < old_rows.size() && ptrdiff_t(old_rows[old_row].m_start_index) + delta == ptrdiff_t(index) && old_rows[old_row].m_start_index >= start + erased)
+				{
+					for(size_t i = old_row; i < old_rows.size(); ++i)
+						rebase(old_rows[i], delta, m_text_rows.size());
+					break;
+				}
+			}
+
+			TextRow row;
+			vec4 rect(0.f, m_text_rows.size() * line_height, padded_size.x, 0.f);
+			s_vg->break_text_row(base, first, end, rect, m_text_paint, row, m_glyphs);
+			m_text_rows.push_back(row);
+
+			first = row.m_end + 1;
+		}
+
+		bind_glyphs(m_text_rows, m_glyphs);
+		text_layout_stats().m_partial++;
+
+		m_frame.m_content = this->compute_text_size();
+		m_frame.mark_dirty(DIRTY_LAYOUT);
+	}
+
 	size_t Text::char_at(const vec2& pos) const
 	{
 		const char* start = m_text.c_str();
@@ -184,7 +447,7 @@ namespace two
 			{
 				for(const TextGlyph& glyph : row.m_glyphs)
 					if(pos.x < glyph.m_rect.x + glyph.m_rect.width * 0.5f) // pos.x >= glyph.m_rect.x &&
-						return glyph.m_position - start;
+						return glyph.m_index;
 
 				return row.m_end - start;
 			}
@@ -221,8 +484,7 @@ namespace two
 
 		if(index != row.m_end_index)
 		{
-			size_t offset = row.m_start - m_text.c_str();
-			return row.m_glyphs[index - offset].m_rect;
+			return row.m_glyphs[index - row.m_start_index].m_rect;
 		}
 		else
 		{
@@ -8,6 +8,7 @@
 #include <climits>
 #include <stl/string.h>
 #include <stl/vector.h>
+#include <stl/span.h>
 #include <math/Vec.h>
 #endif
 #include <ui/Forward.h>
@@ -18,7 +19,7 @@ namespace two
 {
 	export_ struct TWO_UI_EXPORT TextGlyph
 	{
-		const char* m_position;
+		size_t m_index;		// byte offset in the text, stays valid when the string reallocates
 		vec4 m_rect;
 	};
 
@@ -30,14 +31,18 @@ namespace two
 		size_t m_end_index;
 		vec4 m_rect;
 
-		vector<TextGlyph> m_glyphs;
+		// glyphs live in one flat buffer per text, m_glyphs views the range starting at m_first_glyph
+		size_t m_first_glyph;
+		span<TextGlyph> m_glyphs;
 	};
 
 	inline TextRow text_row(const char* str, const char* start, const char* end, const vec4& rect)
 	{
-		return { start, end, size_t(start - str), size_t(end - str), rect, {} };
+		return { start, end, size_t(start - str), size_t(end - str), rect, 0, {} };
 	}
 
+	TWO_UI_EXPORT void bind_glyphs(span<TextRow> rows, vector<TextGlyph>& glyphs);
+
 	TWO_UI_EXPORT bool is_separator(char c);
 
 	TWO_UI_EXPORT size_t word_begin(const string& text, size_t index);
@@ -109,6 +114,7 @@ namespace two
 		vec2 compute_text_size();
 
 		void break_text_rows();
+		void break_text_rows(size_t start, size_t erased, size_t inserted);
 
 		vec4 interval_rect(const TextRow& row, size_t start, size_t end) const;
 		vec4 interval_rect(size_t start, size_t end) const;
@@ -146,6 +152,7 @@ namespace two
 		size_t m_num_lines;
 
 		vector<TextRow> m_text_rows;
+		vector<TextGlyph> m_glyphs;
 
 		TextPaint m_text_paint;
 
@@ -160,10 +167,21 @@ namespace two
 
 		vector<TextMarker> m_markers;
 
+		float d_break_width = 0.f;
+
 	public:
 		static Vg* s_vg;
 	};
 
+	struct TextLayoutStats
+	{
+		size_t m_hits = 0;
+		size_t m_misses = 0;
+		size_t m_partial = 0;
+	};
+
+	TWO_UI_EXPORT TextLayoutStats& text_layout_stats();
+
 	TWO_UI_EXPORT Colour palette_colour(const ColourPalette& palette, PaletteIndex color_index);
 	TWO_UI_EXPORT Paint palette_paint(const ColourPalette& palette, PaletteIndex color_index);
 	TWO_UI_EXPORT TextPaint palette_text_paint(const Text& text, const ColourPalette& palette, PaletteIndex color_index);
@@ -37,9 +37,10 @@ namespace two
 		, d_widget(widget)
 		, d_parent(parent)
 	{
+		// the new frame is itself force dirty, its siblings are only repositioned
 		if(parent)
 		{
-			parent->mark_dirty(DIRTY_FORCE_LAYOUT);
+			parent->mark_dirty(DIRTY_LAYOUT);
 			//d_index[d_parent->d_length] = d_widget.d_index;
 		}
 	}
@@ -48,7 +49,7 @@ namespace two
 	{
 		if(d_parent)
 		{
-			d_parent->mark_dirty(DIRTY_FORCE_LAYOUT);
+			d_parent->mark_dirty(DIRTY_LAYOUT);
 			d_parent = nullptr;
 		}
 	}
@@ -105,6 +106,8 @@ namespace two
 	void Frame::mark_dirty(DirtyLayout dirty)
 	{
 		this->set_dirty(dirty);
+		if(dirty >= DIRTY_REDRAW)
+			d_damaged = true;
 		if(dirty == DIRTY_FORCE_LAYOUT)
 			dirty = DIRTY_LAYOUT;
 		Frame* parent = this->d_parent;
@@ -193,6 +196,9 @@ namespace two
 	void Frame::set_position(Axis dim, float position)
 	{
 		if(m_position[dim] == position) return;
+		// the rect the frame is moving away from is damaged too
+		if(m_layer || d_parent)
+			this->layer().damage(this->absolute_rect());
 		m_position[dim] = position;
 		this->mark_dirty(DIRTY_REDRAW);
 	}
@@ -211,6 +217,11 @@ namespace two
 		d_parent->derive_position(root, local);
 	}
 
+	vec4 Frame::absolute_rect()
+	{
+		return vec4(this->absolute_position(), m_size * this->absolute_scale());
+	}
+
 	float Frame::derive_scale(Frame& root)
 	{
 		if(this == &root)
@@ -274,19 +285,30 @@ namespace two
 		this->mark_dirty(DIRTY_FORCE_LAYOUT);
 	}
 
-	void Frame::relayout()
+	size_t Frame::relayout()
 	{
-		const DirtyLayout dirty = this->clearDirty();
-		if(!dirty) return;
+		// frames solved from their cached content that end up with a new size mark their subtree dirty when read
+		// so we iterate until the layout is stable, which takes a second pass at most in the usual case
+		static const size_t max_passes = 4;
 
+		size_t solved = 0;
 		SolverVector solvers;
-		for(auto& widget : d_widget.m_nodes)
-			collect_solvers(widget->m_frame, solvers, dirty);
+		for(size_t pass = 0; pass < max_passes; ++pass)
+		{
+			const DirtyLayout dirty = this->clearDirty();
+			if(!dirty) break;
+
+			solvers.clear();
+			for(auto& widget : d_widget.m_nodes)
+				collect_solvers(widget->m_frame, solvers, dirty);
 
-		m_solver->reset();
-		m_solver->m_size = m_size;
+			m_solver->reset();
+			m_solver->m_size = m_size;
 
-		two::relayout(solvers);
+			solved += two::relayout(solvers);
+		}
+
+		return solved;
 	}
 
 	void Frame::sync_solver(FrameSolver& solver)
@@ -297,10 +319,7 @@ namespace two
 		solver.setup(m_position, m_size, m_span, !empty() ? &content : nullptr);
 
 		if(d_dirty == DIRTY_PARENT)
-		{
-			// @bug this causes a bug in the relayout if we want to implement scarce behavior for wrap frames, since here the content is instead just the unpadded size
-			solver.d_content = m_size - rect_sum(solver.d_layout->m_padding);
-		}
+			solver.d_content = d_measured;
 	}
 
 	void fix_position(Frame& frame, Axis dim, FrameSolver* solver)
@@ -317,8 +336,13 @@ namespace two
 	void Frame::read_solver(FrameSolver& solver)
 	{
 		this->set_position(solver.m_position);
-		this->set_size(solver.m_size);
+		// the children of a frame solved with its subtree were already laid out with its new size
+		if(solver.d_subtree)
+			m_size = solver.m_size;
+		else
+			this->set_size(solver.m_size);
 		m_span = solver.m_span;
+		d_measured = solver.d_content;
 
 		fix_position(*this, Axis::X, &solver);
 		fix_position(*this, Axis::Y, &solver);
@@ -72,6 +72,7 @@ namespace two
 		inline vec2 derive_position(const vec2& pos, Frame& root) { vec2 local = pos; derive_position(root, local); return local; }
 		inline vec2 derive_position(const vec2& pos) { return derive_position(pos, root()); }
 		inline vec2 absolute_position() { return derive_position({ 0.f, 0.f }); }
+		vec4 absolute_rect();
 
 		float derive_scale(Frame& root);
 		inline float absolute_scale() { return this->derive_scale(root()); }
@@ -88,7 +89,7 @@ namespace two
 
 		void transfer_pixel_span(Frame& prev, Frame& next, Axis dim, float pixelSpan);
 
-		void relayout();
+		size_t relayout();
 
 		void sync_solver(FrameSolver& solver);
 		void read_solver(FrameSolver& solver);
@@ -99,7 +100,9 @@ namespace two
 		Widget& d_widget;
 		Frame* d_parent;
 		DirtyLayout d_dirty = DIRTY_FORCE_LAYOUT;
+		bool d_damaged = true;
 		v2<uint> d_index = { 0, 0 };
+		vec2 d_measured = { 0.f, 0.f };
 
 		Opacity m_opacity = Opacity::Clear;
 
@@ -0,0 +1,132 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#ifdef TWO_MODULES
+module;
+#include <infra/Cpp20.h>
+module two.ui;
+#else
+#include <stl/vector.hpp>
+#include <stl/math.h>
+#include <infra/Reverse.h>
+#include <math/Vec.hpp>
+#include <ui/Frame/HitIndex.h>
+#include <ui/Frame/Frame.h>
+#include <ui/Frame/Layer.h>
+#include <ui/Style/Layout.h>
+#include <ui/WidgetStruct.h>
+#endif
+
+namespace two
+{
+	inline vec4 rect_intersect(const vec4& a, const vec4& b)
+	{
+		const vec2 lo = max(a.pos, b.pos);
+		const vec2 hi = min(a.pos + a.size, b.pos + b.size);
+		return vec4(lo, hi - lo);
+	}
+
+	void HitIndex::clear()
+	{
+		m_root = nullptr;
+		m_entries.clear();
+		for(vector<uint32_t>& cell : m_cells)
+			cell.clear();
+		m_valid = false;
+	}
+
+	void HitIndex::add(Frame& frame, const vec2& offset, float scale, const vec4& clip)
+	{
+		// same traversal as pinpoint : sublayers first, then children, topmost first, then the frame itself
+		if(!frame.d_style || frame.hollow())
+			return;
+
+		const vec4 rect = vec4(offset, frame.m_size * scale);
+		const vec4 inner = frame.d_layout->m_clipping == Clip::Clip ? rect_intersect(clip, rect) : clip;
+
+		if(frame.m_layer)
+			for(Layer* layer : reverse_adapt(frame.m_layer->d_sublayers))
+			{
+				Frame& sub = layer->m_frame;
+				this->add(sub, sub.absolute_position(), sub.absolute_scale(), inner);
+			}
+
+		for(auto& widget : reverse_adapt(frame.d_widget.m_nodes))
+		{
+			Frame& child = widget->m_frame;
+			// frames with a layer are reached first through the sublayers of their parent layer
+			if(child.m_layer)
+				continue;
+			this->add(child, offset + child.m_position * scale, scale * child.m_scale, inner);
+		}
+
+		const vec4 hit = rect_intersect(inner, rect);
+		if(hit.width >= 0.f && hit.height >= 0.f)
+			m_entries.push_back({ &frame, hit });
+	}
+
+	void HitIndex::build(Frame& root)
+	{
+		this->clear();
+
+		m_root = &root;
+		m_bounds = vec4(vec2(0.f), root.m_size);
+		m_grid = uvec2(max(uint(ceil(m_bounds.width / c_cell_size)), 1U), max(uint(ceil(m_bounds.height / c_cell_size)), 1U));
+		m_cells.resize(m_grid.x * m_grid.y);
+
+		this->add(root, vec2(0.f), 1.f, vec4(vec2(-1e6f), vec2(2e6f)));
+
+		for(uint32_t i = 0; i < uint32_t(m_entries.size()); ++i)
+		{
+			const vec4& rect = m_entries[i].m_rect;
+			const uint x0 = uint(clamp(int(floor(rect.x / c_cell_size)), 0, int(m_grid.x) - 1));
+			const uint y0 = uint(clamp(int(floor(rect.y / c_cell_size)), 0, int(m_grid.y) - 1));
+			const uint x1 = uint(clamp(int(floor((rect.x + rect.width) / c_cell_size)), 0, int(m_grid.x) - 1));
+			const uint y1 = uint(clamp(int(floor((rect.y + rect.height) / c_cell_size)), 0, int(m_grid.y) - 1));
+			for(uint y = y0; y <= y1; ++y)
+				for(uint x = x0; x <= x1; ++x)
+					m_cells[y * m_grid.x + x].push_back(i);
+		}
+
+		m_valid = true;
+	}
+
+	inline bool inside(const vec4& rect, const vec2& pos)
+	{
+		return pos.x >= rect.x && pos.x <= rect.x + rect.width
+			&& pos.y >= rect.y && pos.y <= rect.y + rect.height;
+	}
+
+	inline bool descends(Frame* frame, Frame& root)
+	{
+		for(; frame; frame = frame->d_parent)
+			if(frame == &root)
+				return true;
+		return false;
+	}
+
+	bool HitIndex::pinpoint(Frame& frame, vec2 pos, const FrameFilter& filter, Frame*& result) const
+	{
+		result = nullptr;
+		if(!m_valid || !inside(m_bounds, pos))
+			return false;
+		if(!frame.d_style || frame.hollow())
+			return true;
+
+		const uint x = min(uint(pos.x / c_cell_size), m_grid.x - 1);
+		const uint y = min(uint(pos.y / c_cell_size), m_grid.y - 1);
+
+		const bool subtree = &frame != m_root;
+		for(uint32_t index : m_cells[y * m_grid.x + x])
+		{
+			const HitEntry& entry = m_entries[index];
+			if(inside(entry.m_rect, pos) && filter(*entry.m_frame) && (!subtree || descends(entry.m_frame, frame)))
+			{
+				result = entry.m_frame;
+				return true;
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,52 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#pragma once
+
+#ifndef TWO_MODULES
+#include <stl/vector.h>
+#include <math/Vec.h>
+#endif
+#include <ui/Forward.h>
+#include <ui/WidgetStruct.h>
+
+namespace two
+{
+	// absolute hit rect of a frame, in the order the frames are tested by pinpoint
+	struct HitEntry
+	{
+		Frame* m_frame;
+		vec4 m_rect;
+	};
+
+	// frames binned in a uniform grid of absolute cells, built from the layout of the last frame
+	// a pointer query tests the few frames of its cell, front to back, instead of descending the whole tree
+	export_ class TWO_UI_EXPORT HitIndex
+	{
+	public:
+		void build(Frame& root);
+		void clear();
+
+		bool valid() const { return m_valid; }
+
+		// topmost frame under the absolute position pos that passes the filter, restricted to the subtree of frame
+		// returns false if the index can't answer, in which case the tree must be walked
+		bool pinpoint(Frame& frame, vec2 pos, const FrameFilter& filter, Frame*& result) const;
+
+		vector<HitEntry> m_entries;
+
+		// entry indices of each cell, in pinpoint order
+		vector<vector<uint32_t>> m_cells;
+		vec4 m_bounds = vec4(0.f);
+		uvec2 m_grid = uvec2(0U);
+
+		static constexpr float c_cell_size = 64.f;
+
+	private:
+		void add(Frame& frame, const vec2& offset, float scale, const vec4& clip);
+
+		Frame* m_root = nullptr;
+		bool m_valid = false;
+	};
+}
@@ -8,11 +8,14 @@ module;
 module two.ui;
 #else
 #include <stl/algorithm.h>
+#include <stl/vector.hpp>
+#include <math/Vec.hpp>
 #include <infra/Reverse.h>
 #include <infra/Sort.h>
 #include <ui/Frame/Layer.h>
 #include <ui/Sheet.h>
 #include <ui/Style/Layout.h>
+#include <ui/UiRenderer.h>
 #endif
 
 #include <algorithm>
@@ -31,6 +34,47 @@ namespace two
 	{
 		if(d_parentLayer)
 			d_parentLayer->removeLayer(*this);
+		if(d_handle != SIZE_MAX && Frame::s_vg)
+			Frame::s_vg->release_layer(*this);
+	}
+
+	void Layer::damage(const vec4& rect)
+	{
+		static const size_t max_rects = 8;
+
+		if(rect.width <= 0.f || rect.height <= 0.f)
+			return;
+
+		auto merge = [](const vec4& a, const vec4& b)
+		{
+			const vec2 lo = min(vec2(a.x, a.y), vec2(b.x, b.y));
+			const vec2 hi = max(vec2(a.x + a.width, a.y + a.height), vec2(b.x + b.width, b.y + b.height));
+			return vec4(lo, hi - lo);
+		};
+
+		// overlapping rects are merged until the set is disjoint again
+		vec4 merged = rect;
+		for(size_t i = 0; i < d_damage.size();)
+			if(rect_intersects(d_damage[i], merged))
+			{
+				merged = merge(d_damage[i], merged);
+				d_damage[i] = d_damage.back();
+				d_damage.pop_back();
+				i = 0;
+			}
+			else
+				++i;
+
+		d_damage.push_back(merged);
+
+		// past a handful of rects, tracking them costs more than the area they save
+		if(d_damage.size() > max_rects)
+		{
+			vec4 bounds = d_damage[0];
+			for(const vec4& r : d_damage)
+				bounds = merge(bounds, r);
+			d_damage = { bounds };
+		}
 	}
 
 	size_t Layer::z() const
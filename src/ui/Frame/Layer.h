@@ -32,7 +32,11 @@ namespace two
 		void setRedraw() { if(d_redraw < REDRAW) d_redraw = REDRAW; }
 		void setForceRedraw() { d_redraw = FORCE_REDRAW; }
 
-		void endRedraw() { d_redraw = NO_REDRAW; }
+		void endRedraw() { d_redraw = NO_REDRAW; d_damage.clear(); }
+
+		// accumulates an absolute rect that changed since the layer was last recorded
+		void damage(const vec4& rect);
+		bool damaged() const { return !d_damage.empty(); }
 
 		void addLayer(Layer& layer);
 		void removeLayer(Layer& layer);
@@ -59,6 +63,10 @@ namespace two
 		Redraw d_redraw = REDRAW;
 		size_t d_handle = SIZE_MAX;
 
+		// absolute bounds of the frame when the layer was last recorded
+		vec4 d_bounds = vec4(0.f);
+		vector<vec4> d_damage;
+
 		vector<Layer*> d_sublayers;
 	};
 }
@@ -23,13 +23,21 @@ module two.ui;
 
 namespace two
 {
+	bool partial_layout(Frame& frame)
+	{
+		// a frame laid out directly by its parent solver only needs its cached content size when the parent changes
+		// frames bound to grid lines or table columns are measured together with their siblings, so they are always solved
+		FrameSolver& parent = *frame.d_parent->m_solver;
+		FrameSolver& solver = *frame.m_solver;
+		return !parent.grid() && solver.m_solvers[Axis::X] == &parent && solver.m_solvers[Axis::Y] == &parent;
+	}
+
 	void collect_solvers(Frame& frame, SolverVector& solvers, DirtyLayout dirtyTop)
 	{
 		if(dirtyTop >= DIRTY_FORCE_LAYOUT)
 			frame.set_dirty(DIRTY_FORCE_LAYOUT);
 		else if(dirtyTop >= DIRTY_LAYOUT)
-			//frame.set_dirty(DIRTY_PARENT);
-			frame.set_dirty(DIRTY_LAYOUT); // @kludge because relayout with DIRTY_PARENT isn't always correct due to size / content issue
+			frame.set_dirty(partial_layout(frame) ? DIRTY_PARENT : DIRTY_LAYOUT);
 
 		if(!frame.d_dirty)
 			return;
@@ -37,15 +45,23 @@ namespace two
 		//this->debugPrintDepth();
 		//printf(" >> %s %s\n", d_style->m_name.c_str(), to_string(d_dirty).c_str());
 
-		if(frame.d_dirty >= DIRTY_PARENT)
+		if(frame.d_dirty == DIRTY_PARENT)
+		{
+			// the subtree is not solved : grid lines and columns are only measured from the frames bound to them
+			frame.m_solver->FrameSolver::collect(solvers);
+		}
+		else if(frame.d_dirty >= DIRTY_PARENT)
 		{
 			frame.m_solver->collect(solvers);
 		}
 
-		if(frame.d_dirty >= DIRTY_REDRAW)
+		frame.m_solver->d_subtree = frame.d_dirty >= DIRTY_LAYOUT;
+
+		// only the frames that changed damage their layer, their ancestors are dirty just to be traversed
+		if(frame.d_damaged)
 		{
-			frame.layer().setRedraw();
-			frame.layer().setForceRedraw(); // @ kludge for nodes in canvas when moving the canvas window
+			frame.layer().damage(frame.absolute_rect());
+			frame.d_damaged = false;
 		}
 
 		for(auto& widget : frame.d_widget.m_nodes)
@@ -54,7 +70,7 @@ namespace two
 		frame.clearDirty();
 	}
 
-	void relayout(SolverVector& solvers)
+	size_t relayout(SolverVector& solvers)
 	{
 		//for(FrameSolver* solver : solvers)
 		//	solver->sync();
@@ -65,8 +81,13 @@ namespace two
 		for(FrameSolver* solver : solvers)
 			solver->layout();
 
+		size_t solved = 0;
 		for(FrameSolver* solver : solvers)
+		{
 			solver->read();
+			solved += solver->d_frame ? 1 : 0;
+		}
+		return solved;
 	}
 
 	Space Space::preset(Preset preset)
@@ -16,7 +16,7 @@ namespace two
 	using SolverVector = vector<FrameSolver*>;
 
 	void collect_solvers(Frame& frame, SolverVector& solvers, DirtyLayout dirtyTop);
-	void relayout(SolverVector& solvers);
+	size_t relayout(SolverVector& solvers);
 
 	export_ class refl_ TWO_UI_EXPORT FrameSolver : public UiRect
 	{
@@ -109,6 +109,8 @@ namespace two
 
 		FrameSolver* d_prev = nullptr;
 		size_t d_count = 0;
+
+		bool d_subtree = false;
 	};
 
 	export_ class refl_ TWO_UI_EXPORT RowSolver : public FrameSolver
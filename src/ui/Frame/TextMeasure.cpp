@@ -0,0 +1,235 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#include <infra/Cpp20.h>
+
+// the fonts are only measured here, the renderers that rasterize glyphs compile their own copy
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <stb_truetype.h>
+
+#ifdef TWO_MODULES
+module two.ui;
+#else
+#include <stl/vector.hpp>
+#include <infra/File.h>
+#include <infra/Log.h>
+#include <math/Vec.hpp>
+#include <ui/Style/Paint.h>
+#include <ui/Frame/Caption.h>
+#include <ui/Frame/TextMeasure.h>
+#include <ui/UiRenderer.h>
+#endif
+
+namespace two
+{
+	uint32_t decode_utf8(const char*& iter, const char* end)
+	{
+		const uint8_t c = uint8_t(*iter++);
+		if(c < 0x80)
+			return c;
+
+		const uint32_t count = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+		uint32_t codepoint = c & (0x3F >> count);
+		for(uint32_t i = 0; i < count && iter < end && (uint8_t(*iter) & 0xC0) == 0x80; ++i)
+			codepoint = (codepoint << 6) | (uint8_t(*iter++) & 0x3F);
+		return codepoint;
+	}
+
+	float align_offset(const TextPaint& paint, float width)
+	{
+		if(paint.m_align.x == Align::Center)
+			return -width * 0.5f;
+		else if(paint.m_align.x == Align::Right)
+			return -width;
+		return 0.f;
+	}
+
+	struct FontInfo
+	{
+		stbtt_fontinfo m_info;
+	};
+
+	MeasuredFont::MeasuredFont()
+	{}
+
+	MeasuredFont::~MeasuredFont()
+	{}
+
+	TextMeasure::TextMeasure(Vg& vg)
+		: m_vg(vg)
+	{}
+
+	TextMeasure::~TextMeasure()
+	{}
+
+	MeasuredFont& TextMeasure::font(cstring name)
+	{
+		for(auto& font : m_fonts)
+			if(font->m_name == name)
+				return font->m_fallback ? *font->m_fallback : *font;
+
+		unique<MeasuredFont> font = make_unique<MeasuredFont>();
+		font->m_name = name;
+		font->m_data = read_binary_file(m_vg.font_path(name));
+		font->m_info = make_unique<FontInfo>();
+
+		const unsigned char* data = font->m_data.data();
+		font->m_loaded = !font->m_data.empty() && stbtt_InitFont(&font->m_info->m_info, data, stbtt_GetFontOffsetForIndex(data, 0));
+		if(font->m_loaded)
+		{
+			int ascent, descent, gap;
+			stbtt_GetFontVMetrics(&font->m_info->m_info, &ascent, &descent, &gap);
+			font->m_ascent = float(ascent);
+			font->m_descent = float(descent);
+			font->m_gap = float(gap);
+			font->m_em = float(ascent - descent);
+		}
+		else
+		{
+			warn("ui: could not load font %s", name);
+			if(!m_fonts.empty() && m_fonts[0]->m_loaded)
+				font->m_fallback = m_fonts[0].get();
+		}
+
+		for(uint32_t c = 0; c < 128; ++c)
+		{
+			int advance = 0, bearing = 0;
+			if(font->m_loaded)
+				stbtt_GetCodepointHMetrics(&font->m_info->m_info, int(c), &advance, &bearing);
+			font->m_ascii[c] = font->m_loaded ? float(advance) : 0.5f;
+		}
+
+		m_fonts.push_back(move(font));
+		MeasuredFont& loaded = *m_fonts.back();
+		return loaded.m_fallback ? *loaded.m_fallback : loaded;
+	}
+
+	float TextMeasure::advance(MeasuredFont& font, uint32_t codepoint, uint32_t previous, float size)
+	{
+		float advance = 0.f;
+		if(codepoint < 128)
+			advance = font.m_ascii[codepoint];
+		else if(font.m_loaded)
+		{
+			int units = 0, bearing = 0;
+			stbtt_GetCodepointHMetrics(&font.m_info->m_info, int(codepoint), &units, &bearing);
+			advance = float(units);
+		}
+		else
+			advance = 0.5f;
+
+		if(previous && font.m_loaded)
+			advance += float(stbtt_GetCodepointKernAdvance(&font.m_info->m_info, int(previous), int(codepoint)));
+		return advance * font.scale(size);
+	}
+
+	float TextMeasure::text_width(MeasuredFont& font, const char* first, const char* end, float size)
+	{
+		float width = 0.f;
+		uint32_t previous = 0;
+		for(const char* iter = first; iter < end;)
+		{
+			const uint32_t codepoint = decode_utf8(iter, end);
+			width += this->advance(font, codepoint, previous, size);
+			previous = codepoint;
+		}
+		return width;
+	}
+
+	void TextMeasure::break_next_row(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row)
+	{
+		MeasuredFont& font = this->font(paint.m_font);
+		const float line_height = font.line_height(paint.m_size);
+
+		// the row breaks at the last space that fits, or in the middle of a word longer than the row
+		float x = 0.f;
+		const char* space = nullptr;
+		float space_x = 0.f;
+		uint32_t previous = 0;
+
+		const char* iter = first;
+		while(iter < end && *iter != '\n')
+		{
+			const char* at = iter;
+			const uint32_t codepoint = decode_utf8(iter, end);
+			const float advance = this->advance(font, codepoint, previous, paint.m_size);
+			previous = codepoint;
+
+			if(x + advance > rect.width && at > first && codepoint != ' ')
+			{
+				const char* row_end = space ? space : at;
+				row = text_row(text, first, row_end, { rect.x, rect.y, space ? space_x : x, line_height });
+				return;
+			}
+
+			if(codepoint == ' ' || codepoint == '\t')
+			{
+				space = at;
+				space_x = x;
+			}
+			x += advance;
+		}
+
+		row = text_row(text, first, iter, { rect.x, rect.y, x, line_height });
+	}
+
+	void TextMeasure::break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& row, vector<TextGlyph>& glyphs)
+	{
+		MeasuredFont& font = this->font(paint.m_font);
+
+		const size_t first = glyphs.size();
+		glyphs.resize(first + (row.m_end - row.m_start));
+
+		// one glyph per byte, as carets index bytes : continuation bytes are empty glyphs at the end of their character
+		float x = rect.x + align_offset(paint, this->text_width(font, row.m_start, row.m_end, paint.m_size));
+		uint32_t previous = 0;
+		for(const char* iter = row.m_start; iter < row.m_end;)
+		{
+			const char* at = iter;
+			const uint32_t codepoint = decode_utf8(iter, row.m_end);
+			const float advance = this->advance(font, codepoint, previous, paint.m_size);
+			previous = codepoint;
+
+			for(const char* byte = at; byte < iter; ++byte)
+			{
+				TextGlyph& text_glyph = glyphs[first + (byte - row.m_start)];
+				text_glyph.m_index = row.m_start_index + size_t(byte - row.m_start);
+				text_glyph.m_rect = byte == at ? vec4(x, row.m_rect.y, advance, row.m_rect.height) : vec4(x + advance, row.m_rect.y, 0.f, row.m_rect.height);
+			}
+			x += advance;
+		}
+	}
+
+	float TextMeasure::line_height(const TextPaint& paint)
+	{
+		return this->font(paint.m_font).line_height(paint.m_size);
+	}
+
+	vec2 TextMeasure::text_size(cstring text, size_t len, const TextPaint& paint)
+	{
+		MeasuredFont& font = this->font(paint.m_font);
+		const char* end = text + len;
+
+		float width = 0.f;
+		size_t lines = 0;
+		const char* line = text;
+		do
+		{
+			const char* line_end = line;
+			if(paint.m_text_break)
+				while(line_end < end && *line_end != '\n')
+					++line_end;
+			else
+				line_end = end;
+
+			width = max(width, this->text_width(font, line, line_end, paint.m_size));
+			lines++;
+			line = line_end + 1;
+		}
+		while(line <= end && paint.m_text_break);
+
+		return vec2(width, float(lines) * font.line_height(paint.m_size));
+	}
+}
@@ -0,0 +1,75 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#pragma once
+
+#ifndef TWO_MODULES
+#include <stdint.h>
+#include <stl/string.h>
+#include <stl/vector.h>
+#include <stl/memory.h>
+#include <math/Vec.h>
+#endif
+#include <ui/Forward.h>
+#include <ui/Frame/Caption.h>
+
+namespace two
+{
+	export_ TWO_UI_EXPORT uint32_t decode_utf8(const char*& iter, const char* end);
+
+	// horizontal offset of a line of the given width, relative to the anchor of its alignment
+	export_ TWO_UI_EXPORT float align_offset(const TextPaint& paint, float width);
+
+	struct FontInfo;
+
+	// a font measured from its file, all metrics in font units : the data is kept for the backends that rasterize glyphs from it
+	export_ struct TWO_UI_EXPORT MeasuredFont
+	{
+		MeasuredFont();
+		~MeasuredFont();
+
+		string m_name;
+		vector<uint8_t> m_data;
+		unique<FontInfo> m_info;
+
+		// a font file that can't be read is measured as a monospace font, so that layouts still run without the data folder
+		bool m_loaded = false;
+
+		float m_ascent = 0.8f;
+		float m_descent = -0.2f;
+		float m_gap = 0.2f;
+		float m_em = 1.f;
+
+		float m_ascii[128];
+
+		// a font that fails to load is measured with the first font loaded, when there is one
+		MeasuredFont* m_fallback = nullptr;
+
+		float scale(float size) const { return size / m_em; }
+		float line_height(float size) const { return (m_ascent - m_descent + m_gap) * scale(size); }
+	};
+
+	// text layout from the font files : the renderers forward their measuring to it so that they break and size text the same
+	export_ class TWO_UI_EXPORT TextMeasure
+	{
+	public:
+		TextMeasure(Vg& vg);
+		~TextMeasure();
+
+		MeasuredFont& font(cstring name);
+
+		// advance of the codepoint, kerned against the previous one, in pixels
+		float advance(MeasuredFont& font, uint32_t codepoint, uint32_t previous, float size);
+		float text_width(MeasuredFont& font, const char* first, const char* end, float size);
+
+		void break_next_row(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row);
+		void break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& row, vector<TextGlyph>& glyphs);
+
+		float line_height(const TextPaint& paint);
+		vec2 text_size(cstring text, size_t len, const TextPaint& paint);
+
+		Vg& m_vg;
+		vector<unique<MeasuredFont>> m_fonts;
+	};
+}
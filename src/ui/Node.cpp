@@ -108,8 +108,10 @@ namespace ui
 	Widget& canvas_cable(Widget& parent, NodeKnob& out, NodeKnob& in, bool straight = false)
 	{
 		Widget& self = widget(parent, node_styles().cable);
-		self.m_frame.m_position = min(out.m_end, in.m_end);
-		self.m_frame.m_size = max(out.m_end, in.m_end) - self.m_frame.m_position;
+		// the cable follows its knobs : moving it through the frame damages its layer
+		const vec2 position = min(out.m_end, in.m_end);
+		self.m_frame.set_position(position);
+		self.m_frame.set_size(max(out.m_end, in.m_end) - position);
 		self.m_custom_draw = [&, straight](const Frame& frame, const vec4& rect, Vg& vg)
 		{
 			UNUSED(rect); draw_node_cable(out.m_end - frame.m_position, in.m_end - frame.m_position, out.m_colour, in.m_colour, straight, vg);
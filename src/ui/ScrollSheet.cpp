@@ -146,12 +146,12 @@ namespace ui
 		offset = offset - remainder;
 
 		for(Widget* widget : elements)
-			widget->m_frame.m_position += offset;
+			widget->m_frame.set_position(widget->m_frame.m_position + offset);
 
-		scroll_plan.m_position += -offset * scroll_plan.m_scale;
+		scroll_plan.set_position(scroll_plan.m_position - offset * scroll_plan.m_scale);
 
 		const vec2 bounds = bounds_max + 2.f * margin - bounds_min;
-		scroll_plan.m_size = bounds;
+		scroll_plan.set_size(bounds);
 	}
 
 	Widget& scrollable(Widget& parent)
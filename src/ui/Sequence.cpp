@@ -8,12 +8,19 @@ module;
 module two.ui;
 #else
 #include <stl/algorithm.h>
+#include <stl/math.h>
+#include <math/Vec.hpp>
 #include <tree/Graph.hpp>
 #include <ui/Sequence.h>
 #include <ui/WidgetStruct.h>
 #include <ui/UiRoot.h>
 #include <ui/ContainerStruct.h>
 #include <ui/ScrollSheet.h>
+#include <ui/Container.h>
+#include <ui/Button.h>
+#include <ui/Sheet.h>
+#include <ui/Frame/Frame.h>
+#include <ui/Style/Layout.h>
 #endif
 
 namespace two
@@ -92,5 +99,106 @@ namespace ui
 	{
 		return element(sequence.m_body ? *sequence.m_body : sequence, object, *sequence.m_selection);
 	}
+
+	// visible span of a frame along an axis in its own coordinates, as clipped by all its clipping parents
+	vec2 visible_span(Frame& frame, Axis dim)
+	{
+		float lo = 0.f;
+		float hi = frame.m_size[dim];
+		float offset = 0.f;
+		float scale = 1.f;
+
+		for(Frame* current = &frame; current->d_parent; current = current->d_parent)
+		{
+			offset = current->m_position[dim] + offset * current->m_scale;
+			scale *= current->m_scale;
+
+			Frame& parent = *current->d_parent;
+			if(parent.d_layout && parent.d_layout->m_clipping == Clip::Clip)
+			{
+				lo = max(lo, -offset / scale);
+				hi = min(hi, (parent.m_size[dim] - offset) / scale);
+			}
+		}
+
+		return { lo, max(lo, hi) };
+	}
+
+	void virtual_begin(VirtualSequence& self, Widget& container)
+	{
+		// where the row 0 was laid out in the container in the previous frame
+		const float origin = self.m_body ? self.m_body->m_frame.m_position.y - float(self.m_first) * self.m_pitch : 0.f;
+
+		// the pitch is measured on the rows laid out in the previous frame, the row height is only an initial estimate
+		const float spacing = self.m_body && self.m_body->m_frame.d_layout ? self.m_body->m_frame.d_layout->m_spacing.y : 0.f;
+		const size_t rows = self.m_last - self.m_first;
+		if(self.m_estimated && self.m_body && rows > 0 && self.m_body->m_frame.m_size.y > 0.f)
+			self.m_pitch = (self.m_body->m_frame.m_size.y + spacing) / float(rows);
+		else if(!self.m_estimated || self.m_pitch == 0.f)
+			self.m_pitch = self.m_row_height + spacing;
+
+		const float pitch = max(self.m_pitch, 1.f);
+		const vec2 span = visible_span(container.m_frame, Axis::Y);
+
+		const float first = floor((span.x - origin) / pitch) - float(self.m_overscan);
+		const float last = ceil((span.y - origin) / pitch) + float(self.m_overscan);
+
+		self.m_first = size_t(max(0.f, min(first, float(self.m_count))));
+		self.m_last = max(self.m_first, size_t(max(0.f, min(last, float(self.m_count)))));
+
+		dummy(container, vec2(0.f, float(self.m_first) * self.m_pitch));
+	}
+
+	void virtual_end(VirtualSequence& self, Widget& container)
+	{
+		dummy(container, vec2(0.f, float(self.m_count - self.m_last) * self.m_pitch));
+	}
+
+	VirtualSequence& virtual_setup(Widget& parent, size_t count, float row_height, bool estimated, size_t overscan)
+	{
+		VirtualSequence& self = twidget<VirtualSequence>(parent, styles().virtual_sequence);
+		self.m_count = count;
+		self.m_row_height = row_height;
+		self.m_estimated = estimated;
+		self.m_overscan = overscan;
+		return self;
+	}
+
+	VirtualSequence& virtual_sequence(Widget& parent, size_t count, float row_height, bool estimated, size_t overscan)
+	{
+		VirtualSequence& self = virtual_setup(parent, count, row_height, estimated, overscan);
+		virtual_begin(self, self);
+		self.m_body = &widget(self, styles().sequence);
+		virtual_end(self, self);
+		return self;
+	}
+
+	VirtualSequence& scroll_virtual_sequence(Widget& parent, size_t count, float row_height, bool estimated, size_t overscan)
+	{
+		VirtualSequence& self = virtual_setup(parent, count, row_height, estimated, overscan);
+		Widget& container = *scroll_sheet(self).m_body;
+		virtual_begin(self, container);
+		self.m_body = &widget(container, styles().sequence);
+		virtual_end(self, container);
+		return self;
+	}
+
+	VirtualSequence& virtual_table(Widget& parent, span<cstring> columns, span<float> weights, size_t count, float row_height, bool estimated, size_t overscan)
+	{
+		VirtualSequence& self = virtual_setup(parent, count, row_height, estimated, overscan);
+		// the header stays out of the scrolled area, the rows get their own table with the same weights
+		Table& header = table(self, columns, weights);
+		Widget& container = *scroll_sheet(self).m_body;
+		virtual_begin(self, container);
+		self.m_body = &ui::columns(container, header.m_weights);
+		virtual_end(self, container);
+		return self;
+	}
+
+	Widget& virtual_table_row(VirtualSequence& parent, size_t index)
+	{
+		bool odd = index % 2 == 1;
+		return button(*parent.m_body, odd ? table_styles().row_odd : table_styles().row_even);
+	}
 }
 }
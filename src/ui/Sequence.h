@@ -6,6 +6,7 @@
 
 #ifndef TWO_MODULES
 #include <stl/vector.h>
+#include <stl/span.h>
 #include <type/Ref.h>
 #endif
 #include <ui/Forward.h>
@@ -24,5 +25,13 @@ namespace ui
 	export_ TWO_UI_EXPORT Widget& element(Widget& parent, Ref object, vector<Ref>& selection);
 
 	export_ TWO_UI_EXPORT func_ Widget& sequence_element(Sequence& parent, Ref object);
+
+	// virtual sequences only create the rows that intersect the clipping viewport, plus an overscan margin
+	// the caller adds the rows in [m_first, m_last) with sequence_element(), the others are replaced by spacers
+	export_ TWO_UI_EXPORT VirtualSequence& virtual_sequence(Widget& parent, size_t count, float row_height, bool estimated = false, size_t overscan = 4);
+	export_ TWO_UI_EXPORT VirtualSequence& scroll_virtual_sequence(Widget& parent, size_t count, float row_height, bool estimated = false, size_t overscan = 4);
+	export_ TWO_UI_EXPORT VirtualSequence& virtual_table(Widget& parent, span<cstring> columns, span<float> weights, size_t count, float row_height, bool estimated = false, size_t overscan = 4);
+
+	export_ TWO_UI_EXPORT Widget& virtual_table_row(VirtualSequence& parent, size_t index);
 }
 }
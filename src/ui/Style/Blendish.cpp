@@ -385,8 +385,9 @@ namespace two
 			i.m_background_colour = none;
 		});
 
-		for(auto name_style : g_styles)
-			name_style.second->prepare();
+		for(Style* style : g_style_table)
+			if(style)
+				style->prepare();
 	}
 
 	void style_blendish_dark(UiWindow& ui_window)
@@ -423,7 +424,8 @@ namespace two
 			i.m_background_colour = Colour(0.f);
 		});
 
-		for(auto name_style : g_styles)
-			name_style.second->prepare();
+		for(Style* style : g_style_table)
+			if(style)
+				style->prepare();
 	}
 }
@@ -438,9 +438,11 @@ namespace two
 		});
 #endif
 
-		for(auto name_style : g_styles)
+		for(Style* registered : g_style_table)
 		{
-			Style& s = *name_style.second;
+			if(!registered)
+				continue;
+			Style& s = *registered;
 
 			s.m_skin.m_text_font = "proggy";
 			s.m_skin.m_text_size = 13.f;
@@ -52,8 +52,8 @@ namespace two
 	{
 		StyleSelector selector;
 		for(const string& name : styles)
-			if(g_styles.find(name) != g_styles.end())
-				selector.styles.push_back(g_styles[name]);
+			if(Style* style = find_style(style_id(name)))
+				selector.styles.push_back(style);
 			else
 				warn("ui - style %s not found", name.c_str());
 		return selector;
@@ -358,8 +358,9 @@ namespace two
 
 		ui::window_styles().close_button.m_skin.m_image = ui_window.find_image("close_15");
 
-		for(auto name_style : g_styles)
-			name_style.second->prepare();
+		for(Style* style : g_style_table)
+			if(style)
+				style->prepare();
 	}
 
 	void style_minimal(UiWindow& ui_window)
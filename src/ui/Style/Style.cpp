@@ -8,10 +8,12 @@ module;
 module two.ui;
 #else
 #include <stl/algorithm.h>
+#include <stl/vector.hpp>
+#include <stl/unordered_map.hpp>
 #include <infra/StringConvert.h>
-#include <infra/Reverse.h>
 #include <math/Vec.hpp>
 #include <ui/Style/Style.h>
+#include <ui/Style/Styles.h>
 #include <ui/Style/Layout.h>
 #include <ui/Style/Skin.h>
 #include <ui/Widget.h>
@@ -90,10 +92,31 @@ namespace two
 
 	Styles& styles() { static Styles styles; return styles; }
 
+	StyleId style_id(const string& name)
+	{
+		auto it = g_style_ids.find(name);
+		if(it != g_style_ids.end())
+			return it->second;
+		const StyleId id = StyleId(g_style_table.size());
+		g_style_ids[name] = id;
+		g_style_table.push_back(nullptr);
+		return id;
+	}
+
+	Style* find_style(StyleId id)
+	{
+		return id < g_style_table.size() ? g_style_table[id] : nullptr;
+	}
+
 	void register_styles(span<Style*> styles)
 	{
 		for(Style* style : styles)
+		{
+			style->m_id = style_id(style->m_name);
+			g_style_table[style->m_id] = style;
 			g_styles[style->m_name] = style;
+			style->resolve();
+		}
 	}
 
 	Style::Style()
@@ -131,19 +154,39 @@ namespace two
 			subskin.skin.prepare();
 			subskin.skin.m_name = m_name + ":" + to_lower(flags_to_string<WidgetState, 9>(subskin.state));
 		}
+		this->resolve();
+	}
+
+	// pack the seven skinnable state flags : HOVERED, PRESSED, ACTIVE, SELECTED, DISABLED, DRAGGED, FOCUSED
+	inline uint32_t skin_index(uint32_t state) { return ((state >> 1) & 0x03) | ((state >> 2) & 0x7c); }
+	inline uint32_t skin_state(uint32_t index) { return ((index & 0x03) << 1) | ((index & 0x7c) << 2); }
+
+	void Style::resolve()
+	{
+		auto match = [&](uint32_t state) -> uint8_t
+		{
+			for(size_t i = m_skins.size(); i-- > 0;)
+				if(state == m_skins[i].state) // exact match
+					return uint8_t(i);
+			for(size_t i = m_skins.size(); i-- > 0;)
+				if(state & m_skins[i].state) // partial match
+					return uint8_t(i);
+			return UINT8_MAX;
+		};
+
+		for(uint32_t i = 0; i < 128; ++i)
+			m_resolved[i] = match(skin_state(i));
+		m_resolved_skins = m_skins.size();
 	}
 
 	InkStyle& Style::state_skin(WidgetState state)
 	{
-		// turn off non-skinnable state flags
-		state = static_cast<WidgetState>(state & ~(CREATED | ACTIVATED | CLOSED));
-		for(Subskin& subskin : reverse_adapt(m_skins))
-			if(state == subskin.state) // exact match
-				return subskin.skin;
-		for(Subskin& subskin : reverse_adapt(m_skins))
-			if(state & subskin.state) // partial match
-				return subskin.skin;
-		return m_skin;
+		// skins declined since the last resolve invalidate the table
+		if(m_resolved_skins != m_skins.size())
+			this->resolve();
+		// non-skinnable state flags are dropped by the packing
+		const uint8_t index = m_resolved[skin_index(state)];
+		return index == UINT8_MAX ? m_skin : m_skins[index].skin;
 	}
 
 	InkStyle& Style::decline_skin(WidgetState state, bool inherit)
@@ -24,6 +24,12 @@ namespace two
 		attr_ WidgetState state;
 	};
 
+	// interned style name : ids are stable for the lifetime of the program, even when styles are reset
+	using StyleId = uint32_t;
+
+	export_ TWO_UI_EXPORT StyleId style_id(const string& name);
+	export_ TWO_UI_EXPORT Style* find_style(StyleId id);
+
 	export_ TWO_UI_EXPORT void register_styles(span<Style*> styles);
 
 	export_ class refl_ TWO_UI_EXPORT Style
@@ -39,12 +45,23 @@ namespace two
 		InkStyle& state_skin(WidgetState state);
 		InkStyle& decline_skin(WidgetState state, bool inherit = false);
 
+		// precompute the skin matching each combination of skinnable states
+		void resolve();
+
 		attr_ Style* m_base;
 
 		attr_ string m_name;
 		attr_ Layout m_layout;
 		attr_ InkStyle m_skin;
 		attr_ vector<Subskin> m_skins;
+
+		StyleId m_id = 0;
+
+	private:
+		// index in m_skins of the skin resolved for each combination of skinnable states, UINT8_MAX for the base skin
+		// indices stay valid when the style is copied, which pointers would not
+		uint8_t m_resolved[128];
+		size_t m_resolved_skins = SIZE_MAX;
 	};
 
 	struct StyleSelector
@@ -59,6 +76,7 @@ namespace two
 		vector<Style*> styles;
 	};
 
+	// the names are resolved through their interned ids
 	StyleSelector select(span<string> styles);
 
 	export_ TWO_UI_EXPORT func_ void layout_minimal(UiWindow& ui_window);
@@ -7,6 +7,8 @@ module;
 #include <infra/Cpp20.h>
 module two.ui;
 #else
+#include <stl/vector.hpp>
+#include <stl/unordered_map.hpp>
 #include <math/Vec.hpp>
 #include <infra/ToString.h>
 #include <ui/Style/Styles.h>
@@ -33,6 +35,8 @@ namespace two
 	}
 	
 	map<string, Style*> g_styles;
+	map<string, StyleId> g_style_ids;
+	vector<Style*> g_style_table;
 
 	void Styles::reset()
 	{
@@ -70,6 +74,7 @@ namespace two
 		gridsheet = Style("GridSheet", wedge, [](Layout& l) { l.m_opacity = Opacity::Opaque; l.m_spacing = vec2(5.f); });
 
 		sequence = Style("Sequence", wedge, [](Layout& l) { l.m_space = Preset::Sheet; });
+		virtual_sequence = Style("VirtualSequence", sequence, {});
 		element = Style("Element", wedge, [](Layout& l) { l.m_space = Preset::Stack; l.m_opacity = Opacity::Opaque; });
 
 		label = Style("Label", item, [](Layout& l) { l.m_align = { Align::Left, Align::Center }; });
@@ -145,7 +150,7 @@ namespace two
 		register_styles({
 			&widget, &wedge, &ui, &unit, &item, &control, &wrap_control, &spacer, &separator, &filler, &drag_handle,
 			&div, &row, &stack, &sheet, &flex, &list, &header, &board, &layout, &indent,
-			&screen, &decal, &overlay, &gridsheet, &sequence, &element,
+			&screen, &decal, &overlay, &gridsheet, &sequence, &virtual_sequence, &element,
 			&label, &title, &message, &text, &bullet, &button, &wrap_button, &multi_button, &toggle, &checkbox, &checkmark,
 			&dummy, &tooltip, &rectangle, &viewport, &type_in, &text_edit, &type_zone, &caret, &image, &image_stretch,
 			&radio_switch, &radio_switch_h, &radio_choice, &radio_choice_item,
@@ -6,6 +6,7 @@
 
 #include <stl/string.h>
 #include <stl/map.h>
+#include <stl/vector.h>
 #include <ui/Forward.h>
 #include <ui/Style/Style.h>
 
@@ -18,7 +19,7 @@ namespace two
 
 		Style widget; Style wedge; Style ui; Style unit; Style item; Style control; Style wrap_control; Style spacer; Style separator; Style filler; Style drag_handle;
 		Style div; Style row; Style stack; Style sheet; Style flex; Style list; Style header; Style board; Style layout; Style indent;
-		Style screen; Style decal; Style overlay; Style gridsheet; Style sequence; Style element;
+		Style screen; Style decal; Style overlay; Style gridsheet; Style sequence; Style virtual_sequence; Style element;
 		Style label; Style title; Style message; Style text; Style bullet; Style button; Style wrap_button; Style multi_button; Style toggle; Style checkbox; Style checkmark;
 		Style dummy; Style tooltip; Style rectangle; Style viewport; Style type_in; Style text_edit; Style type_zone; Style caret; Style image; Style image_stretch;
 		Style radio_switch; Style radio_switch_h; Style radio_choice; Style radio_choice_item;
@@ -32,4 +33,6 @@ namespace two
 	export_ TWO_UI_EXPORT Styles& styles();
 
 	extern map<string, Style*> g_styles;
+	extern map<string, StyleId> g_style_ids;
+	extern vector<Style*> g_style_table;
 }
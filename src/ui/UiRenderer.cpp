@@ -9,6 +9,7 @@ module two.ui;
 #else
 #include <stl/string.h>
 #include <stl/map.h>
+#include <stl/vector.hpp>
 #include <infra/Log.h>
 #include <math/Vec.hpp>
 #include <ui/UiRenderer.h>
@@ -22,6 +23,7 @@ module two.ui;
 #endif
 
 #include <cstdio>
+#include <cstring>
 
 namespace two
 {
@@ -82,21 +84,30 @@ namespace two
 		this->draw_rect(rect, paint);
 	}
 
-	void Vg::fill_text(cstring text, size_t len, const vec4& rect, const TextPaint& paint, TextRow& row)
+	void Vg::append_glyphs(const vec4& rect, const TextPaint& paint, TextRow& row, vector<TextGlyph>& glyphs)
+	{
+		const size_t first = glyphs.size();
+		this->break_glyphs(rect, paint, row, glyphs);
+		row.m_first_glyph = first;
+		row.m_glyphs = { glyphs.data() + first, glyphs.size() - first };
+	}
+
+	void Vg::fill_text(cstring text, size_t len, const vec4& rect, const TextPaint& paint, TextRow& row, vector<TextGlyph>& glyphs)
 	{
 		row = text_row(text, text, text + len, { rect.x, rect.y, this->text_size(text, len, Axis::X, paint), line_height(paint) });
-		this->break_glyphs(rect, paint, row);
+		this->append_glyphs(rect, paint, row, glyphs);
 	}
 
-	void Vg::break_text_width(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row)
+	void Vg::break_text_width(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row, vector<TextGlyph>& glyphs)
 	{
 		this->break_next_row(text, first, end, rect, paint, row);
+		row.m_first_glyph = glyphs.size();
 
 		if(row.m_start != row.m_end)
-			this->break_glyphs(rect, paint, row);
+			this->append_glyphs(rect, paint, row, glyphs);
 	}
 
-	void Vg::break_text_returns(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row)
+	void Vg::break_text_returns(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row, vector<TextGlyph>& glyphs)
 	{
 		const char* iter = first;
 
@@ -104,25 +115,40 @@ namespace two
 			++iter;
 
 		row = text_row(text, first, iter, { rect.x, rect.y, this->text_size(first, iter - first, Axis::X, paint), line_height(paint) });
-		this->break_glyphs(rect, paint, row);
+		this->append_glyphs(rect, paint, row, glyphs);
 
 		// @kludge because text_size doesn't report the correct size when there is a space at the end : investigate (vg-renderer, nanovg)
 		if(!row.m_glyphs.empty())
-			row.m_rect = { rect.x, rect.y, row.m_glyphs.back().m_rect.x + row.m_glyphs.back().m_rect.width, line_height(paint) };
+		{
+			const TextGlyph& last = row.m_glyphs[row.m_glyphs.size() - 1];
+			row.m_rect = { rect.x, rect.y, last.m_rect.x + last.m_rect.width, line_height(paint) };
+		}
+	}
+
+	void Vg::break_text_row(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row, vector<TextGlyph>& glyphs)
+	{
+		if(paint.m_text_wrap)
+			this->break_text_width(text, first, end, rect, paint, row, glyphs);
+		else
+			this->break_text_returns(text, first, end, rect, paint, row, glyphs);
 	}
 
-	void Vg::break_text(cstring text, size_t len, const vec2& space, const TextPaint& paint, vector<TextRow>& textRows)
+	void Vg::break_text(cstring text, size_t len, const vec2& space, const TextPaint& paint, vector<TextRow>& textRows, vector<TextGlyph>& glyphs)
 	{
 		float line_height = this->line_height(paint);
 
 		textRows.clear();
+		glyphs.clear();
+
+		// at most one glyph per byte : reserving up front keeps the row views valid while breaking
+		glyphs.reserve(len);
 
 		if(!paint.m_text_break)
 		{
 			textRows.resize(1);
 
 			vec4 rect(0.f, 0.f, space.x, line_height);
-			this->fill_text(text, len, rect, paint, textRows[0]);
+			this->fill_text(text, len, rect, paint, textRows[0], glyphs);
 			return;
 		}
 
@@ -136,13 +162,12 @@ namespace two
 			TextRow& row = textRows.back();
 
 			vec4 rect(0.f, index * line_height, space.x, 0.f);
-			if(paint.m_text_wrap)
-				this->break_text_width(text, first, end, rect, paint, row);
-			else
-				this->break_text_returns(text, first, end, rect, paint, row);
+			this->break_text_row(text, first, end, rect, paint, row, glyphs);
 
 			first = row.m_end + 1;
 		}
+
+		bind_glyphs(textRows, glyphs);
 	}
 
 	struct UiRenderer::Impl
@@ -152,6 +177,9 @@ namespace two
 		bool m_debug_fadded_rect = false;
 		bool m_debug_fontent_rect = false;
 		bool m_debug_flip_rect = false;
+
+		// damage of the last rendered frame, kept for the stats overlay
+		vector<vec4> m_damage;
 	};
 
 	UiRenderer::UiRenderer(Vg& vg)
@@ -172,23 +200,58 @@ namespace two
 		m_debug_batch = 0;
 		static size_t prevBatch = 0;
 
+		m_stats = {};
+		m_impl->m_damage.clear();
+
 		m_vg.begin_frame(view, vec4(vec2(0.f), target.m_frame.m_size), pixel_ratio, colour);
 
-#ifdef TWO_UI_DRAW_CACHE
-		target.visit([&](Layer& layer) {
-			if(layer.redraw() || layer.forceRedraw())
-				this->render_layer(layer);
-		});
+		if(m_vg.retained())
+		{
+			// clean layers are only replayed : an idle ui doesn't traverse a single frame
+			target.visit([&](Layer& layer)
+			{
+				// layers are recorded in absolute coordinates, so a layer moved along with one of its parents is damaged as a whole
+				const vec4 bounds = layer.m_frame.absolute_rect();
+				if(bounds != layer.d_bounds)
+				{
+					layer.damage(layer.d_bounds);
+					layer.damage(bounds);
+					layer.d_bounds = bounds;
+				}
+
+				m_stats.m_layers++;
+				if(layer.redraw() || layer.damaged())
+				{
+					for(const vec4& rect : layer.d_damage)
+					{
+						m_impl->m_damage.push_back(rect);
+						m_stats.m_damage_area += rect.width * rect.height;
+					}
+					m_stats.m_damage_rects += layer.d_damage.size();
+					m_stats.m_recorded++;
+					this->render_layer(layer);
+				}
+				else
+					m_stats.m_cached++;
+			});
 
-		target.visit([&](Layer& layer) {
-			m_vg.draw_layer(layer, vec2(0.f), 1.f);
-		});
-#else
-		target.visit([&](Layer& layer)
+			target.visit([&](Layer& layer)
+			{
+				m_vg.draw_layer(layer, vec2(0.f), 1.f);
+			});
+		}
+		else
 		{
-			this->render_layer(layer);
-		});
-#endif
+			target.visit([&](Layer& layer)
+			{
+				m_stats.m_layers++;
+				m_stats.m_recorded++;
+				this->render_layer(layer);
+			});
+		}
+
+		if(m_stats_overlay)
+			this->draw_stats();
 
 		if(m_debug_batch > 1 && m_debug_batch != prevBatch)
 		{
@@ -204,9 +267,8 @@ namespace two
 		if(layer.master())
 			m_vg.begin_target();
 
-#ifdef TWO_UI_DRAW_CACHE
-		m_vg.begin_cached(layer);
-#endif
+		if(m_vg.retained())
+			m_vg.begin_cached(layer);
 
 		if(layer.m_frame.d_parent)
 			this->begin_layer(*layer.m_frame.d_parent);
@@ -221,9 +283,8 @@ namespace two
 		if(layer.m_frame.d_parent)
 			this->end_layer(*layer.m_frame.d_parent);
 
-#ifdef TWO_UI_DRAW_CACHE
-		m_vg.end_cached();
-#endif
+		if(m_vg.retained())
+			m_vg.end_cached();
 
 		if(layer.master())
 			m_vg.end_target();
@@ -480,6 +541,22 @@ namespace two
 			vg.stroke({ inkstyle.m_background_colour, inkstyle.m_border_colour, inkstyle.m_border_width.x });
 	}
 
+	void UiRenderer::draw_stats()
+	{
+		m_vg.begin_target();
+
+		for(const vec4& rect : m_impl->m_damage)
+			m_vg.debug_rect(rect, Colour::Red);
+
+		char text[128];
+		snprintf(text, 128, "layers %zu : %zu cached, %zu recorded - damage %zu rects, %.0f px", m_stats.m_layers, m_stats.m_cached, m_stats.m_recorded, m_stats.m_damage_rects, m_stats.m_damage_area);
+
+		const TextPaint paint = { "dejavu", Colour::White, 14.f, { Align::Left, Align::Left }, false, false };
+		m_vg.draw_text(vec2(8.f), text, text + strlen(text), paint);
+
+		m_vg.end_target();
+	}
+
 	void UiRenderer::log_FPS()
 	{
 		static size_t frames = 0;
@@ -42,12 +42,13 @@ namespace two
 		virtual void begin_target() = 0;
 		virtual void end_target() = 0;
 
-#ifdef TWO_UI_DRAW_CACHE
-		virtual void begin_cached(Layer& layer) = 0;
-		virtual void end_cached() = 0;
+		// retained mode : each layer is recorded once and replayed every frame until it is damaged
+		virtual bool retained() const { return false; }
+		virtual void begin_cached(Layer& layer) { UNUSED(layer); }
+		virtual void end_cached() {}
 
-		virtual void draw_layer(Layer& layer, const vec2& position = vec2(0.f), float scale = 1.f) = 0;
-#endif
+		virtual void draw_layer(Layer& layer, const vec2& position = vec2(0.f), float scale = 1.f) { UNUSED(layer); UNUSED(position); UNUSED(scale); }
+		virtual void release_layer(Layer& layer) { UNUSED(layer); }
 
 		virtual void begin_layer(Layer& layer, const vec2& position = vec2(0.f), float scale = 1.f) = 0;
 		virtual void end_layer() = 0;
@@ -84,14 +85,17 @@ namespace two
 
 		virtual void debug_rect(const vec4& rect, const Colour& colour);
 
-		virtual void break_text(cstring text, size_t len, const vec2& space, const TextPaint& paint, vector<TextRow>& rows);
+		virtual void break_text(cstring text, size_t len, const vec2& space, const TextPaint& paint, vector<TextRow>& rows, vector<TextGlyph>& glyphs);
+		void break_text_row(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row, vector<TextGlyph>& glyphs);
 
-		void fill_text(cstring text, size_t len, const vec4& rect, const TextPaint& paint, TextRow& row);
-		void break_text_width(const char* text, const char* start, const char* end, const vec4& rect, const TextPaint& paint, TextRow& textRow);
-		void break_text_returns(const char* text, const char* start, const char* end, const vec4& rect, const TextPaint& paint, TextRow& textRow);
+		void fill_text(cstring text, size_t len, const vec4& rect, const TextPaint& paint, TextRow& row, vector<TextGlyph>& glyphs);
+		void break_text_width(const char* text, const char* start, const char* end, const vec4& rect, const TextPaint& paint, TextRow& textRow, vector<TextGlyph>& glyphs);
+		void break_text_returns(const char* text, const char* start, const char* end, const vec4& rect, const TextPaint& paint, TextRow& textRow, vector<TextGlyph>& glyphs);
+		void append_glyphs(const vec4& rect, const TextPaint& paint, TextRow& textRow, vector<TextGlyph>& glyphs);
 
 		virtual void break_next_row(const char* text, const char* first, const char* end, const vec4& rect, const TextPaint& paint, TextRow& row) = 0;
-		virtual void break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& textRow) = 0;
+		// appends the glyphs of the row at the end of the glyph buffer
+		virtual void break_glyphs(const vec4& rect, const TextPaint& paint, TextRow& textRow, vector<TextGlyph>& glyphs) = 0;
 
 		virtual float line_height(const TextPaint& paint) = 0;
 		virtual float text_size(cstring text, size_t len, Axis dim, const TextPaint& paint) = 0;
@@ -119,6 +123,15 @@ namespace two
 	export_ TWO_UI_EXPORT void draw_image_stretch(Vg& vg, const Image& image, const vec4& rect, const vec2& stretch = { 1.f, 1.f });
 	export_ TWO_UI_EXPORT void draw_skin_image(Vg& vg, const Frame& frame, int section, vec4 rect);
 
+	export_ struct TWO_UI_EXPORT UiRenderStats
+	{
+		size_t m_layers = 0;
+		size_t m_cached = 0;
+		size_t m_recorded = 0;
+		size_t m_damage_rects = 0;
+		float m_damage_area = 0.f;
+	};
+
 	export_ class TWO_UI_EXPORT UiRenderer
 	{
 	public:
@@ -138,6 +151,12 @@ namespace two
 		void draw_frame(const Frame& frame);
 
 		void log_FPS();
+		void draw_stats();
+
+		// stats of the last rendered frame
+		UiRenderStats m_stats;
+		// overlays the stats and outlines the damaged rects of each frame
+		bool m_stats_overlay = false;
 
 	protected:
 		Vg& m_vg;
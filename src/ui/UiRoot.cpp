@@ -44,6 +44,8 @@ namespace two
 
 	void Ui::input_frame()
 	{
+		m_solved_frames = 0;
+
 		Widget* hovered = static_cast<Widget*>(m_mouse.heartbeat().m_receiver);
 		if(hovered != m_hovered)
 		{
@@ -51,6 +53,9 @@ namespace two
 			m_hovered = hovered;
 		}
 
+		// the declaration of this frame can create and destroy frames
+		m_hit_index.clear();
+
 		m_drop = {};
 	}
 
@@ -64,7 +69,7 @@ namespace two
 
 		m_cursor_style = &ui::cursor_styles().cursor;
 
-		m_frame.relayout();
+		m_solved_frames += m_frame.relayout();
 	}
 
 	void Ui::clear_events()
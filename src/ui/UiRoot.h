@@ -13,6 +13,7 @@
 #endif
 #include <ui/Forward.h>
 #include <ui/WidgetStruct.h>
+#include <ui/Frame/HitIndex.h>
 
 namespace two
 {
@@ -56,5 +57,11 @@ namespace two
 		Widget* m_hovered = nullptr;
 		DropAction m_drop = {};
 		Clock m_tooltip_clock;
+
+		// frames solved by the layout in the current frame
+		size_t m_solved_frames = 0;
+
+		// built once the frame widgets are declared, valid until they are declared again
+		HitIndex m_hit_index;
 	};
 }
@@ -153,7 +153,7 @@ namespace two
 
 		m_ui->input_frame();
 
-		m_ui->m_frame.relayout();
+		m_ui->m_solved_frames += m_ui->m_frame.relayout();
 
 		return !m_shutdown;
 	}
@@ -168,6 +168,7 @@ namespace two
 			// add sub layers
 		}
 
+		m_ui->m_hit_index.build(m_ui->m_frame);
 		m_ui->clear_events();
 	}
 
@@ -146,7 +146,10 @@ namespace two
 
 	Widget* Widget::pinpoint(vec2 pos, const FrameFilter& filter)
 	{
-		Frame* frame = two::pinpoint(m_frame, pos, filter);
+		Frame* frame = nullptr;
+		const HitIndex& index = this->ui().m_hit_index;
+		if(!index.pinpoint(m_frame, m_frame.derive_position(pos), filter, frame))
+			frame = two::pinpoint(m_frame, pos, filter);
 		return frame ? &frame->d_widget : nullptr;
 	}
 
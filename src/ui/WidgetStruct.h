@@ -82,6 +82,8 @@ namespace two
 		virtual void receive_event(InputEvent& event) override;
 		//virtual ControlNode* propagate_event(InputEvent& event) override;
 
+		virtual void reordered() override { m_frame.mark_dirty(DIRTY_LAYOUT); }
+
 		attr_ Frame m_frame;
 		attr_ WidgetState m_state = CREATED;
 		attr_ uint32_t m_switch = 0;
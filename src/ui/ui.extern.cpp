@@ -17,10 +17,13 @@ namespace stl
 	template class TWO_UI_EXPORT vector<Text::ColorSection>;
 	template class TWO_UI_EXPORT vector<TextMarker>;
 	template class TWO_UI_EXPORT vector<TextEdit::Action>;
+	template class TWO_UI_EXPORT vector<TextPiece>;
 	template class TWO_UI_EXPORT vector<Space>;
 	template class TWO_UI_EXPORT vector<FrameSolver*>;
 	template class TWO_UI_EXPORT vector<Style*>;
 	template class TWO_UI_EXPORT vector<Layer*>;
+	template class TWO_UI_EXPORT vector<HitEntry>;
+	template class TWO_UI_EXPORT vector<vector<uint32_t>>;
 	template class TWO_UI_EXPORT vector<Docker*>;
 	template class TWO_UI_EXPORT vector<Dock*>;
 	template class TWO_UI_EXPORT vector<Node*>;
@@ -36,8 +39,6 @@ namespace stl
 	template class TWO_UI_EXPORT unordered_map<string, Style*>;
 
 	template class TWO_UI_EXPORT unordered_set<string>;
-	template class TWO_UI_EXPORT vector<LanguageDefinition::StringToken>;
-	template class TWO_UI_EXPORT vector<LanguageDefinition::RegexToken>;
 	template class TWO_UI_EXPORT unordered_map<string, Identifier>;
 }
 #endif
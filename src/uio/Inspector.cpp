@@ -9,6 +9,7 @@ module two.uio;
 #else
 #include <tree/Graph.hpp>
 #include <stl/algorithm.h>
+#include <infra/ToString.h>
 #include <type/Any.h>
 #include <ecs/ECS.hpp>
 #include <refl/Class.h>
@@ -264,6 +265,198 @@ namespace two
 			object_edit_inline(table, object);
 	}
 
+	struct BulkMember
+	{
+		Member* m_member = nullptr;
+		size_t m_offset = 0;			// offset of the member from the start of the edited type, bases included
+	};
+
+	struct BulkEditState : public NodeState
+	{
+		Type* m_type = nullptr;
+		vector<BulkMember> m_members;
+		vector<void*> m_objects;
+	};
+
+	static void bulk_edit_setup(BulkEditState& state, Type& type, void* first)
+	{
+		state.m_type = &type;
+		state.m_members.clear();
+
+		for(Member& member : cls(type).m_members)
+			if(member.is_mutable() && !member.is_component() && !member.m_get)
+			{
+				// the upcast of a member to its declaring class is the same for all the objects of one type
+				char* base = (char*)member.cast(Ref(first, type)).m_value;
+				const size_t offset = size_t(base - (char*)first) + member.m_offset;
+				state.m_members.push_back({ &member, offset });
+			}
+	}
+
+	static bool bulk_member_edit(Widget& table, BulkMember& bulk, span<void*> objects)
+	{
+		Member& member = *bulk.m_member;
+		Type& type = *member.m_type;
+
+		auto field = [&](void* object) { return (void*)((char*)object + bulk.m_offset); };
+
+		// the values are compared to the first one, up to the first that differs
+		bool mixed = false;
+		for(size_t i = 1; i < objects.size() && !mixed; ++i)
+			mixed = member.is_pointer() ? *(void**)field(objects[0]) != *(void**)field(objects[i])
+										: !compare(Ref(field(objects[0]), type), Ref(field(objects[i]), type));
+
+		Widget& row = ui::table_row(table);
+		ui::label(row, member.m_name);
+
+		// the first object is edited in place, then copied to the others
+		Ref value = member.is_pointer() ? Ref(*(void**)field(objects[0]), type) : Ref(field(objects[0]), type);
+		const bool changed = any_edit(row, value, member.is_link() | member.is_pointer());
+
+		if(mixed)
+			ui::label(row, "(mixed)");
+
+		if(!changed)
+			return false;
+
+		if(member.is_pointer())
+		{
+			for(void* object : objects)
+				*(void**)field(object) = value.m_value;
+		}
+		else
+		{
+			for(size_t i = 1; i < objects.size(); ++i)
+				meta(type).copy_assign(Ref(field(objects[i]), type), value);
+		}
+
+		return true;
+	}
+
+	static bool bulk_object_edit(Widget& parent, Type& type, BulkEditState& state)
+	{
+		if(state.m_objects.empty())
+			return false;
+
+		if(state.m_type != &type)
+			bulk_edit_setup(state, type, state.m_objects[0]);
+
+		static cstring columns[2] = { "field", "value" };
+		static float spans[2] = { 0.4f, 0.6f };
+		Table& self = ui::table(parent, { columns, 2 }, { spans, 2 });
+
+		bool changed = false;
+		for(BulkMember& member : state.m_members)
+			changed |= bulk_member_edit(self, member, state.m_objects);
+		return changed;
+	}
+
+	bool bulk_object_edit(Widget& parent, Type& type, span<Ref> objects)
+	{
+		BulkEditState& state = parent.state<BulkEditState>();
+		state.m_objects.clear();
+		for(Ref object : objects)
+		{
+			if(object.m_type != &type)
+				object = cls(object).upcast(object, type);
+			if(object.m_value)
+				state.m_objects.push_back(object.m_value);
+		}
+		return bulk_object_edit(parent, type, state);
+	}
+
+	bool bulk_object_edit(Widget& parent, Type& type, void* first, size_t stride, size_t count)
+	{
+		BulkEditState& state = parent.state<BulkEditState>();
+		state.m_objects.resize(count);
+		for(size_t i = 0; i < count; ++i)
+			state.m_objects[i] = (char*)first + i * stride;
+		return bulk_object_edit(parent, type, state);
+	}
+
+	struct BulkStream
+	{
+		EntityStream* m_stream;
+		vector<uint32_t> m_indices;		// all the buffers of a stream share the indices of its entities
+	};
+
+	static Buffer* stream_buffer(EntityStream& stream, Type& type)
+	{
+		for(auto& buffer : stream.m_buffers)
+			if(buffer->m_type == &type)
+				return buffer.get();
+		return nullptr;
+	}
+
+	bool bulk_entity_edit(Widget& parent, span<Entity> entities)
+	{
+		if(entities.empty())
+			return false;
+
+		bool changed = false;
+
+		static cstring columns[2] = { "field", "value" };
+		static float spans[2] = { 0.4f, 0.6f };
+		Table& self = ui::table(parent, { columns, 2 }, { spans, 2 });
+
+		// a selection of mixed archetypes is grouped by stream
+		vector<BulkStream> streams;
+		for(Entity entity : entities)
+		{
+			EntityStream& stream = s_ecs[entity.m_ecs]->stream(entity.m_stream);
+			auto it = find_if(streams.begin(), streams.end(), [&](const BulkStream& bulk) { return bulk.m_stream == &stream; });
+			if(it == streams.end())
+			{
+				streams.push_back({ &stream, {} });
+				it = streams.end() - 1;
+			}
+			it->m_indices.push_back(stream.m_handles[entity.m_handle]);
+		}
+
+		vector<Type*> types;
+		for(BulkStream& bulk : streams)
+			for(auto& buffer : bulk.m_stream->m_buffers)
+				if(!has(types, buffer->m_type))
+					types.push_back(buffer->m_type);
+
+		// each component is edited on all the streams that have it, the entities without it are counted in its title
+		for(Type* component : types)
+		{
+			Type& type = *component;
+
+			size_t count = 0;
+			for(BulkStream& bulk : streams)
+				if(stream_buffer(*bulk.m_stream, type))
+					count += bulk.m_indices.size();
+
+			const string title = count < entities.size()
+				? string(type.m_name) + " (" + to_string(count) + " of " + to_string(entities.size()) + ")"
+				: string(type.m_name);
+
+			Widget& row = ui::table_separator(self);
+			Widget* body = ui::tree_node(row, title.c_str(), false, true).m_body;
+			if(!body)
+				continue;
+
+			// the components are addressed straight in the contiguous storage of the buffers
+			const size_t stride = meta(type).m_size;
+
+			BulkEditState& state = body->state<BulkEditState>();
+			state.m_objects.clear();
+			for(BulkStream& bulk : streams)
+				if(Buffer* buffer = stream_buffer(*bulk.m_stream, type))
+				{
+					char* data = (char*)buffer->data();
+					for(uint32_t index : bulk.m_indices)
+						state.m_objects.push_back(data + index * stride);
+				}
+
+			changed |= bulk_object_edit(*body, type, state);
+		}
+
+		return changed;
+	}
+
 	void multi_inspector(Widget& parent, Type& type, vector<Var>& objects, size_t& selected)
 	{
 		enum Modes { CREATE = 1 << 0, TYPE_INFO = 1 << 1 };
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <stl/vector.h>
+#include <stl/span.h>
 #include <ecs/Entity.h>
 #include <uio/Forward.h>
 
@@ -50,6 +51,17 @@ namespace two
 
 	export_ TWO_UIO_EXPORT func_ void multi_object_edit(Widget& parent, Type& type, vector<Ref> objects);
 
+	// edits a selection of objects of the same type as one : each member shows the value of the first object, flagged when
+	// the selection holds different values, and an edit is copied to every object through the member offset
+	export_ TWO_UIO_EXPORT bool bulk_object_edit(Widget& parent, Type& type, span<Ref> objects);
+	// objects laid out contiguously in memory, stride bytes apart
+	export_ TWO_UIO_EXPORT bool bulk_object_edit(Widget& parent, Type& type, void* first, size_t stride, size_t count);
+	// edits the components of the entities sharing the stream of the first one
+	export_ TWO_UIO_EXPORT bool bulk_entity_edit(Widget& parent, span<Entity> entities);
+
+	template <class T>
+	bool bulk_object_edit(Widget& parent, span<T> objects) { return bulk_object_edit(parent, type<T>(), objects.data(), sizeof(T), objects.size()); }
+
 	template <class T_Object>
 	T_Object* deref(unique<T_Object>& element) { return element.get(); }
 
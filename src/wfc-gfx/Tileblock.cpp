@@ -103,6 +103,7 @@ namespace two
 	void WfcBlock::reset()
 	{
 		m_wave = TileWave(*m_tileset, uint16_t(m_size.x), uint16_t(m_size.y), uint16_t(m_size.z), false);
+		m_wave.m_backtrack_limit = m_backtrack;
 		this->update(m_wave);
 	}
 
@@ -120,7 +121,15 @@ namespace two
 
 	void WfcBlock::solve(size_t limit)
 	{
-		m_wave.solve(limit);
+		m_wave.m_backtrack_limit = m_backtrack;
+
+		if(limit == 0 && m_chunk != uvec3(0U))
+			solve_chunks(m_wave, m_chunk, m_chunk_margin);
+		else if(limit == 0 && m_seeds > 1)
+			solve_seeds(m_wave, m_seeds);
+		else
+			m_wave.solve(limit);
+
 		this->update(m_wave);
 	}
 
@@ -134,7 +143,7 @@ namespace two
 			uint16_t tile = UINT16_MAX;
 
 			for(uint16_t t = 0; t < wave.m_states.size(); ++t)
-				if(wave.m_wave.at(x, y, z)[t])
+				if(wave.possible(wave.index(uint32_t(x), uint32_t(y), uint32_t(z)), t))
 					tile = (num_states++ == 0) ? t : UINT16_MAX;
 
 			m_entropy.at(x, y, z) = num_states;
@@ -383,7 +392,7 @@ namespace two
 		auto query_models = [&](ModelArrayView& state)
 		{
 			for(size_t t = 0; t < tileblock.m_wave.m_states.size(); ++t)
-				if(tileblock.m_wave.m_wave.at(coord.x, coord.y, coord.z)[t])
+				if(tileblock.m_wave.possible(coord, uint16_t(t)))
 				{
 					Tile& tile = tileblock.m_tileset->m_tiles_flip[t];
 					TileModel& tile_model = tileblock.m_tile_models[tile.m_index];
@@ -412,7 +421,7 @@ namespace two
 
 		Gnode& node = gfx::node(parent, vec3(coord));
 
-		size_t index = tileblock.m_wave.m_wave.indexAt(coord.x, coord.y, coord.z);
+		size_t index = tileblock.m_wave.index(coord.x, coord.y, coord.z);
 		size_t side = size_t(ceil(sqrt(float(tileblock.m_entropy[index]))));
 		size_t columns = tileblock.m_entropy[index] / side;
 
@@ -420,7 +429,7 @@ namespace two
 
 		size_t count = 0;
 		for(uint16_t t = 0; t < tileblock.m_wave.m_states.size(); ++t)
-			if(tileblock.m_wave.m_wave.at(coord.x, coord.y, coord.z)[t])
+			if(tileblock.m_wave.possible(coord, t))
 			{
 				vec3 position = offset + vec3(float(count % side), 0.f, float(count / side));
 				Gnode& con = gfx::node(node, position, tileblock.m_tile_models[t].m_rotation, tileblock.m_tileset->m_tile_scale / 2.f);
@@ -466,6 +475,18 @@ namespace two
 		if(button("solve 10"))
 			tileblock.solve(10);
 
+		ui::field<uint32_t>(body, "seeds", tileblock.m_seeds, {});
+		ui::field<uint32_t>(body, "backtrack", tileblock.m_backtrack, {});
+
+		// leave the chunk size at 0, 0, 0 to solve the whole block at once
+		ui::field<uint32_t>(body, "chunk x", tileblock.m_chunk.x, {});
+		ui::field<uint32_t>(body, "chunk y", tileblock.m_chunk.y, {});
+		ui::field<uint32_t>(body, "chunk z", tileblock.m_chunk.z, {});
+		ui::field<uint32_t>(body, "chunk margin", tileblock.m_chunk_margin, {});
+
+		if(button("solve"))
+			tileblock.solve(0);
+
 		static uint16_t tile = 0;
 		ui::field<uint16_t>(body, "tile", tile, {});
 
@@ -41,6 +41,12 @@ namespace two
 
 		bool m_auto_solve = false;
 
+		// solve(0) settings : randomized seeds solved in parallel, chunked solving, and bounded backtracking
+		uint32_t m_seeds = 1;
+		uvec3 m_chunk = uvec3(0U);
+		uint32_t m_chunk_margin = 2;
+		uint32_t m_backtrack = 0;
+
 		uvec3 to_coord(const vec3& position);
 		vec3 to_position(const uvec3& coord);
 
@@ -147,25 +147,25 @@ namespace two
 			if(!wave.m_periodic && (sx + n > wave.m_width || sy + n > wave.m_height || sz + n > wave.m_depth))
 				continue;
 		
-			for(size_t t2 = 0; t2 < wave.m_states.size(); ++t2)
+			const uint32_t cell = wave.index(sx, sy, sz);
+
+			for(uint16_t t2 = 0; t2 < wave.m_states.size(); ++t2)
 			{
-				if(!wave.m_wave.at(sx, sy, sz)[t2])
+				if(!wave.possible(cell, t2))
 					continue;
 
 				bool can_pattern_fit = false;
 
 				const vector<PatternIndex>& prop = tileset.m_propagator.at(n - 1 - dx, n - 1 - dy, n - 1 - dz)[t2];
 				for(const auto& t3 : prop) {
-					if(wave.m_wave.at(changed.x, changed.y, changed.z)[t3]) {
+					if(wave.possible(changed, t3)) {
 						can_pattern_fit = true;
 						break;
 					}
 				}
 
-				if(!can_pattern_fit) {
-					wave.m_wave.at(sx, sy, sz)[t2] = false;
-					wave.m_changes.push_back(uvec3(sx, sy, sz));
-				}
+				if(!can_pattern_fit)
+					wave.ban(cell, t2);
 			}
 		}
 	}
@@ -320,7 +320,7 @@ namespace two
 							continue;
 
 						for(size_t t = 0; t < wave.m_states.size(); ++t)
-							if(wave.m_wave.at(sx, sy)[t])
+							if(wave.possible(wave.index(sx, sy, 0), uint16_t(t)))
 								tile_contributors.push_back(tileset.m_patterns[t][dx + dy * tileset.m_n]);
 					}
 			}
@@ -0,0 +1,242 @@
+//  Copyright (c) 2019 Hugo Amiard hugo.amiard@laposte.net
+//  This software is provided 'as-is' under the zlib License, see the LICENSE.txt file.
+//  This notice and the license may not be removed or altered from any source distribution.
+
+#include <infra/Cpp20.h>
+#ifndef TWO_CPP_20
+#include <atomic>
+#include <climits>
+#endif
+
+#ifdef TWO_MODULES
+module two.wfc;
+#else
+#include <stl/vector.hpp>
+#include <stl/math.h>
+#include <math/Vec.hpp>
+#include <math/Random.h>
+#include <jobs/Job.h>
+#include <wfc/Wfc.h>
+#endif
+
+namespace two
+{
+	struct SplitMix
+	{
+		mutable uint64_t m_state;
+
+		double operator()() const
+		{
+			uint64_t z = (m_state += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			z = z ^ (z >> 31);
+			return double(z >> 11) * (1.0 / 9007199254740992.0);
+		}
+	};
+
+	RandomDouble random_sequence(uint64_t seed)
+	{
+		return SplitMix{ seed };
+	}
+
+	void restrict_wave(Wave& wave, const Wave& source, const uvec3& origin)
+	{
+		const uint16_t states = uint16_t(wave.m_states.size());
+
+		for(uint32_t z = 0; z < wave.m_depth; ++z)
+			for(uint32_t y = 0; y < wave.m_height; ++y)
+				for(uint32_t x = 0; x < wave.m_width; ++x)
+				{
+					const uint32_t cell = wave.index(x, y, z);
+					const uint32_t from = source.index(origin.x + x, origin.y + y, origin.z + z);
+					for(uint16_t t = 0; t < states; ++t)
+						if(!source.possible(from, t) && wave.possible(cell, t))
+							wave.ban(cell, t);
+				}
+	}
+
+	template <class T_Task>
+	void run_tasks(uint32_t count, const T_Task& task)
+	{
+		JobSystem* js = JobSystem::instance();
+		if(js && count > 1)
+		{
+			Job* parent = js->job();
+			for(uint32_t i = 0; i < count; ++i)
+			{
+				auto run = [&task, i](JobSystem&, Job*) { task(i); };
+				js->run(js->job(parent, run));
+			}
+			js->complete(parent);
+		}
+		else
+		{
+			for(uint32_t i = 0; i < count; ++i)
+				task(i);
+		}
+	}
+
+	Result solve_seeds(Wave& wave, uint32_t seeds, uint64_t seed)
+	{
+		if(seed == 0)
+			seed = randi<ullong>(1, ULLONG_MAX);
+
+		vector<Wave> waves(max(seeds, 1U), wave);
+		std::atomic<uint32_t> winner = { UINT32_MAX };
+
+		auto attempt = [&](uint32_t i)
+		{
+			Wave& attempt = waves[i];
+			attempt.m_random_double = random_sequence(seed + i * 0x9E3779B97F4A7C15ULL);
+
+			// solve in steps, so that the other attempts stop as soon as one succeeds
+			Result result = Result::kUnfinished;
+			while(result == Result::kUnfinished && winner.load() == UINT32_MAX)
+				result = attempt.solve(64);
+
+			uint32_t none = UINT32_MAX;
+			if(result == Result::kSuccess)
+				winner.compare_exchange_strong(none, i);
+		};
+
+		if(JobSystem::instance())
+			run_tasks(uint32_t(waves.size()), attempt);
+		else
+			for(uint32_t i = 0; i < waves.size() && winner.load() == UINT32_MAX; ++i)
+				attempt(i);
+
+		const uint32_t index = winner.load();
+		wave = waves[index == UINT32_MAX ? 0 : index];
+		return index == UINT32_MAX ? Result::kFail : Result::kSuccess;
+	}
+
+	struct WaveChunk
+	{
+		uvec3 m_lo;
+		uvec3 m_hi;
+		uvec3 m_min;
+		uvec3 m_max;
+		uint8_t m_phase;
+		vector<uint16_t> m_tiles;
+		Result m_result = Result::kUnfinished;
+	};
+
+	void solve_chunk(const Wave& wave, WaveChunk& chunk, uint32_t attempts, uint64_t seed)
+	{
+		const uvec3 size = chunk.m_max - chunk.m_min;
+
+		Wave base = { uint16_t(wave.m_states.size()), uint16_t(size.x), uint16_t(size.y), uint16_t(size.z), false };
+		base.m_rules = wave.m_rules;
+		base.m_states = wave.m_states;
+		base.m_valid_coord = [](int, int, int) { return true; };
+		base.m_backtrack_limit = wave.m_backtrack_limit;
+
+		// the base is set up by its first ban, on a job thread : its noise comes from the chunk seed, not the shared generator
+		base.m_random_double = random_sequence(seed);
+
+		restrict_wave(base, wave, chunk.m_min);
+		base.propagate();
+
+		for(uint32_t a = 0; a < max(attempts, 1U); ++a)
+		{
+			Wave attempt = base;
+			attempt.m_random_double = random_sequence(seed + (a + 1) * 0x9E3779B97F4A7C15ULL);
+			chunk.m_result = attempt.solve(0);
+			if(chunk.m_result != Result::kSuccess)
+				continue;
+
+			// only the core is kept : the margin is solved so that the core boundary can be extended
+			chunk.m_tiles.clear();
+			for(uint32_t z = chunk.m_lo.z; z < chunk.m_hi.z; ++z)
+				for(uint32_t y = chunk.m_lo.y; y < chunk.m_hi.y; ++y)
+					for(uint32_t x = chunk.m_lo.x; x < chunk.m_hi.x; ++x)
+					{
+						const uvec3 local = uvec3(x, y, z) - chunk.m_min;
+						chunk.m_tiles.push_back(tile_at(attempt, uint16_t(local.x), uint16_t(local.y), uint16_t(local.z)));
+					}
+			return;
+		}
+	}
+
+	Result solve_chunks(Wave& wave, const uvec3& chunk_size, uint32_t margin, uint32_t attempts, uint64_t seed)
+	{
+		if(!wave.m_rules || wave.m_periodic)
+			return wave.solve(0);
+
+		if(seed == 0)
+			seed = randi<ullong>(1, ULLONG_MAX);
+
+		const uvec3 size = uvec3(wave.m_width, wave.m_height, wave.m_depth);
+		const uvec3 chunk = max(chunk_size, uvec3(1U));
+		const uvec3 count = (size + chunk - 1U) / chunk;
+
+		wave.propagate();
+
+		vector<WaveChunk> chunks;
+		for(uint32_t z = 0; z < count.z; ++z)
+			for(uint32_t y = 0; y < count.y; ++y)
+				for(uint32_t x = 0; x < count.x; ++x)
+				{
+					WaveChunk c;
+					c.m_lo = uvec3(x, y, z) * chunk;
+					c.m_hi = min(c.m_lo + chunk, size);
+					c.m_min = uvec3(max(ivec3(c.m_lo) - int(margin), ivec3(0)));
+					c.m_max = min(c.m_hi + margin, size);
+					// chunks of the same phase never share a face, so they can be solved at the same time
+					c.m_phase = uint8_t((x % 2) | (y % 2) << 1 | (z % 2) << 2);
+					chunks.push_back(c);
+				}
+
+		for(uint8_t phase = 0; phase < 8; ++phase)
+		{
+			vector<WaveChunk*> batch;
+			for(WaveChunk& c : chunks)
+				if(c.m_phase == phase)
+					batch.push_back(&c);
+
+			if(batch.empty())
+				continue;
+
+			auto task = [&](uint32_t i)
+			{
+				WaveChunk& c = *batch[i];
+				solve_chunk(wave, c, attempts, seed + wave.index(c.m_lo.x, c.m_lo.y, c.m_lo.z) * 0xBF58476D1CE4E5B9ULL);
+			};
+
+			run_tasks(uint32_t(batch.size()), task);
+
+			// fix the chunk cores in the wave, and propagate them to the neighbouring chunks before the next phase
+			// chunks can disagree on constraints that span more than a chunk : the phase is then undone, and the rest solved serially
+			auto fix = [&](WaveChunk& c) -> bool
+			{
+				if(c.m_result != Result::kSuccess)
+					return false;
+
+				size_t i = 0;
+				for(uint32_t z = c.m_lo.z; z < c.m_hi.z; ++z)
+					for(uint32_t y = c.m_lo.y; y < c.m_hi.y; ++y)
+						for(uint32_t x = c.m_lo.x; x < c.m_hi.x; ++x)
+						{
+							const uint16_t tile = c.m_tiles[i++];
+							if(tile == UINT16_MAX || !wave.possible(uvec3(x, y, z), tile))
+								return false;
+							wave.set_tile(uvec3(x, y, z), tile);
+						}
+
+				wave.propagate();
+				return !wave.m_contradiction;
+			};
+
+			const Wave snapshot = wave;
+			for(WaveChunk* c : batch)
+				if(!fix(*c))
+				{
+					wave = snapshot;
+					return wave.solve(0);
+				}
+		}
+
+		return wave.solve(0);
+	}
+}
@@ -11,6 +11,7 @@ module two.wfc;
 using Json = json11::Json;
 
 #include <stl/algorithm.h>
+#include <stl/bitset.h>
 #include <infra/ToString.h>
 #include <srlz/Serial.h>
 #include <math/Axes.h>
@@ -157,6 +158,21 @@ namespace two
 				side(SignedAxis::MinusZ).at(t1, t2) = side(SignedAxis::PlusZ).at(t2, t1);
 				side(SignedAxis::MinusY).at(t1, t2) = side(SignedAxis::PlusY).at(t2, t1);
 			}
+
+		// flatten the propagator into per state support lists
+		for(size_t d = 0; d < 6; ++d)
+		{
+			m_rules.m_offsets[d].clear();
+			m_rules.m_supported[d].clear();
+			for(uint16_t t1 = 0; t1 < m_num_tiles; ++t1)
+			{
+				m_rules.m_offsets[d].push_back(uint32_t(m_rules.m_supported[d].size()));
+				for(uint16_t t2 = 0; t2 < m_num_tiles; ++t2)
+					if(m_propagator[d].at(t2, t1))
+						m_rules.m_supported[d].push_back(t2);
+			}
+			m_rules.m_offsets[d].push_back(uint32_t(m_rules.m_supported[d].size()));
+		}
 	}
 
 	void load_rule_propagator(WaveTileset& tileset, const Json& config)
@@ -303,44 +319,27 @@ namespace two
 		return true;
 	}
 
-	uint16_t tile_at(Wave& wave, uint16_t x, uint16_t y, uint16_t z)
+	uint16_t tile_at(const Wave& wave, uint16_t x, uint16_t y, uint16_t z)
 	{
+		const uint32_t cell = wave.index(x, y, z);
+
 		uint16_t num_states = 0;;
 		uint16_t tile = UINT16_MAX;
 
-		for(uint16_t t = 0; t < wave.m_states.size(); ++t)
-			if(wave.m_wave.at(x, y, z)[t])
-				tile = (num_states++ == 0) ? t : UINT16_MAX;
-
-		return tile;
-	}
-
-	void propagate_tiled(WaveTileset& tileset, Wave& wave)
-	{
-		uvec3 changed = pop(wave.m_changes);
-
-		int directions = wave.m_depth == 1 ? 4 : 6;
-		for(int d = 0; d < directions; d++)
+		for(uint32_t w = 0; w < wave.m_words; ++w)
 		{
-			uvec3 coord;
-			if(!neighbour(wave, changed, SignedAxis(d), coord)) continue;
-
-			for(size_t t2 = 0; t2 < wave.m_states.size(); t2++)
-				if(wave.m_wave.at(coord.x, coord.y, coord.z)[t2])
-				{
-					bool b = false;
-
-					for(size_t t1 = 0; t1 < wave.m_states.size() && !b; ++t1)
-						if(wave.m_wave.at(changed.x, changed.y, changed.z)[t1])
-							b = tileset.m_propagator[d].at(t2, t1) != 0;
-
-					if(!b)
-					{
-						wave.m_wave.at(coord.x, coord.y, coord.z)[t2] = false;
-						wave.m_changes.push_back(coord);
-					}
-				}
+			const uint64_t bits = wave.m_bits[cell * wave.m_words + w];
+			if(bits == 0) continue;
+
+			// index of the lowest set bit
+			const uint16_t t = uint16_t(w * 64 + stl::popcount((bits & (~bits + 1)) - 1));
+			num_states += uint16_t(stl::popcount(bits));
+			if(num_states > 1)
+				return UINT16_MAX;
+			tile = t;
 		}
+
+		return tile;
 	}
 
 	TileWave::TileWave()
@@ -350,7 +349,7 @@ namespace two
 	TileWave::TileWave(WaveTileset& tileset, uint16_t width, uint16_t height, uint16_t depth, bool periodic)
 		: Wave(tileset.m_num_tiles, width, height, depth, periodic)
 	{
-		m_propagate = [&](Wave& wave) { propagate_tiled(tileset, wave); };
+		m_rules = &tileset.m_rules;
 		m_valid_coord = [](int, int, int) { return true; };
 		m_states = tileset.m_weights;
 	}
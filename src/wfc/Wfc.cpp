@@ -6,12 +6,15 @@
 #ifndef TWO_CPP_20
 #include <cmath>
 #include <cfloat>
+#include <cstring>
 #endif
 
 #ifdef TWO_MODULES
 module two.wfc;
 #else
 #include <stl/limits.h>
+#include <stl/bitset.h>
+#include <stl/algorithm.h>
 #include <infra/ToString.h>
 #include <math/Random.h>
 #include <math/Grid.hpp>
@@ -59,71 +62,271 @@ namespace two
 		, m_depth(depth)
 		, m_periodic(periodic)
 		, m_states(states, 1.0)
-		, m_wave(width, height, depth, vector<ubool>(states, true))
 	{
 		m_random_double = []() -> double { return randf<double>(); };
+		this->clear();
 	}
 
 	void Wave::clear()
 	{
-		m_wave.reset(m_width, m_height, m_depth, vector<ubool>(m_states.size(), true));
+		const size_t cells = size_t(m_width) * m_height * m_depth;
+		const uint16_t states = uint16_t(m_states.size());
+
+		m_words = (states + 63) / 64;
+		m_bits.resize(cells * m_words);
+		for(size_t cell = 0; cell < cells; ++cell)
+			for(uint32_t w = 0; w < m_words; ++w)
+			{
+				const uint32_t count = states - w * 64U < 64U ? states - w * 64U : 64U;
+				m_bits[cell * m_words + w] = count == 64 ? UINT64_MAX : (uint64_t(1) << count) - 1;
+			}
+
 		m_changes.clear();
+		m_bans.clear();
+		m_ready = false;
+		m_contradiction = false;
+
+		m_backtracks = 0;
+		m_decisions.clear();
+		m_trail.clear();
+		m_propagated.clear();
 	}
 
-	Result Wave::find_lowest_entropy(uvec3& coord)
+	// weights, validity and propagation rules are assigned after construction, so the running state is built on first use
+	void Wave::setup()
 	{
-		// We actually calculate exp(entropy), i.e. the sum of the weights of the possible patterns
-		double min = FLT_MAX;// std::numeric_limits<double>::infinity();
+		const uint32_t cells = uint32_t(m_width) * m_height * m_depth;
+		const uint16_t states = uint16_t(m_states.size());
 
-		for(uint16_t x = 0; x < m_width; ++x)
-			for(uint16_t y = 0; y < m_height; ++y)
-				for(uint16_t z = 0; z < m_depth; ++z)
-				{
-					if(!m_valid_coord(x, y, z)) continue;
+		m_weight_logs.resize(states);
+		double sum_weights = 0.0;
+		double sum_weight_logs = 0.0;
+		for(uint16_t t = 0; t < states; ++t)
+		{
+			m_weight_logs[t] = m_states[t] > 0.0 ? m_states[t] * log(m_states[t]) : 0.0;
+			sum_weights += m_states[t];
+			sum_weight_logs += m_weight_logs[t];
+		}
 
-					size_t states = 0;
-					double entropy = 0;
+		const double entropy = sum_weights > 0.0 ? log(sum_weights) - sum_weight_logs / sum_weights : 0.0;
 
-					for(uint16_t t = 0; t < m_states.size(); ++t)
-					{
-						if(m_wave.at(x, y, z)[t])
-						{
-							states += 1;
-							entropy += m_states[t];
-						}
-					}
+		m_num_possible.clear();
+		m_num_possible.resize(cells, states);
+		m_sum_weights.clear();
+		m_sum_weights.resize(cells, sum_weights);
+		m_sum_weight_logs.clear();
+		m_sum_weight_logs.resize(cells, sum_weight_logs);
+		m_entropies.clear();
+		m_entropies.resize(cells, entropy);
+
+		m_noise.resize(cells);
+		for(uint32_t cell = 0; cell < cells; ++cell)
+			m_noise[cell] = 1e-6 * m_random_double();
+
+		m_directions = m_depth == 1 ? 4 : 6;
+		if(m_rules)
+		{
+			// supports of t in direction d : the states of the cell behind d that enable t
+			vector<uint16_t> initial(size_t(states) * m_directions, 0);
+			for(uint32_t d = 0; d < m_directions; ++d)
+				for(uint16_t t1 = 0; t1 < states; ++t1)
+					for(uint32_t i = m_rules->m_offsets[d][t1]; i < m_rules->m_offsets[d][t1 + 1]; ++i)
+						initial[m_rules->m_supported[d][i] * m_directions + d]++;
+
+			m_supports.resize(size_t(cells) * initial.size());
+			for(uint32_t cell = 0; cell < cells; ++cell)
+				memcpy(&m_supports[size_t(cell) * initial.size()], initial.data(), initial.size() * sizeof(uint16_t));
+		}
+
+		m_heap.clear();
+		m_heap_index.clear();
+		m_heap_index.resize(cells, UINT32_MAX);
+		m_ready = true;
+
+		for(uint32_t cell = 0; cell < cells; ++cell)
+		{
+			const uvec3 c = this->coord(cell);
+			if(states > 1 && m_valid_coord(c.x, c.y, c.z))
+				this->heap_update(cell);
+		}
 
-					if(entropy == 0 || states == 0)
-					{
-						int directions = m_depth == 1 ? 4 : 6;
+		if(m_rules)
+		{
+			// states that no state supports from some side can only be removed upfront : their count never reaches zero
+			vector<uint8_t> sides(cells, 0);
+			for(uint32_t cell = 0; cell < cells; ++cell)
+				for(uint32_t d = 0; d < m_directions; ++d)
+				{
+					uvec3 c;
+					if(neighbour(*this, this->coord(cell), SignedAxis(d), c))
+						sides[this->index(c.x, c.y, c.z)] |= uint8_t(1 << d);
+				}
 
-						for(int d = 0; d < directions; d++)
+			for(uint32_t cell = 0; cell < cells; ++cell)
+				for(uint16_t t = 0; t < states; ++t)
+					for(uint32_t d = 0; d < m_directions; ++d)
+						if((sides[cell] & (1 << d)) && m_supports[(size_t(cell) * states + t) * m_directions + d] == 0)
 						{
-							uvec3 adjacent;
-							neighbour(*this, { x, y, z }, SignedAxis(d), adjacent);
-							m_failure_point[d] = tile_at(*this, uint16_t(adjacent.x), uint16_t(adjacent.y), uint16_t(adjacent.z));
+							if(this->possible(cell, t))
+								this->ban(cell, t);
+							break;
 						}
-						return Result::kFail;
-					}
+		}
+	}
+
+	void Wave::heap_update(uint32_t cell)
+	{
+		auto priority = [&](uint32_t i) { return m_entropies[m_heap[i]] + m_noise[m_heap[i]]; };
+		auto swap = [&](uint32_t a, uint32_t b)
+		{
+			const uint32_t cell = m_heap[a];
+			m_heap[a] = m_heap[b];
+			m_heap[b] = cell;
+			m_heap_index[m_heap[a]] = a;
+			m_heap_index[m_heap[b]] = b;
+		};
+
+		uint32_t i = m_heap_index[cell];
+		if(i == UINT32_MAX)
+		{
+			i = uint32_t(m_heap.size());
+			m_heap.push_back(cell);
+			m_heap_index[cell] = i;
+		}
+
+		while(i > 0 && priority(i) < priority((i - 1) / 2))
+		{
+			swap(i, (i - 1) / 2);
+			i = (i - 1) / 2;
+		}
 
-					if(states == 1)
-						continue; // Already frozen
+		const uint32_t size = uint32_t(m_heap.size());
+		while(true)
+		{
+			const uint32_t l = 2 * i + 1;
+			const uint32_t r = 2 * i + 2;
+			uint32_t lowest = i;
+			if(l < size && priority(l) < priority(lowest)) lowest = l;
+			if(r < size && priority(r) < priority(lowest)) lowest = r;
+			if(lowest == i) break;
+			swap(i, lowest);
+			i = lowest;
+		}
+	}
 
-					// Add a tie-breaking bias:
-					const double noise = 0.5 * m_random_double();
-					entropy += noise;
+	void Wave::heap_remove(uint32_t cell)
+	{
+		const uint32_t i = m_heap_index[cell];
+		if(i == UINT32_MAX)
+			return;
 
-					if(entropy < min)
-					{
-						min = entropy;
-						coord = { x, y, z };
-					}
-				}
+		const uint32_t last = m_heap.back();
+		m_heap.pop_back();
+		m_heap_index[cell] = UINT32_MAX;
 
-		if(min == FLT_MAX) //std::numeric_limits<double>::infinity())
-			return Result::kSuccess;
+		if(last != cell)
+		{
+			m_heap[i] = last;
+			m_heap_index[last] = i;
+			this->heap_update(last);
+		}
+	}
+
+	void Wave::ban(uint32_t cell, uint16_t t)
+	{
+		// setup might already remove t
+		if(!m_ready)
+			this->setup();
+		if(!this->possible(cell, t))
+			return;
+
+		m_bits[cell * m_words + t / 64] &= ~(uint64_t(1) << (t % 64));
+
+		const uint16_t count = --m_num_possible[cell];
+		m_sum_weights[cell] -= m_states[t];
+		m_sum_weight_logs[cell] -= m_weight_logs[t];
+
+		const double sum = m_sum_weights[cell];
+		m_entropies[cell] = sum > 0.0 ? log(sum) - m_sum_weight_logs[cell] / sum : 0.0;
+
+		if(count > 1)
+		{
+			if(m_heap_index[cell] != UINT32_MAX)
+				this->heap_update(cell);
+		}
 		else
-			return Result::kUnfinished;
+		{
+			this->heap_remove(cell);
+			const uvec3 c = this->coord(cell);
+			if(count == 0 && !m_contradiction && m_valid_coord(c.x, c.y, c.z))
+			{
+				m_contradiction = true;
+				m_contradiction_cell = cell;
+			}
+		}
+
+		if(m_rules)
+			m_bans.push_back({ cell, t });
+		else
+			m_changes.push_back(this->coord(cell));
+
+		if(m_backtrack_limit > 0)
+			m_trail.push_back({ cell, t });
+
+		m_stabilized = false;
+	}
+
+	void Wave::propagate_ban(uint32_t cell, uint16_t t1)
+	{
+		const uint32_t states = uint32_t(m_states.size());
+		const uvec3 changed = this->coord(cell);
+
+		if(m_backtrack_limit > 0)
+			m_propagated.push_back({ cell, t1 });
+
+		for(uint32_t d = 0; d < m_directions; ++d)
+		{
+			uvec3 c;
+			if(!neighbour(*this, changed, SignedAxis(d), c)) continue;
+
+			const uint32_t adjacent = this->index(c.x, c.y, c.z);
+			uint16_t* supports = &m_supports[size_t(adjacent) * states * m_directions];
+
+			for(uint32_t i = m_rules->m_offsets[d][t1]; i < m_rules->m_offsets[d][t1 + 1]; ++i)
+			{
+				const uint16_t t2 = m_rules->m_supported[d][i];
+				uint16_t& count = supports[t2 * m_directions + d];
+				if(count > 0 && --count == 0 && this->possible(adjacent, t2))
+					this->ban(adjacent, t2);
+			}
+		}
+	}
+
+	Result Wave::find_lowest_entropy(uvec3& coord)
+	{
+		if(!m_ready)
+			this->setup();
+
+		if(m_contradiction)
+		{
+			coord = this->coord(m_contradiction_cell);
+
+			for(uint32_t d = 0; d < m_directions; d++)
+			{
+				uvec3 adjacent;
+				if(neighbour(*this, coord, SignedAxis(d), adjacent))
+					m_failure_point[d] = tile_at(*this, uint16_t(adjacent.x), uint16_t(adjacent.y), uint16_t(adjacent.z));
+				else
+					m_failure_point[d] = UINT16_MAX;
+			}
+			return Result::kFail;
+		}
+
+		if(m_heap.empty())
+			return Result::kSuccess;
+
+		coord = this->coord(m_heap[0]);
+		return Result::kUnfinished;
 	}
 
 	Result Wave::observe()
@@ -135,44 +338,126 @@ namespace two
 		if(m_state != Result::kUnfinished)
 			return m_state;
 
+		const uint32_t cell = this->index(coord.x, coord.y, coord.z);
+
 		vector<double> distribution(m_states.size());
 		for(uint16_t t = 0; t < m_states.size(); ++t)
-			distribution[t] = m_wave.at(coord.x, coord.y, coord.z)[t] ? m_states[t] : 0;
+			distribution[t] = this->possible(cell, t) ? m_states[t] : 0;
 
 		size_t r = spin_the_bottle(distribution, m_random_double());
-		for(uint16_t t = 0; t < m_states.size(); ++t)
-			m_wave.at(coord.x, coord.y, coord.z)[t] = (t == r);
 
-		m_changes.push_back(coord);
-		m_stabilized = false;
+		if(m_backtrack_limit > 0)
+			m_decisions.push_back({ cell, uint16_t(r), uint32_t(m_trail.size()), uint32_t(m_propagated.size()) });
+
+		for(uint16_t t = 0; t < m_states.size(); ++t)
+			if(t != r && this->possible(cell, t))
+				this->ban(cell, t);
 
 		return Result::kUnfinished;
 	}
 
 	void Wave::propagate(size_t limit)
 	{
-		for(size_t i = 0; (limit && i < limit) || (!limit && m_changes.size() > 0); ++i)
-			m_propagate(*this);
+		if(!m_ready)
+			this->setup();
 
-		if(m_changes.size() == 0)
+		auto pending = [&]() { return m_rules ? !m_bans.empty() : !m_changes.empty(); };
+
+		for(size_t i = 0; (!limit || i < limit) && pending(); ++i)
+		{
+			if(m_rules)
+			{
+				const uvec2 ban = pop(m_bans);
+				this->propagate_ban(ban.x, uint16_t(ban.y));
+			}
+			else
+				m_propagate(*this);
+		}
+
+		if(!pending())
 			m_stabilized = true;
 	}
 
+	bool Wave::backtrack()
+	{
+		if(m_decisions.empty() || m_backtracks >= m_backtrack_limit)
+			return false;
+
+		m_backtracks++;
+
+		const Decision decision = pop(m_decisions);
+		const uint32_t states = uint32_t(m_states.size());
+
+		// give back the supports removed by the bans propagated since the decision
+		while(m_propagated.size() > decision.m_propagated)
+		{
+			const uvec2 ban = pop(m_propagated);
+			const uvec3 changed = this->coord(ban.x);
+
+			for(uint32_t d = 0; d < m_directions; ++d)
+			{
+				uvec3 c;
+				if(!neighbour(*this, changed, SignedAxis(d), c)) continue;
+
+				const uint32_t adjacent = this->index(c.x, c.y, c.z);
+				uint16_t* supports = &m_supports[size_t(adjacent) * states * m_directions];
+
+				for(uint32_t i = m_rules->m_offsets[d][ban.y]; i < m_rules->m_offsets[d][ban.y + 1]; ++i)
+					supports[m_rules->m_supported[d][i] * m_directions + d]++;
+			}
+		}
+
+		// then restore the banned states
+		while(m_trail.size() > decision.m_trail)
+		{
+			const uvec2 ban = pop(m_trail);
+			const uint32_t cell = ban.x;
+			const uint16_t t = uint16_t(ban.y);
+
+			m_bits[cell * m_words + t / 64] |= uint64_t(1) << (t % 64);
+
+			const uint16_t count = ++m_num_possible[cell];
+			m_sum_weights[cell] += m_states[t];
+			m_sum_weight_logs[cell] += m_weight_logs[t];
+
+			const double sum = m_sum_weights[cell];
+			m_entropies[cell] = sum > 0.0 ? log(sum) - m_sum_weight_logs[cell] / sum : 0.0;
+
+			const uvec3 c = this->coord(cell);
+			if(count > 1 && m_valid_coord(c.x, c.y, c.z))
+				this->heap_update(cell);
+		}
+
+		m_bans.clear();
+		m_changes.clear();
+		m_contradiction = false;
+		m_state = Result::kUnfinished;
+
+		// the observed state led to a contradiction : rule it out and carry on from there
+		this->ban(decision.m_cell, decision.m_state);
+		this->propagate();
+		return true;
+	}
+
 	void Wave::set_tile(const uvec3& coord, uint16_t tile)
 	{
+		const uint32_t cell = this->index(coord.x, coord.y, coord.z);
 		for(uint16_t t = 0; t < m_states.size(); ++t)
-			if(t != tile)
-				m_wave.at(coord.x, coord.y, coord.z)[t] = false;
-
-		m_changes.push_back({ coord.x, coord.y, coord.z });
+			if(t != tile && this->possible(cell, t))
+				this->ban(cell, t);
 	}
 
 	Result Wave::solve(size_t limit)
 	{
+		this->propagate();
+
 		for(size_t l = 0; l < limit || limit == 0; ++l)
 		{
 			Result result = this->observe();
 
+			if(result == Result::kFail && this->backtrack())
+				continue;
+
 			if(result != Result::kUnfinished)
 				return result;
 
@@ -52,6 +52,14 @@ namespace two
 		int flip(int tile, uint8_t flip) const { return m_tiles_flip[tile].m_flips[flip]; }
 	};
 
+	// AC-4 supports : for direction d, the states a state t enables in the neighbour cell are
+	// m_supported[d][m_offsets[d][t]] to m_supported[d][m_offsets[d][t + 1]]
+	export_ struct TWO_WFC_EXPORT WaveRules
+	{
+		vector<uint32_t> m_offsets[6];
+		vector<uint16_t> m_supported[6];
+	};
+
 	using RandomDouble = function<double()>;
 	using ValidCoord = function<bool(int, int, int)>;
 	using Propagator = function<void(Wave&)>;
@@ -66,9 +74,49 @@ namespace two
 
 		vector<double> m_states;
 		vector<string> m_pattern_names; // debug
-		vector3d<vector<ubool>> m_wave;
 		vector<uvec3> m_changes;
 
+		// possible states of each cell, packed as bitsets of m_words 64 bit words, in vector3d order
+		uint32_t m_words = 0;
+		vector<uint64_t> m_bits;
+
+		// running sums per cell, updated on each ban
+		vector<uint16_t> m_num_possible;
+		vector<double> m_sum_weights;
+		vector<double> m_sum_weight_logs;
+		vector<double> m_entropies;
+		vector<double> m_noise;
+		vector<double> m_weight_logs;
+
+		// cells not yet collapsed, as a binary min-heap on entropy
+		vector<uint32_t> m_heap;
+		vector<uint32_t> m_heap_index;
+
+		// when set, propagation counts the remaining supports of each state (AC-4) instead of calling m_propagate
+		const WaveRules* m_rules = nullptr;
+		uint32_t m_directions = 6;
+		vector<uint16_t> m_supports;
+		vector<uvec2> m_bans;
+
+		bool m_ready = false;
+		bool m_contradiction = false;
+		uint32_t m_contradiction_cell = 0;
+
+		// bounded backtracking : on contradiction, undo the last observations instead of failing, at most m_backtrack_limit times
+		struct Decision
+		{
+			uint32_t m_cell;
+			uint16_t m_state;
+			uint32_t m_trail;
+			uint32_t m_propagated;
+		};
+
+		uint32_t m_backtrack_limit = 0;
+		uint32_t m_backtracks = 0;
+		vector<Decision> m_decisions;
+		vector<uvec2> m_trail;
+		vector<uvec2> m_propagated;
+
 		bool m_stabilized = true;
 		bool m_solved = false;
 		Result m_state = Result::kUnfinished;
@@ -93,17 +141,47 @@ namespace two
 		}*/
 
 		void clear();
+		void setup();
+
+		inline uint32_t index(uint32_t x, uint32_t y, uint32_t z) const { return x + y * m_width + z * m_width * m_height; }
+		inline uvec3 coord(uint32_t cell) const { return { cell % m_width, cell / m_width % m_height, cell / (m_width * m_height) }; }
+
+		inline bool possible(uint32_t cell, uint16_t t) const { return (m_bits[cell * m_words + t / 64] >> (t % 64)) & 1; }
+		inline bool possible(const uvec3& c, uint16_t t) const { return this->possible(this->index(c.x, c.y, c.z), t); }
+
+		void ban(uint32_t cell, uint16_t t);
+		void propagate_ban(uint32_t cell, uint16_t t);
+
+		void heap_update(uint32_t cell);
+		void heap_remove(uint32_t cell);
+
 		void set_tile(const uvec3& coord, uint16_t tile);
 		Result find_lowest_entropy(uvec3& coord);
 		Result observe();
 		void propagate(size_t limit = 0);
+		bool backtrack();
 
 		meth_ Result solve(size_t limit);
 	};
 
+	// deterministic generator for waves solved on worker threads, randf() shares one global engine
+	export_ TWO_WFC_EXPORT RandomDouble random_sequence(uint64_t seed);
+
+	// restrict the cells of wave to the states possible in source, offset by origin in source
+	export_ TWO_WFC_EXPORT void restrict_wave(Wave& wave, const Wave& source, const uvec3& origin);
+
+	// solve copies of wave with different seeds on the job system, and keep the first success
+	export_ TWO_WFC_EXPORT Result solve_seeds(Wave& wave, uint32_t seeds, uint64_t seed = 0);
+
+	// solve wave in chunks of chunk cells, each extended by margin cells on each side to keep its boundary solvable
+	// chunks that don't touch are solved in parallel on the job system, then their cores are fixed in wave and propagated
+	// requires AC-4 rules and a non periodic wave, otherwise falls back to solve(0)
+	export_ TWO_WFC_EXPORT Result solve_chunks(Wave& wave, const uvec3& chunk, uint32_t margin, uint32_t attempts = 4, uint64_t seed = 0);
+
 	export_ struct refl_ TWO_WFC_EXPORT WaveTileset : public Tileset
 	{
 		vector3d<ubool> m_propagator[6];
+		WaveRules m_rules;
 
 		constr_ WaveTileset();
 		void initialize();
@@ -120,7 +198,7 @@ namespace two
 	};
 
 	export_ TWO_WFC_EXPORT bool neighbour(Wave& wave, const uvec3& coord, SignedAxis d, uvec3& neighbour);
-	export_ TWO_WFC_EXPORT uint16_t tile_at(Wave& wave, uint16_t x, uint16_t y, uint16_t z);
+	export_ TWO_WFC_EXPORT uint16_t tile_at(const Wave& wave, uint16_t x, uint16_t y, uint16_t z);
 
 	export_ TWO_WFC_EXPORT void add_tile(Tileset& tileset, const set<string>& subset_tiles, const string& tile_name, char symmetry, float weight);
 	export_ TWO_WFC_EXPORT void add_tile(Tileset& tileset, const string& tile_name, char symmetry, float weight);
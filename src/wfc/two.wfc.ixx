@@ -9,6 +9,7 @@ export import std.regex;
 
 export import json11;
 export import two.infra;
+export import two.jobs;
 export import two.type;
 export import two.srlz;
 export import two.math;
@@ -11,6 +11,7 @@ namespace stl
 {
 	using namespace two;
 	template class TWO_WFC_EXPORT vector<Tile>;
+	template class TWO_WFC_EXPORT vector<Wave::Decision>;
 	template class TWO_WFC_EXPORT unordered_map<char, uint>;
 }
 #endif